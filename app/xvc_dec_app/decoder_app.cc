@@ -33,8 +33,6 @@
 #include <sstream>
 #include <vector>
 
-#include "xvc_dec_app/y4m_writer.h"
-
 namespace xvc_app {
 
 DecoderApp::~DecoderApp() {
@@ -88,6 +86,10 @@ void DecoderApp::ReadArguments(int argc, const char *argv[]) {
       std::stringstream(argv[++i]) >> cli_.simd_mask;
     } else if (arg == "-threads") {
       std::stringstream(argv[++i]) >> cli_.threads;
+    } else if (arg == "-low-delay") {
+      std::stringstream(argv[++i]) >> cli_.low_delay;
+    } else if (arg == "-output-direct-io") {
+      std::stringstream(argv[++i]) >> cli_.output_direct_io;
     } else if (arg == "-loop") {
       std::stringstream(argv[++i]) >> cli_.loop;
     } else if (arg == "-verbose") {
@@ -107,8 +109,15 @@ bool DecoderApp::CheckParameters() {
     std::exit(1);
   }
 
-  input_stream_.open(cli_.input_filename, std::ios_base::binary);
-  if (!input_stream_) {
+  if (cli_.input_filename == "-") {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    nal_reader_ = xvc::NalStreamReader::OpenStream(&std::cin);
+  } else {
+    nal_reader_ = xvc::NalStreamReader::OpenFile(cli_.input_filename);
+  }
+  if (!nal_reader_) {
     std::cerr << "Failed to open bitstream file: "
       << cli_.input_filename << std::endl;
     std::exit(1);
@@ -126,11 +135,21 @@ bool DecoderApp::CheckParameters() {
       if (filename_suffix == ".y4m") {
         output_y4m_format_ = true;
       }
-      file_output_stream_.open(cli_.output_filename, std::ios_base::binary);
-      if (!file_output_stream_) {
-        std::cerr << "Failed to open output file for writing: "
-          << cli_.output_filename << std::endl;
-        std::exit(1);
+      if (cli_.output_direct_io > 0) {
+        picture_writer_.reset(new PictureWriter(output_y4m_format_));
+        if (!picture_writer_->OpenDirect(cli_.output_filename)) {
+          // Fall back to buffered writes, e.g. on tmpfs
+          picture_writer_.reset();
+        }
+      }
+      if (!picture_writer_) {
+        file_output_stream_.open(cli_.output_filename,
+                                 std::ios_base::binary);
+        if (!file_output_stream_) {
+          std::cerr << "Failed to open output file for writing: "
+            << cli_.output_filename << std::endl;
+          std::exit(1);
+        }
       }
     }
   }
@@ -166,6 +185,9 @@ void DecoderApp::CreateAndConfigureApi() {
   if (cli_.threads != -1) {
     params_->threads = cli_.threads;
   }
+  if (cli_.low_delay != -1) {
+    params_->low_delay = cli_.low_delay;
+  }
   if (xvc_api_->parameters_check(params_) != XVC_DEC_OK) {
     std::cerr << "Error. Invalid parameters. Please check the values of the"
       " command line parameters." << std::endl;
@@ -184,48 +206,44 @@ void DecoderApp::PrintDecoderSettings() {
 }
 
 void DecoderApp::MainDecoderLoop() {
-  std::vector<uint8_t> nal_bytes_;
   xvc_decoded_picture decoded_pic;
   xvc_dec_return_code ret;
   num_pictures_decoded_ = 0;
   start_ = std::chrono::steady_clock::now();
-  std::ostream &output_stream = output_to_stdout_ ?
-    std::cout : file_output_stream_;
   if (output_to_stdout_) {
     std::cout.setf(std::ios::unitbuf);
 #ifdef _WIN32
     _setmode(_fileno(stdout), _O_BINARY);
 #endif
   }
+  // Decoded pictures are written on a separate thread
+  if (!picture_writer_ &&
+      (output_to_stdout_ || file_output_stream_.is_open())) {
+    picture_writer_.reset(new PictureWriter(output_y4m_format_));
+    picture_writer_->OpenStream(output_to_stdout_ ? &std::cout :
+                                &file_output_stream_);
+  }
   int loop_iterations = std::max(1, cli_.loop);
   if (cli_.loop == 0) {
     loop_iterations = std::numeric_limits<int>::max();
   }
-  Y4mWriter y4m_writer;
-
   while (true) {
-    // Get size of next Nal Unit.
-    // size = 0 means no more Nal Units (end of file).
-    size_t nal_size = ReadNextNalSize(&input_stream_);
-    if (!nal_size) {
-      if (--loop_iterations > 0) {
-        input_stream_.clear();
-        input_stream_.seekg(0, input_stream_.beg);
+    // Get next Nal Unit without copying it.
+    const uint8_t *nal;
+    size_t nal_size;
+    if (!nal_reader_->ReadNal(&nal, &nal_size)) {
+      if (nal_reader_->IsTruncated()) {
+        std::cerr << "Unable to read nal." << std::endl;
+        std::exit(1);
+      }
+      if (--loop_iterations > 0 && nal_reader_->Rewind()) {
         continue;
       }
       break;
     }
 
-    // Read next Nal Unit from file.
-    nal_bytes_.resize(nal_size);
-    input_stream_.read(reinterpret_cast<char *>(&nal_bytes_[0]), nal_size);
-    if (static_cast<size_t>(input_stream_.gcount()) < nal_size) {
-      std::cerr << "Unable to read nal." << std::endl;
-      std::exit(1);
-    }
-
     // Decode next Nal Unit.
-    ret = xvc_api_->decoder_decode_nal(decoder_, &nal_bytes_[0], nal_size, 0);
+    ret = xvc_api_->decoder_decode_nal(decoder_, nal, nal_size, 0);
     if (ret == XVC_DEC_BITSTREAM_VERSION_HIGHER_THAN_DECODER) {
       std::cerr << xvc_api_->xvc_dec_get_error_text(ret) << std::endl;
       std::exit(XVC_DEC_BITSTREAM_VERSION_HIGHER_THAN_DECODER);
@@ -236,11 +254,8 @@ void DecoderApp::MainDecoderLoop() {
 
     // Check if there is a decoded picture ready to be output.
     if (xvc_api_->decoder_get_picture(decoder_, &decoded_pic) == XVC_DEC_OK) {
-      if (output_stream.good()) {
-        if (output_y4m_format_) {
-          y4m_writer.WriteHeader(decoded_pic.stats, &output_stream);
-        }
-        output_stream.write(decoded_pic.bytes, decoded_pic.size);
+      if (picture_writer_) {
+        picture_writer_->WritePicture(decoded_pic);
       }
       if (cli_.verbose) {
         PrintPictureInfo(decoded_pic.stats);
@@ -256,24 +271,27 @@ void DecoderApp::MainDecoderLoop() {
     std::exit(ret);
   }
   while (xvc_api_->decoder_get_picture(decoder_, &decoded_pic) == XVC_DEC_OK) {
-    if (output_stream.good()) {
-      if (output_y4m_format_) {
-        y4m_writer.WriteHeader(decoded_pic.stats, &output_stream);
-      }
-      output_stream.write(decoded_pic.bytes, decoded_pic.size);
+    if (picture_writer_) {
+      picture_writer_->WritePicture(decoded_pic);
     }
     PrintPictureInfo(decoded_pic.stats);
     num_pictures_decoded_++;
   }
 
+  // Wait for the remaining pictures to be written
+  if (picture_writer_ && !picture_writer_->Close()) {
+    std::cerr << "Failed to write decoded pictures to: "
+      << cli_.output_filename << std::endl;
+  }
   end_ = std::chrono::steady_clock::now();
 }
 
 void DecoderApp::CloseStream() {
+  picture_writer_.reset();
   if (file_output_stream_.is_open()) {
     file_output_stream_.close();
   }
-  input_stream_.close();
+  nal_reader_.reset();
 }
 
 void DecoderApp::PrintStatistics() {
@@ -318,6 +336,7 @@ int DecoderApp::CheckConformance() {
 void DecoderApp::PrintUsage() {
   GetLog() << std::endl << "Usage: -bitstream-file <string>"
     " -output-file <string>  [Optional parameters]" << std::endl;
+  GetLog() << "  Bitstream file - is read from stdin" << std::endl;
   GetLog() << std::endl << "Optional parameters:" << std::endl;
   GetLog() << "  -output-width <int>" << std::endl;
   GetLog() << "  -output-height <int>" << std::endl;
@@ -328,20 +347,10 @@ void DecoderApp::PrintUsage() {
   GetLog() << "      3: 4:4:4" << std::endl;
   GetLog() << "  -output-bitdepth <int>" << std::endl;
   GetLog() << "  -max-framerate <int>" << std::endl;
+  GetLog() << "  -low-delay <0/1>" << std::endl;
+  GetLog() << "  -output-direct-io <0/1>" << std::endl;
   GetLog() << "  -loop <int>" << std::endl;
-  GetLog() << "  -verbose <0/1>" << std::endl;
-}
-
-size_t DecoderApp::ReadNextNalSize(std::istream *input) {
-  size_t length;
-  uint8_t nal_size[4];
-  input->read(reinterpret_cast<char *>(nal_size), 4);
-  if (input->gcount() < 4) {
-    return 0;
-  }
-  length = nal_size[0] | (nal_size[1] << 8) | (nal_size[2] << 16) |
-    (nal_size[3] << 24);
-  return length;
+  GetLog() << "  -verbose <0/1/2>" << std::endl;
 }
 
 void DecoderApp::PrintPictureInfo(xvc_dec_pic_stats pic_stats) {
@@ -413,6 +422,26 @@ void DecoderApp::PrintPictureInfo(xvc_dec_pic_stats pic_stats) {
     }
     GetLog() << std::endl;
   }
+  if (cli_.verbose >= 2) {
+    GetLog() << std::fixed << std::setprecision(2);
+    GetLog() << "  Bytes:" << std::setw(8) << pic_stats.nal_bytes;
+    GetLog() << "  Time:" << std::setw(8) << pic_stats.decode_time_ms;
+    GetLog() << "  CPU:" << std::setw(8) << pic_stats.cpu_time_ms;
+    GetLog() << "  Queue:" << std::setw(8) << pic_stats.queue_wait_ms;
+    GetLog() << "  CUs 4-128: {";
+    int num_sizes =
+      sizeof(pic_stats.num_cus_by_size) / sizeof(pic_stats.num_cus_by_size[0]);
+    for (int i = 0; i < num_sizes; i++) {
+      GetLog() << std::setw(6) << pic_stats.num_cus_by_size[i];
+    }
+    GetLog() << " }  Intra:" << std::setw(6) << pic_stats.num_intra_cus;
+    GetLog() << "  Inter:" << std::setw(6) << pic_stats.num_inter_cus;
+    GetLog() << "  Merge:" << std::setw(6) << pic_stats.num_merge_cus;
+    GetLog() << "  Skip:" << std::setw(6) << pic_stats.num_skip_cus;
+    GetLog() << std::endl;
+    GetLog().unsetf(std::ios_base::floatfield);
+    GetLog() << std::setprecision(6);
+  }
 }
 
 }  // namespace xvc_app
@@ -24,8 +24,11 @@
 #include <chrono>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <string>
 
+#include "xvc_dec_app/picture_writer.h"
+#include "xvc_dec_lib/nal_stream_reader.h"
 #include "xvc_dec_lib/xvcdec.h"
 
 namespace xvc_app {
@@ -45,13 +48,13 @@ public:
 
 private:
   void PrintUsage();
-  size_t ReadNextNalSize(std::istream *input);
   void PrintPictureInfo(xvc_dec_pic_stats pic_stats);
   std::ostream& GetLog() {
     return !log_to_stderr_ ? std::cout : std::cerr;
   }
 
-  std::ifstream input_stream_;
+  std::unique_ptr<xvc::NalStreamReader> nal_reader_;
+  std::unique_ptr<PictureWriter> picture_writer_;
   std::ofstream file_output_stream_;
   bool output_to_stdout_ = false;
   bool log_to_stderr_ = false;
@@ -73,6 +76,8 @@ private:
     int max_framerate = -1;
     int simd_mask = -1;
     int threads = -1;
+    int output_direct_io = 0;
+    int low_delay = -1;
     int loop = -1;
     int verbose = 0;
   } cli_;
@@ -0,0 +1,216 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_dec_app/picture_writer.h"
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+namespace xvc_app {
+
+PictureWriter::PictureWriter(bool y4m_format, int queue_size)
+  : y4m_format_(y4m_format),
+  queue_size_(queue_size > 0 ? queue_size : 1),
+  buffers_(queue_size_) {
+  for (int i = 0; i < queue_size_; i++) {
+    free_buffers_.push_back(i);
+  }
+}
+
+PictureWriter::~PictureWriter() {
+  Close();
+}
+
+void PictureWriter::OpenStream(std::ostream *output) {
+  assert(!thread_.joinable());
+  output_ = output;
+  Start();
+}
+
+bool PictureWriter::OpenDirect(const std::string &filename) {
+  assert(!thread_.joinable());
+#if defined(_WIN32) || !defined(O_DIRECT)
+  return false;
+#else
+  fd_ = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+  if (fd_ < 0) {
+    return false;
+  }
+  direct_buffer_.resize(kDirectIoBlockSize + kDirectIoAlignment);
+  uintptr_t addr = reinterpret_cast<uintptr_t>(&direct_buffer_[0]);
+  direct_block_ = &direct_buffer_[0] +
+    ((kDirectIoAlignment - (addr & (kDirectIoAlignment - 1))) &
+    (kDirectIoAlignment - 1));
+  direct_size_ = 0;
+  Start();
+  return true;
+#endif
+}
+
+void PictureWriter::WritePicture(const xvc_decoded_picture &decoded_pic) {
+  std::string header;
+  if (y4m_format_) {
+    std::ostringstream header_stream;
+    y4m_writer_.WriteHeader(decoded_pic.stats, &header_stream);
+    header = header_stream.str();
+  }
+  QueuedPicture picture;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    buffer_cond_.wait(lock, [this]() { return !free_buffers_.empty(); });
+    picture.buffer_index = free_buffers_.back();
+    free_buffers_.pop_back();
+  }
+  // Buffers keep their capacity so copying does not reallocate after the
+  // first pictures
+  std::vector<char> &buffer = buffers_[picture.buffer_index];
+  picture.size = header.size() + decoded_pic.size;
+  if (buffer.size() < picture.size) {
+    buffer.resize(picture.size);
+  }
+  if (!header.empty()) {
+    std::memcpy(&buffer[0], header.data(), header.size());
+  }
+  if (decoded_pic.size > 0) {
+    std::memcpy(&buffer[header.size()], decoded_pic.bytes, decoded_pic.size);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.push_back(picture);
+  picture_cond_.notify_one();
+}
+
+bool PictureWriter::Close() {
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closing_ = true;
+    }
+    picture_cond_.notify_one();
+    thread_.join();
+  }
+#if !defined(_WIN32) && defined(O_DIRECT)
+  if (fd_ >= 0) {
+    if (direct_size_ > 0) {
+      // The last partial block can not be written with direct io
+      int flags = fcntl(fd_, F_GETFL);
+      if (flags == -1 || fcntl(fd_, F_SETFL, flags & ~O_DIRECT) == -1 ||
+          !WriteFile(direct_block_, direct_size_)) {
+        failed_ = true;
+      }
+      direct_size_ = 0;
+    }
+    if (close(fd_) != 0) {
+      failed_ = true;
+    }
+    fd_ = -1;
+  }
+#endif
+  if (output_) {
+    output_->flush();
+    if (!output_->good()) {
+      failed_ = true;
+    }
+    output_ = nullptr;
+  }
+  return !failed_;
+}
+
+void PictureWriter::Start() {
+  closing_ = false;
+  thread_ = std::thread(&PictureWriter::WriterMain, this);
+}
+
+void PictureWriter::WriterMain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    picture_cond_.wait(lock, [this]() {
+      return !queue_.empty() || closing_;
+    });
+    if (queue_.empty()) {
+      break;
+    }
+    QueuedPicture picture = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    Write(&buffers_[picture.buffer_index][0], picture.size);
+    lock.lock();
+    free_buffers_.push_back(picture.buffer_index);
+    buffer_cond_.notify_one();
+  }
+}
+
+void PictureWriter::Write(const char *data, size_t size) {
+  if (failed_ || size == 0) {
+    return;
+  }
+  if (fd_ >= 0) {
+    WriteDirect(data, size);
+  } else if (output_->good()) {
+    output_->write(data, size);
+  }
+}
+
+void PictureWriter::WriteDirect(const char *data, size_t size) {
+  // Pictures are gathered into aligned blocks of fixed size as required by
+  // direct io, the remainder is kept until the next picture
+  const size_t block_size = kDirectIoBlockSize;
+  while (size > 0) {
+    size_t num_bytes = std::min(size, block_size - direct_size_);
+    std::memcpy(direct_block_ + direct_size_, data, num_bytes);
+    direct_size_ += num_bytes;
+    data += num_bytes;
+    size -= num_bytes;
+    if (direct_size_ == block_size) {
+      if (!WriteFile(direct_block_, block_size)) {
+        failed_ = true;
+        return;
+      }
+      direct_size_ = 0;
+    }
+  }
+}
+
+bool PictureWriter::WriteFile(const char *data, size_t size) {
+#if defined(_WIN32)
+  return false;
+#else
+  while (size > 0) {
+    ssize_t ret = write(fd_, data, size);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      return false;
+    }
+    data += ret;
+    size -= static_cast<size_t>(ret);
+  }
+  return true;
+#endif
+}
+
+}  // namespace xvc_app
@@ -0,0 +1,94 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_DEC_APP_PICTURE_WRITER_H_
+#define XVC_DEC_APP_PICTURE_WRITER_H_
+
+#include <stddef.h>
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "xvc_dec_app/y4m_writer.h"
+#include "xvc_dec_lib/xvcdec.h"
+
+namespace xvc_app {
+
+// Writes decoded pictures on a separate thread so that the decoding loop
+// does not block on disk or pipe throughput. Each picture is copied into a
+// buffer from a small recycled pool since the decoder reuses its output
+// buffer on the next call to decoder_get_picture. The caller only blocks
+// when all buffers of the pool are waiting to be written.
+class PictureWriter {
+public:
+  static const int kDefaultQueueSize = 4;
+  static const size_t kDirectIoAlignment = 4096;
+  static const size_t kDirectIoBlockSize = 4 << 20;
+
+  explicit PictureWriter(bool y4m_format,
+                         int queue_size = kDefaultQueueSize);
+  ~PictureWriter();
+  // Writes to a stream, e.g. stdout or an already opened file
+  void OpenStream(std::ostream *output);
+  // Opens the file for unbuffered writes in large aligned blocks bypassing
+  // the page cache (O_DIRECT). Returns false if not supported by the
+  // platform or file system.
+  bool OpenDirect(const std::string &filename);
+  void WritePicture(const xvc_decoded_picture &decoded_pic);
+  // Waits for all queued pictures to be written, returns false if any write
+  // has failed.
+  bool Close();
+
+private:
+  struct QueuedPicture {
+    int buffer_index;
+    size_t size;
+  };
+  void Start();
+  void WriterMain();
+  void Write(const char *data, size_t size);
+  void WriteDirect(const char *data, size_t size);
+  bool WriteFile(const char *data, size_t size);
+
+  const bool y4m_format_;
+  const int queue_size_;
+  Y4mWriter y4m_writer_;
+  std::ostream *output_ = nullptr;
+  int fd_ = -1;
+  std::vector<char> direct_buffer_;
+  char *direct_block_ = nullptr;
+  size_t direct_size_ = 0;
+  bool failed_ = false;
+  std::vector<std::vector<char>> buffers_;
+  std::vector<int> free_buffers_;
+  std::deque<QueuedPicture> queue_;
+  bool closing_ = false;
+  std::mutex mutex_;
+  std::condition_variable picture_cond_;
+  std::condition_variable buffer_cond_;
+  std::thread thread_;
+};
+
+}  // namespace xvc_app
+
+#endif  // XVC_DEC_APP_PICTURE_WRITER_H_
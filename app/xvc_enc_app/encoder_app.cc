@@ -30,6 +30,7 @@
 #include <sstream>
 #include <vector>
 
+#include "xvc_enc_app/picture_reader.h"
 #include "xvc_enc_app/y4m_reader.h"
 
 namespace xvc_app {
@@ -116,6 +117,16 @@ void EncoderApp::ReadArguments(int argc, const char *argv[]) {
       std::stringstream(argv[++i]) >> cli_.tc_offset;
     } else if (arg == "-qp") {
       std::stringstream(argv[++i]) >> cli_.qp;
+    } else if (arg == "-bitrate") {
+      std::stringstream(argv[++i]) >> cli_.bitrate;
+    } else if (arg == "-vbv-buffer-size") {
+      std::stringstream(argv[++i]) >> cli_.vbv_buffer_size;
+    } else if (arg == "-tile-columns") {
+      std::stringstream(argv[++i]) >> cli_.tile_columns;
+    } else if (arg == "-tile-rows") {
+      std::stringstream(argv[++i]) >> cli_.tile_rows;
+    } else if (arg == "-threads") {
+      std::stringstream(argv[++i]) >> cli_.threads;
     } else if (arg == "-flat-lambda") {
       std::stringstream(argv[++i]) >> cli_.flat_lambda;
     } else if (arg == "-speed-mode") {
@@ -298,6 +309,21 @@ void EncoderApp::CreateAndConfigureApi() {
   if (cli_.qp != -1) {
     params_->qp = cli_.qp;
   }
+  if (cli_.bitrate != -1) {
+    params_->target_bitrate = cli_.bitrate;
+  }
+  if (cli_.vbv_buffer_size != -1) {
+    params_->vbv_buffer_size = cli_.vbv_buffer_size;
+  }
+  if (cli_.tile_columns != -1) {
+    params_->tile_columns = cli_.tile_columns;
+  }
+  if (cli_.tile_rows != -1) {
+    params_->tile_rows = cli_.tile_rows;
+  }
+  if (cli_.threads != -1) {
+    params_->threads = cli_.threads;
+  }
   if (cli_.flat_lambda >= 0) {
     params_->flat_lambda = cli_.flat_lambda;
   }
@@ -332,25 +358,44 @@ void EncoderApp::PrintEncoderSettings() {
     << std::endl;
   std::cout << "Bitdepth:     " << params_->input_bitdepth << std::endl;
   std::cout << "Framerate:    " << params_->framerate << std::endl;
-  std::cout << "QP:           " << params_->qp << std::endl;
+  if (params_->target_bitrate > 0) {
+    std::cout << "Bitrate:      " << params_->target_bitrate << " kbit/s"
+      << std::endl;
+  } else {
+    std::cout << "QP:           " << params_->qp << std::endl;
+  }
 }
 
 void EncoderApp::MainEncoderLoop() {
-  // Calculate how much data to read for each picture.
-  std::vector<uint8_t> picture_bytes;
-  int picture_samples = 0;
-  if (params_->chroma_format == XVC_ENC_CHROMA_FORMAT_MONOCHROME) {
-    picture_samples = params_->width * params_->height;
-  } else if (params_->chroma_format == XVC_ENC_CHROMA_FORMAT_420) {
-    picture_samples = (3 * (params_->width * params_->height)) >> 1;
+  // Calculate how much data to read for each picture and where each of the
+  // planes starts within the picture.
+  const int sample_size = params_->input_bitdepth == 8 ? 1 : 2;
+  int chroma_width = 0;
+  int chroma_height = 0;
+  if (params_->chroma_format == XVC_ENC_CHROMA_FORMAT_420) {
+    chroma_width = params_->width >> 1;
+    chroma_height = params_->height >> 1;
   } else if (params_->chroma_format == XVC_ENC_CHROMA_FORMAT_422) {
-    picture_samples = 2 * params_->width * params_->height;
+    chroma_width = params_->width >> 1;
+    chroma_height = params_->height;
   } else if (params_->chroma_format == XVC_ENC_CHROMA_FORMAT_444) {
-    picture_samples = 3 * params_->width * params_->height;
-  }
-  assert(picture_samples > 0);
-  picture_bytes.resize(params_->input_bitdepth == 8 ?
-                       picture_samples : (picture_samples << 1));
+    chroma_width = params_->width;
+    chroma_height = params_->height;
+  }
+  const size_t luma_bytes =
+    static_cast<size_t>(params_->width) * params_->height * sample_size;
+  const size_t chroma_bytes =
+    static_cast<size_t>(chroma_width) * chroma_height * sample_size;
+  const size_t picture_bytes = luma_bytes + 2 * chroma_bytes;
+  assert(picture_bytes > 0);
+  ptrdiff_t plane_offsets[3] = {
+    0,
+    static_cast<ptrdiff_t>(luma_bytes),
+    static_cast<ptrdiff_t>(luma_bytes + chroma_bytes) };
+  xvc_enc_pic_planes input_planes;
+  input_planes.stride[0] = params_->width * sample_size;
+  input_planes.stride[1] = chroma_width * sample_size;
+  input_planes.stride[2] = chroma_width * sample_size;
 
   // Setting the buffer pointer for reconstructed picture to nullptr
   // indicates that no reconstructed picture is requested.
@@ -366,19 +411,23 @@ void EncoderApp::MainEncoderLoop() {
 
   xvc_enc_nal_unit *nal_units;
   int num_nal_units;
-  if (input_seekable_) {
-    // Skip input pictures (if supported by stream)
-    input_stream_->seekg(0, std::ifstream::end);
-    std::streampos input_length = input_stream_->tellg();
-    std::streamoff start_pos =
-      start_skip_ + (picture_skip_ + picture_bytes.size()) * cli_.skip_pictures;
-    if (start_pos < input_length) {
-      input_stream_->seekg(start_pos, std::ifstream::beg);
-    } else {
-      std::cerr << "Error: The value of skip-pictures is larger than the "
-        << "number of pictures in the input file.";
-      std::exit(1);
+
+  // Pictures are read ahead on a separate thread, seekable input files are
+  // memory mapped and fall back to sequential reading if that fails.
+  PictureReader picture_reader(picture_bytes);
+  if (!input_seekable_ ||
+      !picture_reader.OpenMapped(cli_.input_filename, start_skip_)) {
+    if (input_seekable_) {
+      input_stream_->clear();
+      input_stream_->seekg(start_skip_, std::ifstream::beg);
     }
+    picture_reader.OpenStream(input_stream_);
+  }
+  if (!picture_reader.Start(picture_skip_, cli_.skip_pictures,
+                            cli_.temporal_subsample, max_num_pics)) {
+    std::cerr << "Error: The value of skip-pictures is larger than the "
+      << "number of pictures in the input file.";
+    std::exit(1);
   }
 
   char nal_size[4];
@@ -389,18 +438,8 @@ void EncoderApp::MainEncoderLoop() {
   // loop_check will become false when the entire file has been encoded
   // or when max_num_pics have been encoded.
   while (loop_check) {
-    if (input_seekable_) {
-      input_stream_->seekg(picture_skip_, std::ifstream::cur);
-    } else {
-      assert(picture_skip_ < static_cast<int>(picture_bytes.size()));
-      // Read dummy frame header
-      input_stream_->read(reinterpret_cast<char *>(&picture_bytes.front()),
-                          picture_skip_);
-    }
-    input_stream_->read(reinterpret_cast<char *>(&picture_bytes.front()),
-                        picture_bytes.size());
-    if (input_stream_->gcount() < static_cast<int>(picture_bytes.size()) ||
-      (max_num_pics >= 0 && picture_index_ >= max_num_pics)) {
+    const uint8_t *picture = picture_reader.ReadPicture();
+    if (!picture) {
       // Flush the encoder for remaining nal_units and reconstructed pictures.
       xvc_api_->encoder_flush(encoder_, &nal_units, &num_nal_units,
                               rec_pic_ptr);
@@ -411,8 +450,11 @@ void EncoderApp::MainEncoderLoop() {
       // Encode one picture and get 0 or 1 reconstructed picture back.
       // Also get back 0 or more nal_units depending on if pictures are being
       // buffered in order to encode a full Sub Gop.
-      xvc_api_->encoder_encode(encoder_, &picture_bytes[0], &nal_units,
-                               &num_nal_units, rec_pic_ptr);
+      for (int c = 0; c < 3; c++) {
+        input_planes.planes[c] = picture + plane_offsets[c];
+      }
+      xvc_api_->encoder_encode_planes(encoder_, &input_planes, &nal_units,
+                                      &num_nal_units, rec_pic_ptr);
       picture_index_++;
     }
 
@@ -452,13 +494,6 @@ void EncoderApp::MainEncoderLoop() {
       rec_stream_.write(reinterpret_cast<char *>(rec_pic_ptr->pic),
                         rec_pic_ptr->size);
     }
-
-    // Jump forward in the input file if temporal subsampling is applied.
-    if (input_seekable_ && cli_.temporal_subsample > 1) {
-      std::streamoff skip_picture = picture_bytes.size() + picture_skip_;
-      input_stream_->seekg((cli_.temporal_subsample - 1) * skip_picture,
-                           std::ifstream::cur);
-    }
   }
 
   if (current_segment_bytes > max_segment_bytes_) {
@@ -530,9 +565,18 @@ void EncoderApp::PrintUsage() {
   std::cout << "  -beta-offset <-32..31>" << std::endl;
   std::cout << "  -tc-offset <-32..31>" << std::endl;
   std::cout << "  -qp <-64..63> (default: 32)" << std::endl;
-  std::cout << "  -speed-mode <0..1>" << std::endl;
+  std::cout << "  -bitrate <kbit/s> (default: 0, constant qp)" << std::endl;
+  std::cout << "  -vbv-buffer-size <kbit> (default: 0, no vbv)" << std::endl;
+  std::cout << "  -tile-columns <1..16> (default: 1)" << std::endl;
+  std::cout << "  -tile-rows <1..16> (default: 1)" << std::endl;
+  std::cout << "  -threads <-1..n> (default: -1, one per cpu core)"
+    << std::endl;
+  std::cout << "  -speed-mode <0..4>" << std::endl;
   std::cout << "      0: Placebo" << std::endl;
   std::cout << "      1: Slow (default)" << std::endl;
+  std::cout << "      2: Medium" << std::endl;
+  std::cout << "      3: Fast" << std::endl;
+  std::cout << "      4: Ultra fast" << std::endl;
   std::cout << "  -tune <0..1>" << std::endl;
   std::cout << "      0: Visual quality (default)" << std::endl;
   std::cout << "      1: PSNR" << std::endl;
@@ -89,6 +89,11 @@ private:
     int beta_offset = std::numeric_limits<int>::min();
     int tc_offset = std::numeric_limits<int>::min();
     int qp = -1;
+    int bitrate = -1;
+    int vbv_buffer_size = -1;
+    int tile_columns = -1;
+    int tile_rows = -1;
+    int threads = -1;
     int flat_lambda = -1;
     int speed_mode = -1;
     int tune_mode = -1;
@@ -0,0 +1,172 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_app/picture_reader.h"
+
+#include <cassert>
+
+namespace xvc_app {
+
+PictureReader::PictureReader(size_t picture_bytes, int queue_size)
+  : picture_bytes_(picture_bytes),
+  queue_size_(queue_size > 0 ? queue_size : 1) {
+}
+
+PictureReader::~PictureReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  space_cond_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool PictureReader::OpenMapped(const std::string &filename,
+                               std::streamoff data_offset) {
+  if (!mapped_file_.Open(filename)) {
+    return false;
+  }
+  mapped_ = true;
+  mapped_pos_ = static_cast<size_t>(data_offset);
+  return true;
+}
+
+void PictureReader::OpenStream(std::istream *input) {
+  mapped_ = false;
+  input_ = input;
+  // One buffer more than the queue holds for the picture being encoded
+  buffers_.resize(queue_size_ + 1);
+  for (int i = 0; i < static_cast<int>(buffers_.size()); i++) {
+    buffers_[i].resize(picture_bytes_);
+    free_buffers_.push_back(i);
+  }
+}
+
+bool PictureReader::Start(std::streamoff picture_skip, int skip_pictures,
+                          int temporal_subsample, int max_pictures) {
+  assert(mapped_ || input_);
+  picture_skip_ = picture_skip;
+  temporal_subsample_ = temporal_subsample > 1 ? temporal_subsample : 1;
+  max_pictures_ = max_pictures;
+  const std::streamoff picture_size = picture_skip_ + picture_bytes_;
+  if (mapped_) {
+    mapped_pos_ += static_cast<size_t>(picture_size * skip_pictures);
+    if (mapped_pos_ >= mapped_file_.GetSize() && skip_pictures > 0) {
+      return false;
+    }
+  } else {
+    initial_skip_ = picture_size * skip_pictures;
+  }
+  thread_ = std::thread(&PictureReader::ReaderMain, this);
+  return true;
+}
+
+const uint8_t* PictureReader::ReadPicture() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (current_buffer_ >= 0) {
+    // The previous picture has been consumed by the encoder
+    free_buffers_.push_back(current_buffer_);
+    current_buffer_ = -1;
+  }
+  space_cond_.notify_one();
+  picture_cond_.wait(lock, [this]() {
+    return !queue_.empty() || end_of_input_;
+  });
+  if (queue_.empty()) {
+    return nullptr;
+  }
+  QueuedPicture picture = queue_.front();
+  queue_.pop_front();
+  current_buffer_ = picture.buffer_index;
+  space_cond_.notify_one();
+  return picture.data;
+}
+
+void PictureReader::ReaderMain() {
+  int num_pictures = 0;
+  while (max_pictures_ < 0 || num_pictures < max_pictures_) {
+    QueuedPicture picture = { nullptr, -1 };
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      space_cond_.wait(lock, [this]() {
+        return stop_ || (static_cast<int>(queue_.size()) < queue_size_ &&
+          (mapped_ || !free_buffers_.empty()));
+      });
+      if (stop_) {
+        break;
+      }
+      if (!mapped_) {
+        picture.buffer_index = free_buffers_.back();
+        free_buffers_.pop_back();
+      }
+    }
+    // The actual file access is done without holding the lock
+    bool success = mapped_ ? ReadMapped(&picture) : ReadStream(&picture);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!success) {
+      if (picture.buffer_index >= 0) {
+        free_buffers_.push_back(picture.buffer_index);
+      }
+      break;
+    }
+    queue_.push_back(picture);
+    num_pictures++;
+    picture_cond_.notify_one();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  end_of_input_ = true;
+  picture_cond_.notify_one();
+}
+
+bool PictureReader::ReadMapped(QueuedPicture *picture) {
+  const size_t picture_size = picture_skip_ + picture_bytes_;
+  if (mapped_pos_ >= mapped_file_.GetSize() ||
+      mapped_file_.GetSize() - mapped_pos_ < picture_size) {
+    return false;
+  }
+  const size_t data_pos = mapped_pos_ + static_cast<size_t>(picture_skip_);
+  mapped_file_.Prefetch(data_pos, picture_bytes_);
+  picture->data = mapped_file_.GetData() + data_pos;
+  mapped_pos_ += picture_size * temporal_subsample_;
+  return true;
+}
+
+bool PictureReader::ReadStream(QueuedPicture *picture) {
+  if (initial_skip_ > 0) {
+    input_->ignore(initial_skip_);
+    initial_skip_ = 0;
+  }
+  std::vector<uint8_t> &buffer = buffers_[picture->buffer_index];
+  if (picture_skip_ > 0) {
+    input_->ignore(picture_skip_);
+  }
+  input_->read(reinterpret_cast<char *>(&buffer[0]), picture_bytes_);
+  if (input_->gcount() < static_cast<std::streamsize>(picture_bytes_)) {
+    return false;
+  }
+  if (temporal_subsample_ > 1) {
+    input_->ignore((picture_skip_ + picture_bytes_) *
+      (temporal_subsample_ - 1));
+  }
+  picture->data = &buffer[0];
+  return true;
+}
+
+}  // namespace xvc_app
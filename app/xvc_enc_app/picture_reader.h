@@ -0,0 +1,97 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_APP_PICTURE_READER_H_
+#define XVC_ENC_APP_PICTURE_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "xvc_common_lib/mapped_file.h"
+
+namespace xvc_app {
+
+// Reads raw input pictures on a separate thread so that file access overlaps
+// with encoding. Seekable files are memory mapped and pictures are handed out
+// as pointers into the mapping after the reader thread has faulted in their
+// pages. Other inputs are read into a small pool of picture buffers.
+class PictureReader {
+public:
+  static const int kDefaultQueueSize = 4;
+
+  explicit PictureReader(size_t picture_bytes,
+                         int queue_size = kDefaultQueueSize);
+  ~PictureReader();
+  // Maps the file, the first picture header starts at data_offset.
+  // Returns false if the file can not be memory mapped.
+  bool OpenMapped(const std::string &filename, std::streamoff data_offset);
+  // Reads from the current position of a sequential input
+  void OpenStream(std::istream *input);
+  // Starts the reader thread. Each picture is preceded by picture_skip header
+  // bytes, the first skip_pictures are skipped and then only every
+  // temporal_subsample picture is read. A negative max_pictures reads until
+  // end of input. Returns false if skip_pictures is known to be beyond the
+  // end of the input.
+  bool Start(std::streamoff picture_skip, int skip_pictures,
+             int temporal_subsample, int max_pictures);
+  // Returns the next picture or nullptr at end of input. The picture is
+  // valid until the next call to ReadPicture.
+  const uint8_t* ReadPicture();
+
+private:
+  struct QueuedPicture {
+    const uint8_t *data;
+    int buffer_index;
+  };
+  void ReaderMain();
+  bool ReadMapped(QueuedPicture *picture);
+  bool ReadStream(QueuedPicture *picture);
+
+  const size_t picture_bytes_;
+  const int queue_size_;
+  xvc::MappedFile mapped_file_;
+  bool mapped_ = false;
+  size_t mapped_pos_ = 0;
+  std::istream *input_ = nullptr;
+  std::streamoff picture_skip_ = 0;
+  std::streamoff initial_skip_ = 0;
+  int temporal_subsample_ = 1;
+  int max_pictures_ = -1;
+  std::vector<std::vector<uint8_t>> buffers_;
+  std::vector<int> free_buffers_;
+  int current_buffer_ = -1;
+  std::deque<QueuedPicture> queue_;
+  bool end_of_input_ = false;
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable picture_cond_;
+  std::condition_variable space_cond_;
+  std::thread thread_;
+};
+
+}  // namespace xvc_app
+
+#endif  // XVC_ENC_APP_PICTURE_READER_H_
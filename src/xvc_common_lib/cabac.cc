@@ -351,11 +351,13 @@ void CabacContexts::ResetStates(const Qp &qp, PicturePredictionType pic_type) {
 ContextModel& CabacContexts::GetSkipFlagCtx(const CodingUnit &cu) {
   int offset = 0;
   if (!Restrictions::Get().disable_cabac_skip_flag_ctx) {
-    const CodingUnit *tmp;
-    if ((tmp = cu.GetCodingUnitLeft()) != nullptr && tmp->GetSkipFlag()) {
+    const PictureData::CuInfoTable &cu_info =
+      cu.GetPicData()->GetCuInfoTable(cu.GetCuTree());
+    ptrdiff_t idx;
+    if ((idx = cu.GetCuInfoIdxLeft()) >= 0 && cu_info.skip_flag[idx]) {
       offset++;
     }
-    if ((tmp = cu.GetCodingUnitAbove()) != nullptr && tmp->GetSkipFlag()) {
+    if ((idx = cu.GetCuInfoIdxAbove()) >= 0 && cu_info.skip_flag[idx]) {
       offset++;
     }
   }
@@ -363,17 +365,19 @@ ContextModel& CabacContexts::GetSkipFlagCtx(const CodingUnit &cu) {
 }
 
 ContextModel& CabacContexts::GetSplitBinaryCtx(const CodingUnit &cu) {
-  const CodingUnit *left = cu.GetCodingUnitLeft();
-  const CodingUnit *above = cu.GetCodingUnitAbove();
+  const PictureData::CuInfoTable &cu_info =
+    cu.GetPicData()->GetCuInfoTable(cu.GetCuTree());
+  const ptrdiff_t left = cu.GetCuInfoIdxLeft();
+  const ptrdiff_t above = cu.GetCuInfoIdxAbove();
   int depth = (cu.GetDepth() << 1) + cu.GetBinaryDepth();
   int offset = 0;
-  if (left) {
-    offset +=
-      ((left->GetDepth() << 1) + left->GetBinaryDepth()) > depth ? 1 : 0;
+  if (left >= 0) {
+    offset += ((cu_info.depth[left] << 1) +
+               cu_info.binary_depth[left]) > depth ? 1 : 0;
   }
-  if (above) {
-    offset +=
-      ((above->GetDepth() << 1) + above->GetBinaryDepth()) > depth ? 1 : 0;
+  if (above >= 0) {
+    offset += ((cu_info.depth[above] << 1) +
+               cu_info.binary_depth[above]) > depth ? 1 : 0;
   }
   return cu_split_binary[offset];
 }
@@ -381,31 +385,33 @@ ContextModel& CabacContexts::GetSplitBinaryCtx(const CodingUnit &cu) {
 ContextModel& CabacContexts::GetSplitFlagCtx(const CodingUnit &cu,
                                              int pic_max_depth) {
   int offset = 0;
-  const CodingUnit *left = cu.GetCodingUnitLeft();
-  const CodingUnit *above = cu.GetCodingUnitAbove();
+  const PictureData::CuInfoTable &cu_info =
+    cu.GetPicData()->GetCuInfoTable(cu.GetCuTree());
+  const ptrdiff_t left = cu.GetCuInfoIdxLeft();
+  const ptrdiff_t above = cu.GetCuInfoIdxAbove();
   if (!Restrictions::Get().disable_cabac_split_flag_ctx) {
-    if (left) {
-      offset += left->GetDepth() > cu.GetDepth();
+    if (left >= 0) {
+      offset += cu_info.depth[left] > cu.GetDepth();
     }
-    if (above) {
-      offset += above->GetDepth() > cu.GetDepth();
+    if (above >= 0) {
+      offset += cu_info.depth[above] > cu.GetDepth();
     }
   }
   if (!Restrictions::Get().disable_ext_cabac_alt_split_flag_ctx) {
     int min_depth = pic_max_depth;
     int max_depth = 0;
     auto update_min_max =
-      [&min_depth, &max_depth, pic_max_depth](const CodingUnit *tmp) {
-      if (tmp) {
-        min_depth = std::min(min_depth, tmp->GetDepth());
-        max_depth = std::max(max_depth, tmp->GetDepth());
+      [&min_depth, &max_depth, &cu_info, pic_max_depth](ptrdiff_t idx) {
+      if (idx >= 0) {
+        min_depth = std::min(min_depth, static_cast<int>(cu_info.depth[idx]));
+        max_depth = std::max(max_depth, static_cast<int>(cu_info.depth[idx]));
       } else {
         min_depth = 0;
         max_depth = pic_max_depth;
       }
     };
-    update_min_max(cu.GetCodingUnitLeft());
-    update_min_max(cu.GetCodingUnitAbove());
+    update_min_max(left);
+    update_min_max(above);
     min_depth = std::max(0, min_depth - 1);
     max_depth = std::min(pic_max_depth, max_depth + 1);
     if (cu.GetDepth() < min_depth) {
@@ -453,22 +459,19 @@ ContextModel& CabacContexts::GetSubblockCsbfCtx(YuvComponent comp,
   return ctx_base[right | below];
 }
 
-ContextModel&
-CabacContexts::GetCoeffSigCtx(YuvComponent comp, int pattern_sig_ctx,
-                              ScanOrder scan_order, int posx, int posy,
-                              int width_log2, int height_log2) {
+static int DeriveCoeffSigCtxIdx(bool is_luma, int pattern_sig_ctx,
+                                ScanOrder scan_order, int posx, int posy,
+                                int width_log2, int height_log2) {
   static const uint8_t kCtxIndexMap[16] = {
     0, 1, 4, 5, 2, 3, 4, 5, 6, 6, 8, 8, 7, 7, 8, 8
   };
-  ContextModel *ctx_base =
-    util::IsLuma(comp) ? &coeff_sig_luma[0] : &coeff_sig_chroma[0];
-  if ((!posx && !posy) || Restrictions::Get().disable_cabac_coeff_sig_ctx) {
-    return ctx_base[0];
+  if (!posx && !posy) {
+    return 0;
   }
   if (width_log2 == 2 && height_log2 == 2) {
-    return ctx_base[kCtxIndexMap[4 * posy + posx]];
+    return kCtxIndexMap[4 * posy + posx];
   }
-  int start_offset = util::IsLuma(comp) ? 21 : 12;
+  int start_offset = is_luma ? 21 : 12;
   if (width_log2 == 3 && height_log2 == 3) {
     start_offset = scan_order == ScanOrder::kDiagonal ? 9 : 15;
   }
@@ -485,9 +488,140 @@ CabacContexts::GetCoeffSigCtx(YuvComponent comp, int pattern_sig_ctx,
   } else {
     cnt = 2;
   }
-  int comp_offset =
-    util::IsLuma(comp) && ((posx >> 2) + (posy >> 2)) > 0 ? 3 : 0;
-  return ctx_base[start_offset + comp_offset + cnt];
+  int comp_offset = is_luma && ((posx >> 2) + (posy >> 2)) > 0 ? 3 : 0;
+  return start_offset + comp_offset + cnt;
+}
+
+static int DeriveCoeffLastPosCtxIdx(bool is_luma, bool alt_ctx, int size,
+                                    int pos) {
+  if (is_luma) {
+    int offset, shift;
+    if (alt_ctx) {
+      static const std::array<uint8_t, 8> kOffsetMappingExt = {
+        0, 0, 0, 3, 6, 10, 15, 21   // 1, 2, 4, 8, 16, 32, 64, 128
+      };
+      const int size_log2 = util::SizeToLog2(size);
+      offset = kOffsetMappingExt[size_log2];
+      shift = (size_log2 + 1) >> 2;
+    } else {
+      const int size_bits = util::SizeLog2Bits(size);
+      offset = size_bits * 3 + ((size_bits + 1) >> 2);
+      shift = (size_bits + 3) >> 2;
+    }
+    return offset + (pos >> shift);
+  } else {
+    int shift;
+    if (alt_ctx) {
+      shift = util::Clip3(size >> 3, 0, 2);
+    } else {
+      // Negative for size 2, which only codes the first bin
+      shift = std::max(0, util::SizeLog2Bits(size));
+    }
+    return pos >> shift;
+  }
+}
+
+// Context indices for the residual coding loops, derived once for every
+// combination of block size, scan order, pattern_sig_ctx and component
+class CoeffCtxIdxTable {
+public:
+  CoeffCtxIdxTable() {
+    for (int luma = 0; luma < 2; luma++) {
+      for (int size_class = 0; size_class < kNumSizeClasses; size_class++) {
+        const int size_log2 = 2 + size_class;
+        for (int scan = 0; scan < kNumScanOrders; scan++) {
+          const ScanOrder scan_order = static_cast<ScanOrder>(scan);
+          const uint8_t *scan_table =
+            TransformHelper::GetCoeffScanTable4x4(scan_order);
+          for (int pattern = 0; pattern < kNumPatternSigCtx; pattern++) {
+            for (int first = 0; first < 2; first++) {
+              uint8_t *dst = &sig_[luma][size_class][scan][pattern][first][0];
+              if (!first && size_class == 0) {
+                // A 4x4 block has no other subblock than the top-left one
+                std::fill(dst, dst + kSubblockSize, 0);
+                continue;
+              }
+              // All subblocks except the top-left one share contexts
+              const int subblock_posx = first ? 0 : 4;
+              for (int i = 0; i < kSubblockSize; i++) {
+                dst[i] = static_cast<uint8_t>(
+                  DeriveCoeffSigCtxIdx(luma != 0, pattern, scan_order,
+                                       subblock_posx + (scan_table[i] & 3),
+                                       scan_table[i] >> 2,
+                                       size_log2, size_log2));
+              }
+            }
+          }
+        }
+      }
+      // Luma transforms are never smaller than 4 samples
+      for (int size_log2 = luma ? 2 : 1; size_log2 < kNumSizes; size_log2++) {
+        const int size = 1 << size_log2;
+        const int num_bins = TransformHelper::kLastPosGroupIdx[size - 1] + 1;
+        for (int alt_ctx = 0; alt_ctx < 2; alt_ctx++) {
+          uint8_t *dst = &last_pos_[luma][alt_ctx][size_log2][0];
+          for (int pos = 0; pos < num_bins; pos++) {
+            dst[pos] = static_cast<uint8_t>(
+              DeriveCoeffLastPosCtxIdx(luma != 0, alt_ctx != 0, size, pos));
+          }
+        }
+      }
+    }
+  }
+  const uint8_t* GetSig(bool is_luma, int pattern_sig_ctx,
+                        ScanOrder scan_order, bool first_subblock,
+                        int width_log2, int height_log2) const {
+    int size_class = 2;
+    if (width_log2 == height_log2 && width_log2 < 4) {
+      size_class = width_log2 - 2;
+    }
+    return &sig_[is_luma][size_class][static_cast<int>(scan_order)]
+      [pattern_sig_ctx][first_subblock][0];
+  }
+  const uint8_t* GetLastPos(bool is_luma, bool alt_ctx, int size) const {
+    return &last_pos_[is_luma][alt_ctx][util::SizeToLog2(size)][0];
+  }
+  const uint8_t* GetZero() const { return &zero_[0]; }
+
+private:
+  static const int kNumSizeClasses = 3;   // 4x4, 8x8 and all other sizes
+  static const int kNumScanOrders = static_cast<int>(ScanOrder::kTotalNumber);
+  static const int kNumPatternSigCtx = 4;
+  static const int kSubblockSize = 16;
+  static const int kNumSizes = 8;
+  static const int kNumLastPosBins = 14;
+
+  uint8_t sig_[2][kNumSizeClasses][kNumScanOrders][kNumPatternSigCtx][2]
+    [kSubblockSize];
+  uint8_t last_pos_[2][2][kNumSizes][kNumLastPosBins] = {};
+  uint8_t zero_[kSubblockSize] = {};
+};
+
+static const CoeffCtxIdxTable kCoeffCtxIdxTable;
+
+ContextModel&
+CabacContexts::GetCoeffSigCtx(YuvComponent comp, int pattern_sig_ctx,
+                              ScanOrder scan_order, int posx, int posy,
+                              int width_log2, int height_log2) {
+  ContextModel *ctx_base = GetCoeffSigCtxBase(comp);
+  if (Restrictions::Get().disable_cabac_coeff_sig_ctx) {
+    return ctx_base[0];
+  }
+  return ctx_base[DeriveCoeffSigCtxIdx(util::IsLuma(comp), pattern_sig_ctx,
+                                       scan_order, posx, posy, width_log2,
+                                       height_log2)];
+}
+
+const uint8_t*
+CabacContexts::GetCoeffSigCtxIdx(YuvComponent comp, int pattern_sig_ctx,
+                                 ScanOrder scan_order, bool first_subblock,
+                                 int width_log2, int height_log2) const {
+  if (Restrictions::Get().disable_cabac_coeff_sig_ctx) {
+    return kCoeffCtxIdxTable.GetZero();
+  }
+  return kCoeffCtxIdxTable.GetSig(util::IsLuma(comp), pattern_sig_ctx,
+                                  scan_order, first_subblock, width_log2,
+                                  height_log2);
 }
 
 ContextModel& CabacContexts::GetCoeffGreaterThan1Ctx(YuvComponent comp,
@@ -511,44 +645,14 @@ ContextModel& CabacContexts::GetCoeffGreaterThan2Ctx(YuvComponent comp,
   return ctx_base[ctx_set];
 }
 
-ContextModel&
-CabacContexts::GetCoeffLastPosCtx(YuvComponent comp, int width, int height,
-                                  int pos, bool is_pos_x) {
-  const int size = is_pos_x ? width : height;
-  if (util::IsLuma(comp)) {
-    auto &ctx_base = is_pos_x ? coeff_last_pos_x_luma : coeff_last_pos_y_luma;
-    if (Restrictions::Get().disable_cabac_coeff_last_pos_ctx) {
-      return ctx_base[0];
-    }
-    int offset, shift;
-    if (!Restrictions::Get().disable_ext_cabac_alt_last_pos_ctx) {
-      static const std::array<uint8_t, 8> kOffsetMappingExt = {
-        0, 0, 0, 3, 6, 10, 15, 21   // 1, 2, 4, 8, 16, 32, 64, 128
-      };
-      const int size_log2 = util::SizeToLog2(size);
-      offset = kOffsetMappingExt[size_log2];
-      shift = (size_log2 + 1) >> 2;
-    } else {
-      const int size_bits = util::SizeLog2Bits(size);
-      offset = size_bits * 3 + ((size_bits + 1) >> 2);
-      shift = (size_bits + 3) >> 2;
-    }
-    return ctx_base[offset + (pos >> shift)];
-  } else {
-    auto &ctx_base =
-      is_pos_x ? coeff_last_pos_x_chroma : coeff_last_pos_y_chroma;
-    if (Restrictions::Get().disable_cabac_coeff_last_pos_ctx) {
-      return ctx_base[0];
-    }
-    int offset = 0;
-    int shift;
-    if (!Restrictions::Get().disable_ext_cabac_alt_last_pos_ctx) {
-      shift = util::Clip3(size >> 3, 0, 2);
-    } else {
-      shift = util::SizeLog2Bits(size);
-    }
-    return ctx_base[offset + (pos >> shift)];
+const uint8_t*
+CabacContexts::GetCoeffLastPosCtxIdx(YuvComponent comp, int size) const {
+  if (Restrictions::Get().disable_cabac_coeff_last_pos_ctx) {
+    return kCoeffCtxIdxTable.GetZero();
   }
+  return kCoeffCtxIdxTable.GetLastPos(
+    util::IsLuma(comp),
+    !Restrictions::Get().disable_ext_cabac_alt_last_pos_ctx, size);
 }
 
 }   // namespace xvc
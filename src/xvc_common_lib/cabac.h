@@ -26,6 +26,7 @@
 #include "xvc_common_lib/picture_types.h"
 #include "xvc_common_lib/transform.h"
 #include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/utils.h"
 
 namespace xvc {
 
@@ -99,11 +100,40 @@ public:
   ContextModel& GetCoeffSigCtx(YuvComponent comp, int pattern_sig_ctx,
                                ScanOrder scan_order, int posx, int posy,
                                int width_log2, int height_log2);
+  // Precomputed significance contexts for all coefficients of a 4x4 subblock,
+  // the coefficient at scan offset i uses GetCoeffSigCtxBase(comp)[ctx_idx[i]]
+  const uint8_t* GetCoeffSigCtxIdx(YuvComponent comp, int pattern_sig_ctx,
+                                   ScanOrder scan_order, bool first_subblock,
+                                   int width_log2, int height_log2) const;
+  ContextModel* GetCoeffSigCtxBase(YuvComponent comp) {
+    return util::IsLuma(comp) ? &coeff_sig_luma[0] : &coeff_sig_chroma[0];
+  }
   ContextModel& GetCoeffGreaterThan1Ctx(YuvComponent comp, int ctx_set,
                                         int c1);
   ContextModel& GetCoeffGreaterThan2Ctx(YuvComponent comp, int ctx_set);
-  ContextModel& GetCoeffLastPosCtx(YuvComponent comp, int width, int height,
-                                   int pos, bool is_pos_x);
+  // Precomputed contexts of the last position prefix bins for a transform of
+  // the given size, bin i uses GetCoeffLastPosCtxBase(comp, ..)[ctx_idx[i]]
+  const uint8_t* GetCoeffLastPosCtxIdx(YuvComponent comp, int size) const;
+  ContextModel* GetCoeffLastPosCtxBase(YuvComponent comp, bool is_pos_x) {
+    if (util::IsLuma(comp)) {
+      return is_pos_x ? &coeff_last_pos_x_luma[0] : &coeff_last_pos_y_luma[0];
+    }
+    return is_pos_x ? &coeff_last_pos_x_chroma[0] : &coeff_last_pos_y_chroma[0];
+  }
+  // Read-only access for rate estimation
+  const ContextModel& GetSkipFlagCtx(const CodingUnit &cu) const {
+    return const_cast<CabacContexts*>(this)->GetSkipFlagCtx(cu);
+  }
+  const ContextModel& GetSplitBinaryCtx(const CodingUnit &cu) const {
+    return const_cast<CabacContexts*>(this)->GetSplitBinaryCtx(cu);
+  }
+  const ContextModel& GetSplitFlagCtx(const CodingUnit &cu,
+                                      int max_depth) const {
+    return const_cast<CabacContexts*>(this)->GetSplitFlagCtx(cu, max_depth);
+  }
+  const ContextModel& GetInterDirBiCtx(const CodingUnit &cu) const {
+    return const_cast<CabacContexts*>(this)->GetInterDirBiCtx(cu);
+  }
 
   std::array<ContextModel, kNumCuCbfCtxLuma> cu_cbf_luma;
   std::array<ContextModel, kNumCuCbfCtxChroma> cu_cbf_chroma;
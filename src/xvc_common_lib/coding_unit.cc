@@ -55,6 +55,7 @@ CodingUnit& CodingUnit::operator=(const CodingUnit &cu) {
   assert(cu_tree_ == cu.cu_tree_);
   pos_x_ = cu.pos_x_;
   pos_y_ = cu.pos_y_;
+  ctu_coeff_ = pic_data_->GetCtuCoeff(pos_x_, pos_y_);
   width_ = cu.width_;
   height_ = cu.height_;
   depth_ = cu.depth_;
@@ -74,6 +75,7 @@ void CodingUnit::CopyPositionAndSizeFrom(const CodingUnit &cu) {
   assert(cu_tree_ == cu.cu_tree_);
   pos_x_ = cu.pos_x_;
   pos_y_ = cu.pos_y_;
+  ctu_coeff_ = pic_data_->GetCtuCoeff(pos_x_, pos_y_);
   width_ = cu.width_;
   height_ = cu.height_;
   depth_ = cu.depth_;
@@ -159,7 +161,7 @@ const CodingUnit* CodingUnit::GetCodingUnitAbove() const {
   if (posy == 0) {
     return nullptr;
   }
-  return pic_data_->GetCuAt(cu_tree_, posx, posy - constants::kMinBlockSize);
+  return GetCuAtIfSameTile(posx, posy - constants::kMinBlockSize);
 }
 
 const CodingUnit* CodingUnit::GetCodingUnitAboveIfSameCtu() const {
@@ -168,7 +170,7 @@ const CodingUnit* CodingUnit::GetCodingUnitAboveIfSameCtu() const {
   if ((posy % constants::kCtuSize) == 0) {
     return nullptr;
   }
-  return pic_data_->GetCuAt(cu_tree_, posx, posy - constants::kMinBlockSize);
+  return GetCuAtIfSameTile(posx, posy - constants::kMinBlockSize);
 }
 
 const CodingUnit* CodingUnit::GetCodingUnitAboveLeft() const {
@@ -177,8 +179,8 @@ const CodingUnit* CodingUnit::GetCodingUnitAboveLeft() const {
   if (posx == 0 || posy == 0) {
     return nullptr;
   }
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize,
-                            posy - constants::kMinBlockSize);
+  return GetCuAtIfSameTile(posx - constants::kMinBlockSize,
+                           posy - constants::kMinBlockSize);
 }
 
 const CodingUnit* CodingUnit::GetCodingUnitAboveCorner() const {
@@ -187,8 +189,8 @@ const CodingUnit* CodingUnit::GetCodingUnitAboveCorner() const {
   if (posy == 0) {
     return nullptr;
   }
-  return pic_data_->GetCuAt(cu_tree_, right - constants::kMinBlockSize,
-                            posy - constants::kMinBlockSize);
+  return GetCuAtIfSameTile(right - constants::kMinBlockSize,
+                           posy - constants::kMinBlockSize);
 }
 
 const CodingUnit* CodingUnit::GetCodingUnitAboveRight() const {
@@ -198,7 +200,7 @@ const CodingUnit* CodingUnit::GetCodingUnitAboveRight() const {
     return nullptr;
   }
   // Padding in table will guard for y going out-of-bounds
-  return pic_data_->GetCuAt(cu_tree_, right, posy - constants::kMinBlockSize);
+  return GetCuAtIfSameTile(right, posy - constants::kMinBlockSize);
 }
 
 const CodingUnit* CodingUnit::GetCodingUnitLeft() const {
@@ -207,7 +209,7 @@ const CodingUnit* CodingUnit::GetCodingUnitLeft() const {
   if (posx == 0) {
     return nullptr;
   }
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize, posy);
+  return GetCuAtIfSameTile(posx - constants::kMinBlockSize, posy);
 }
 
 const CodingUnit* CodingUnit::GetCodingUnitLeftCorner() const {
@@ -216,8 +218,8 @@ const CodingUnit* CodingUnit::GetCodingUnitLeftCorner() const {
   if (posx == 0) {
     return nullptr;
   }
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize,
-                            bottom - constants::kMinBlockSize);
+  return GetCuAtIfSameTile(posx - constants::kMinBlockSize,
+                           bottom - constants::kMinBlockSize);
 }
 
 const CodingUnit* CodingUnit::GetCodingUnitLeftBelow() const {
@@ -227,7 +229,70 @@ const CodingUnit* CodingUnit::GetCodingUnitLeftBelow() const {
     return nullptr;
   }
   // Padding in table will guard for y going out-of-bounds
-  return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize, bottom);
+  return GetCuAtIfSameTile(posx - constants::kMinBlockSize, bottom);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxAbove() const {
+  if (pos_y_ == 0) {
+    return -1;
+  }
+  return GetCuInfoIdxIfSameTile(pos_x_, pos_y_ - constants::kMinBlockSize);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxAboveIfSameCtu() const {
+  if ((pos_y_ % constants::kCtuSize) == 0) {
+    return -1;
+  }
+  return GetCuInfoIdxIfSameTile(pos_x_, pos_y_ - constants::kMinBlockSize);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxAboveLeft() const {
+  if (pos_x_ == 0 || pos_y_ == 0) {
+    return -1;
+  }
+  return GetCuInfoIdxIfSameTile(pos_x_ - constants::kMinBlockSize,
+                                pos_y_ - constants::kMinBlockSize);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxAboveCorner() const {
+  if (pos_y_ == 0) {
+    return -1;
+  }
+  return GetCuInfoIdxIfSameTile(pos_x_ + width_ - constants::kMinBlockSize,
+                                pos_y_ - constants::kMinBlockSize);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxAboveRight() const {
+  if (pos_y_ == 0) {
+    return -1;
+  }
+  // Padding in table will guard for y going out-of-bounds
+  return GetCuInfoIdxIfSameTile(pos_x_ + width_,
+                                pos_y_ - constants::kMinBlockSize);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxLeft() const {
+  if (pos_x_ == 0) {
+    return -1;
+  }
+  return GetCuInfoIdxIfSameTile(pos_x_ - constants::kMinBlockSize, pos_y_);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxLeftCorner() const {
+  if (pos_x_ == 0) {
+    return -1;
+  }
+  return GetCuInfoIdxIfSameTile(pos_x_ - constants::kMinBlockSize,
+                                pos_y_ + height_ - constants::kMinBlockSize);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxLeftBelow() const {
+  if (pos_x_ == 0) {
+    return -1;
+  }
+  // Padding in table will guard for y going out-of-bounds
+  return GetCuInfoIdxIfSameTile(pos_x_ - constants::kMinBlockSize,
+                                pos_y_ + height_);
 }
 
 int CodingUnit::GetCuSizeAboveRight(YuvComponent comp) const {
@@ -240,7 +305,7 @@ int CodingUnit::GetCuSizeAboveRight(YuvComponent comp) const {
   }
   posx -= constants::kMinBlockSize;
   for (int i = height_; i >= 0; i -= constants::kMinBlockSize) {
-    if (pic_data_->GetCuAt(cu_tree_, posx + i, posy)) {
+    if (GetCuAtIfSameTile(posx + i, posy)) {
       return util::IsLuma(comp) ? i : (i >> chroma_shift);
     }
   }
@@ -257,13 +322,28 @@ int CodingUnit::GetCuSizeBelowLeft(YuvComponent comp) const {
   }
   posy -= constants::kMinBlockSize;
   for (int i = width_; i >= 0; i -= constants::kMinBlockSize) {
-    if (pic_data_->GetCuAt(cu_tree_, posx, posy + i)) {
+    if (GetCuAtIfSameTile(posx, posy + i)) {
       return util::IsLuma(comp) ? i : (i >> chroma_shift);
     }
   }
   return 0;
 }
 
+const CodingUnit* CodingUnit::GetCuAtIfSameTile(int posx, int posy) const {
+  if (!IsSameTile(posx, posy)) {
+    return nullptr;
+  }
+  return pic_data_->GetCuAt(cu_tree_, posx, posy);
+}
+
+ptrdiff_t CodingUnit::GetCuInfoIdxIfSameTile(int posx, int posy) const {
+  if (!IsSameTile(posx, posy)) {
+    return -1;
+  }
+  ptrdiff_t idx = pic_data_->GetCuInfoIdx(posx, posy);
+  return pic_data_->GetCuInfoTable(cu_tree_).depth[idx] < 0 ? -1 : idx;
+}
+
 IntraMode CodingUnit::GetIntraMode(YuvComponent comp) const {
   if (util::IsLuma(comp)) {
     assert(cu_tree_ == CuTree::Primary);
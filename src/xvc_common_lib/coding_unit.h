@@ -127,6 +127,9 @@ public:
 
   // Neighborhood
   bool IsFullyWithinPicture() const;
+  bool IsSameTile(int posx, int posy) const {
+    return pic_data_->IsSameTile(pos_x_, pos_y_, posx, posy);
+  }
   const CodingUnit *GetCodingUnitAbove() const;
   const CodingUnit *GetCodingUnitAboveIfSameCtu() const;
   const CodingUnit *GetCodingUnitAboveLeft() const;
@@ -135,6 +138,16 @@ public:
   const CodingUnit *GetCodingUnitLeft() const;
   const CodingUnit *GetCodingUnitLeftCorner() const;
   const CodingUnit *GetCodingUnitLeftBelow() const;
+  // Index of the neighboring 4x4 block in the cu info table of the picture,
+  // or -1 when there is no available cu at that position
+  ptrdiff_t GetCuInfoIdxAbove() const;
+  ptrdiff_t GetCuInfoIdxAboveIfSameCtu() const;
+  ptrdiff_t GetCuInfoIdxAboveLeft() const;
+  ptrdiff_t GetCuInfoIdxAboveCorner() const;
+  ptrdiff_t GetCuInfoIdxAboveRight() const;
+  ptrdiff_t GetCuInfoIdxLeft() const;
+  ptrdiff_t GetCuInfoIdxLeftCorner() const;
+  ptrdiff_t GetCuInfoIdxLeftBelow() const;
   int GetCuSizeAboveRight(YuvComponent comp) const;
   int GetCuSizeBelowLeft(YuvComponent comp) const;
 
@@ -218,6 +231,10 @@ public:
   void LoadStateFrom(const InterState &state);
 
 private:
+  // Cus in other tiles are treated as unavailable
+  const CodingUnit* GetCuAtIfSameTile(int posx, int posy) const;
+  ptrdiff_t GetCuInfoIdxIfSameTile(int posx, int posy) const;
+
   PictureData *pic_data_ = nullptr;
   CoeffCtuBuffer *ctu_coeff_ = nullptr;   // Coefficient storage for this CU
   CuTree cu_tree_;
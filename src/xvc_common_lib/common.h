@@ -73,7 +73,7 @@ namespace constants {
 // xvc version
 const uint32_t kXvcCodecIdentifier = 7894627;
 const uint32_t kXvcMajorVersion = 1;
-const uint32_t kXvcMinorVersion = 0;
+const uint32_t kXvcMinorVersion = 1;
 
 // Picture
 const int kMaxYuvComponents = 3;
@@ -144,6 +144,11 @@ const int kPicSizeBits = 16;
 const PicNum kMaxSubGopLength = 64;
 const int kEncapsulationCode1 = 182;
 const int kEncapsulationCode2 = 214;
+// Tiles, signaled in segment header from minor version 1
+const uint32_t kTilesMinorVersion = 1;
+const int kTileSizeBits = 4;
+const int kMaxTileColumns = 1 << kTileSizeBits;
+const int kMaxTileRows = 1 << kTileSizeBits;
 
 // Min and Max
 const int16_t kInt16Max = INT16_MAX;
@@ -78,6 +78,9 @@ void DeblockingFilter::DeblockCtu(int rsaddr, CuTree cu_tree, Direction dir,
     (!pic_data_->HasSecondaryCuTree() || cu_tree == CuTree::Secondary) &&
     !Restrictions::Get().disable_deblock_chroma_filter;
 
+  const PictureData::CuInfoTable &cu_info =
+    pic_data_->GetCuInfoTable(cu_tree);
+
   for (int dy = 0; dy < constants::kMaxBlockSize; dy += subblock_size) {
     for (int dx = 0; dx < constants::kMaxBlockSize; dx += subblock_size) {
       const int x = ctu_pos_x + dx;
@@ -90,24 +93,24 @@ void DeblockingFilter::DeblockCtu(int rsaddr, CuTree cu_tree, Direction dir,
 
       // cu_p is the coding unit to the left/above
       // of the edge that is evaluated (might be the same cu).
-      const CodingUnit *cu_p = nullptr;
-      if (dir == Direction::kVertical) {
-        cu_p = pic_data_->GetCuAt(cu_tree, x - 1, y);
-      } else if (dir == Direction::kHorizontal) {
-        cu_p = pic_data_->GetCuAt(cu_tree, x, y - 1);
-      }
-      if (cu_p == nullptr || (cu_p->GetPosX(luma) == cu_q->GetPosX(luma) &&
-                              cu_p->GetPosY(luma) == cu_q->GetPosY(luma))) {
+      // The cu pointers are only compared, all cu fields are read from the
+      // cu info table.
+      const int x_p = dir == Direction::kVertical ? x - 1 : x;
+      const int y_p = dir == Direction::kVertical ? y : y - 1;
+      const CodingUnit *cu_p = pic_data_->GetCuAt(cu_tree, x_p, y_p);
+      if (cu_p == nullptr || cu_p == cu_q) {
         continue;
       }
+      const ptrdiff_t idx_p = pic_data_->GetCuInfoIdx(x_p, y_p);
+      const ptrdiff_t idx_q = pic_data_->GetCuInfoIdx(x, y);
 
       // Derive boundary strength.
-      int boundary_strength = GetBoundaryStrength(*cu_p, *cu_q);
+      int boundary_strength = GetBoundaryStrength(cu_info, idx_p, idx_q);
       if (!boundary_strength) {
         continue;
       }
 
-      int qp = (cu_p->GetQp(luma) + cu_q->GetQp(luma) + 1) >> 1;
+      int qp = (cu_info.qp_luma[idx_p] + cu_info.qp_luma[idx_q] + 1) >> 1;
       if (Restrictions::Get().disable_deblock_depending_on_qp) {
         qp = 32;
       }
@@ -117,7 +120,8 @@ void DeblockingFilter::DeblockCtu(int rsaddr, CuTree cu_tree, Direction dir,
       }
 
       if (deblock_chroma && boundary_strength == 2) {
-        int chroma_qp = (cu_p->GetQp(chroma) + cu_q->GetQp(chroma) + 1) >> 1;
+        int chroma_qp =
+          (cu_info.qp_chroma[idx_p] + cu_info.qp_chroma[idx_q] + 1) >> 1;
         if (Restrictions::Get().disable_deblock_depending_on_qp) {
           chroma_qp = 31;
         }
@@ -139,30 +143,33 @@ void DeblockingFilter::DeblockCtu(int rsaddr, CuTree cu_tree, Direction dir,
   }
 }
 
-int DeblockingFilter::GetBoundaryStrength(const CodingUnit &cu_p,
-                                          const CodingUnit &cu_q) {
+int
+DeblockingFilter::GetBoundaryStrength(const PictureData::CuInfoTable &cu_info,
+                                      ptrdiff_t idx_p, ptrdiff_t idx_q) {
   static const int one_integer_step = 1 << constants::kMvPrecisionShift;
+  const int kL0 = static_cast<int>(RefPicList::kL0);
+  const int kL1 = static_cast<int>(RefPicList::kL1);
   int boundary_strength = 0;
   if (Restrictions::Get().disable_deblock_boundary_strength_zero) {
     boundary_strength = 1;
   }
-  YuvComponent luma = YuvComponent::kY;
 
-  if (cu_p.IsIntra() || cu_q.IsIntra()) {
+  if (cu_info.pred_mode[idx_p] == PredictionMode::kIntra ||
+      cu_info.pred_mode[idx_q] == PredictionMode::kIntra) {
     boundary_strength = 2;
-  } else if (cu_p.GetCbf(luma) || cu_q.GetCbf(luma)) {
+  } else if (cu_info.cbf_luma[idx_p] || cu_info.cbf_luma[idx_q]) {
     boundary_strength = 1;
   } else if (pic_data_->GetPredictionType() == PicturePredictionType::kBi) {
-    PicNum refP0 = cu_p.GetRefPoc(RefPicList::kL0);
-    PicNum refP1 = cu_p.GetRefPoc(RefPicList::kL1);
-    PicNum refQ0 = cu_q.GetRefPoc(RefPicList::kL0);
-    PicNum refQ1 = cu_q.GetRefPoc(RefPicList::kL1);
+    PicNum refP0 = GetRefPoc(cu_info, idx_p, RefPicList::kL0);
+    PicNum refP1 = GetRefPoc(cu_info, idx_p, RefPicList::kL1);
+    PicNum refQ0 = GetRefPoc(cu_info, idx_q, RefPicList::kL0);
+    PicNum refQ1 = GetRefPoc(cu_info, idx_q, RefPicList::kL1);
     if ((refP0 == refQ0 && refP1 == refQ1) ||
       (refP0 == refQ1 && refP1 == refQ0)) {
-      auto &mvP0 = cu_p.GetMv(RefPicList::kL0);
-      auto &mvP1 = cu_p.GetMv(RefPicList::kL1);
-      auto &mvQ0 = cu_q.GetMv(RefPicList::kL0);
-      auto &mvQ1 = cu_q.GetMv(RefPicList::kL1);
+      auto &mvP0 = cu_info.mv[kL0][idx_p];
+      auto &mvP1 = cu_info.mv[kL1][idx_p];
+      auto &mvQ0 = cu_info.mv[kL0][idx_q];
+      auto &mvQ1 = cu_info.mv[kL1][idx_q];
       auto cond1 = [&mvP0, &mvP1, &mvQ0, &mvQ1]() {
         return (std::abs(mvP0.x - mvQ0.x) >= one_integer_step) ||
           (std::abs(mvP0.y - mvQ0.y) >= one_integer_step) ||
@@ -195,12 +202,12 @@ int DeblockingFilter::GetBoundaryStrength(const CodingUnit &cu_p,
     }
   } else {
     // For uni-prediction assumes that a POC is only referenced once
-    if (cu_p.GetRefIdx(RefPicList::kL0) != cu_q.GetRefIdx(RefPicList::kL0)) {
+    if (cu_info.ref_idx[kL0][idx_p] != cu_info.ref_idx[kL0][idx_q]) {
       boundary_strength = 1;
-    } else if (std::abs(cu_p.GetMv(RefPicList::kL0).x -
-                        cu_q.GetMv(RefPicList::kL0).x) >= one_integer_step ||
-               std::abs(cu_p.GetMv(RefPicList::kL0).y -
-                        cu_q.GetMv(RefPicList::kL0).y) >= one_integer_step) {
+    } else if (std::abs(cu_info.mv[kL0][idx_p].x -
+                        cu_info.mv[kL0][idx_q].x) >= one_integer_step ||
+               std::abs(cu_info.mv[kL0][idx_p].y -
+                        cu_info.mv[kL0][idx_q].y) >= one_integer_step) {
       boundary_strength = 1;
     }
   }
@@ -211,6 +218,17 @@ int DeblockingFilter::GetBoundaryStrength(const CodingUnit &cu_p,
   return boundary_strength;
 }
 
+PicNum DeblockingFilter::GetRefPoc(const PictureData::CuInfoTable &cu_info,
+                                   ptrdiff_t idx, RefPicList ref_list) const {
+  const InterDir inter_dir = cu_info.inter_dir[idx];
+  if (inter_dir != InterDir::kBi &&
+      static_cast<int>(inter_dir) != static_cast<int>(ref_list)) {
+    return static_cast<PicNum>(-1);
+  }
+  return pic_data_->GetRefPicLists()->GetRefPoc(
+    ref_list, cu_info.ref_idx[static_cast<int>(ref_list)][idx]);
+}
+
 void DeblockingFilter::FilterEdgeLuma(int x, int y, Direction dir,
                                       int subblock_size, int boundary_strength,
                                       int qp) {
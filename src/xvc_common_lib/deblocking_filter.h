@@ -51,7 +51,11 @@ private:
 
   void DeblockCtu(int rsaddr, CuTree cu_tree, Direction dir,
                   int subblock_size);
-  int GetBoundaryStrength(const CodingUnit &cu_p, const CodingUnit &cu_q);
+  int GetBoundaryStrength(const PictureData::CuInfoTable &cu_info,
+                          ptrdiff_t idx_p, ptrdiff_t idx_q);
+  // Same as CodingUnit::GetRefPoc
+  PicNum GetRefPoc(const PictureData::CuInfoTable &cu_info, ptrdiff_t idx,
+                   RefPicList ref_list) const;
   void FilterEdgeLuma(int x, int y, Direction dir, int subblock_size,
                       int boundary_strength, int qp);
   bool CheckStrongFilter(Sample *src, int beta, int tc, ptrdiff_t offset);
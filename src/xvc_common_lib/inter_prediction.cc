@@ -22,9 +22,11 @@
 #include <cstdlib>
 
 #include "xvc_common_lib/utils.h"
+#include "xvc_common_lib/picture_data.h"
 #include "xvc_common_lib/reference_picture_lists.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/simd_cpu.h"
+#include "xvc_common_lib/temporal_mv_field.h"
 
 namespace xvc {
 
@@ -143,73 +145,92 @@ InterPrediction::GetMvPredictors(const CodingUnit &cu, RefPicList ref_list,
   return list;
 }
 
-static bool HasDifferentMotion(const CodingUnit &cu1, const CodingUnit &cu2) {
-  if (cu1.GetInterDir() != cu2.GetInterDir()) {
+static bool HasDifferentMotion(const PictureData::CuInfoTable &cu_info,
+                               ptrdiff_t idx1, ptrdiff_t idx2) {
+  const InterDir inter_dir = cu_info.inter_dir[idx1];
+  if (inter_dir != cu_info.inter_dir[idx2]) {
     return true;
   }
   for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
-    RefPicList ref_list = RefPicList(i);
-    if (!cu1.HasMv(ref_list)) {
+    if (inter_dir != InterDir::kBi && static_cast<int>(inter_dir) != i) {
       continue;
     }
-    if (cu1.GetRefIdx(ref_list) != cu2.GetRefIdx(ref_list) ||
-        cu1.GetMv(ref_list) != cu2.GetMv(ref_list)) {
+    if (cu_info.ref_idx[i][idx1] != cu_info.ref_idx[i][idx2] ||
+        cu_info.mv[i][idx1] != cu_info.mv[i][idx2]) {
       return true;
     }
   }
   return false;
 }
 
+static MergeCandidate
+GetMergeCandidateFromCuInfo(const PictureData::CuInfoTable &cu_info,
+                            ptrdiff_t idx) {
+  MergeCandidate cand;
+  cand.inter_dir = cu_info.inter_dir[idx];
+  for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+    cand.mv[i] = cu_info.mv[i][idx];
+    cand.ref_idx[i] = cu_info.ref_idx[i][idx];
+  }
+  return cand;
+}
+
 InterMergeCandidateList
 InterPrediction::GetMergeCandidates(const CodingUnit &cu, int merge_cand_idx) {
   const bool pic_bipred = cu.GetPicType() == PicturePredictionType::kBi;
   const int kL0 = static_cast<int>(RefPicList::kL0);
   const int kL1 = static_cast<int>(RefPicList::kL1);
+  const PictureData::CuInfoTable &cu_info =
+    cu.GetPicData()->GetCuInfoTable(cu.GetCuTree());
+  auto is_inter = [&cu_info](ptrdiff_t idx) {
+    return idx >= 0 && cu_info.pred_mode[idx] == PredictionMode::kInter;
+  };
   InterMergeCandidateList list;
   int num = 0;
 
-  const CodingUnit *left = cu.GetCodingUnitLeftCorner();
-  bool has_a1 = left && left->IsInter();
+  const ptrdiff_t left = cu.GetCuInfoIdxLeftCorner();
+  bool has_a1 = is_inter(left);
   if (has_a1) {
-    list[num] = GetMergeCandidateFromCu(*left);
+    list[num] = GetMergeCandidateFromCuInfo(cu_info, left);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *above = cu.GetCodingUnitAboveCorner();
-  bool has_b1 = above && above->IsInter();
-  if (has_b1 && (!has_a1 || HasDifferentMotion(*left, *above))) {
-    list[num] = GetMergeCandidateFromCu(*above);
+  const ptrdiff_t above = cu.GetCuInfoIdxAboveCorner();
+  bool has_b1 = is_inter(above);
+  if (has_b1 && (!has_a1 || HasDifferentMotion(cu_info, left, above))) {
+    list[num] = GetMergeCandidateFromCuInfo(cu_info, above);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *above_right = cu.GetCodingUnitAboveRight();
-  bool has_b0 = above_right && above_right->IsInter();
-  if (has_b0 && (!has_b1 || HasDifferentMotion(*above, *above_right))) {
-    list[num] = GetMergeCandidateFromCu(*above_right);
+  const ptrdiff_t above_right = cu.GetCuInfoIdxAboveRight();
+  bool has_b0 = is_inter(above_right);
+  if (has_b0 &&
+      (!has_b1 || HasDifferentMotion(cu_info, above, above_right))) {
+    list[num] = GetMergeCandidateFromCuInfo(cu_info, above_right);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *left_below = cu.GetCodingUnitLeftBelow();
-  bool has_a0 = left_below && left_below->IsInter();
-  if (has_a0 && (!has_a1 || HasDifferentMotion(*left, *left_below))) {
-    list[num] = GetMergeCandidateFromCu(*left_below);
+  const ptrdiff_t left_below = cu.GetCuInfoIdxLeftBelow();
+  bool has_a0 = is_inter(left_below);
+  if (has_a0 && (!has_a1 || HasDifferentMotion(cu_info, left, left_below))) {
+    list[num] = GetMergeCandidateFromCuInfo(cu_info, left_below);
     if (num++ == merge_cand_idx) {
       return list;
     }
   }
 
-  const CodingUnit *above_left = cu.GetCodingUnitAboveLeft();
-  bool has_b2 = above_left && above_left->IsInter();
+  const ptrdiff_t above_left = cu.GetCuInfoIdxAboveLeft();
+  bool has_b2 = is_inter(above_left);
   if (has_b2 && num < 4
-      && (!has_a1 || HasDifferentMotion(*left, *above_left))
-      && (!has_b1 || HasDifferentMotion(*above, *above_left))) {
-    list[num] = GetMergeCandidateFromCu(*above_left);
+      && (!has_a1 || HasDifferentMotion(cu_info, left, above_left))
+      && (!has_b1 || HasDifferentMotion(cu_info, above, above_left))) {
+    list[num] = GetMergeCandidateFromCuInfo(cu_info, above_left);
     if (num++ == merge_cand_idx) {
       return list;
     }
@@ -488,21 +509,23 @@ InterPrediction::GetTemporalMvPredictor(const CodingUnit &cu,
   RefPicList tmvp_mv_ref_list = ref_pic_list->HasOnlyBackReferences() ?
     ref_list : ReferencePictureLists::Inverse(tmvp_cu_ref_list);
 
+  const TemporalMvField &col_field =
+    ref_pic_list->GetTemporalMvField(tmvp_cu_ref_list, tmvp_cu_ref_idx);
+
   auto get_temporal_mv =
-    [this, &cu_poc, &cu_ref_poc](const CodingUnit *col_cu,
-                                 RefPicList col_ref_list,
-                                 MotionVector *col_mv) {
-    if (!col_cu->IsInter()) {
+    [this, &cu_poc, &cu_ref_poc, &col_field](
+      const TemporalMvField::Entry &col, RefPicList col_ref_list,
+      MotionVector *col_mv) {
+    if (!col.IsInter()) {
       return false;
     }
-    if (!col_cu->HasMv(col_ref_list)) {
+    if (!col.HasMv(col_ref_list)) {
       col_ref_list = ReferencePictureLists::Inverse(col_ref_list);
     }
-    int col_ref_idx = col_cu->GetRefIdx(col_ref_list);
-    PicNum col_poc = col_cu->GetPoc();
-    PicNum col_ref_poc =
-      col_cu->GetRefPicLists()->GetRefPoc(col_ref_list, col_ref_idx);
-    *col_mv = col_cu->GetMv(col_ref_list);
+    int col_ref_idx = col.GetRefIdx(col_ref_list);
+    PicNum col_poc = col_field.GetPoc();
+    PicNum col_ref_poc = col_field.GetRefPoc(col_ref_list, col_ref_idx);
+    *col_mv = col.GetMv(col_ref_list);
     ScaleMv(cu_poc, cu_ref_poc, col_poc, col_ref_poc, col_mv);
     return true;
   };
@@ -516,11 +539,9 @@ InterPrediction::GetTemporalMvPredictor(const CodingUnit &cu,
       col_x = ((col_x >> 4) << 4);
       col_y = ((col_y >> 4) << 4);
     }
-    // Including picture out of bounds check
-    const CodingUnit *col_cu =
-      ref_pic_list->GetCodingUnitAt(tmvp_cu_ref_list, tmvp_cu_ref_idx,
-                                    cu.GetCuTree(), col_x, col_y);
-    if (col_cu && get_temporal_mv(col_cu, tmvp_mv_ref_list, mv_out)) {
+    // Positions outside of the picture have no motion
+    if (get_temporal_mv(col_field.GetEntryAt(col_x, col_y), tmvp_mv_ref_list,
+                        mv_out)) {
       return true;
     }
   }
@@ -532,10 +553,8 @@ InterPrediction::GetTemporalMvPredictor(const CodingUnit &cu,
     col_x = ((col_x >> 4) << 4);
     col_y = ((col_y >> 4) << 4);
   }
-  const CodingUnit *col_cu =
-    ref_pic_list->GetCodingUnitAt(tmvp_cu_ref_list, tmvp_cu_ref_idx,
-                                  cu.GetCuTree(), col_x, col_y);
-  if (get_temporal_mv(col_cu, tmvp_mv_ref_list, mv_out)) {
+  if (get_temporal_mv(col_field.GetEntryAt(col_x, col_y), tmvp_mv_ref_list,
+                      mv_out)) {
     return true;
   }
   return false;
@@ -813,7 +832,26 @@ void InterPrediction::FilterChroma(int width, int height,
   const int N = kNumTapsChroma;
   const int16_t *filter_hor = &kChromaFilter[frac_x][0];
   const int16_t *filter_ver = &kChromaFilter[frac_y][0];
-  if (frac_y == 0) {
+  if (width < 4) {
+    // Simd functions may store 4 samples per row, which would overwrite
+    // samples of the block to the right that can belong to a coded tile
+    if (frac_y == 0) {
+      FilterHorSampleSample<N>(width, height, bitdepth_, filter_hor,
+                               ref, ref_stride, pred, pred_stride);
+    } else if (frac_x == 0) {
+      FilterVerSampleSample<N>(width, height, bitdepth_, filter_ver,
+                               ref, ref_stride, pred, pred_stride);
+    } else {
+      ptrdiff_t hor_offset = (N / 2 - 1) * ref_stride;
+      FilterHorSampleShort<N>(width, height + N - 1, bitdepth_, filter_hor,
+                              ref - hor_offset, ref_stride,
+                              &filter_buffer_[0], width);
+      int ver_offset = (N / 2 - 1) * width;
+      FilterVerShortSample<N>(width, height, bitdepth_, filter_ver,
+                              &filter_buffer_[ver_offset], width,
+                              pred, pred_stride);
+    }
+  } else if (frac_y == 0) {
     simd_.filter_h_sample_sample[1](width, height, bitdepth_, filter_hor,
                                     ref, ref_stride, pred, pred_stride);
   } else if (frac_x == 0) {
@@ -923,18 +961,6 @@ static void AddAvg(int width, int height, int offset,
                      min_val, max_val);
 }
 
-MergeCandidate InterPrediction::GetMergeCandidateFromCu(const CodingUnit &cu) {
-  const int kL0 = static_cast<int>(RefPicList::kL0);
-  const int kL1 = static_cast<int>(RefPicList::kL1);
-  MergeCandidate cand;
-  cand.inter_dir = cu.GetInterDir();
-  cand.mv[kL0] = cu.GetMv(RefPicList::kL0);
-  cand.mv[kL1] = cu.GetMv(RefPicList::kL1);
-  cand.ref_idx[kL0] = cu.GetRefIdx(RefPicList::kL0);
-  cand.ref_idx[kL1] = cu.GetRefIdx(RefPicList::kL1);
-  return cand;
-}
-
 InterPrediction::SimdFunc::SimdFunc() {
   add_avg[0] = &AddAvg;
   add_avg[1] = &AddAvg;
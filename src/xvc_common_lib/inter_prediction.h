@@ -117,7 +117,6 @@ private:
                 const int16_t *src_l0, ptrdiff_t src_l0_stride,
                 const int16_t *src_l1, ptrdiff_t src_l1_stride,
                 Sample *pred, ptrdiff_t pred_stride);
-  MergeCandidate GetMergeCandidateFromCu(const CodingUnit &cu);
 
   const InterPrediction::SimdFunc &simd_;
   std::array<int16_t, kBufSize> filter_buffer_;
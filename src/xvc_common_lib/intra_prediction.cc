@@ -99,20 +99,22 @@ IntraPrediction::ComputeReferenceState(const CodingUnit &cu, YuvComponent comp,
 
 IntraPredictorLuma
 IntraPrediction::GetPredictorLuma(const CodingUnit &cu) const {
-  const CodingUnit *cu_left = cu.GetCodingUnitLeft();
+  const PictureData::CuInfoTable &cu_info =
+    cu.GetPicData()->GetCuInfoTable(cu.GetCuTree());
+  const ptrdiff_t idx_left = cu.GetCuInfoIdxLeft();
   IntraMode left = IntraMode::kDc;
-  if (cu_left && cu_left->IsIntra()) {
-    left = cu_left->GetIntraMode(YuvComponent::kY);
+  if (idx_left >= 0 && cu_info.intra_mode[idx_left] >= 0) {
+    left = static_cast<IntraMode>(cu_info.intra_mode[idx_left]);
   }
-  const CodingUnit *cu_above;
+  ptrdiff_t idx_above;
   if (Restrictions::Get().disable_ext_intra_unrestricted_predictor) {
-    cu_above = cu.GetCodingUnitAboveIfSameCtu();
+    idx_above = cu.GetCuInfoIdxAboveIfSameCtu();
   } else {
-    cu_above = cu.GetCodingUnitAbove();
+    idx_above = cu.GetCuInfoIdxAbove();
   }
   IntraMode above = IntraMode::kDc;
-  if (cu_above && cu_above->IsIntra()) {
-    above = cu_above->GetIntraMode(YuvComponent::kY);
+  if (idx_above >= 0 && cu_info.intra_mode[idx_above] >= 0) {
+    above = static_cast<IntraMode>(cu_info.intra_mode[idx_above]);
   }
   IntraPredictorLuma mpm;
   if (Restrictions::Get().disable_intra_mpm_prediction) {
@@ -363,17 +365,17 @@ IntraPrediction::AngularPred(int width, int height, IntraMode dir_mode,
 IntraPrediction::NeighborState
 IntraPrediction::DetermineNeighbors(const CodingUnit &cu, YuvComponent comp) {
   NeighborState neighbors;
-  int x = cu.GetPosX(comp);
-  int y = cu.GetPosY(comp);
-  if (x > 0) {
+  int x = cu.GetPosX(YuvComponent::kY);
+  int y = cu.GetPosY(YuvComponent::kY);
+  if (x > 0 && cu.IsSameTile(x - 1, y)) {
     neighbors.has_left = true;
     neighbors.has_below_left = cu.GetCuSizeBelowLeft(comp);
   }
-  if (y > 0) {
+  if (y > 0 && cu.IsSameTile(x, y - 1)) {
     neighbors.has_above = true;
     neighbors.has_above_right = cu.GetCuSizeAboveRight(comp);
   }
-  if (x > 0 && y > 0) {
+  if (neighbors.has_left && neighbors.has_above) {
     neighbors.has_above_left = true;
   }
   return neighbors;
@@ -0,0 +1,155 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_common_lib/mapped_file.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace xvc {
+
+static const size_t kPageSize = 4096;
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+bool MappedFile::IsRegularFile(const std::string &filename) {
+#if defined(_WIN32)
+  DWORD attributes = GetFileAttributesA(filename.c_str());
+  return attributes != INVALID_FILE_ATTRIBUTES &&
+    !(attributes & (FILE_ATTRIBUTE_DIRECTORY | FILE_ATTRIBUTE_DEVICE));
+#else
+  struct stat file_stat;
+  return stat(filename.c_str(), &file_stat) == 0 &&
+    S_ISREG(file_stat.st_mode);
+#endif
+}
+
+bool MappedFile::Open(const std::string &filename) {
+  Close();
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  file_handle_ = file;
+  LARGE_INTEGER file_size;
+  if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size)) {
+    Close();
+    return false;
+  }
+  size_ = static_cast<size_t>(file_size.QuadPart);
+  if (size_ == 0) {
+    return true;
+  }
+  mapping_handle_ =
+    CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping_handle_) {
+    Close();
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(
+    MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+  if (!data_) {
+    Close();
+    return false;
+  }
+  return true;
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    close(fd);
+    return false;
+  }
+  size_ = static_cast<size_t>(file_stat.st_size);
+  if (size_ == 0) {
+    close(fd);
+    return true;
+  }
+  void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the file descriptor is closed
+  close(fd);
+  if (data == MAP_FAILED) {
+    size_ = 0;
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(data);
+  madvise(data, size_, MADV_SEQUENTIAL);
+  return true;
+#endif
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const {
+  if (offset >= size_) {
+    return;
+  }
+  if (size > size_ - offset) {
+    size = size_ - offset;
+  }
+#if !defined(_WIN32)
+  const size_t page_offset = offset & ~(kPageSize - 1);
+  madvise(const_cast<uint8_t*>(data_ + page_offset),
+          size + offset - page_offset, MADV_WILLNEED);
+#endif
+  // Touch one byte per page to make sure the pages are resident
+  volatile uint8_t sink = 0;
+  for (size_t pos = 0; pos < size; pos += kPageSize) {
+    sink ^= data_[offset + pos];
+  }
+  sink ^= data_[offset + size - 1];
+}
+
+void MappedFile::Close() {
+#if defined(_WIN32)
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_handle_) {
+    CloseHandle(mapping_handle_);
+  }
+  if (file_handle_) {
+    CloseHandle(file_handle_);
+  }
+  file_handle_ = nullptr;
+  mapping_handle_ = nullptr;
+#else
+  if (data_) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+}
+
+}   // namespace xvc
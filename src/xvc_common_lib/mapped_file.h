@@ -0,0 +1,63 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_COMMON_LIB_MAPPED_FILE_H_
+#define XVC_COMMON_LIB_MAPPED_FILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+namespace xvc {
+
+// Read-only memory mapping of a whole file. Used for seekable inputs where
+// the content can be accessed directly without copying into a stream buffer.
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  // Checks without opening the file, so that a pipe is left untouched for a
+  // sequential reader.
+  static bool IsRegularFile(const std::string &filename);
+  // Returns false if the file can not be opened or mapped, e.g. for pipes.
+  // An empty file is opened successfully but has no data.
+  bool Open(const std::string &filename);
+  const uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+  // Faults in the pages of the given range so that a later access does not
+  // stall on disk reads.
+  void Prefetch(size_t offset, size_t size) const;
+
+private:
+  void Close();
+
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+#if defined(_WIN32)
+  void *file_handle_ = nullptr;
+  void *mapping_handle_ = nullptr;
+#endif
+};
+
+}   // namespace xvc
+
+#endif  // XVC_COMMON_LIB_MAPPED_FILE_H_
@@ -0,0 +1,151 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_common_lib/perf_trace.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+
+namespace xvc {
+
+namespace {
+
+const char* GetStageName(PerfStage stage) {
+  switch (stage) {
+    case PerfStage::kEntropyDecode: return "entropy_decode";
+    case PerfStage::kDecodeCtu: return "decode_ctu";
+    case PerfStage::kDeblock: return "deblock";
+    case PerfStage::kPadBorder: return "pad_border";
+    case PerfStage::kChecksum: return "checksum";
+    case PerfStage::kOutputConversion: return "output_conversion";
+    case PerfStage::kThreadWait: return "thread_wait";
+    case PerfStage::kIntraSearch: return "intra_search";
+    case PerfStage::kInterSearch: return "inter_search";
+    case PerfStage::kRdoQuant: return "rdo_quant";
+    case PerfStage::kCabacWrite: return "cabac_write";
+    case PerfStage::kIntraAnalysis: return "intra_analysis";
+    default:
+      return "unknown";
+  }
+}
+
+// Stages that are invoked too frequently to be recorded as individual trace
+// events, these are still accumulated in the per-picture stats.
+bool IsAggregateOnly(PerfStage stage) {
+  return stage == PerfStage::kRdoQuant;
+}
+
+}   // namespace
+
+thread_local PerfStats* PerfStats::current_ = nullptr;
+thread_local TraceRecorder::ThreadBuffer* TraceRecorder::thread_buffer_ =
+  nullptr;
+
+TraceRecorder* TraceRecorder::Get() {
+  static std::unique_ptr<TraceRecorder> instance([]() -> TraceRecorder* {
+    const char *filename = std::getenv("XVC_TRACE_FILE");
+    if (!filename || !*filename) {
+      return nullptr;
+    }
+    return new TraceRecorder(filename);
+  }());
+  return instance.get();
+}
+
+void TraceRecorder::SetThreadName(const char *name) {
+  if (TraceRecorder *trace = Get()) {
+    trace->GetThreadBuffer()->name = name;
+  }
+}
+
+TraceRecorder::TraceRecorder(const char *filename)
+  : filename_(filename),
+  start_time_(PerfStats::Clock::now()),
+  num_events_(0) {
+}
+
+TraceRecorder::~TraceRecorder() {
+  WriteFile();
+}
+
+void TraceRecorder::AddEvent(PerfStage stage,
+                             PerfStats::Clock::time_point start,
+                             PerfStats::Clock::time_point end) {
+  if (IsAggregateOnly(stage)) {
+    return;
+  }
+  ThreadBuffer *buffer = GetThreadBuffer();
+  if (num_events_.fetch_add(1, std::memory_order_relaxed) >= kMaxEvents) {
+    buffer->num_dropped++;
+    return;
+  }
+  Event event;
+  event.stage = stage;
+  event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    start - start_time_).count();
+  event.duration_ns =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  buffer->events.push_back(event);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::GetThreadBuffer() {
+  if (!thread_buffer_) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_buffers_.emplace_back(new ThreadBuffer());
+    thread_buffer_ = thread_buffers_.back().get();
+    thread_buffer_->tid = static_cast<int>(thread_buffers_.size());
+  }
+  return thread_buffer_;
+}
+
+void TraceRecorder::WriteFile() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ofstream file(filename_);
+  if (!file) {
+    return;
+  }
+  file << std::fixed << std::setprecision(3);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  for (auto &buffer : thread_buffers_) {
+    if (!buffer->name.empty()) {
+      file << (first ? "" : ",\n")
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << buffer->tid << ",\"args\":{\"name\":\"" << buffer->name
+        << "\"}}";
+      first = false;
+    }
+    for (const Event &event : buffer->events) {
+      // Timestamps are given in microseconds
+      file << (first ? "" : ",\n")
+        << "{\"name\":\"" << GetStageName(event.stage)
+        << "\",\"cat\":\"xvc\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+        << ",\"ts\":" << event.start_ns / 1000.0
+        << ",\"dur\":" << event.duration_ns / 1000.0 << "}";
+      first = false;
+    }
+  }
+  size_t num_dropped = 0;
+  for (auto &buffer : thread_buffers_) {
+    num_dropped += buffer->num_dropped;
+  }
+  file << "\n],\"otherData\":{\"dropped_events\":" << num_dropped << "}}\n";
+}
+
+}   // namespace xvc
@@ -0,0 +1,214 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_COMMON_LIB_PERF_TRACE_H_
+#define XVC_COMMON_LIB_PERF_TRACE_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#ifndef XVC_ENABLE_TRACING
+#define XVC_ENABLE_TRACING 0
+#endif
+
+namespace xvc {
+
+// Processing stages that can be timed by the instrumentation layer.
+// Stages may nest, e.g. entropy decoding is part of ctu decoding.
+enum class PerfStage {
+  kEntropyDecode = 0,
+  kDecodeCtu = 1,
+  kDeblock = 2,
+  kPadBorder = 3,
+  kChecksum = 4,
+  kOutputConversion = 5,
+  kThreadWait = 6,
+  kIntraSearch = 7,
+  kInterSearch = 8,
+  kRdoQuant = 9,
+  kCabacWrite = 10,
+  kIntraAnalysis = 11,
+  kTotalNumber = 12,
+};
+
+// Events that can be counted by the instrumentation layer.
+enum class PerfCounter {
+  kInterPredCacheLookup = 0,
+  kInterPredCacheHit = 1,
+  kTotalNumber = 2,
+};
+
+// Accumulated time per stage and event counts for one picture. The counters
+// may be updated concurrently by all threads working on the same picture.
+class PerfStats {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  PerfStats() { Clear(); }
+  PerfStats(const PerfStats&) = delete;
+  PerfStats& operator=(const PerfStats&) = delete;
+  void Clear() {
+    for (auto &time : time_ns_) {
+      time.store(0, std::memory_order_relaxed);
+    }
+    for (auto &count : counts_) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+  void Add(PerfStage stage, int64_t ns) {
+    time_ns_[static_cast<int>(stage)].fetch_add(ns, std::memory_order_relaxed);
+  }
+  uint32_t GetMicroseconds(PerfStage stage) const {
+    return static_cast<uint32_t>(
+      time_ns_[static_cast<int>(stage)].load(std::memory_order_relaxed) /
+      1000);
+  }
+  void Count(PerfCounter counter, int64_t num) {
+    counts_[static_cast<int>(counter)].fetch_add(num,
+                                                 std::memory_order_relaxed);
+  }
+  uint32_t GetCount(PerfCounter counter) const {
+    return static_cast<uint32_t>(
+      counts_[static_cast<int>(counter)].load(std::memory_order_relaxed));
+  }
+  // Stats that timers on the calling thread accumulate into (may be null)
+  static PerfStats* GetCurrent() { return current_; }
+  static void SetCurrent(PerfStats *stats) { current_ = stats; }
+
+private:
+  static thread_local PerfStats *current_;
+  std::array<std::atomic<int64_t>,
+    static_cast<int>(PerfStage::kTotalNumber)> time_ns_;
+  std::array<std::atomic<int64_t>,
+    static_cast<int>(PerfCounter::kTotalNumber)> counts_;
+};
+
+// Directs all timers on the calling thread to the given stats while in scope.
+class ScopedPerfStats {
+public:
+  explicit ScopedPerfStats(PerfStats *stats)
+    : prev_(PerfStats::GetCurrent()) {
+    PerfStats::SetCurrent(stats);
+  }
+  ~ScopedPerfStats() { PerfStats::SetCurrent(prev_); }
+  ScopedPerfStats(const ScopedPerfStats&) = delete;
+  ScopedPerfStats& operator=(const ScopedPerfStats&) = delete;
+
+private:
+  PerfStats *prev_;
+};
+
+// Records complete events of all threads and writes them as a Chrome
+// trace_event JSON file (viewable in chrome://tracing or Perfetto) when the
+// process exits. Only active if the XVC_TRACE_FILE environment variable
+// points to the output file. At most kMaxEvents events are kept in memory,
+// later events are dropped and only the number of them is written.
+class TraceRecorder {
+public:
+  static TraceRecorder* Get();
+  static void SetThreadName(const char *name);
+  void AddEvent(PerfStage stage, PerfStats::Clock::time_point start,
+                PerfStats::Clock::time_point end);
+  ~TraceRecorder();
+
+private:
+  struct Event {
+    PerfStage stage;
+    int64_t start_ns;
+    int64_t duration_ns;
+  };
+  struct ThreadBuffer {
+    int tid;
+    std::string name;
+    std::vector<Event> events;
+    size_t num_dropped = 0;
+  };
+  static const size_t kMaxEvents = 1 << 20;
+  explicit TraceRecorder(const char *filename);
+  ThreadBuffer* GetThreadBuffer();
+  void WriteFile();
+
+  static thread_local ThreadBuffer *thread_buffer_;
+  const std::string filename_;
+  const PerfStats::Clock::time_point start_time_;
+  std::atomic<size_t> num_events_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers_;
+};
+
+// Measures the time spent in the enclosing scope for the given stage.
+class ScopedTimer {
+public:
+  explicit ScopedTimer(PerfStage stage)
+    : stage_(stage),
+    stats_(PerfStats::GetCurrent()),
+    start_(PerfStats::Clock::now()) {
+  }
+  ~ScopedTimer() {
+    PerfStats::Clock::time_point end = PerfStats::Clock::now();
+    if (stats_) {
+      stats_->Add(stage_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end - start_).count());
+    }
+    if (TraceRecorder *trace = TraceRecorder::Get()) {
+      trace->AddEvent(stage_, start_, end);
+    }
+  }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  const PerfStage stage_;
+  PerfStats *stats_;
+  const PerfStats::Clock::time_point start_;
+};
+
+}   // namespace xvc
+
+#define XVC_PERF_CONCAT_INNER(a, b) a##b
+#define XVC_PERF_CONCAT(a, b) XVC_PERF_CONCAT_INNER(a, b)
+
+// Instrumentation macros, these compile to nothing unless built with
+// XVC_ENABLE_TRACING enabled (cmake -DENABLE_TRACING=ON).
+#if XVC_ENABLE_TRACING
+#define XVC_PERF_TIMER(stage) \
+  ::xvc::ScopedTimer XVC_PERF_CONCAT(perf_timer_, __LINE__)( \
+    ::xvc::PerfStage::stage)
+#define XVC_PERF_STATS_SCOPE(stats) \
+  ::xvc::ScopedPerfStats XVC_PERF_CONCAT(perf_stats_, __LINE__)(stats)
+#define XVC_PERF_COUNT(counter, num) \
+  do { \
+    if (::xvc::PerfStats *perf_stats = ::xvc::PerfStats::GetCurrent()) { \
+      perf_stats->Count(::xvc::PerfCounter::counter, num); \
+    } \
+  } while (0)
+#define XVC_PERF_THREAD_NAME(name) ::xvc::TraceRecorder::SetThreadName(name)
+#else
+#define XVC_PERF_TIMER(stage)
+#define XVC_PERF_STATS_SCOPE(stats)
+#define XVC_PERF_COUNT(counter, num)
+#define XVC_PERF_THREAD_NAME(name)
+#endif
+
+#endif  // XVC_COMMON_LIB_PERF_TRACE_H_
@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <utility>
 
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/common.h"
@@ -29,10 +30,56 @@
 
 namespace xvc {
 
+struct PictureData::CuStorage {
+  ChromaFormat chroma_format;
+  int width;
+  int height;
+  std::array<std::vector<CodingUnit*>,
+    constants::kMaxNumCuTrees> cu_pic_table;
+  std::array<CuInfoTable, constants::kMaxNumCuTrees> cu_info_table;
+  std::vector<std::unique_ptr<CuAllocator>> cu_allocators;
+};
+
+PictureData::CuStoragePool::CuStoragePool() {
+}
+
+PictureData::CuStoragePool::~CuStoragePool() {
+}
+
+std::unique_ptr<PictureData::CuStorage>
+PictureData::CuStoragePool::Acquire(ChromaFormat chroma_format, int width,
+                                    int height) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (!storage_.empty()) {
+    std::unique_ptr<CuStorage> storage = std::move(storage_.back());
+    storage_.pop_back();
+    // Storage released before a change of picture format is dropped
+    if (storage->chroma_format == chroma_format && storage->width == width &&
+        storage->height == height) {
+      return storage;
+    }
+  }
+  return nullptr;
+}
+
+void PictureData::CuStoragePool::Release(std::unique_ptr<CuStorage> storage) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  storage_.push_back(std::move(storage));
+}
+
+PictureData::CuAllocator::CuAllocator(ChromaFormat chroma_format,
+                                      int alloc_batch_size)
+  : ctu_coeff(new CoeffCtuBuffer(util::GetChromaShiftX(chroma_format),
+                                 util::GetChromaShiftY(chroma_format))),
+  batch_size(alloc_batch_size) {
+  // Initial CU buffer allocation, includes majority of allocated CUs
+  buffers.emplace_back(batch_size * 4);
+}
+
 PictureData::PictureData(ChromaFormat chroma_format, int width, int height,
-                         int bitdepth)
-  : ctu_coeff_(new CoeffCtuBuffer(util::GetChromaShiftX(chroma_format),
-                                  util::GetChromaShiftY(chroma_format))),
+                         int bitdepth,
+                         std::shared_ptr<CuStoragePool> cu_storage_pool)
+  : cu_storage_pool_(std::move(cu_storage_pool)),
   pic_width_(width),
   pic_height_(height),
   bitdepth_(bitdepth),
@@ -44,19 +91,14 @@ PictureData::PictureData(ChromaFormat chroma_format, int width, int height,
   ctu_num_x_((pic_width_ + constants::kCtuSize - 1) /
              constants::kCtuSize),
   ctu_num_y_((pic_height_ + constants::kCtuSize - 1) /
-             constants::kCtuSize),
-  cu_alloc_batch_size_(std::max(1, ctu_num_x_ * ctu_num_y_) * 4) {
+             constants::kCtuSize) {
   int num_cu_pic_x = (pic_width_ + constants::kMaxBlockSize - 1) /
     constants::kMinBlockSize;
-  int num_cu_pic_y = (pic_height_ + constants::kMaxBlockSize - 1) /
-    constants::kMinBlockSize;
   cu_pic_stride_ = num_cu_pic_x + 1;
-  // Initial CU buffer allocation, includes majority of allocated CUs
-  cu_alloc_buffers_.emplace_back(cu_alloc_batch_size_ * 4);
-  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
-    cu_pic_table_[tree_idx].resize(cu_pic_stride_ * (num_cu_pic_y + 1));
-    std::fill(cu_pic_table_[tree_idx].begin(),
-              cu_pic_table_[tree_idx].end(), nullptr);
+  InitTiles(1, 1);
+  if (!cu_storage_pool_) {
+    AllocateCuTables();
+    AllocateCuAllocators();
   }
 }
 
@@ -84,6 +126,7 @@ void PictureData::Init(const SegmentHeader &segment, const Qp &pic_qp,
 
   // CU structure
   max_binary_split_depth_ = segment.max_binary_split_depth;
+  InitTiles(segment.num_tile_columns, segment.num_tile_rows);
 
   // Setup Qp
   pic_qp_.reset(new Qp(pic_qp));
@@ -102,17 +145,38 @@ void PictureData::Init(const SegmentHeader &segment, const Qp &pic_qp,
                       segment.chroma_qp_offset_u, segment.chroma_qp_offset_v);
   }
 
+  // Cu tables and cu objects of an earlier picture are reused if available
+  if (cu_pic_table_[0].empty()) {
+    std::unique_ptr<CuStorage> storage = !cu_storage_pool_ ? nullptr :
+      cu_storage_pool_->Acquire(chroma_fmt_, pic_width_, pic_height_);
+    if (storage) {
+      cu_pic_table_.swap(storage->cu_pic_table);
+      cu_info_table_.swap(storage->cu_info_table);
+      cu_allocators_.swap(storage->cu_allocators);
+    } else {
+      AllocateCuTables();
+    }
+  }
+  AllocateCuAllocators();
+
   // Initialize CU allocator / object pool
   // Buffer pointers are reset to first entry without any deconstruction
   // this requires that no object are reused across pictures
-  cu_alloc_free_list_.clear();
-  cu_alloc_list_index_ = 0;
-  cu_alloc_item_index_ = 0;
+  for (auto &cu_allocator : cu_allocators_) {
+    cu_allocator->free_list.clear();
+    cu_allocator->list_index = 0;
+    cu_allocator->item_index = 0;
+    if (cu_allocator->buffers.empty()) {
+      cu_allocator->buffers.emplace_back(cu_allocator->batch_size * 4);
+    }
+  }
 
   // CTU initialization
   for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
     std::fill(cu_pic_table_[tree_idx].begin(),
               cu_pic_table_[tree_idx].end(), nullptr);
+    std::fill(cu_info_table_[tree_idx].depth.begin(),
+              cu_info_table_[tree_idx].depth.end(), -1);
     // Clear all CTU objects and re-assign again below for every picture
     ctu_rs_list_[tree_idx].clear();
   }
@@ -151,26 +215,26 @@ CodingUnit *PictureData::CreateCu(CuTree cu_tree, int depth, int posx,
   if (posx >= pic_width_ || posy >= pic_height_) {
     return nullptr;
   }
+  CuAllocator &alloc = *cu_allocators_[GetTileIdxIfInside(posx, posy)];
   CodingUnit *cu;
-  if (!cu_alloc_free_list_.empty()) {
-    cu = cu_alloc_free_list_.back();
-    cu_alloc_free_list_.pop_back();
+  if (!alloc.free_list.empty()) {
+    cu = alloc.free_list.back();
+    alloc.free_list.pop_back();
   } else {
-    assert(!cu_alloc_buffers_.empty());
-    if (cu_alloc_item_index_ ==
-        cu_alloc_buffers_[cu_alloc_list_index_].size()) {
-      cu_alloc_list_index_++;
-      cu_alloc_item_index_ = 0;
+    assert(!alloc.buffers.empty());
+    if (alloc.item_index == alloc.buffers[alloc.list_index].size()) {
+      alloc.list_index++;
+      alloc.item_index = 0;
     }
-    if (cu_alloc_list_index_ == cu_alloc_buffers_.size()) {
+    if (alloc.list_index == alloc.buffers.size()) {
       // Allocate an extra buffer (typically needed for intra pictures)
-      cu_alloc_buffers_.emplace_back(cu_alloc_batch_size_);
+      alloc.buffers.emplace_back(alloc.batch_size);
     }
-    cu = &cu_alloc_buffers_[cu_alloc_list_index_][cu_alloc_item_index_];
-    cu_alloc_item_index_++;
+    cu = &alloc.buffers[alloc.list_index][alloc.item_index];
+    alloc.item_index++;
   }
   // Reinitialize memory to a known state
-  return new (cu) CodingUnit(this, ctu_coeff_.get(), cu_tree, depth,
+  return new (cu) CodingUnit(this, alloc.ctu_coeff.get(), cu_tree, depth,
                              posx, posy, width, height);
 }
 
@@ -180,7 +244,40 @@ void PictureData::ReleaseCu(CodingUnit *cu) {
       ReleaseCu(sub_cu);
     }
   }
-  cu_alloc_free_list_.push_back(cu);
+  const int posx = cu->GetPosX(YuvComponent::kY);
+  const int posy = cu->GetPosY(YuvComponent::kY);
+  cu_allocators_[GetTileIdxIfInside(posx, posy)]->free_list.push_back(cu);
+}
+
+void PictureData::ReleaseCus() {
+  if (cu_storage_pool_) {
+    for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
+      ctu_rs_list_[tree_idx].clear();
+    }
+    if (cu_pic_table_[0].empty()) {
+      return;
+    }
+    std::unique_ptr<CuStorage> storage(new CuStorage());
+    storage->chroma_format = chroma_fmt_;
+    storage->width = pic_width_;
+    storage->height = pic_height_;
+    cu_pic_table_.swap(storage->cu_pic_table);
+    cu_info_table_.swap(storage->cu_info_table);
+    cu_allocators_.swap(storage->cu_allocators);
+    cu_storage_pool_->Release(std::move(storage));
+    return;
+  }
+  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
+    std::vector<CodingUnit*>().swap(cu_pic_table_[tree_idx]);
+    cu_info_table_[tree_idx] = CuInfoTable();
+    ctu_rs_list_[tree_idx].clear();
+  }
+  for (auto &cu_allocator : cu_allocators_) {
+    std::vector<CodingUnit*>().swap(cu_allocator->free_list);
+    std::vector<std::vector<CodingUnit>>().swap(cu_allocator->buffers);
+    cu_allocator->list_index = 0;
+    cu_allocator->item_index = 0;
+  }
 }
 
 void PictureData::MarkUsedInPic(CodingUnit *cu) {
@@ -197,11 +294,12 @@ void PictureData::MarkUsedInPic(CodingUnit *cu) {
   const int index_y = cu->GetPosY(YuvComponent::kY) / constants::kMinBlockSize;
   const int num_x = cu->GetWidth(YuvComponent::kY) / constants::kMinBlockSize;
   const int num_y = cu->GetHeight(YuvComponent::kY) / constants::kMinBlockSize;
+  const ptrdiff_t offset = index_y * cu_pic_stride_ + index_x;
   for (int y = 0; y < num_y; y++) {
-    CodingUnit **ptr =
-      &cu_pic_table_[cu_tree][(index_y + y) * cu_pic_stride_ + index_x];
+    CodingUnit **ptr = &cu_pic_table_[cu_tree][offset + y * cu_pic_stride_];
     std::fill(ptr, ptr + num_x, cu);
   }
+  SetCuInfo(*cu, offset, num_x, num_y);
 }
 
 void PictureData::ClearMarkCuInPic(CodingUnit *cu) {
@@ -210,11 +308,85 @@ void PictureData::ClearMarkCuInPic(CodingUnit *cu) {
   const int index_y = cu->GetPosY(YuvComponent::kY) / constants::kMinBlockSize;
   const int num_x = cu->GetWidth(YuvComponent::kY) / constants::kMinBlockSize;
   const int num_y = cu->GetHeight(YuvComponent::kY) / constants::kMinBlockSize;
+  const ptrdiff_t offset = index_y * cu_pic_stride_ + index_x;
   for (int y = 0; y < num_y; y++) {
-    CodingUnit **ptr =
-      &cu_pic_table_[cu_tree][(index_y + y) * cu_pic_stride_ + index_x];
+    CodingUnit **ptr = &cu_pic_table_[cu_tree][offset + y * cu_pic_stride_];
     std::fill(ptr, ptr + num_x, nullptr);
   }
+  ResetCuInfo(cu->GetCuTree(), offset, num_x, num_y);
+}
+
+void PictureData::UpdateCuInfo(const CodingUnit &cu) {
+  assert(cu.GetSplit() == SplitType::kNone);
+  assert(GetCuAt(cu.GetCuTree(), cu.GetPosX(YuvComponent::kY),
+                 cu.GetPosY(YuvComponent::kY)) == &cu);
+  SetCuInfo(cu, GetCuInfoIdx(cu.GetPosX(YuvComponent::kY),
+                             cu.GetPosY(YuvComponent::kY)),
+            cu.GetWidth(YuvComponent::kY) / constants::kMinBlockSize,
+            cu.GetHeight(YuvComponent::kY) / constants::kMinBlockSize);
+}
+
+void PictureData::SetCuAt(CuTree cu_tree, int posx, int posy,
+                          CodingUnit *cu) {
+  const ptrdiff_t cu_idx = GetCuInfoIdx(posx, posy);
+  cu_pic_table_[static_cast<int>(cu_tree)][cu_idx] = cu;
+  if (cu) {
+    SetCuInfo(*cu, cu_idx, 1, 1);
+  } else {
+    ResetCuInfo(cu_tree, cu_idx, 1, 1);
+  }
+}
+
+void PictureData::ResetCuInfo(CuTree cu_tree, ptrdiff_t offset,
+                              int num_x, int num_y) {
+  CuInfoTable &cu_info = cu_info_table_[static_cast<int>(cu_tree)];
+  for (int y = 0; y < num_y; y++) {
+    int8_t *depth = &cu_info.depth[offset + y * cu_pic_stride_];
+    std::fill(depth, depth + num_x, -1);
+  }
+}
+
+void PictureData::SetCuInfo(const CodingUnit &cu, ptrdiff_t offset,
+                            int num_x, int num_y) {
+  CuInfoTable &cu_info = cu_info_table_[static_cast<int>(cu.GetCuTree())];
+  const int8_t depth = static_cast<int8_t>(cu.GetDepth());
+  const int8_t binary_depth = static_cast<int8_t>(cu.GetBinaryDepth());
+  const uint8_t skip_flag = cu.GetSkipFlag() ? 1 : 0;
+  const int8_t intra_mode =
+    cu.GetCuTree() == CuTree::Primary && cu.IsIntra() ?
+    static_cast<int8_t>(cu.GetIntraMode(YuvComponent::kY)) : -1;
+  const PredictionMode pred_mode = cu.GetPredMode();
+  const uint8_t qp_luma = static_cast<uint8_t>(cu.GetQp(YuvComponent::kY));
+  const uint8_t qp_chroma = max_num_components_ > 1 ?
+    static_cast<uint8_t>(cu.GetQp(YuvComponent::kU)) : 0;
+  const uint8_t cbf_luma = cu.GetCbf(YuvComponent::kY) ? 1 : 0;
+  const InterDir inter_dir = cu.GetInterDir();
+  for (int y = 0; y < num_y; y++) {
+    const ptrdiff_t idx = offset + y * cu_pic_stride_;
+    std::fill(&cu_info.depth[idx], &cu_info.depth[idx] + num_x, depth);
+    std::fill(&cu_info.binary_depth[idx], &cu_info.binary_depth[idx] + num_x,
+              binary_depth);
+    std::fill(&cu_info.skip_flag[idx], &cu_info.skip_flag[idx] + num_x,
+              skip_flag);
+    std::fill(&cu_info.intra_mode[idx], &cu_info.intra_mode[idx] + num_x,
+              intra_mode);
+    std::fill(&cu_info.pred_mode[idx], &cu_info.pred_mode[idx] + num_x,
+              pred_mode);
+    std::fill(&cu_info.qp_luma[idx], &cu_info.qp_luma[idx] + num_x, qp_luma);
+    std::fill(&cu_info.qp_chroma[idx], &cu_info.qp_chroma[idx] + num_x,
+              qp_chroma);
+    std::fill(&cu_info.cbf_luma[idx], &cu_info.cbf_luma[idx] + num_x,
+              cbf_luma);
+    std::fill(&cu_info.inter_dir[idx], &cu_info.inter_dir[idx] + num_x,
+              inter_dir);
+    for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+      const RefPicList ref_list = static_cast<RefPicList>(i);
+      std::fill(&cu_info.mv[i][idx], &cu_info.mv[i][idx] + num_x,
+                cu.GetMv(ref_list));
+      std::fill(&cu_info.ref_idx[i][idx], &cu_info.ref_idx[i][idx] + num_x,
+                static_cast<int8_t>(cu.GetRefIdx(ref_list)));
+    }
+  }
 }
 
 PicturePredictionType PictureData::GetPredictionType() const {
@@ -259,6 +431,73 @@ RefPicList PictureData::DetermineTmvpRefList(int *tmvp_ref_idx) {
   return (tid_l1 >= tid_l0) ? RefPicList::kL1 : RefPicList::kL0;
 }
 
+void PictureData::InitTiles(int num_tile_columns, int num_tile_rows) {
+  num_tile_columns = util::Clip3(num_tile_columns, 1, std::max(1, ctu_num_x_));
+  num_tile_rows = util::Clip3(num_tile_rows, 1, std::max(1, ctu_num_y_));
+  if (num_tile_columns == num_tile_columns_ &&
+      num_tile_rows == num_tile_rows_) {
+    return;
+  }
+  num_tile_columns_ = num_tile_columns;
+  num_tile_rows_ = num_tile_rows;
+  // Uniform spacing of tile boundaries in units of ctus
+  const int num_tiles = num_tile_columns * num_tile_rows;
+  tile_ctus_.assign(num_tiles, std::vector<int>());
+  // Always at least one entry so that empty pictures still have a tile
+  ctu_tile_idx_.assign(std::max(1, ctu_num_x_ * ctu_num_y_), 0);
+  for (int tile_y = 0; tile_y < num_tile_rows; tile_y++) {
+    const int y0 = tile_y * ctu_num_y_ / num_tile_rows;
+    const int y1 = (tile_y + 1) * ctu_num_y_ / num_tile_rows;
+    for (int tile_x = 0; tile_x < num_tile_columns; tile_x++) {
+      const int x0 = tile_x * ctu_num_x_ / num_tile_columns;
+      const int x1 = (tile_x + 1) * ctu_num_x_ / num_tile_columns;
+      const int tile_idx = tile_y * num_tile_columns + tile_x;
+      for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+          tile_ctus_[tile_idx].push_back(y * ctu_num_x_ + x);
+          ctu_tile_idx_[y * ctu_num_x_ + x] = tile_idx;
+        }
+      }
+    }
+  }
+}
+
+void PictureData::AllocateCuAllocators() {
+  // The first allocator also holds the cus created outside of any tile
+  const int num_tiles = GetNumTiles();
+  const int num_ctus = std::max(1, ctu_num_x_ * ctu_num_y_);
+  if (cu_allocators_.empty()) {
+    cu_allocators_.emplace_back(new CuAllocator(chroma_fmt_, num_ctus * 4));
+  }
+  while (static_cast<int>(cu_allocators_.size()) < num_tiles) {
+    cu_allocators_.emplace_back(
+      new CuAllocator(chroma_fmt_, std::max(1, num_ctus / num_tiles) * 4));
+  }
+}
+
+void PictureData::AllocateCuTables() {
+  const int num_cu_pic_y = (pic_height_ + constants::kMaxBlockSize - 1) /
+    constants::kMinBlockSize;
+  const size_t table_size = cu_pic_stride_ * (num_cu_pic_y + 1);
+  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
+    cu_pic_table_[tree_idx].resize(table_size, nullptr);
+    CuInfoTable &cu_info = cu_info_table_[tree_idx];
+    cu_info.depth.resize(table_size, -1);
+    cu_info.binary_depth.resize(table_size, 0);
+    cu_info.skip_flag.resize(table_size, 0);
+    cu_info.intra_mode.resize(table_size, -1);
+    cu_info.pred_mode.resize(table_size, PredictionMode::kIntra);
+    cu_info.qp_luma.resize(table_size, 0);
+    cu_info.qp_chroma.resize(table_size, 0);
+    cu_info.cbf_luma.resize(table_size, 0);
+    cu_info.inter_dir.resize(table_size, InterDir::kL0);
+    for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+      cu_info.mv[i].resize(table_size);
+      cu_info.ref_idx[i].resize(table_size, -1);
+    }
+  }
+}
+
 void PictureData::AllocateAllCtu(CuTree cu_tree) {
   const int depth = 0;
   int tree_idx = static_cast<int>(cu_tree);
@@ -19,12 +19,16 @@
 #ifndef XVC_COMMON_LIB_PICTURE_DATA_H_
 #define XVC_COMMON_LIB_PICTURE_DATA_H_
 
+#include <array>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <vector>
 
+#include "xvc_common_lib/cu_types.h"
 #include "xvc_common_lib/picture_types.h"
 #include "xvc_common_lib/reference_picture_lists.h"
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/temporal_mv_field.h"
 #include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/utils.h"
 
@@ -34,7 +38,49 @@ class CodingUnit;
 
 class PictureData {
 public:
-  PictureData(ChromaFormat chroma_format, int width, int height, int bitdepth);
+  // Cu tables and cu objects of a picture that has been fully coded
+  struct CuStorage;
+
+  // Keeps the cu storage released by one picture until the next picture of
+  // the same format is initialized, shared by all pictures of a codec
+  class CuStoragePool {
+  public:
+    CuStoragePool();
+    ~CuStoragePool();
+    // Returns nullptr if no storage of matching format is available
+    std::unique_ptr<CuStorage> Acquire(ChromaFormat chroma_format, int width,
+                                       int height);
+    void Release(std::unique_ptr<CuStorage> storage);
+
+  private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<CuStorage>> storage_;
+  };
+
+  // Copy of the cu fields most frequently read by neighbor lookups, stored as
+  // separate arrays per 4x4 block using the same indexing as GetCuAt
+  struct CuInfoTable {
+    // Quad split depth, negative when there is no cu at the position
+    std::vector<int8_t> depth;
+    std::vector<int8_t> binary_depth;
+    std::vector<uint8_t> skip_flag;
+    // Luma intra mode, negative for inter cus and for the secondary cu tree
+    std::vector<int8_t> intra_mode;
+    std::vector<PredictionMode> pred_mode;
+    std::vector<uint8_t> qp_luma;
+    std::vector<uint8_t> qp_chroma;
+    std::vector<uint8_t> cbf_luma;
+    // Motion data, only valid for inter cus
+    std::vector<InterDir> inter_dir;
+    std::array<std::vector<MotionVector>,
+      static_cast<int>(RefPicList::kTotalNumber)> mv;
+    std::array<std::vector<int8_t>,
+      static_cast<int>(RefPicList::kTotalNumber)> ref_idx;
+  };
+
+  // Cu tables and cu objects are taken from the pool by Init when given
+  PictureData(ChromaFormat chroma_format, int width, int height, int bitdepth,
+              std::shared_ptr<CuStoragePool> cu_storage_pool = nullptr);
   ~PictureData();
 
   void Init(const SegmentHeader &segment, const Qp &pic_qp,
@@ -63,7 +109,7 @@ public:
   ChromaFormat GetChromaFormat() const { return chroma_fmt_; }
   int GetChromaShiftX() const { return chroma_shift_x_; }
   int GetChromaShiftY() const { return chroma_shift_y_; }
-  bool HasSecondaryCuTree() { return num_cu_trees_ > 1; }
+  bool HasSecondaryCuTree() const { return num_cu_trees_ > 1; }
   int GetMaxNumComponents() const {
     return max_num_components_;
   }
@@ -104,12 +150,53 @@ public:
       (posx / constants::kMinBlockSize);
     return cu_pic_table_[static_cast<int>(cu_tree)][cu_idx];
   }
+  void SetCuAt(CuTree cu_tree, int posx, int posy, CodingUnit *cu);
   const CodingUnit* GetLumaCu(const CodingUnit *cu) const;
+  // Cus of different tiles must be created and released from different
+  // threads only, positions outside of the picture belong to the first tile
   CodingUnit* CreateCu(CuTree cu_tree, int depth, int posx, int posy,
                        int width, int height);
   void ReleaseCu(CodingUnit *cu);
+  // Frees all cu objects and cu tables of a fully coded picture, later
+  // pictures only read its temporal mv field. Returned to the cu storage pool
+  // if there is one, otherwise allocated again by next Init.
+  void ReleaseCus();
   void MarkUsedInPic(CodingUnit *cu);
   void ClearMarkCuInPic(CodingUnit *cu);
+  // Must be called when fields of a marked cu have been modified
+  void UpdateCuInfo(const CodingUnit &cu);
+  const CuInfoTable& GetCuInfoTable(CuTree cu_tree) const {
+    return cu_info_table_[static_cast<int>(cu_tree)];
+  }
+  ptrdiff_t GetCuInfoIdx(int posx, int posy) const {
+    return (posy / constants::kMinBlockSize) * cu_pic_stride_ +
+      (posx / constants::kMinBlockSize);
+  }
+  CoeffCtuBuffer* GetCtuCoeff(int posx, int posy) const {
+    return cu_allocators_[GetTileIdxIfInside(posx, posy)]->ctu_coeff.get();
+  }
+
+  // Tiles
+  int GetNumTiles() const { return static_cast<int>(tile_ctus_.size()); }
+  // Ctu addresses of a tile in coding order
+  const std::vector<int>& GetTileCtus(int tile_idx) const {
+    return tile_ctus_[tile_idx];
+  }
+  int GetTileIdx(int posx, int posy) const {
+    return ctu_tile_idx_[(posy / constants::kCtuSize) * ctu_num_x_ +
+      posx / constants::kCtuSize];
+  }
+  // Neighboring samples in other tiles or outside the picture are unavailable
+  bool IsSameTile(int posx1, int posy1, int posx2, int posy2) const {
+    if (tile_ctus_.size() == 1) {
+      return true;
+    }
+    if (posx2 < 0 || posy2 < 0 || posx2 >= pic_width_ ||
+        posy2 >= pic_height_) {
+      return false;
+    }
+    return GetTileIdx(posx1, posy1) == GetTileIdx(posx2, posy2);
+  }
 
   // High level syntax
   void SetNalType(NalUnitType type) { nal_type_ = type; }
@@ -131,6 +218,11 @@ public:
     return &ref_pic_lists_;
   }
   bool GetTmvpValid() const { return tmvp_valid_; }
+  // Motion used by later pictures, stored when all cus have been coded
+  const TemporalMvField& GetTemporalMvField() const {
+    return temporal_mv_field_;
+  }
+  void StoreTemporalMvField() { temporal_mv_field_.Build(*this); }
   RefPicList GetTmvpRefList() const { return tmvp_ref_list_; }
   int GetTmvpRefIdx() const { return tmvp_ref_idx_; }
   void SetAdaptiveQp(bool adaptive_qp) { adaptive_qp_ = adaptive_qp; }
@@ -143,21 +235,41 @@ public:
   int GetTcOffset() const { return tc_offset_; }
 
 private:
+  // Object pool of cu objects for one tile
+  struct CuAllocator {
+    CuAllocator(ChromaFormat chroma_format, int batch_size);
+    // Non owning pointers to CU objects that were preivously used in rdo
+    std::vector<CodingUnit*> free_list;
+    // Chunks of allocated memory, the inner arrays are static and never resized
+    std::vector<std::vector<CodingUnit>> buffers;
+    // Holds coefficients for a single ctu, then reused for next one
+    std::unique_ptr<CoeffCtuBuffer> ctu_coeff;
+    int batch_size;
+    size_t list_index = 0;
+    size_t item_index = 0;
+  };
   RefPicList DetermineTmvpRefList(int *tmvp_ref_idx);
+  void InitTiles(int num_tile_columns, int num_tile_rows);
+  void AllocateCuTables();
+  void AllocateCuAllocators();
   void AllocateAllCtu(CuTree cu_tree);
+  void ResetCuInfo(CuTree cu_tree, ptrdiff_t offset, int num_x, int num_y);
+  void SetCuInfo(const CodingUnit &cu, ptrdiff_t offset, int num_x, int num_y);
+  int GetTileIdxIfInside(int posx, int posy) const {
+    return posx < 0 || posy < 0 ? 0 : GetTileIdx(posx, posy);
+  }
 
   std::array<std::vector<CodingUnit*>,
     constants::kMaxNumCuTrees> ctu_rs_list_;
   std::array<std::vector<CodingUnit*>,
     constants::kMaxNumCuTrees> cu_pic_table_;
+  std::array<CuInfoTable, constants::kMaxNumCuTrees> cu_info_table_;
   std::array<std::vector<YuvComponent>,
     constants::kMaxNumCuTrees> cu_tree_components_;
-  // Non owning pointers to CU objects that were preivously used in rdo
-  std::vector<CodingUnit*> cu_alloc_free_list_;
-  // Chunks of allocated memory, the inner arrays are static and never resized
-  std::vector<std::vector<CodingUnit>> cu_alloc_buffers_;
-  // Holds coefficients for a single ctu, then reused for next one
-  std::unique_ptr<CoeffCtuBuffer> ctu_coeff_;
+  std::vector<std::unique_ptr<CuAllocator>> cu_allocators_;
+  std::shared_ptr<CuStoragePool> cu_storage_pool_;
+  std::vector<std::vector<int>> tile_ctus_;
+  std::vector<int> ctu_tile_idx_;
   ptrdiff_t cu_pic_stride_;
   int pic_width_;
   int pic_height_;
@@ -169,9 +281,8 @@ private:
   int num_cu_trees_;
   int ctu_num_x_;
   int ctu_num_y_;
-  int cu_alloc_batch_size_;
-  size_t cu_alloc_list_index_ = 0;
-  size_t cu_alloc_item_index_ = 0;
+  int num_tile_columns_ = 0;
+  int num_tile_rows_ = 0;
   PicNum poc_ = static_cast<PicNum>(-1);
   PicNum doc_ = static_cast<PicNum>(-1);
   SegmentNum soc_ = static_cast<SegmentNum>(-1);
@@ -182,6 +293,7 @@ private:
   std::vector<Qp> qps_;
   NalUnitType nal_type_ = NalUnitType::kIntraPicture;
   ReferencePictureLists ref_pic_lists_;
+  TemporalMvField temporal_mv_field_;
   bool tmvp_valid_ = false;
   RefPicList tmvp_ref_list_ = RefPicList::kTotalNumber;
   int tmvp_ref_idx_ = -1;
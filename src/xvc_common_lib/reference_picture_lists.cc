@@ -61,17 +61,12 @@ ReferencePictureLists::GetRefPicTid(RefPicList ref_list, int ref_idx) const {
   return (*entry_list)[ref_idx].data->GetTid();
 }
 
-const CodingUnit*
-ReferencePictureLists::GetCodingUnitAt(RefPicList ref_list, int index,
-                                       CuTree cu_tree, int posx,
-                                       int posy) const {
-  std::shared_ptr<const PictureData> pic_data;
-  if (ref_list == RefPicList::kL0) {
-    pic_data = l0_[index].data;
-  } else {
-    pic_data = l1_[index].data;
-  }
-  return pic_data->GetCuAt(cu_tree, posx, posy);
+const TemporalMvField&
+ReferencePictureLists::GetTemporalMvField(RefPicList ref_list,
+                                          int ref_idx) const {
+  const std::vector<RefEntry> &entry_list =
+    ref_list == RefPicList::kL0 ? l0_ : l1_;
+  return entry_list[ref_idx].data->GetTemporalMvField();
 }
 
 void
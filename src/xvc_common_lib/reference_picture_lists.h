@@ -34,8 +34,8 @@ enum class RefPicList {
   kTotalNumber = 2
 };
 
-class CodingUnit;
 class PictureData;
+class TemporalMvField;
 
 class ReferencePictureLists {
 public:
@@ -58,8 +58,8 @@ public:
   bool HasOnlyBackReferences() const { return only_back_references_; }
   PicturePredictionType GetRefPicType(RefPicList ref_list, int ref_idx) const;
   int GetRefPicTid(RefPicList ref_list, int ref_idx) const;
-  const CodingUnit* GetCodingUnitAt(RefPicList ref_list, int ref_idx,
-                                    CuTree cu_tree, int posx, int posy) const;
+  const TemporalMvField& GetTemporalMvField(RefPicList ref_list,
+                                            int ref_idx) const;
   void SetRefPic(RefPicList ref_list, int index, PicNum ref_poc,
                  const std::shared_ptr<const PictureData> &pic_data,
                  const std::shared_ptr<const YuvPicture> &ref_pic);
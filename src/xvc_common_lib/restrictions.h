@@ -20,6 +20,10 @@
 #define XVC_COMMON_LIB_RESTRICTIONS_H_
 
 
+namespace xvc_test {
+class ScopedRestrictions;
+}   // namespace xvc_test
+
 namespace xvc {
 
 enum class RestrictedMode {
@@ -193,12 +197,18 @@ private:
   // It shall not be called anywhere in the code except for
   // 1. in the segment header read function in the decoder and
   // 2. the SetRestrictedMode in the encoder class.
+  // Tests may also override flags through xvc_test::ScopedRestrictions.
   // For this reason, the GetRW function is private and only
   // accessible by its friend classes.
   friend class SegmentHeaderReader;
   friend class Encoder;
   friend class Decoder;
   friend class ThreadDecoder;
+  friend class SplitRdoPool;
+  friend class AsyncEncoder;
+  friend class PictureEncoder;
+  friend class PictureDecoder;
+  friend class ::xvc_test::ScopedRestrictions;
   static thread_local Restrictions instance;
   static Restrictions &GetRW() { return instance; }
 
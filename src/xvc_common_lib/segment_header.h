@@ -68,6 +68,8 @@ struct SegmentHeader {
   int deblock = -1;
   int beta_offset = 0;
   int tc_offset = 0;
+  int num_tile_columns = 1;
+  int num_tile_rows = 1;
   Restrictions restrictions;
 
 private:
@@ -0,0 +1,92 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_common_lib/temporal_mv_field.h"
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/restrictions.h"
+#include "xvc_common_lib/utils.h"
+
+namespace xvc {
+
+void TemporalMvField::Build(const PictureData &pic_data) {
+  const YuvComponent luma = YuvComponent::kY;
+  const int block_size = Restrictions::Get().disable_ext_tmvp_full_resolution ?
+    kCompressedBlockSize : constants::kMinBlockSize;
+  // Same extent and padding as the cu table of the picture
+  const int num_x = (pic_data.GetPictureWidth(luma) +
+                     constants::kMaxBlockSize - 1) / block_size;
+  const int num_y = (pic_data.GetPictureHeight(luma) +
+                     constants::kMaxBlockSize - 1) / block_size;
+  shift_ = util::SizeToLog2(block_size);
+  stride_ = num_x + 1;
+  entries_.resize(stride_ * (num_y + 1));
+  poc_ = pic_data.GetPoc();
+
+  const ReferencePictureLists *ref_pic_lists = pic_data.GetRefPicLists();
+  for (int list_idx = 0; list_idx < 2; list_idx++) {
+    const RefPicList ref_list = static_cast<RefPicList>(list_idx);
+    const int num_ref_pics = ref_pic_lists->GetNumRefPics(ref_list);
+    ref_pocs_[list_idx].resize(num_ref_pics);
+    for (int ref_idx = 0; ref_idx < num_ref_pics; ref_idx++) {
+      ref_pocs_[list_idx][ref_idx] =
+        ref_pic_lists->GetRefPoc(ref_list, ref_idx);
+    }
+  }
+
+  for (int y = 0; y <= num_y; y++) {
+    Entry *entry = &entries_[y * stride_];
+    for (int x = 0; x <= num_x; x++, entry++) {
+      const CodingUnit *cu =
+        pic_data.GetCuAt(CuTree::Primary, x * block_size, y * block_size);
+      for (int list_idx = 0; list_idx < 2; list_idx++) {
+        const RefPicList ref_list = static_cast<RefPicList>(list_idx);
+        if (cu && cu->IsInter() && cu->HasMv(ref_list)) {
+          entry->mv[list_idx] = cu->GetMv(ref_list);
+          entry->ref_idx[list_idx] =
+            static_cast<int8_t>(cu->GetRefIdx(ref_list));
+        } else {
+          entry->mv[list_idx] = MotionVector();
+          entry->ref_idx[list_idx] = -1;
+        }
+      }
+    }
+  }
+
+  const int depth_num_x = (pic_data.GetPictureWidth(luma) +
+                           constants::kMaxBlockSize - 1) /
+    constants::kMinBlockSize;
+  const int depth_num_y = (pic_data.GetPictureHeight(luma) +
+                           constants::kMaxBlockSize - 1) /
+    constants::kMinBlockSize;
+  depth_stride_ = depth_num_x + 1;
+  depth_.resize(depth_stride_ * (depth_num_y + 1));
+  for (int y = 0; y <= depth_num_y; y++) {
+    int8_t *depth = &depth_[y * depth_stride_];
+    for (int x = 0; x <= depth_num_x; x++) {
+      const CodingUnit *cu =
+        pic_data.GetCuAt(CuTree::Primary, x * constants::kMinBlockSize,
+                         y * constants::kMinBlockSize);
+      depth[x] = !cu ? -1 :
+        static_cast<int8_t>(cu->GetDepth() + cu->GetBinaryDepth());
+    }
+  }
+}
+
+}   // namespace xvc
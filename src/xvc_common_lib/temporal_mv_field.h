@@ -0,0 +1,86 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_COMMON_LIB_TEMPORAL_MV_FIELD_H_
+#define XVC_COMMON_LIB_TEMPORAL_MV_FIELD_H_
+
+#include <array>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/cu_types.h"
+#include "xvc_common_lib/reference_picture_lists.h"
+
+namespace xvc {
+
+class PictureData;
+
+// Compact copy of the motion of a coded picture, used by later pictures for
+// temporal mv prediction instead of the cu objects of the reference picture.
+// Stored at 16x16 granularity when tmvp is restricted to that resolution,
+// otherwise at the minimum cu size. The split depth is always kept at the
+// minimum cu size for encoder split decisions.
+class TemporalMvField {
+public:
+  static const int kCompressedBlockSize = 16;
+  struct Entry {
+    bool IsInter() const { return ref_idx[0] >= 0 || ref_idx[1] >= 0; }
+    bool HasMv(RefPicList ref_list) const {
+      return ref_idx[static_cast<int>(ref_list)] >= 0;
+    }
+    int GetRefIdx(RefPicList ref_list) const {
+      return ref_idx[static_cast<int>(ref_list)];
+    }
+    const MotionVector& GetMv(RefPicList ref_list) const {
+      return mv[static_cast<int>(ref_list)];
+    }
+    std::array<MotionVector, 2> mv;
+    // Negative when the reference picture list is not used
+    std::array<int8_t, 2> ref_idx;
+  };
+
+  // Copies the motion of all primary tree cus of a fully coded picture
+  void Build(const PictureData &pic_data);
+  PicNum GetPoc() const { return poc_; }
+  PicNum GetRefPoc(RefPicList ref_list, int ref_idx) const {
+    return ref_pocs_[static_cast<int>(ref_list)][ref_idx];
+  }
+  // Same addressing as the cu table of the picture, positions up to one
+  // minimum cu outside of the picture are valid and have no motion
+  const Entry& GetEntryAt(int posx, int posy) const {
+    return entries_[(posy >> shift_) * stride_ + (posx >> shift_)];
+  }
+  // Sum of quad and binary split depth, negative when there is no cu
+  int GetDepthAt(int posx, int posy) const {
+    return depth_[(posy / constants::kMinBlockSize) * depth_stride_ +
+                  (posx / constants::kMinBlockSize)];
+  }
+
+private:
+  std::vector<Entry> entries_;
+  std::vector<int8_t> depth_;
+  std::array<std::vector<PicNum>, 2> ref_pocs_;
+  PicNum poc_ = 0;
+  ptrdiff_t stride_ = 0;
+  ptrdiff_t depth_stride_ = 0;
+  int shift_ = 0;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_COMMON_LIB_TEMPORAL_MV_FIELD_H_
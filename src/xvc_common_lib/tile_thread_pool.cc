@@ -0,0 +1,101 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_common_lib/tile_thread_pool.h"
+
+#include <algorithm>
+
+#include "xvc_common_lib/perf_trace.h"
+
+namespace xvc {
+
+TileThreadPool::TileThreadPool(int num_threads) {
+  if (num_threads < 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  for (int i = 1; i < num_threads; i++) {
+    worker_threads_.emplace_back([this] {
+      WorkerMain();
+    });
+  }
+}
+
+TileThreadPool::~TileThreadPool() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  running_ = false;
+  wait_work_cond_.notify_all();
+  lock.unlock();
+  for (auto &thread : worker_threads_) {
+    thread.join();
+  }
+}
+
+void TileThreadPool::Run(int num_tiles,
+                         const std::function<void(int)> &code_tile) {
+  if (worker_threads_.empty() || num_tiles == 1) {
+    for (int tile = 0; tile < num_tiles; tile++) {
+      code_tile(tile);
+    }
+    return;
+  }
+  Job job = { &code_tile, num_tiles, 0, 0 };
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_jobs_.push_back(&job);
+  wait_work_cond_.notify_all();
+  while (job.next_tile < job.num_tiles) {
+    CodeNextTile(&lock, &job);
+  }
+  XVC_PERF_TIMER(kThreadWait);
+  work_done_cond_.wait(lock, [&job] { return job.num_done == job.num_tiles; });
+}
+
+void TileThreadPool::CodeNextTile(std::unique_lock<std::mutex> *lock,
+                                  Job *job) {
+  const int tile = job->next_tile++;
+  if (job->next_tile == job->num_tiles) {
+    pending_jobs_.erase(std::find(pending_jobs_.begin(), pending_jobs_.end(),
+                                  job));
+  }
+  lock->unlock();
+  (*job->code_tile)(tile);
+  lock->lock();
+  // The job is owned by the calling thread and must not be touched after
+  // the last tile has been reported as done
+  if (++job->num_done == job->num_tiles) {
+    work_done_cond_.notify_all();
+  }
+}
+
+void TileThreadPool::WorkerMain() {
+  XVC_PERF_THREAD_NAME("tile worker");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    {
+      XVC_PERF_TIMER(kThreadWait);
+      wait_work_cond_.wait(lock, [this] {
+        return !running_ || !pending_jobs_.empty();
+      });
+    }
+    if (!running_) {
+      return;
+    }
+    CodeNextTile(&lock, pending_jobs_.front());
+  }
+}
+
+}   // namespace xvc
@@ -0,0 +1,65 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_COMMON_LIB_TILE_THREAD_POOL_H_
+#define XVC_COMMON_LIB_TILE_THREAD_POOL_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <vector>
+
+namespace xvc {
+
+// Worker threads for coding the tiles of a picture. The calling thread codes
+// tiles as well, so a pool of num_threads has num_threads - 1 workers and
+// with at most one thread all tiles are coded inline. Multiple pictures may
+// code their tiles through the same pool at the same time.
+class TileThreadPool {
+public:
+  // A negative num_threads gives one thread per cpu core
+  explicit TileThreadPool(int num_threads);
+  ~TileThreadPool();
+  // Calls code_tile for each tile index and returns when all are done
+  void Run(int num_tiles, const std::function<void(int)> &code_tile);
+
+private:
+  struct Job {
+    const std::function<void(int)> *code_tile;
+    int num_tiles;
+    int next_tile;
+    int num_done;
+  };
+  void CodeNextTile(std::unique_lock<std::mutex> *lock, Job *job);
+  void WorkerMain();
+
+  std::vector<std::thread> worker_threads_;
+  std::mutex mutex_;
+  std::condition_variable wait_work_cond_;
+  std::condition_variable work_done_cond_;
+  // Jobs that still have tiles which no thread has started on
+  std::deque<Job*> pending_jobs_;
+  bool running_ = true;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_COMMON_LIB_TILE_THREAD_POOL_H_
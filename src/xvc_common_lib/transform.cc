@@ -1326,17 +1326,18 @@ ForwardTransform::FwdPartialTransform64(int shift, int lines,
     in += in_stride;
     out++;
   }
+  // Output is 64 rows of lines coefficients, clear what was not transformed
   if (ZeroWdt) {
     Coeff *tmp = orig_out;
-    for (int y = 0; y < tx_cols; y++) {
-      memset(tmp + tx_lines, 0, sizeof(Coeff)*tx_lines);
+    for (int y = 0; y < tx_lines; y++) {
+      std::memset(tmp + tx_cols, 0, sizeof(Coeff) * (lines - tx_cols));
       tmp += out_stride;
     }
   }
   if (ZeroHgt) {
     Coeff *tmp = orig_out + tx_lines * out_stride;
-    for (int y = tx_lines; y < lines; y++) {
-      std::memset(tmp, 0, sizeof(Coeff) * 64);
+    for (int y = tx_lines; y < 64; y++) {
+      std::memset(tmp, 0, sizeof(Coeff) * lines);
       tmp += out_stride;
     }
   }
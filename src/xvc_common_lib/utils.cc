@@ -18,6 +18,15 @@
 
 #include "xvc_common_lib/utils.h"
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 namespace xvc {
 
 namespace util {
@@ -132,6 +141,30 @@ int ScaleChromaY(int size, ChromaFormat chroma_format) {
   }
 }
 
+int64_t GetThreadCpuTime() {
+#if defined(_WIN32)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time,
+                      &kernel_time, &user_time)) {
+    return 0;
+  }
+  // FILETIME is expressed in units of 100 nanoseconds
+  int64_t kernel = (static_cast<int64_t>(kernel_time.dwHighDateTime) << 32) |
+    kernel_time.dwLowDateTime;
+  int64_t user = (static_cast<int64_t>(user_time.dwHighDateTime) << 32) |
+    user_time.dwLowDateTime;
+  return (kernel + user) * 100;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+  return 0;
+#endif
+}
+
 }  // namespace util
 
 }  // namespace xvc
@@ -88,6 +88,10 @@ inline int GetNumComponents(ChromaFormat chroma_fmt) {
   return chroma_fmt == ChromaFormat::kMonochrome ? 1 : 3;
 }
 
+// CPU time in nanoseconds consumed by the calling thread so far,
+// returns 0 on platforms where this is not supported
+int64_t GetThreadCpuTime();
+
 }   // namespace util
 
 }   // namespace xvc
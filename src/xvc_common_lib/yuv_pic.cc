@@ -100,43 +100,50 @@ void YuvPicture::CopyFrom(const uint8_t *pic8,
   }
 }
 
-void YuvPicture::CopyFromWithPadding(const uint8_t *pic8,
-                                     int input_bitdepth) {
+void YuvPicture::CopyFrom(
+  const uint8_t *const planes[constants::kMaxYuvComponents],
+  const ptrdiff_t strides[constants::kMaxYuvComponents], int input_bitdepth) {
   if (sample_buffer_.empty()) {
     return;
   }
-
-  if (input_bitdepth == 8) {
-    for (int c = 0; c < constants::kMaxYuvComponents; c++) {
-      YuvComponent comp = YuvComponent(c);
-      for (int y = 0; y < height_[comp]; y++) {
-        for (int x = 0; x < width_[comp]; x++) {
-          Sample *dst = GetSamplePtr(comp, x, y);
-          *dst = static_cast<Sample>(*pic8++);
+  const int bit_shift = bitdepth_ - input_bitdepth;
+  assert(bit_shift >= 0);
+  for (int c = 0; c < constants::kMaxYuvComponents; c++) {
+    const YuvComponent comp = YuvComponent(c);
+    const int width = width_[c];
+    const uint8_t *src8 = planes[c];
+    Sample *dst = GetSamplePtr(comp, 0, 0);
+    for (int y = 0; y < height_[c]; y++) {
+      if (input_bitdepth == 8 && sizeof(Sample) == 1) {
+        std::memcpy(dst, src8, width);
+      } else if (input_bitdepth == 8) {
+        for (int x = 0; x < width; x++) {
+          dst[x] = static_cast<Sample>(src8[x] << bit_shift);
         }
-      }
-    }
-  } else {
-    const uint16_t *pic16 = reinterpret_cast<const uint16_t *>(&pic8[0]);
-    for (int c = 0; c < constants::kMaxYuvComponents; c++) {
-      YuvComponent comp = YuvComponent(c);
-      for (int y = 0; y < height_[comp]; y++) {
-        for (int x = 0; x < width_[comp]; x++) {
-          Sample *dst = GetSamplePtr(comp, x, y);
-          *dst = static_cast<Sample>(*pic16++);
+      } else if (bit_shift == 0) {
+        // Assuming little endian
+        std::memcpy(dst, src8, width * sizeof(Sample));
+      } else {
+        // Input planes are not necessarily 16 bit aligned
+        for (int x = 0; x < width; x++) {
+          const int sample = src8[2 * x] | (src8[2 * x + 1] << 8);
+          dst[x] = static_cast<Sample>(sample << bit_shift);
         }
       }
+      src8 += strides[c];
+      dst += stride_[c];
     }
   }
-  PadBorder();
 }
 
-
-void YuvPicture::CopyFromWithResampling(const uint8_t *pic8, int input_bitdepth,
-                                        int orig_width, int orig_height) {
+void YuvPicture::CopyFromWithResampling(
+  const uint8_t *const planes[constants::kMaxYuvComponents],
+  const ptrdiff_t strides[constants::kMaxYuvComponents],
+  int input_bitdepth, int orig_width, int orig_height) {
   YuvPicture temp_pic(chroma_format_, orig_width, orig_height, input_bitdepth,
                       true);
-  temp_pic.CopyFromWithPadding(pic8, input_bitdepth);
+  temp_pic.CopyFrom(planes, strides, input_bitdepth);
+  temp_pic.PadBorder();
   for (int c = 0; c < constants::kMaxYuvComponents; c++) {
     YuvComponent comp = YuvComponent(c);
     uint8_t* dst = reinterpret_cast<uint8_t*>(GetSamplePtr(comp, 0, 0));
@@ -150,6 +157,24 @@ void YuvPicture::CopyFromWithResampling(const uint8_t *pic8, int input_bitdepth,
   }
 }
 
+void YuvPicture::CopyFromWithResampling(const uint8_t *pic8, int input_bitdepth,
+                                        int orig_width, int orig_height) {
+  // Input planes are stored consecutively without padding
+  const int sample_size = input_bitdepth == 8 ? 1 : 2;
+  const uint8_t *planes[constants::kMaxYuvComponents];
+  ptrdiff_t strides[constants::kMaxYuvComponents];
+  planes[0] = pic8;
+  strides[0] = orig_width * sample_size;
+  for (int c = 1; c < constants::kMaxYuvComponents; c++) {
+    const int prev_height = c == 1 ? orig_height :
+      util::ScaleChromaY(orig_height, chroma_format_);
+    planes[c] = planes[c - 1] + strides[c - 1] * prev_height;
+    strides[c] = util::ScaleChromaX(orig_width, chroma_format_) * sample_size;
+  }
+  CopyFromWithResampling(planes, strides, input_bitdepth, orig_width,
+                         orig_height);
+}
+
 
 
 void YuvPicture::CopyToSameBitdepth(std::vector<uint8_t> *out_bytes) const {
@@ -53,9 +53,17 @@ public:
     return DataBuffer<const Sample>(GetSamplePtr(comp, x, y), GetStride(comp));
   }
   void CopyFrom(const uint8_t *picture_bytes, int input_bitdepth);
-  void CopyFromWithPadding(const uint8_t *picture_bytes, int input_bitdepth);
   void CopyFromWithResampling(const uint8_t *picture_bytes, int input_bitdepth,
                               int orig_width, int orig_height);
+  // Copy from separate planes with stride given in bytes, samples are stored
+  // as 8 bit for input_bitdepth 8, otherwise as 16 bit little endian
+  void CopyFrom(const uint8_t *const planes[constants::kMaxYuvComponents],
+                const ptrdiff_t strides[constants::kMaxYuvComponents],
+                int input_bitdepth);
+  void CopyFromWithResampling(
+    const uint8_t *const planes[constants::kMaxYuvComponents],
+    const ptrdiff_t strides[constants::kMaxYuvComponents],
+    int input_bitdepth, int orig_width, int orig_height);
   void CopyToSameBitdepth(std::vector<uint8_t> *pic_bytes) const;
   void CopyTo(std::vector<uint8_t> *out_bytes, int out_width,
               int out_height, ChromaFormat out_chroma_format,
@@ -0,0 +1,273 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_dec_lib/async_decoder.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+#include "xvc_common_lib/perf_trace.h"
+
+namespace xvc {
+
+AsyncDecoder::AsyncDecoder(Decoder *decoder, int input_queue_size,
+                           int output_queue_size)
+  : decoder_(decoder),
+  input_queue_size_(input_queue_size > 0 ?
+                    input_queue_size : kDefaultInputQueueSize),
+  output_queue_size_(output_queue_size > 0 ?
+                     output_queue_size : kDefaultOutputQueueSize) {
+}
+
+AsyncDecoder::~AsyncDecoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  input_cond_.notify_all();
+  output_cond_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+#if !defined(_WIN32)
+  for (int fd : event_fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+xvc_dec_return_code AsyncDecoder::SendNal(const uint8_t *nal_unit,
+                                          size_t nal_unit_size,
+                                          int64_t user_data) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (end_of_input_) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    if (!nal_unit) {
+      end_of_input_ = true;
+    } else if (input_queue_.size() >= input_queue_size_) {
+      return XVC_DEC_QUEUE_FULL;
+    } else {
+      InputNal input;
+      if (!free_nal_buffers_.empty()) {
+        input.bytes = std::move(free_nal_buffers_.back());
+        free_nal_buffers_.pop_back();
+      }
+      input.bytes.assign(nal_unit, nal_unit + nal_unit_size);
+      input.user_data = user_data;
+      input_queue_.push_back(std::move(input));
+    }
+    if (!thread_.joinable()) {
+      Start();
+    }
+  }
+  input_cond_.notify_one();
+  return XVC_DEC_OK;
+}
+
+xvc_dec_return_code AsyncDecoder::ReceivePicture(xvc_decoded_picture *pic,
+                                                 bool wait) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (picture_callback_) {
+    return XVC_DEC_INVALID_ARGUMENT;
+  }
+  if (wait) {
+    output_cond_.wait(lock, [this]() {
+      return !output_queue_.empty() || end_of_output_;
+    });
+  }
+  if (output_queue_.empty()) {
+    return end_of_output_ ? XVC_DEC_END_OF_STREAM : XVC_DEC_NO_DECODED_PIC;
+  }
+  // The previous picture is no longer used by the application
+  if (current_pic_.bytes.capacity() > 0) {
+    free_pic_buffers_.push_back(std::move(current_pic_.bytes));
+  }
+  current_pic_ = std::move(output_queue_.front());
+  output_queue_.pop_front();
+  ConsumeEvent();
+  lock.unlock();
+  output_cond_.notify_all();
+  *pic = current_pic_.pic;
+  // Plane pointers are relative to the copied picture buffer
+  char *base = current_pic_.bytes.empty() ? nullptr : &current_pic_.bytes[0];
+  pic->bytes = base;
+  for (int c = 0; c < 3; c++) {
+    if (current_pic_.pic.planes[c]) {
+      pic->planes[c] = base + (current_pic_.pic.planes[c] -
+                               current_pic_.pic.bytes);
+    }
+  }
+  return XVC_DEC_OK;
+}
+
+xvc_dec_return_code
+AsyncDecoder::SetPictureCallback(xvc_dec_picture_callback callback,
+                                 void *opaque) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_.joinable()) {
+    return XVC_DEC_INVALID_ARGUMENT;
+  }
+  picture_callback_ = callback;
+  picture_callback_opaque_ = opaque;
+  return XVC_DEC_OK;
+}
+
+int AsyncDecoder::GetEventFd() {
+  std::lock_guard<std::mutex> lock(mutex_);
+#if defined(_WIN32)
+  return -1;
+#else
+  if (event_fds_[0] < 0) {
+    // A pipe holding one byte per picture in the output queue, and one
+    // byte for end of stream that is never consumed
+    if (pipe(event_fds_) != 0) {
+      event_fds_[0] = event_fds_[1] = -1;
+      return -1;
+    }
+    for (int fd : event_fds_) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    for (size_t i = 0; i < output_queue_.size(); i++) {
+      SignalEvent();
+    }
+    if (end_of_output_) {
+      SignalEvent();
+    }
+  }
+  return event_fds_[0];
+#endif
+}
+
+Decoder::State AsyncDecoder::GetState() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_;
+}
+
+void AsyncDecoder::Start() {
+  thread_ = std::thread(&AsyncDecoder::WorkerMain, this);
+}
+
+void AsyncDecoder::WorkerMain() {
+  XVC_PERF_THREAD_NAME("decoder");
+  while (true) {
+    InputNal nal;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      input_cond_.wait(lock, [this]() {
+        return stop_ || !input_queue_.empty() || end_of_input_;
+      });
+      if (stop_) {
+        return;
+      }
+      if (input_queue_.empty()) {
+        break;
+      }
+      nal = std::move(input_queue_.front());
+      input_queue_.pop_front();
+    }
+    decoder_->DecodeNal(&nal.bytes[0], nal.bytes.size(), nal.user_data);
+    Decoder::State state = decoder_->GetState();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // Unsupported bitstreams are reported until the decoder is destroyed
+      if (state_ != Decoder::State::kDecoderVersionTooLow &&
+          state_ != Decoder::State::kBitstreamBitdepthTooHigh) {
+        state_ = state;
+      }
+      free_nal_buffers_.push_back(std::move(nal.bytes));
+    }
+    if (!OutputPictures()) {
+      return;
+    }
+  }
+  decoder_->FlushBufferedNalUnits();
+  if (!OutputPictures()) {
+    return;
+  }
+  if (picture_callback_) {
+    picture_callback_(picture_callback_opaque_, nullptr);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    end_of_output_ = true;
+    SignalEvent();
+  }
+  output_cond_.notify_all();
+}
+
+bool AsyncDecoder::OutputPictures() {
+  xvc_decoded_picture pic;
+  while (decoder_->GetDecodedPicture(&pic)) {
+    if (picture_callback_) {
+      picture_callback_(picture_callback_opaque_, &pic);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    output_cond_.wait(lock, [this]() {
+      return stop_ || output_queue_.size() < output_queue_size_;
+    });
+    if (stop_) {
+      return false;
+    }
+    OutputPicture output;
+    if (!free_pic_buffers_.empty()) {
+      output.bytes = std::move(free_pic_buffers_.back());
+      free_pic_buffers_.pop_back();
+    }
+    lock.unlock();
+    output.pic = pic;
+    output.bytes.assign(pic.bytes, pic.bytes + pic.size);
+    lock.lock();
+    output_queue_.push_back(std::move(output));
+    SignalEvent();
+    lock.unlock();
+    output_cond_.notify_all();
+  }
+  return true;
+}
+
+void AsyncDecoder::SignalEvent() {
+#if !defined(_WIN32)
+  if (event_fds_[1] >= 0) {
+    const char event = 1;
+    ssize_t ret = write(event_fds_[1], &event, 1);
+    (void)ret;
+  }
+#endif
+}
+
+void AsyncDecoder::ConsumeEvent() {
+#if !defined(_WIN32)
+  if (event_fds_[0] >= 0) {
+    char event;
+    ssize_t ret = read(event_fds_[0], &event, 1);
+    (void)ret;
+  }
+#endif
+}
+
+}   // namespace xvc
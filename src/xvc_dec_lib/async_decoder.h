@@ -0,0 +1,97 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_DEC_LIB_ASYNC_DECODER_H_
+#define XVC_DEC_LIB_ASYNC_DECODER_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <vector>
+
+#include "xvc_dec_lib/decoder.h"
+#include "xvc_dec_lib/xvcdec.h"
+
+namespace xvc {
+
+// Runs the nal unit parsing and picture output of a Decoder on a separate
+// thread so that submitting a nal unit never waits for decoding to finish.
+// Decoded pictures are delivered in output order, either through a callback
+// called on the decoding thread or by copying them into a bounded output
+// queue. For the output queue an event file descriptor is provided that is
+// readable whenever a picture or the end of stream can be received.
+class AsyncDecoder {
+public:
+  static const int kDefaultInputQueueSize = 16;
+  static const int kDefaultOutputQueueSize = 4;
+
+  AsyncDecoder(Decoder *decoder, int input_queue_size, int output_queue_size);
+  ~AsyncDecoder();
+  // A null nal unit signals end of stream
+  xvc_dec_return_code SendNal(const uint8_t *nal_unit, size_t nal_unit_size,
+               int64_t user_data);
+  xvc_dec_return_code ReceivePicture(xvc_decoded_picture *pic, bool wait);
+  xvc_dec_return_code SetPictureCallback(
+    xvc_dec_picture_callback picture_callback, void *opaque);
+  int GetEventFd();
+  // Last error state of the decoder after decoding a queued nal unit
+  Decoder::State GetState();
+
+private:
+  struct InputNal {
+    std::vector<uint8_t> bytes;
+    int64_t user_data;
+  };
+  struct OutputPicture {
+    xvc_decoded_picture pic;
+    std::vector<char> bytes;
+  };
+  void Start();
+  void WorkerMain();
+  // Returns false if the decoder is being destroyed
+  bool OutputPictures();
+  void SignalEvent();
+  void ConsumeEvent();
+
+  Decoder *decoder_;
+  const size_t input_queue_size_;
+  const size_t output_queue_size_;
+  xvc_dec_picture_callback picture_callback_ = nullptr;
+  void *picture_callback_opaque_ = nullptr;
+  Decoder::State state_ = Decoder::State::kNoSegmentHeader;
+  std::deque<InputNal> input_queue_;
+  std::deque<OutputPicture> output_queue_;
+  // Buffers are recycled to avoid reallocation for each picture
+  std::vector<std::vector<uint8_t>> free_nal_buffers_;
+  std::vector<std::vector<char>> free_pic_buffers_;
+  OutputPicture current_pic_;
+  bool end_of_input_ = false;
+  bool end_of_output_ = false;
+  bool stop_ = false;
+  int event_fds_[2] = { -1, -1 };
+  std::mutex mutex_;
+  std::condition_variable input_cond_;
+  std::condition_variable output_cond_;
+  std::thread thread_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_DEC_LIB_ASYNC_DECODER_H_
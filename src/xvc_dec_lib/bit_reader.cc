@@ -78,6 +78,15 @@ void BitReader::ReadBytes(uint8_t *bytes, size_t len) {
   consumed_ += tocopy;
 }
 
+BitReader BitReader::SplitBytes(size_t len) {
+  assert(bit_mask_ == 0x80);
+  assert(consumed_ + len <= length_);
+  len = std::min(len, length_ - consumed_);
+  BitReader sub_reader(&buffer_[consumed_], len);
+  consumed_ += len;
+  return sub_reader;
+}
+
 void BitReader::Rewind(int num_bits) {
   while (num_bits--) {
     bit_mask_ <<= 1;
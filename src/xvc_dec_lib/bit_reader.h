@@ -38,6 +38,8 @@ public:
   void SkipBits();
   uint8_t ReadByte();
   void ReadBytes(uint8_t *bytes, size_t len);
+  // Returns a reader of the next len bytes and skips past them
+  BitReader SplitBytes(size_t len);
   void Rewind(int num_bits);
 
 private:
@@ -18,15 +18,43 @@
 
 #include "xvc_dec_lib/cu_decoder.h"
 
+#include <algorithm>
 #include <cassert>
 
+#include "xvc_common_lib/perf_trace.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
 
 namespace xvc {
 
+void CuDecodeStats::Add(const CodingUnit &cu) {
+  const int size = std::max(cu.GetWidth(YuvComponent::kY),
+                            cu.GetHeight(YuvComponent::kY));
+  num_cus_by_size[util::SizeLog2Bits(size)]++;
+  if (cu.IsIntra()) {
+    num_intra++;
+  } else if (cu.GetSkipFlag()) {
+    num_skip++;
+  } else if (cu.GetMergeFlag()) {
+    num_merge++;
+  } else {
+    num_inter++;
+  }
+}
+
+void CuDecodeStats::Add(const CuDecodeStats &other) {
+  for (int i = 0; i < kNumSizeClasses; i++) {
+    num_cus_by_size[i] += other.num_cus_by_size[i];
+  }
+  num_intra += other.num_intra;
+  num_inter += other.num_inter;
+  num_merge += other.num_merge;
+  num_skip += other.num_skip;
+}
+
 CuDecoder::CuDecoder(const SimdFunctions &simd, const Qp &pic_qp,
-                     YuvPicture *decoded_pic, PictureData *pic_data)
+                     YuvPicture *decoded_pic, PictureData *pic_data,
+                     CuDecodeStats *cu_stats)
   : min_pel_(0),
   max_pel_((1 << decoded_pic->GetBitdepth()) - 1),
   pic_qp_(pic_qp),
@@ -39,10 +67,12 @@ CuDecoder::CuDecoder(const SimdFunctions &simd, const Qp &pic_qp,
   cu_reader_(pic_data, intra_pred_),
   temp_pred_(kBufferStride_, constants::kMaxBlockSize),
   temp_resi_(kBufferStride_, constants::kMaxBlockSize),
-  temp_coeff_(kBufferStride_, constants::kMaxBlockSize) {
+  temp_coeff_(kBufferStride_, constants::kMaxBlockSize),
+  cu_stats_(*cu_stats) {
 }
 
 void CuDecoder::DecodeCtu(int rsaddr, SyntaxReader *reader) {
+  XVC_PERF_TIMER(kDecodeCtu);
   ReadCtu(rsaddr, reader);
 
   CodingUnit *ctu = pic_data_.GetCtu(CuTree::Primary, rsaddr);
@@ -56,6 +86,7 @@ void CuDecoder::DecodeCtu(int rsaddr, SyntaxReader *reader) {
 }
 
 void CuDecoder::ReadCtu(int rsaddr, SyntaxReader * reader) {
+  XVC_PERF_TIMER(kEntropyDecode);
   CodingUnit *ctu = pic_data_.GetCtu(CuTree::Primary, rsaddr);
   bool read_delta_qp = cu_reader_.ReadCtu(ctu, reader);
   if (pic_data_.HasSecondaryCuTree()) {
@@ -87,7 +118,14 @@ void CuDecoder::DecompressCu(CodingUnit *cu) {
       }
     }
   } else {
+    if (cu->IsInter()) {
+      // Before marking so that the cu info table gets the final motion
+      inter_pred_.CalculateMV(cu);
+    }
     pic_data_.MarkUsedInPic(cu);
+    if (cu->GetCuTree() == CuTree::Primary) {
+      cu_stats_.Add(*cu);
+    }
     for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
       DecompressComponent(cu, comp, cu->GetQp());
     }
@@ -112,7 +150,6 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
     intra_pred_.Predict(intra_mode, *cu, comp, dec, dec_stride,
                         pred_buffer.GetDataPtr(), pred_buffer.GetStride());
   } else {
-    inter_pred_.CalculateMV(cu);
     inter_pred_.MotionCompensation(*cu, comp, pred_buffer.GetDataPtr(),
                                    pred_buffer.GetStride());
   }
@@ -19,6 +19,7 @@
 #ifndef XVC_DEC_LIB_CU_DECODER_H_
 #define XVC_DEC_LIB_CU_DECODER_H_
 
+#include <array>
 #include <vector>
 
 #include "xvc_common_lib/sample_buffer.h"
@@ -34,10 +35,27 @@
 
 namespace xvc {
 
+// Number of decoded coding units in the primary cu tree by size and mode
+struct CuDecodeStats {
+  // Size classes 4, 8, 16, 32, 64 and 128 based on largest cu dimension
+  static const int kNumSizeClasses = 6;
+  static_assert(constants::kMaxBlockSize <= (4 << (kNumSizeClasses - 1)),
+                "Largest block size must map to a size class");
+  void Add(const CodingUnit &cu);
+  void Add(const CuDecodeStats &other);
+
+  std::array<uint32_t, kNumSizeClasses> num_cus_by_size = { { 0 } };
+  uint32_t num_intra = 0;
+  uint32_t num_inter = 0;
+  uint32_t num_merge = 0;
+  uint32_t num_skip = 0;
+};
+
 class CuDecoder {
 public:
   CuDecoder(const SimdFunctions &simd, const Qp &pic_qp,
-            YuvPicture *decoded_pic, PictureData *picture_data);
+            YuvPicture *decoded_pic, PictureData *picture_data,
+            CuDecodeStats *cu_stats);
   void DecodeCtu(int rsaddr, SyntaxReader *reader);
 
 private:
@@ -59,6 +77,7 @@ private:
   SampleBufferStorage temp_pred_;
   ResidualBufferStorage temp_resi_;
   CoeffBufferStorage temp_coeff_;
+  CuDecodeStats &cu_stats_;
 };
 
 }   // namespace xvc
@@ -42,6 +42,7 @@ void CuReader::ReadCu(CodingUnit *cu, SplitRestriction split_restriction,
     for (YuvComponent comp : pic_data_->GetComponents(cu->GetCuTree())) {
       ReadComponent(cu, comp, reader);
     }
+    pic_data_->UpdateCuInfo(*cu);
   }
 }
 
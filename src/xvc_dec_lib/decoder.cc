@@ -18,13 +18,16 @@
 
 #include "xvc_dec_lib/decoder.h"
 
+#include <array>
 #include <cassert>
 #include <limits>
 
+#include "xvc_common_lib/perf_trace.h"
 #include "xvc_common_lib/reference_list_sorter.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/utils.h"
+#include "xvc_dec_lib/async_decoder.h"
 #include "xvc_dec_lib/segment_header_reader.h"
 #include "xvc_dec_lib/thread_decoder.h"
 
@@ -33,6 +36,7 @@ namespace xvc {
 Decoder::Decoder(int num_threads)
   : curr_segment_header_(std::make_shared<SegmentHeader>()),
   prev_segment_header_(std::make_shared<SegmentHeader>()),
+  num_threads_(num_threads),
   simd_(SimdCpu::GetRuntimeCapabilities()) {
   if (num_threads != 0) {
     thread_decoder_ =
@@ -41,11 +45,20 @@ Decoder::Decoder(int num_threads)
 }
 
 Decoder::~Decoder() {
+  async_decoder_.reset();
   if (thread_decoder_) {
     thread_decoder_->StopAll();
   }
 }
 
+AsyncDecoder* Decoder::GetAsyncDecoder() {
+  if (!async_decoder_) {
+    async_decoder_.reset(new AsyncDecoder(this, async_input_queue_size_,
+                                          async_output_queue_size_));
+  }
+  return async_decoder_.get();
+}
+
 bool Decoder::DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
                         int64_t user_data) {
   // Nal header parsing
@@ -160,6 +173,11 @@ bool Decoder::DecodeSegmentHeaderNal(BitReader *bit_reader) {
   }
   pic_buffering_num_ =
     sliding_window_length_ + curr_segment_header_->num_ref_pics;
+  // Pictures are decoded in output order when there is no sub gop
+  // reordering, so they can be output as soon as they are reconstructed
+  // instead of waiting for the sliding window to fill up.
+  low_delay_output_ = low_delay_ && sub_gop_length_ == 1 &&
+    num_tail_pics_ == 0;
 
   if (output_width_ == 0) {
     output_width_ = curr_segment_header_->GetOutputWidth();
@@ -246,9 +264,15 @@ Decoder::DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data) {
     assert(pic_dec);
   }
 
+  if (segment_header->num_tile_columns * segment_header->num_tile_rows > 1 &&
+      !tile_thread_pool_) {
+    tile_thread_pool_.reset(new TileThreadPool(num_threads_));
+  }
+  pic_dec->SetTileThreadPool(tile_thread_pool_.get());
+
   // Setup poc and output status on main thread
   pic_dec->Init(*segment_header, pic_header, std::move(ref_pic_list),
-                user_data);
+                nal->size(), user_data);
 
   // Special handling of inter dependency ref counting for lowest layer
   if (pic_header.tid == 0) {
@@ -340,6 +364,9 @@ bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
     return false;
   }
 
+  // Waiting and output conversion is accounted to the output picture
+  XVC_PERF_STATS_SCOPE(pic_dec->GetPerfStats());
+
   // Wait for picture to finish decoding
   if (thread_decoder_) {
     thread_decoder_->WaitForPicture(
@@ -350,11 +377,14 @@ bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
   }
 
   pic_dec->SetOutputStatus(OutputStatus::kHasBeenOutput);
-  SetOutputStats(pic_dec, output_pic);
   auto decoded_pic = pic_dec->GetRecPic();
-  decoded_pic->CopyTo(&output_pic_bytes_, output_width_, output_height_,
-                      output_chroma_format_, output_bitdepth_,
-                      output_color_matrix_);
+  {
+    XVC_PERF_TIMER(kOutputConversion);
+    decoded_pic->CopyTo(&output_pic_bytes_, output_width_, output_height_,
+                        output_chroma_format_, output_bitdepth_,
+                        output_color_matrix_);
+  }
+  SetOutputStats(pic_dec, output_pic);
   const int sample_size = output_bitdepth_ == 8 ? 1 : 2;
   output_pic->size = output_pic_bytes_.size();
   output_pic->bytes = output_pic_bytes_.empty() ? nullptr :
@@ -388,7 +418,8 @@ Decoder::GetFreePictureDecoder(const SegmentHeader &segment) {
       std::make_shared<PictureDecoder>(simd_, segment.chroma_format,
                                        segment.GetInternalWidth(),
                                        segment.GetInternalHeight(),
-                                       segment.internal_bitdepth);
+                                       segment.internal_bitdepth,
+                                       cu_storage_pool_);
     pic_decoders_.push_back(pic);
     return pic;
   }
@@ -423,7 +454,8 @@ Decoder::GetFreePictureDecoder(const SegmentHeader &segment) {
     pic_dec_it->reset(new PictureDecoder(simd_, segment.chroma_format,
                                          segment.GetInternalWidth(),
                                          segment.GetInternalHeight(),
-                                         segment.internal_bitdepth));
+                                         segment.internal_bitdepth,
+                                         cu_storage_pool_));
   }
   return *pic_dec_it;
 }
@@ -473,6 +505,34 @@ void Decoder::SetOutputStats(std::shared_ptr<PictureDecoder> pic_dec,
   output_pic->stats.qp = pic_data->GetPicQp()->GetQpRaw(YuvComponent::kY);
   output_pic->stats.conforming = pic_dec->GetIsConforming() ? 1 : 0;
 
+  // Decoding cost
+  const PictureDecoder::DecodeStats &decode_stats = pic_dec->GetDecodeStats();
+  output_pic->stats.decode_time_ms = decode_stats.wall_time_ms;
+  output_pic->stats.cpu_time_ms = decode_stats.cpu_time_ms;
+  output_pic->stats.queue_wait_ms = decode_stats.queue_wait_ms;
+  output_pic->stats.nal_bytes = static_cast<uint32_t>(decode_stats.nal_bytes);
+  static_assert(sizeof(output_pic->stats.num_cus_by_size) ==
+                sizeof(decode_stats.cu.num_cus_by_size),
+                "Size class mismatch");
+  for (int i = 0; i < CuDecodeStats::kNumSizeClasses; i++) {
+    output_pic->stats.num_cus_by_size[i] = decode_stats.cu.num_cus_by_size[i];
+  }
+  output_pic->stats.num_intra_cus = decode_stats.cu.num_intra;
+  output_pic->stats.num_inter_cus = decode_stats.cu.num_inter;
+  output_pic->stats.num_merge_cus = decode_stats.cu.num_merge;
+  output_pic->stats.num_skip_cus = decode_stats.cu.num_skip;
+
+  // Time spent per stage, only measured when built with tracing enabled.
+  static const std::array<PerfStage, XVC_DEC_STAGE_TOTAL_NUMBER> kStages = { {
+    PerfStage::kEntropyDecode, PerfStage::kDecodeCtu, PerfStage::kDeblock,
+    PerfStage::kPadBorder, PerfStage::kChecksum, PerfStage::kOutputConversion,
+    PerfStage::kThreadWait,
+  } };
+  for (int i = 0; i < XVC_DEC_STAGE_TOTAL_NUMBER; i++) {
+    output_pic->stats.stage_time_us[i] =
+      pic_dec->GetPerfStats()->GetMicroseconds(kStages[i]);
+  }
+
   // Expose the first five reference pictures in L0 and L1.
   ReferencePictureLists* rpl = pic_data->GetRefPicLists();
   int length = sizeof(output_pic->stats.l0) / sizeof(output_pic->stats.l0[0]);
@@ -30,6 +30,7 @@
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/tile_thread_pool.h"
 #include "xvc_dec_lib/bit_reader.h"
 #include "xvc_dec_lib/picture_decoder.h"
 #include "xvc_dec_lib/xvcdec.h"
@@ -39,6 +40,7 @@ struct xvc_decoder {};
 namespace xvc {
 
 // To avoid including all thread related system headers
+class AsyncDecoder;
 class ThreadDecoder;
 
 class Decoder : public xvc_decoder {
@@ -60,7 +62,7 @@ public:
   void FlushBufferedNalUnits();
   PicNum GetNumDecodedPics() { return num_pics_in_buffer_; }
   PicNum HasPictureReadyForOutput() {
-    return !enforce_sliding_window_ ||
+    return !enforce_sliding_window_ || low_delay_output_ ||
       num_pics_in_buffer_ >= sliding_window_length_;
   }
   PicNum GetNumCorruptedPics() { return num_corrupted_pics_; }
@@ -77,6 +79,14 @@ public:
   }
   void SetOutputBitdepth(int bitdepth) { output_bitdepth_ = bitdepth; }
   void SetDecoderTicks(int ticks) { decoder_ticks_ = ticks; }
+  // Output pictures directly after decoding for streams without reordering
+  void SetLowDelay(bool low_delay) { low_delay_ = low_delay; }
+  void SetAsyncQueueSizes(int input_queue_size, int output_queue_size) {
+    async_input_queue_size_ = input_queue_size;
+    async_output_queue_size_ = output_queue_size;
+  }
+  AsyncDecoder* GetAsyncDecoder();
+  bool IsAsync() const { return async_decoder_ != nullptr; }
   State GetState() { return state_; }
   xvc_dec_chroma_format getChromaFormatApiStyle() {
     return xvc_dec_chroma_format(curr_segment_header_->chroma_format);
@@ -114,14 +124,26 @@ private:
   int output_bitdepth_ = 0;
   int decoder_ticks_ = 0;
   int max_tid_ = 0;
+  int num_threads_ = 0;
+  int async_input_queue_size_ = 0;
+  int async_output_queue_size_ = 0;
   bool enforce_sliding_window_ = true;
+  bool low_delay_ = false;
+  bool low_delay_output_ = false;
   State state_ = State::kNoSegmentHeader;
   SimdFunctions simd_;
   std::vector<uint8_t> output_pic_bytes_;
   std::vector<std::shared_ptr<PictureDecoder>> pic_decoders_;
   std::list<std::shared_ptr<PictureDecoder>> zero_tid_pic_dec_;
+  // Cu objects of decoded pictures, handed over to the next picture to decode
+  std::shared_ptr<PictureData::CuStoragePool> cu_storage_pool_ =
+    std::make_shared<PictureData::CuStoragePool>();
   std::deque<std::pair<NalUnitPtr, int64_t>> nal_buffer_;
+  // Shared by all picture decoders, created for the first stream with tiles
+  std::unique_ptr<TileThreadPool> tile_thread_pool_;
   std::unique_ptr<ThreadDecoder> thread_decoder_;
+  // Declared last so that the decoding thread is stopped first
+  std::unique_ptr<AsyncDecoder> async_decoder_;
 };
 
 }   // namespace xvc
@@ -0,0 +1,146 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_dec_lib/nal_stream_reader.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace xvc {
+
+std::unique_ptr<NalStreamReader>
+NalStreamReader::OpenMapped(const std::string &filename) {
+  std::unique_ptr<MappedNalStreamReader> reader(new MappedNalStreamReader());
+  if (!reader->Open(filename)) {
+    return nullptr;
+  }
+  return std::unique_ptr<NalStreamReader>(reader.release());
+}
+
+static size_t ReadFromStream(std::istream *input, uint8_t *buffer,
+                             size_t size) {
+  input->read(reinterpret_cast<char*>(buffer), size);
+  return static_cast<size_t>(input->gcount());
+}
+
+std::unique_ptr<NalStreamReader>
+NalStreamReader::OpenStream(std::istream *input, size_t chunk_size) {
+  auto read_func = [input](uint8_t *buffer, size_t size) -> size_t {
+    return ReadFromStream(input, buffer, size);
+  };
+  return std::unique_ptr<NalStreamReader>(
+    new BufferedNalStreamReader(read_func, chunk_size));
+}
+
+std::unique_ptr<NalStreamReader>
+NalStreamReader::OpenFile(const std::string &filename) {
+  if (MappedFile::IsRegularFile(filename)) {
+    return OpenMapped(filename);
+  }
+  // Owned by the read function
+  std::shared_ptr<std::ifstream> input =
+    std::make_shared<std::ifstream>(filename, std::ifstream::binary);
+  if (!*input) {
+    return nullptr;
+  }
+  auto read_func = [input](uint8_t *buffer, size_t size) -> size_t {
+    return ReadFromStream(input.get(), buffer, size);
+  };
+  return std::unique_ptr<NalStreamReader>(
+    new BufferedNalStreamReader(read_func, kDefaultChunkSize));
+}
+
+bool MappedNalStreamReader::Open(const std::string &filename) {
+  if (!file_.Open(filename)) {
+    return false;
+  }
+  data_ = file_.GetData();
+  size_ = file_.GetSize();
+  return true;
+}
+
+bool MappedNalStreamReader::ReadNal(const uint8_t **nal, size_t *nal_size) {
+  if (size_ - position_ < kNalSizeBytes) {
+    truncated_ = position_ != size_;
+    return false;
+  }
+  size_t size = ParseNalSize(data_ + position_);
+  if (size_ - position_ - kNalSizeBytes < size) {
+    truncated_ = true;
+    return false;
+  }
+  *nal = data_ + position_ + kNalSizeBytes;
+  *nal_size = size;
+  position_ += kNalSizeBytes + size;
+  return true;
+}
+
+bool MappedNalStreamReader::Rewind() {
+  position_ = 0;
+  truncated_ = false;
+  return true;
+}
+
+BufferedNalStreamReader::BufferedNalStreamReader(ReadFunction read_func,
+                                                 size_t chunk_size)
+  : read_func_(read_func),
+  chunk_size_(chunk_size > 0 ? chunk_size : kDefaultChunkSize),
+  buffer_(2 * chunk_size_) {
+}
+
+bool BufferedNalStreamReader::ReadNal(const uint8_t **nal, size_t *nal_size) {
+  if (!Fill(kNalSizeBytes)) {
+    truncated_ = write_pos_ != read_pos_;
+    return false;
+  }
+  size_t size = ParseNalSize(&buffer_[read_pos_]);
+  if (!Fill(kNalSizeBytes + size)) {
+    truncated_ = true;
+    return false;
+  }
+  *nal = &buffer_[read_pos_ + kNalSizeBytes];
+  *nal_size = size;
+  read_pos_ += kNalSizeBytes + size;
+  return true;
+}
+
+bool BufferedNalStreamReader::Fill(size_t num_bytes) {
+  while (write_pos_ - read_pos_ < num_bytes) {
+    if (buffer_.size() - read_pos_ < num_bytes ||
+        buffer_.size() - write_pos_ < chunk_size_) {
+      // Wrap around by moving the remaining bytes to the beginning
+      const size_t remaining = write_pos_ - read_pos_;
+      if (remaining > 0 && read_pos_ > 0) {
+        std::memmove(&buffer_[0], &buffer_[read_pos_], remaining);
+      }
+      read_pos_ = 0;
+      write_pos_ = remaining;
+      if (buffer_.size() < num_bytes + chunk_size_) {
+        buffer_.resize(num_bytes + chunk_size_);
+      }
+    }
+    size_t bytes_read = read_func_(&buffer_[write_pos_], chunk_size_);
+    if (bytes_read == 0) {
+      return false;
+    }
+    write_pos_ += bytes_read;
+  }
+  return true;
+}
+
+}   // namespace xvc
@@ -0,0 +1,112 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_DEC_LIB_NAL_STREAM_READER_H_
+#define XVC_DEC_LIB_NAL_STREAM_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xvc_common_lib/mapped_file.h"
+
+namespace xvc {
+
+// Splits a bitstream in the xvc file format, where each nal unit is prefixed
+// by its size as a 4 byte little endian value, into nal units. The nal units
+// are returned as spans into internal storage that can be passed directly to
+// decoder_decode_nal without an intermediate copy.
+class NalStreamReader {
+public:
+  static const size_t kNalSizeBytes = 4;
+  static const size_t kDefaultChunkSize = 1 << 20;
+
+  virtual ~NalStreamReader() {}
+  // Returns the next nal unit, valid until the next call to ReadNal or
+  // Rewind. Returns false at end of stream or if the stream is truncated.
+  virtual bool ReadNal(const uint8_t **nal, size_t *nal_size) = 0;
+  // Restarts reading from the first nal unit, returns false if the
+  // underlying input can not be rewound.
+  virtual bool Rewind() = 0;
+  bool IsTruncated() const { return truncated_; }
+
+  // Memory maps the whole file, returns nullptr if the file can not be opened
+  static std::unique_ptr<NalStreamReader>
+    OpenMapped(const std::string &filename);
+  // Reads the input in large chunks, suitable for pipes and sockets
+  static std::unique_ptr<NalStreamReader>
+    OpenStream(std::istream *input, size_t chunk_size = kDefaultChunkSize);
+  // Memory maps regular files and reads other files, such as named pipes or
+  // /dev/stdin, as a stream. Returns nullptr if the file can not be opened.
+  static std::unique_ptr<NalStreamReader>
+    OpenFile(const std::string &filename);
+
+protected:
+  static size_t ParseNalSize(const uint8_t *bytes) {
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+      (static_cast<size_t>(bytes[3]) << 24);
+  }
+  bool truncated_ = false;
+};
+
+// Hands out nal units straight from a read-only memory mapping of a file.
+class MappedNalStreamReader : public NalStreamReader {
+public:
+  bool Open(const std::string &filename);
+  bool ReadNal(const uint8_t **nal, size_t *nal_size) override;
+  bool Rewind() override;
+
+private:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  size_t position_ = 0;
+  MappedFile file_;
+};
+
+// Reads from a sequential input (pipe, socket or stream) in large chunks.
+// Bytes are consumed from a buffer that wraps back to its beginning when the
+// end is reached, only the partially received nal unit is moved when
+// wrapping. The buffer grows when a nal unit is larger than the buffer.
+class BufferedNalStreamReader : public NalStreamReader {
+public:
+  // Fills the buffer with at most size bytes, returns 0 at end of input
+  using ReadFunction = std::function<size_t(uint8_t *buffer, size_t size)>;
+
+  explicit BufferedNalStreamReader(ReadFunction read_func,
+                                   size_t chunk_size = kDefaultChunkSize);
+  bool ReadNal(const uint8_t **nal, size_t *nal_size) override;
+  bool Rewind() override { return false; }
+
+private:
+  bool Fill(size_t num_bytes);
+
+  ReadFunction read_func_;
+  const size_t chunk_size_;
+  std::vector<uint8_t> buffer_;
+  size_t read_pos_ = 0;
+  size_t write_pos_ = 0;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_DEC_LIB_NAL_STREAM_READER_H_
@@ -19,8 +19,10 @@
 #include "xvc_dec_lib/picture_decoder.h"
 
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <memory>
+#include <thread>     // NOLINT
 #include <utility>
 
 #include "xvc_common_lib/deblocking_filter.h"
@@ -28,6 +30,7 @@
 #include "xvc_common_lib/resample.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/utils.h"
 #include "xvc_dec_lib/cu_decoder.h"
 #include "xvc_dec_lib/entropy_decoder.h"
 
@@ -35,10 +38,12 @@ namespace xvc {
 
 PictureDecoder::PictureDecoder(const SimdFunctions &simd,
                                ChromaFormat chroma_format, int width,
-                               int height, int bitdepth)
+                               int height, int bitdepth,
+                               std::shared_ptr<PictureData::CuStoragePool>
+                               cu_storage_pool)
   : simd_(simd),
   pic_data_(std::make_shared<PictureData>(chroma_format, width, height,
-                                          bitdepth)),
+                                          bitdepth, cu_storage_pool)),
   rec_pic_(std::make_shared<YuvPicture>(chroma_format, width, height,
                                         bitdepth, true)) {
 }
@@ -117,10 +122,12 @@ PictureDecoder::DecodeHeader(BitReader *bit_reader, PicNum *sub_gop_end_poc,
 void PictureDecoder::Init(const SegmentHeader &segment,
                           const PicNalHeader &header,
                           ReferencePictureLists &&ref_pic_list,
-                          int64_t user_data) {
+                          size_t nal_size, int64_t user_data) {
   assert(output_status_ == OutputStatus::kHasBeenOutput);
   pic_qp_ = header.pic_qp;
   user_data_ = user_data;
+  decode_stats_ = DecodeStats();
+  decode_stats_.nal_bytes = nal_size;
   output_status_ = OutputStatus::kProcessing;
   ref_count = 0;
   pic_data_->SetNalType(header.nal_unit_type);
@@ -139,40 +146,116 @@ void PictureDecoder::Init(const SegmentHeader &segment,
 bool PictureDecoder::Decode(const SegmentHeader &segment,
                             BitReader *bit_reader) {
   assert(output_status_ == OutputStatus::kProcessing);
+  perf_stats_.Clear();
+  XVC_PERF_STATS_SCOPE(&perf_stats_);
+  const auto start_time = std::chrono::steady_clock::now();
+  const int64_t start_cpu_time = util::GetThreadCpuTime();
   bool success = true;
+  int64_t cpu_time_tiles = 0;
   double lambda = 0;
   Qp qp(pic_qp_, pic_data_->GetChromaFormat(), pic_data_->GetBitdepth(),
         lambda);
 
   pic_data_->Init(segment, qp, true);
 
-  EntropyDecoder entropy_decoder(bit_reader);
-  entropy_decoder.Start();
-  SyntaxReader syntax_reader(qp, pic_data_->GetPredictionType(),
-                             &entropy_decoder);
-  std::unique_ptr<CuDecoder> cu_decoder(
-    new CuDecoder(simd_, qp, rec_pic_.get(), pic_data_.get()));
-  int num_ctus = pic_data_->GetNumberOfCtu();
-  for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
-    cu_decoder->DecodeCtu(rsaddr, &syntax_reader);
+  const int num_tiles = pic_data_->GetNumTiles();
+  if (num_tiles == 1) {
+    success &= DecodeTile(0, qp, bit_reader, &decode_stats_.cu);
+  } else {
+    // Entry points give the size in bytes of all but the last tile,
+    // the last tile is decoded directly from bit_reader
+    std::vector<size_t> tile_sizes;
+    for (int tile = 0; tile < num_tiles - 1; tile++) {
+      size_t tile_size = static_cast<size_t>(bit_reader->ReadBits(16)) << 16;
+      tile_size |= bit_reader->ReadBits(16);
+      tile_sizes.push_back(tile_size);
+    }
+    std::vector<BitReader> tile_readers;
+    for (size_t tile_size : tile_sizes) {
+      tile_readers.push_back(bit_reader->SplitBytes(tile_size));
+    }
+    std::vector<CuDecodeStats> tile_stats(num_tiles);
+    std::vector<int> tile_success(num_tiles, 0);
+    std::vector<int64_t> tile_cpu_time(num_tiles, 0);
+    const Restrictions restrictions = Restrictions::Get();
+    const std::thread::id decoding_thread = std::this_thread::get_id();
+    auto decode_tile = [&](int tile) {
+      Restrictions::GetRW() = restrictions;
+      XVC_PERF_STATS_SCOPE(&perf_stats_);
+      const int64_t tile_start_cpu_time = util::GetThreadCpuTime();
+      BitReader *tile_reader =
+        tile == num_tiles - 1 ? bit_reader : &tile_readers[tile];
+      tile_success[tile] =
+        DecodeTile(tile, qp, tile_reader, &tile_stats[tile]);
+      // Time of this thread is already counted for the picture
+      if (std::this_thread::get_id() != decoding_thread) {
+        tile_cpu_time[tile] = util::GetThreadCpuTime() - tile_start_cpu_time;
+      }
+    };
+    if (tile_thread_pool_) {
+      tile_thread_pool_->Run(num_tiles, decode_tile);
+    } else {
+      for (int tile = 0; tile < num_tiles; tile++) {
+        decode_tile(tile);
+      }
+    }
+    for (int tile = 0; tile < num_tiles; tile++) {
+      success &= tile_success[tile] != 0;
+    }
+    for (int tile = 0; tile < num_tiles; tile++) {
+      decode_stats_.cu.Add(tile_stats[tile]);
+    }
+    for (int64_t cpu_time : tile_cpu_time) {
+      cpu_time_tiles += cpu_time;
+    }
   }
+  pic_data_->StoreTemporalMvField();
   if (pic_data_->GetDeblock()) {
+    XVC_PERF_TIMER(kDeblock);
     DeblockingFilter deblocker(pic_data_.get(), rec_pic_.get(),
                                pic_data_->GetBetaOffset(),
                                pic_data_->GetTcOffset());
     deblocker.DeblockPicture();
   }
-  if (!entropy_decoder.DecodeBinTrm()) {
-    assert(0);
-    success = false;
-  }
-  entropy_decoder.Finish();
+  // Later pictures only read the temporal mv field
+  pic_data_->ReleaseCus();
   int pic_tid = pic_data_->GetTid();
-  rec_pic_->PadBorder();
+  {
+    XVC_PERF_TIMER(kPadBorder);
+    rec_pic_->PadBorder();
+  }
   pic_data_->GetRefPicLists()->ZeroOutReferences();
   if (pic_tid == 0 || segment.checksum_mode == Checksum::Mode::kMaxRobust) {
+    XVC_PERF_TIMER(kChecksum);
     success &= ValidateChecksum(bit_reader, segment.checksum_mode);
   }
+  decode_stats_.wall_time_ms =
+    std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start_time).count();
+  decode_stats_.cpu_time_ms =
+    (util::GetThreadCpuTime() - start_cpu_time + cpu_time_tiles) / 1000000.0;
+  return success;
+}
+
+bool PictureDecoder::DecodeTile(int tile_idx, const Qp &qp,
+                                BitReader *bit_reader,
+                                CuDecodeStats *cu_stats) {
+  // Each tile is coded as a separate cabac stream
+  EntropyDecoder entropy_decoder(bit_reader);
+  entropy_decoder.Start();
+  SyntaxReader syntax_reader(qp, pic_data_->GetPredictionType(),
+                             &entropy_decoder);
+  std::unique_ptr<CuDecoder> cu_decoder(
+    new CuDecoder(simd_, qp, rec_pic_.get(), pic_data_.get(), cu_stats));
+  for (int rsaddr : pic_data_->GetTileCtus(tile_idx)) {
+    cu_decoder->DecodeCtu(rsaddr, &syntax_reader);
+  }
+  bool success = true;
+  if (!entropy_decoder.DecodeBinTrm()) {
+    assert(0);
+    success = false;
+  }
+  entropy_decoder.Finish();
   return success;
 }
 
@@ -25,11 +25,14 @@
 
 #include "xvc_common_lib/checksum.h"
 #include "xvc_common_lib/common.h"
+#include "xvc_common_lib/perf_trace.h"
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/tile_thread_pool.h"
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_dec_lib/bit_reader.h"
+#include "xvc_dec_lib/cu_decoder.h"
 #include "xvc_dec_lib/syntax_reader.h"
 #include "xvc_dec_lib/xvcdec.h"
 
@@ -46,12 +49,26 @@ public:
     int pic_qp;
     bool highest_layer;
   };
+  // Decoding cost of one picture
+  struct DecodeStats {
+    double wall_time_ms = 0;
+    double cpu_time_ms = 0;
+    double queue_wait_ms = 0;
+    size_t nal_bytes = 0;
+    CuDecodeStats cu;
+  };
 
   PictureDecoder(const SimdFunctions &simd, ChromaFormat chroma_format,
-                 int width, int height, int bitdepth);
+                 int width, int height, int bitdepth,
+                 std::shared_ptr<PictureData::CuStoragePool> cu_storage_pool =
+                 nullptr);
   void Init(const SegmentHeader &segment, const PicNalHeader &header,
-            ReferencePictureLists &&ref_pic_list, int64_t user_data);
+            ReferencePictureLists &&ref_pic_list, size_t nal_size,
+            int64_t user_data);
   bool Decode(const SegmentHeader &segment, BitReader *bit_reader);
+  void SetTileThreadPool(TileThreadPool *tile_thread_pool) {
+    tile_thread_pool_ = tile_thread_pool;
+  }
   std::shared_ptr<const PictureData> GetPicData() const { return pic_data_; }
   std::shared_ptr<PictureData> GetPicData() { return pic_data_; }
   std::shared_ptr<const YuvPicture> GetRecPic() const { return rec_pic_; }
@@ -61,6 +78,9 @@ public:
   OutputStatus GetOutputStatus() const { return output_status_; }
   void SetIsConforming(bool conforming) { conforming_ = conforming; }
   bool GetIsConforming() const { return conforming_; }
+  PerfStats* GetPerfStats() { return &perf_stats_; }
+  const DecodeStats& GetDecodeStats() const { return decode_stats_; }
+  void SetQueueWaitTime(double ms) { decode_stats_.queue_wait_ms = ms; }
   bool IsReferenced() const { return ref_count > 0; }
   void AddReferenceCount(int val) const { ref_count += val; }
   void RemoveReferenceCount(int val) const { ref_count -= val; }
@@ -74,13 +94,18 @@ public:
                  PicNum doc, SegmentNum soc, int num_buffered_nals);
 
 private:
+  bool DecodeTile(int tile_idx, const Qp &qp, BitReader *bit_reader,
+                  CuDecodeStats *cu_stats);
   bool ValidateChecksum(BitReader *bit_reader, Checksum::Mode checksum_mode);
 
   const SimdFunctions &simd_;
   std::shared_ptr<PictureData> pic_data_;
   std::shared_ptr<YuvPicture> rec_pic_;
   std::shared_ptr<YuvPicture> alt_rec_pic_;
+  TileThreadPool *tile_thread_pool_ = nullptr;
   Checksum checksum_;
+  PerfStats perf_stats_;
+  DecodeStats decode_stats_;
   bool conforming_ = false;
   int pic_qp_ = -1;
   int64_t user_data_ = 0;
@@ -289,6 +289,18 @@ Decoder::State SegmentHeaderReader::Read(SegmentHeader* segment_header,
     }
   }
 
+  segment_header->num_tile_columns = 1;
+  segment_header->num_tile_rows = 1;
+  if (segment_header->minor_version >= constants::kTilesMinorVersion &&
+      segment_header->major_version == constants::kXvcMajorVersion) {
+    int tiles = bit_reader->ReadBit();
+    if (tiles) {
+      int d = constants::kTileSizeBits;
+      segment_header->num_tile_columns = bit_reader->ReadBits(d) + 1;
+      segment_header->num_tile_rows = bit_reader->ReadBits(d) + 1;
+    }
+  }
+
   Restrictions::GetRW() = restr;
 
   segment_header->soc = segment_counter;
@@ -142,6 +142,7 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
   }
 
   int c1 = 1;
+  ContextModel *sig_ctx_base = ctx_.GetCoeffSigCtxBase(comp);
 
   // foreach subblock
   for (int subblock_index = subblock_last_index; subblock_index >= 0;
@@ -176,6 +177,11 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
     if (!subblock_csbf[subblock_scan]) {
       continue;
     }
+    // Contexts of 2x2 subblocks are derived per coefficient
+    const uint8_t *sig_ctx_idx = SubBlockShift == 1 ? nullptr :
+      ctx_.GetCoeffSigCtxIdx(comp, pattern_sig_ctx, scan_order,
+                             subblock_pos_x == 0 && subblock_pos_y == 0,
+                             width_log2, height_log2);
 
     // sig flags
     for (int coeff_index = subblock_size - subblock_last_coeff_offset;
@@ -189,9 +195,10 @@ void SyntaxReader::ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
       if (coeff_index == 0 && not_first_subblock && coeff_num_non_zero == 0) {
         sig_coeff = true;
       } else {
-        ContextModel &ctx =
+        ContextModel &ctx = SubBlockShift == 1 ?
           ctx_.GetCoeffSigCtx(comp, pattern_sig_ctx, scan_order, coeff_scan_x,
-                              coeff_scan_y, width_log2, height_log2);
+                              coeff_scan_y, width_log2, height_log2) :
+          sig_ctx_base[sig_ctx_idx[coeff_index]];
         sig_coeff = entropydec_->DecodeBin(&ctx) != 0;
       }
       if (sig_coeff) {
@@ -537,10 +544,13 @@ void SyntaxReader::ReadCoeffLastPos(int width, int height, YuvComponent comp,
   }
   uint32_t group_idx_x = TransformHelper::kLastPosGroupIdx[width - 1];
   uint32_t group_idx_y = TransformHelper::kLastPosGroupIdx[height - 1];
+  ContextModel *ctx_base_x = ctx_.GetCoeffLastPosCtxBase(comp, true);
+  ContextModel *ctx_base_y = ctx_.GetCoeffLastPosCtxBase(comp, false);
+  const uint8_t *ctx_idx_x = ctx_.GetCoeffLastPosCtxIdx(comp, width);
+  const uint8_t *ctx_idx_y = ctx_.GetCoeffLastPosCtxIdx(comp, height);
   uint32_t pos_last_x = 0;
   for (; pos_last_x < group_idx_x; pos_last_x++) {
-    ContextModel &ctx = ctx_.GetCoeffLastPosCtx(comp, width, height,
-                                                pos_last_x, true);
+    ContextModel &ctx = ctx_base_x[ctx_idx_x[pos_last_x]];
     uint32_t has_more = entropydec_->DecodeBin(&ctx);
     if (!has_more) {
       break;
@@ -548,8 +558,7 @@ void SyntaxReader::ReadCoeffLastPos(int width, int height, YuvComponent comp,
   }
   uint32_t pos_last_y = 0;
   for (; pos_last_y < group_idx_y; pos_last_y++) {
-    ContextModel &ctx = ctx_.GetCoeffLastPosCtx(comp, width, height,
-                                                pos_last_y, false);
+    ContextModel &ctx = ctx_base_y[ctx_idx_y[pos_last_y]];
     uint32_t has_more = entropydec_->DecodeBin(&ctx);
     if (!has_more) {
       break;
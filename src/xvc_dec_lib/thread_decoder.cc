@@ -20,6 +20,8 @@
 
 #include <algorithm>
 
+#include "xvc_common_lib/perf_trace.h"
+
 namespace xvc {
 
 ThreadDecoder::ThreadDecoder(int num_threads) {
@@ -62,6 +64,7 @@ void ThreadDecoder::DecodeAsync(
   work.segment_header = std::move(segment_header);
   work.nal_offset = nal_offset;
   work.nal = std::move(nal);
+  work.queued_time = std::chrono::steady_clock::now();
 
   // Signal one worker thread to begin processing
   std::unique_lock<std::mutex> lock(global_mutex_);
@@ -79,7 +82,10 @@ void ThreadDecoder::WaitForPicture(const std::shared_ptr<PictureDecoder> &pic,
 
 void ThreadDecoder::WaitOne(PictureDecodedCallback callback) {
   std::unique_lock<std::mutex> lock(global_mutex_);
-  work_done_cond_.wait(lock, [this] { return !finished_work_.empty(); });
+  {
+    XVC_PERF_TIMER(kThreadWait);
+    work_done_cond_.wait(lock, [this] { return !finished_work_.empty(); });
+  }
   WorkItem work = std::move(finished_work_.front());
   finished_work_.pop_front();
   jobs_in_flight_--;
@@ -90,7 +96,10 @@ void ThreadDecoder::WaitOne(PictureDecodedCallback callback) {
 void ThreadDecoder::WaitAll(PictureDecodedCallback callback) {
   std::unique_lock<std::mutex> lock(global_mutex_);
   while (jobs_in_flight_ > 0) {
-    work_done_cond_.wait(lock, [this] { return !finished_work_.empty(); });
+    {
+      XVC_PERF_TIMER(kThreadWait);
+      work_done_cond_.wait(lock, [this] { return !finished_work_.empty(); });
+    }
     WorkItem work = std::move(finished_work_.front());
     finished_work_.pop_front();
     jobs_in_flight_--;
@@ -100,36 +109,40 @@ void ThreadDecoder::WaitAll(PictureDecodedCallback callback) {
 }
 
 void ThreadDecoder::WorkerMain() {
+  XVC_PERF_THREAD_NAME("decoder worker");
   std::unique_lock<std::mutex> lock(global_mutex_);
   while (true) {
     ThreadDecoder::WorkItem work;
-    // Find one picture that can be decoded now
-    wait_work_cond_.wait(lock, [this, &work] {
-      if (!running_) {
-        return true;
-      }
-      if (pending_work_.empty()) {
-        return false;
-      }
-      // Verify all dependencies are satisfied before taking work
-      auto it = pending_work_.begin();
-      for (; it != pending_work_.end(); ++it) {
-        bool valid = true;
-        for (auto &dependency : it->inter_dependencies) {
-          if (dependency->GetOutputStatus() == OutputStatus::kProcessing) {
-            valid = false;
-            break;
-          }
+    {
+      XVC_PERF_TIMER(kThreadWait);
+      // Find one picture that can be decoded now
+      wait_work_cond_.wait(lock, [this, &work] {
+        if (!running_) {
+          return true;
         }
-        if (!valid) {
-          continue;
+        if (pending_work_.empty()) {
+          return false;
         }
-        work = std::move(*it);
-        pending_work_.erase(it);
-        return true;
-      }
-      return false;
-    });
+        // Verify all dependencies are satisfied before taking work
+        auto it = pending_work_.begin();
+        for (; it != pending_work_.end(); ++it) {
+          bool valid = true;
+          for (auto &dependency : it->inter_dependencies) {
+            if (dependency->GetOutputStatus() == OutputStatus::kProcessing) {
+              valid = false;
+              break;
+            }
+          }
+          if (!valid) {
+            continue;
+          }
+          work = std::move(*it);
+          pending_work_.erase(it);
+          return true;
+        }
+        return false;
+      });
+    }
     if (!running_) {
       break;
     }
@@ -143,6 +156,9 @@ void ThreadDecoder::WorkerMain() {
     }
 
     // Decode picture
+    work.pic_dec->SetQueueWaitTime(
+      std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - work.queued_time).count());
     BitReader bit_reader(&(*work.nal)[0] + work.nal_offset,
                          work.nal->size() - work.nal_offset);
     work.success = work.pic_dec->Decode(*work.segment_header, &bit_reader);
@@ -20,6 +20,7 @@
 #define XVC_DEC_LIB_THREAD_DECODER_H_
 
 // Some C++11 headers are not allowed by cpplint
+#include <chrono>               // NOLINT
 #include <condition_variable>   // NOLINT
 #include <deque>
 #include <functional>
@@ -60,8 +61,9 @@ private:
     std::vector<std::shared_ptr<const PictureDecoder>> inter_dependencies;
     std::shared_ptr<SegmentHeader> segment_header;
     std::unique_ptr<std::vector<uint8_t>> nal;
-    std::size_t nal_offset;
-    bool success;
+    std::size_t nal_offset = 0;
+    std::chrono::steady_clock::time_point queued_time;
+    bool success = false;
   };
   void WorkerMain();
 
@@ -20,6 +20,7 @@
 
 #include <cstring>
 
+#include "xvc_dec_lib/async_decoder.h"
 #include "xvc_dec_lib/decoder.h"
 
 #ifdef __cplusplus
@@ -53,6 +54,9 @@ extern "C" {
     param->max_framerate = xvc::constants::kTimeScale;
     param->threads = -1;
     param->simd_mask = static_cast<uint32_t>(-1);
+    param->async_input_queue_size = 0;
+    param->async_output_queue_size = 0;
+    param->low_delay = 0;
     return XVC_DEC_OK;
   }
 
@@ -94,6 +98,13 @@ extern "C" {
         param->max_framerate > xvc::constants::kTimeScale) {
       return XVC_DEC_FRAMERATE_OUT_OF_RANGE;
     }
+    if (param->async_input_queue_size < 0 ||
+        param->async_output_queue_size < 0) {
+      return XVC_DEC_INVALID_PARAMETER;
+    }
+    if (param->low_delay < 0 || param->low_delay > 1) {
+      return XVC_DEC_INVALID_PARAMETER;
+    }
     return XVC_DEC_OK;
   }
 
@@ -120,6 +131,9 @@ extern "C" {
     decoder->SetOutputBitdepth(param->output_bitdepth);
     decoder->SetDecoderTicks(static_cast<int>(xvc::constants::kTimeScale
                                               / param->max_framerate + 0.5));
+    decoder->SetAsyncQueueSizes(param->async_input_queue_size,
+                                param->async_output_queue_size);
+    decoder->SetLowDelay(param->low_delay != 0);
     return decoder;
   }
 
@@ -138,6 +152,9 @@ extern "C" {
       return XVC_DEC_INVALID_ARGUMENT;
     }
     xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    if (lib_decoder->IsAsync()) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
 
     // Framerate is the only parameter that is updated.
     // Changes in other parameters will be ignored.
@@ -147,15 +164,7 @@ extern "C" {
   }
 
   static xvc_dec_return_code
-    xvc_dec_decoder_decode_nal(xvc_decoder *decoder, const uint8_t *nal_unit,
-                               size_t nal_unit_size, int64_t user_data) {
-    if (!decoder || !nal_unit || nal_unit_size < 1) {
-      return XVC_DEC_INVALID_ARGUMENT;
-    }
-    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
-    lib_decoder->DecodeNal(nal_unit, nal_unit_size, user_data);
-
-    xvc::Decoder::State dec_state = lib_decoder->GetState();
+    xvc_dec_state_to_return_code(xvc::Decoder::State dec_state) {
     if (dec_state == xvc::Decoder::State::kDecoderVersionTooLow) {
       return XVC_DEC_BITSTREAM_VERSION_HIGHER_THAN_DECODER;
     } else if (dec_state == xvc::Decoder::State::kBitstreamBitdepthTooHigh) {
@@ -168,6 +177,20 @@ extern "C" {
     return XVC_DEC_OK;
   }
 
+  static xvc_dec_return_code
+    xvc_dec_decoder_decode_nal(xvc_decoder *decoder, const uint8_t *nal_unit,
+                               size_t nal_unit_size, int64_t user_data) {
+    if (!decoder || !nal_unit || nal_unit_size < 1) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    if (lib_decoder->IsAsync()) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    lib_decoder->DecodeNal(nal_unit, nal_unit_size, user_data);
+    return xvc_dec_state_to_return_code(lib_decoder->GetState());
+  }
+
   static xvc_dec_return_code
     xvc_dec_decoder_get_picture(xvc_decoder *decoder,
                                 xvc_decoded_picture *pic_bytes) {
@@ -175,6 +198,9 @@ extern "C" {
       return XVC_DEC_INVALID_ARGUMENT;
     }
     xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    if (lib_decoder->IsAsync()) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
     if (lib_decoder->GetDecodedPicture(pic_bytes)) {
       return XVC_DEC_OK;
     }
@@ -191,6 +217,9 @@ extern "C" {
       return XVC_DEC_INVALID_ARGUMENT;
     }
     xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    if (lib_decoder->IsAsync()) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
     lib_decoder->FlushBufferedNalUnits();
     return XVC_DEC_OK;
   }
@@ -213,12 +242,70 @@ extern "C" {
     return XVC_DEC_OK;
   }
 
+  static xvc_dec_return_code
+    xvc_dec_decoder_send_nal(xvc_decoder *decoder, const uint8_t *nal_unit,
+                             size_t nal_unit_size, int64_t user_data) {
+    if (!decoder || (nal_unit && nal_unit_size < 1)) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    xvc::AsyncDecoder *async_decoder = lib_decoder->GetAsyncDecoder();
+    xvc::Decoder::State dec_state = async_decoder->GetState();
+    if (dec_state == xvc::Decoder::State::kDecoderVersionTooLow ||
+        dec_state == xvc::Decoder::State::kBitstreamBitdepthTooHigh) {
+      return xvc_dec_state_to_return_code(dec_state);
+    }
+    xvc_dec_return_code ret =
+      async_decoder->SendNal(nal_unit, nal_unit_size, user_data);
+    if (ret != XVC_DEC_OK) {
+      return ret;
+    }
+    if (dec_state == xvc::Decoder::State::kChecksumMismatch) {
+      return XVC_DEC_NOT_CONFORMING;
+    }
+    return XVC_DEC_OK;
+  }
+
+  static xvc_dec_return_code
+    xvc_dec_decoder_receive_picture(xvc_decoder *decoder,
+                                    xvc_decoded_picture *out_pic, int wait) {
+    if (!decoder || !out_pic) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    return lib_decoder->GetAsyncDecoder()->ReceivePicture(out_pic, wait != 0);
+  }
+
+  static xvc_dec_return_code
+    xvc_dec_decoder_set_picture_callback(xvc_decoder *decoder,
+                                         xvc_dec_picture_callback callback,
+                                         void *opaque) {
+    if (!decoder) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    return lib_decoder->GetAsyncDecoder()->SetPictureCallback(callback,
+                                                              opaque);
+  }
+
+  static int xvc_dec_decoder_get_event_fd(xvc_decoder *decoder) {
+    if (!decoder) {
+      return -1;
+    }
+    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    return lib_decoder->GetAsyncDecoder()->GetEventFd();
+  }
+
   static const char* xvc_dec_get_error_text(xvc_dec_return_code error_code) {
     switch (error_code) {
       case  XVC_DEC_OK:
         return "";
       case XVC_DEC_NO_DECODED_PIC:
         return "No decoded picture";
+      case XVC_DEC_QUEUE_FULL:
+        return "Decoder input queue is full";
+      case XVC_DEC_END_OF_STREAM:
+        return "End of stream";
       case XVC_DEC_NOT_CONFORMING:
         return "Non-conforming bitstream";
       case XVC_DEC_INVALID_ARGUMENT:
@@ -260,6 +347,10 @@ extern "C" {
     &xvc_dec_decoder_flush,
     &xvc_dec_decoder_check_conformance,
     &xvc_dec_get_error_text,
+    &xvc_dec_decoder_send_nal,
+    &xvc_dec_decoder_receive_picture,
+    &xvc_dec_decoder_set_picture_callback,
+    &xvc_dec_decoder_get_event_fd,
   };
 
   const xvc_decoder_api* xvc_decoder_api_get() {
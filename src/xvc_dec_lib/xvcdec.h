@@ -42,6 +42,8 @@ extern "C" {
   typedef enum {
     XVC_DEC_OK = 0,
     XVC_DEC_NO_DECODED_PIC = 1,
+    XVC_DEC_QUEUE_FULL = 2,
+    XVC_DEC_END_OF_STREAM = 3,
     XVC_DEC_NOT_CONFORMING = 10,
     XVC_DEC_INVALID_ARGUMENT = 20,
     XVC_DEC_INVALID_PARAMETER = 30,
@@ -68,6 +70,18 @@ extern "C" {
     XVC_DEC_COLOR_MATRIX_2020 = 3,
   } xvc_dec_color_matrix;
 
+  // Processing stages measured per decoded picture
+  typedef enum {
+    XVC_DEC_STAGE_ENTROPY_DECODE = 0,
+    XVC_DEC_STAGE_DECODE_CTU = 1,
+    XVC_DEC_STAGE_DEBLOCK = 2,
+    XVC_DEC_STAGE_PAD_BORDER = 3,
+    XVC_DEC_STAGE_CHECKSUM = 4,
+    XVC_DEC_STAGE_OUTPUT_CONVERSION = 5,
+    XVC_DEC_STAGE_THREAD_WAIT = 6,
+    XVC_DEC_STAGE_TOTAL_NUMBER = 7,
+  } xvc_dec_stage;
+
   // Decoded picture statistics
   // Lifecycle managed by xvc_decoded_picture
   typedef struct xvc_dec_pic_stats {
@@ -88,6 +102,22 @@ extern "C" {
     double framerate;
     double bitstream_framerate;
     int32_t conforming;
+    // Decoding cost, wall and cpu time are measured on the decoding thread
+    // and queue wait is the time spent waiting for a free decoding thread
+    double decode_time_ms;
+    double cpu_time_ms;
+    double queue_wait_ms;
+    uint32_t nal_bytes;
+    // Number of coding units (luma tree) with the largest dimension
+    // equal to 4, 8, 16, 32, 64 and 128 samples
+    uint32_t num_cus_by_size[6];
+    uint32_t num_intra_cus;
+    uint32_t num_inter_cus;   // excluding merge and skip
+    uint32_t num_merge_cus;   // excluding skip
+    uint32_t num_skip_cus;
+    // Time in microseconds spent per stage (indexed by xvc_dec_stage), only
+    // measured when the library is built with tracing enabled
+    uint32_t stage_time_us[XVC_DEC_STAGE_TOTAL_NUMBER];
   } xvc_dec_pic_stats;
 
   // Represents a decoded picture
@@ -101,6 +131,12 @@ extern "C" {
     int64_t user_data;  //
   } xvc_decoded_picture;
 
+  // Called from the decoder thread for each decoded picture in output order,
+  // the picture is only valid during the call. A null picture signals that
+  // all pictures have been output.
+  typedef void(*xvc_dec_picture_callback)(void *opaque,
+                                          const xvc_decoded_picture *picture);
+
   // xvc decoder instance
   // Lifecycle managed by api->decoder_create & api->decoder_destroy
   typedef struct xvc_decoder xvc_decoder;
@@ -116,6 +152,12 @@ extern "C" {
     double max_framerate;
     int threads;
     uint32_t simd_mask;
+    int async_input_queue_size;   // nal units, 0 = default
+    int async_output_queue_size;  // pictures, 0 = default
+    // 1 = output pictures as soon as they are decoded for streams without
+    // picture reordering (sub_gop_length 1), at the cost of less decoding
+    // in parallel
+    int low_delay;
   } xvc_decoder_parameters;
 
   // xvc decoder api
@@ -151,6 +193,33 @@ extern "C" {
                                                     int *num);
     // Misc
     const char*(*xvc_dec_get_error_text)(xvc_dec_return_code error_code);
+    // Asynchronous decoding on a separate decoder thread, can not be mixed
+    // with decoder_decode_nal, decoder_get_picture and decoder_flush on the
+    // same decoder.
+    // Queues a copy of the nal unit without waiting for it to be decoded.
+    // Returns XVC_DEC_QUEUE_FULL if the input queue is full, or an error
+    // from a previously queued nal unit.
+    // A null nal unit signals end of stream and flushes the decoder.
+    xvc_dec_return_code(*decoder_send_nal)(xvc_decoder *decoder,
+                                           const uint8_t *nal_unit,
+                                           size_t nal_unit_size,
+                                           int64_t user_data);
+    // Returns the next decoded picture in output order, valid until the
+    // next call. Returns XVC_DEC_NO_DECODED_PIC if none is available and
+    // wait is 0, or XVC_DEC_END_OF_STREAM when all pictures have been output.
+    // Note that waiting before end of stream has been signaled will block
+    // forever if the next picture depends on nal units that are not sent.
+    xvc_dec_return_code(*decoder_receive_picture)(xvc_decoder *decoder,
+                                                  xvc_decoded_picture *out_pic,
+                                                  int wait);
+    // Delivers pictures through a callback instead of
+    // decoder_receive_picture, must be set before the first nal unit is sent.
+    xvc_dec_return_code(*decoder_set_picture_callback)(
+      xvc_decoder *decoder, xvc_dec_picture_callback picture_callback,
+      void *opaque);
+    // File descriptor that is readable while decoder_receive_picture has a
+    // picture or end of stream to return, -1 if not supported.
+    int(*decoder_get_event_fd)(xvc_decoder *decoder);
   } xvc_decoder_api;
 
   // Starting point for using the xvc decoder api
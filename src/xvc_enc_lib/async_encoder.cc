@@ -0,0 +1,197 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/async_encoder.h"
+
+#include <utility>
+
+#include "xvc_common_lib/perf_trace.h"
+#include "xvc_enc_lib/encoder.h"
+
+namespace xvc {
+
+AsyncEncoder::AsyncEncoder(Encoder *encoder, int input_queue_size,
+                           int output_queue_size)
+  : encoder_(encoder),
+  input_queue_size_(input_queue_size > 0 ?
+                    input_queue_size : kDefaultInputQueueSize),
+  output_queue_size_(output_queue_size > 0 ?
+                     output_queue_size : kDefaultOutputQueueSize) {
+}
+
+AsyncEncoder::~AsyncEncoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  input_cond_.notify_all();
+  output_cond_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  // Hand back pictures that were never encoded
+  for (auto &picture : input_queue_) {
+    if (picture.release_callback) {
+      picture.release_callback(picture.opaque, &picture.planes);
+    }
+  }
+}
+
+xvc_enc_return_code
+AsyncEncoder::SendPicture(const xvc_enc_pic_planes *picture,
+                          xvc_enc_release_callback release_callback,
+                          void *opaque) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (end_of_input_) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    if (!picture) {
+      end_of_input_ = true;
+    } else if (input_queue_.size() >= input_queue_size_) {
+      return XVC_ENC_QUEUE_FULL;
+    } else {
+      InputPicture input = { *picture, release_callback, opaque };
+      input_queue_.push_back(input);
+    }
+    if (!thread_.joinable()) {
+      Start();
+    }
+  }
+  input_cond_.notify_one();
+  return XVC_ENC_OK;
+}
+
+xvc_enc_return_code AsyncEncoder::ReceiveNal(xvc_enc_nal_unit *nal_unit,
+                                             bool wait) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (nal_callback_) {
+    return XVC_ENC_INVALID_ARGUMENT;
+  }
+  if (wait) {
+    output_cond_.wait(lock, [this]() {
+      return !output_queue_.empty() || end_of_output_;
+    });
+  }
+  if (output_queue_.empty()) {
+    return end_of_output_ ? XVC_ENC_END_OF_STREAM : XVC_ENC_NO_NAL_UNIT;
+  }
+  // Keep the bytes alive until the next call
+  current_nal_ = std::move(output_queue_.front());
+  output_queue_.pop_front();
+  lock.unlock();
+  output_cond_.notify_all();
+  *nal_unit = current_nal_.nal_unit;
+  nal_unit->bytes = current_nal_.bytes.empty() ? nullptr :
+    &current_nal_.bytes[0];
+  return XVC_ENC_OK;
+}
+
+xvc_enc_return_code
+AsyncEncoder::SetNalCallback(xvc_enc_nal_callback nal_callback,
+                             void *opaque) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_.joinable()) {
+    return XVC_ENC_INVALID_ARGUMENT;
+  }
+  nal_callback_ = nal_callback;
+  nal_callback_opaque_ = opaque;
+  return XVC_ENC_OK;
+}
+
+void AsyncEncoder::Start() {
+  thread_ = std::thread(&AsyncEncoder::WorkerMain, this);
+}
+
+void AsyncEncoder::WorkerMain() {
+  XVC_PERF_THREAD_NAME("encoder");
+  // Restriction flags are thread local, load them the same way as
+  // Encoder::SetEncoderSettings does on the calling thread
+  Restrictions restrictions = Restrictions();
+  restrictions.EnableRestrictedMode(
+    encoder_->GetEncoderSettings().restricted_mode);
+  Restrictions::GetRW() = std::move(restrictions);
+  xvc_enc_nal_unit *nal_units = nullptr;
+  int num_nal_units = 0;
+  while (true) {
+    InputPicture picture;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      input_cond_.wait(lock, [this]() {
+        return stop_ || !input_queue_.empty() || end_of_input_;
+      });
+      if (stop_) {
+        return;
+      }
+      if (input_queue_.empty()) {
+        break;
+      }
+      picture = input_queue_.front();
+      input_queue_.pop_front();
+    }
+    num_nal_units = encoder_->Encode(picture.planes.planes,
+                                     picture.planes.stride, &nal_units,
+                                     false, nullptr);
+    // The picture has been copied into the encoder at this point
+    if (picture.release_callback) {
+      picture.release_callback(picture.opaque, &picture.planes);
+    }
+    if (!OutputNals(nal_units, num_nal_units)) {
+      return;
+    }
+  }
+  num_nal_units = encoder_->Flush(&nal_units, false, nullptr);
+  if (!OutputNals(nal_units, num_nal_units)) {
+    return;
+  }
+  if (nal_callback_) {
+    nal_callback_(nal_callback_opaque_, nullptr);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    end_of_output_ = true;
+  }
+  output_cond_.notify_all();
+}
+
+bool AsyncEncoder::OutputNals(const xvc_enc_nal_unit *nal_units,
+                              int num_nal_units) {
+  for (int i = 0; i < num_nal_units; i++) {
+    if (nal_callback_) {
+      nal_callback_(nal_callback_opaque_, &nal_units[i]);
+      continue;
+    }
+    OutputNal output;
+    output.nal_unit = nal_units[i];
+    output.bytes.assign(nal_units[i].bytes,
+                        nal_units[i].bytes + nal_units[i].size);
+    std::unique_lock<std::mutex> lock(mutex_);
+    output_cond_.wait(lock, [this]() {
+      return stop_ || output_queue_.size() < output_queue_size_;
+    });
+    if (stop_) {
+      return false;
+    }
+    output_queue_.push_back(std::move(output));
+    lock.unlock();
+    output_cond_.notify_all();
+  }
+  return true;
+}
+
+}   // namespace xvc
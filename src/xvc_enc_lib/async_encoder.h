@@ -0,0 +1,91 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_ASYNC_ENCODER_H_
+#define XVC_ENC_LIB_ASYNC_ENCODER_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <vector>
+
+#include "xvc_common_lib/restrictions.h"
+#include "xvc_enc_lib/xvcenc.h"
+
+namespace xvc {
+
+class Encoder;
+
+// Runs an Encoder on a separate thread so that reading input pictures,
+// encoding and writing nal units can overlap. Input pictures are referenced
+// until they have been copied by the encoder and then handed back to the
+// caller through the release callback. Encoded nal units are either copied
+// into a bounded output queue or passed directly to a callback. Both queues
+// are bounded so that the memory use does not grow when one side is slower.
+class AsyncEncoder {
+public:
+  static const int kDefaultInputQueueSize = 4;
+  static const int kDefaultOutputQueueSize = 64;
+
+  AsyncEncoder(Encoder *encoder, int input_queue_size, int output_queue_size);
+  ~AsyncEncoder();
+  xvc_enc_return_code SendPicture(const xvc_enc_pic_planes *picture,
+                                  xvc_enc_release_callback release_callback,
+                                  void *opaque);
+  xvc_enc_return_code ReceiveNal(xvc_enc_nal_unit *nal_unit, bool wait);
+  xvc_enc_return_code SetNalCallback(xvc_enc_nal_callback nal_callback,
+                                     void *opaque);
+
+private:
+  struct InputPicture {
+    xvc_enc_pic_planes planes;
+    xvc_enc_release_callback release_callback;
+    void *opaque;
+  };
+  struct OutputNal {
+    xvc_enc_nal_unit nal_unit;
+    std::vector<uint8_t> bytes;
+  };
+  // Must be called with mutex_ held
+  void Start();
+  void WorkerMain();
+  // Returns false if the encoder is being destroyed
+  bool OutputNals(const xvc_enc_nal_unit *nal_units, int num_nal_units);
+
+  Encoder *encoder_;
+  const size_t input_queue_size_;
+  const size_t output_queue_size_;
+  xvc_enc_nal_callback nal_callback_ = nullptr;
+  void *nal_callback_opaque_ = nullptr;
+  std::deque<InputPicture> input_queue_;
+  std::deque<OutputNal> output_queue_;
+  OutputNal current_nal_;
+  bool end_of_input_ = false;
+  bool end_of_output_ = false;
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable input_cond_;
+  std::condition_variable output_cond_;
+  std::thread thread_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_ASYNC_ENCODER_H_
@@ -0,0 +1,216 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/bit_estimator.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdlib>
+
+#include "xvc_common_lib/restrictions.h"
+#include "xvc_common_lib/utils.h"
+
+namespace xvc {
+
+uint32_t BitEstimator::EstimateCbf(YuvComponent comp, bool cbf) const {
+  if (util::IsLuma(comp)) {
+    return ctx_.cu_cbf_luma[0].GetEntropyBits(cbf ? 1 : 0);
+  }
+  return ctx_.cu_cbf_chroma[0].GetEntropyBits(cbf ? 1 : 0);
+}
+
+uint32_t BitEstimator::EstimateRootCbf(bool root_cbf) const {
+  return ctx_.cu_root_cbf[0].GetEntropyBits(root_cbf ? 1 : 0);
+}
+
+uint32_t BitEstimator::EstimateIntraMode(IntraMode intra_mode,
+                                         const IntraPredictorLuma &mpm) const {
+  assert(intra_mode < IntraMode::kTotalNumber);
+  int mpm_index = -1;
+  for (int i = 0; i < static_cast<int>(mpm.size()); i++) {
+    if (intra_mode == mpm[i]) {
+      mpm_index = i;
+    }
+  }
+  const ContextModel &ctx = ctx_.intra_pred_luma[0];
+  if (mpm_index >= 0) {
+    return ctx.GetEntropyBits(1) + GetBypassBits(1 + (mpm_index > 0));
+  }
+  return ctx.GetEntropyBits(0) + GetBypassBits(5);
+}
+
+uint32_t BitEstimator::EstimateInterDir(const CodingUnit &cu,
+                                        InterDir inter_dir) const {
+  const ContextModel &bi_ctx = ctx_.GetInterDirBiCtx(cu);
+  ContextModel ctx = bi_ctx;
+  uint32_t bits = EstimateBinAndUpdate(inter_dir == InterDir::kBi ? 1 : 0,
+                                       &ctx);
+  if (inter_dir != InterDir::kBi) {
+    if (&bi_ctx != &ctx_.inter_dir[4]) {
+      ctx = ctx_.inter_dir[4];
+    }
+    bits += ctx.GetEntropyBits(inter_dir == InterDir::kL0 ? 0 : 1);
+  }
+  return bits;
+}
+
+uint32_t BitEstimator::EstimateInterMvd(const MotionVector &mvd) const {
+  std::array<ContextModel, CabacContexts::kNumMvdCtx> mvd_ctx =
+    ctx_.inter_mvd;
+  return EstimateInterMvd(mvd, &mvd_ctx[0]);
+}
+
+uint32_t BitEstimator::EstimateInterMvpIdx(int mvp_idx) const {
+  ContextModel mvp_ctx = ctx_.inter_mvp_idx[0];
+  return EstimateInterMvpIdx(mvp_idx, &mvp_ctx);
+}
+
+uint32_t BitEstimator::EstimateInterRefIdx(int ref_idx,
+                                           int num_refs_available) const {
+  std::array<ContextModel, CabacContexts::kNumRefIdxCtx> ref_idx_ctx =
+    ctx_.inter_ref_idx;
+  return EstimateInterRefIdx(ref_idx, num_refs_available, &ref_idx_ctx[0]);
+}
+
+uint32_t BitEstimator::EstimateMergeFlag(bool merge) const {
+  if (Restrictions::Get().disable_inter_merge_mode) {
+    return 0;
+  }
+  return ctx_.inter_merge_flag[0].GetEntropyBits(merge ? 1 : 0);
+}
+
+uint32_t BitEstimator::EstimateMergeIdx(int merge_idx) const {
+  if (Restrictions::Get().disable_inter_merge_candidates) {
+    return 0;
+  }
+  const int max_merge_cand = constants::kNumInterMergeCandidates;
+  uint32_t bits = ctx_.inter_merge_idx[0].GetEntropyBits(merge_idx != 0);
+  if (merge_idx != 0) {
+    int num_bins = merge_idx - ((merge_idx == max_merge_cand - 1) ? 1 : 0);
+    bits += GetBypassBits(num_bins);
+  }
+  return bits;
+}
+
+uint32_t BitEstimator::EstimateInterPrediction(const CodingUnit &cu) const {
+  uint32_t bits = EstimateMergeFlag(cu.GetMergeFlag());
+  if (cu.GetMergeFlag()) {
+    return bits + EstimateMergeIdx(cu.GetMergeIdx());
+  }
+  if (cu.GetPicType() == PicturePredictionType::kBi) {
+    bits += EstimateInterDir(cu, cu.GetInterDir());
+  }
+  std::array<ContextModel, CabacContexts::kNumRefIdxCtx> ref_idx_ctx =
+    ctx_.inter_ref_idx;
+  std::array<ContextModel, CabacContexts::kNumMvdCtx> mvd_ctx =
+    ctx_.inter_mvd;
+  ContextModel mvp_ctx = ctx_.inter_mvp_idx[0];
+  const ReferencePictureLists *ref_pic_lists = cu.GetRefPicLists();
+  for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+    RefPicList ref_pic_list = static_cast<RefPicList>(i);
+    if (!ReferencePictureLists::IsRefPicListUsed(ref_pic_list,
+                                                 cu.GetInterDir())) {
+      continue;
+    }
+    bits += EstimateInterRefIdx(cu.GetRefIdx(ref_pic_list),
+                                ref_pic_lists->GetNumRefPics(ref_pic_list),
+                                &ref_idx_ctx[0]);
+    bits += EstimateInterMvd(cu.GetMvDelta(ref_pic_list), &mvd_ctx[0]);
+    bits += EstimateInterMvpIdx(cu.GetMvpIdx(ref_pic_list), &mvp_ctx);
+  }
+  return bits;
+}
+
+uint32_t BitEstimator::EstimateInterMvd(const MotionVector &mvd,
+                                        ContextModel *mvd_ctx) {
+  uint32_t abs_mvd_x = std::abs(mvd.x);
+  uint32_t abs_mvd_y = std::abs(mvd.y);
+  if (Restrictions::Get().disable_inter_mvd_greater_than_flags) {
+    return GetBypassBits(GetNumExpGolombBins(abs_mvd_x, 1) + (abs_mvd_x != 0) +
+                         GetNumExpGolombBins(abs_mvd_y, 1) + (abs_mvd_y != 0));
+  }
+  uint32_t bits = EstimateBinAndUpdate(abs_mvd_x != 0, &mvd_ctx[0]);
+  bits += EstimateBinAndUpdate(abs_mvd_y != 0, &mvd_ctx[0]);
+  int num_bypass_bins = 0;
+  if (abs_mvd_x) {
+    bits += EstimateBinAndUpdate(abs_mvd_x > 1, &mvd_ctx[1]);
+    num_bypass_bins +=
+      1 + (abs_mvd_x > 1 ? GetNumExpGolombBins(abs_mvd_x - 2, 1) : 0);
+  }
+  if (abs_mvd_y) {
+    bits += EstimateBinAndUpdate(abs_mvd_y > 1, &mvd_ctx[1]);
+    num_bypass_bins +=
+      1 + (abs_mvd_y > 1 ? GetNumExpGolombBins(abs_mvd_y - 2, 1) : 0);
+  }
+  return bits + GetBypassBits(num_bypass_bins);
+}
+
+uint32_t BitEstimator::EstimateInterMvpIdx(int mvp_idx,
+                                           ContextModel *mvp_ctx) {
+  if (Restrictions::Get().disable_inter_mvp) {
+    return 0;
+  }
+  // Truncated unary code using a single context
+  const int max_val = constants::kNumInterMvPredictors - 1;
+  uint32_t bits = EstimateBinAndUpdate(mvp_idx > 0, mvp_ctx);
+  if (!mvp_idx || max_val == 1) {
+    return bits;
+  }
+  for (int i = 1; i < mvp_idx; i++) {
+    bits += EstimateBinAndUpdate(1, mvp_ctx);
+  }
+  if (mvp_idx < max_val) {
+    bits += EstimateBinAndUpdate(0, mvp_ctx);
+  }
+  return bits;
+}
+
+uint32_t BitEstimator::EstimateInterRefIdx(int ref_idx,
+                                           int num_refs_available,
+                                           ContextModel *ref_idx_ctx) {
+  assert(ref_idx < num_refs_available);
+  if (num_refs_available == 1) {
+    return 0;
+  }
+  uint32_t bits = EstimateBinAndUpdate(ref_idx != 0 ? 1 : 0, &ref_idx_ctx[0]);
+  if (!ref_idx || num_refs_available == 2) {
+    return bits;
+  }
+  ref_idx--;
+  bits += EstimateBinAndUpdate(ref_idx != 0 ? 1 : 0, &ref_idx_ctx[1]);
+  if (!ref_idx) {
+    return bits;
+  }
+  // Remaining bins are bypass coded as truncated unary
+  int num_bins = std::min(ref_idx, num_refs_available - 3);
+  return bits + GetBypassBits(num_bins);
+}
+
+int BitEstimator::GetNumExpGolombBins(uint32_t abs_level,
+                                      uint32_t golomb_rice_k) {
+  int num_bins = 1;
+  while (abs_level >= (1u << golomb_rice_k)) {
+    num_bins++;
+    abs_level -= 1 << golomb_rice_k;
+    golomb_rice_k++;
+  }
+  return num_bins + golomb_rice_k;
+}
+
+}   // namespace xvc
@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_BIT_ESTIMATOR_H_
+#define XVC_ENC_LIB_BIT_ESTIMATOR_H_
+
+#include "xvc_common_lib/cabac.h"
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/context_model.h"
+#include "xvc_common_lib/intra_prediction.h"
+#include "xvc_enc_lib/syntax_writer.h"
+
+namespace xvc {
+
+// Read-only rate estimation of syntax elements from the context states of a
+// SyntaxWriter, without copying the contexts or setting up an entropy
+// encoder. All functions return fractional bits (with a precision of
+// ContextModel::kFracBitsPrecision) and give the same result as writing the
+// syntax element with a RdoSyntaxWriter forked from the same writer.
+class BitEstimator {
+public:
+  explicit BitEstimator(const SyntaxWriter &writer)
+    : ctx_(writer.GetContexts()),
+    frac_bits_offset_(writer.GetFractionalBits()) {
+  }
+  // Number of whole bits as counted by RdoSyntaxWriter(writer, 0)
+  Bits GetNumBits(uint32_t frac_bits) const {
+    return (frac_bits_offset_ + frac_bits) >> ContextModel::kFracBitsPrecision;
+  }
+
+  uint32_t EstimateCbf(YuvComponent comp, bool cbf) const;
+  uint32_t EstimateRootCbf(bool root_cbf) const;
+  uint32_t EstimateIntraMode(IntraMode intra_mode,
+                             const IntraPredictorLuma &mpm) const;
+  uint32_t EstimateInterDir(const CodingUnit &cu, InterDir inter_dir) const;
+  uint32_t EstimateInterMvd(const MotionVector &mvd) const;
+  uint32_t EstimateInterMvpIdx(int mvp_idx) const;
+  uint32_t EstimateInterRefIdx(int ref_idx, int num_refs_available) const;
+  uint32_t EstimateMergeFlag(bool merge) const;
+  // Luma inter prediction syntax as written by CuWriter
+  uint32_t EstimateInterPrediction(const CodingUnit &cu) const;
+
+private:
+  uint32_t EstimateMergeIdx(int merge_idx) const;
+  static uint32_t GetBypassBits(int num_bins) {
+    return ContextModel::kEntropyBypassBits * num_bins;
+  }
+  // Used when the same context codes more than one bin of a syntax element,
+  // updates the state of a local copy of the context
+  static uint32_t EstimateBinAndUpdate(uint32_t bin, ContextModel *ctx) {
+    uint32_t bits = ctx->GetEntropyBits(bin);
+    if (bin != ctx->GetMps()) {
+      ctx->UpdateLPS();
+    } else {
+      ctx->UpdateMPS();
+    }
+    return bits;
+  }
+  // Motion syntax is written once per reference list, so these update the
+  // states of local copies of the contexts
+  static uint32_t EstimateInterMvd(const MotionVector &mvd,
+                                   ContextModel *mvd_ctx);
+  static uint32_t EstimateInterMvpIdx(int mvp_idx, ContextModel *mvp_ctx);
+  static uint32_t EstimateInterRefIdx(int ref_idx, int num_refs_available,
+                                      ContextModel *ref_idx_ctx);
+  static int GetNumExpGolombBins(uint32_t abs_level, uint32_t golomb_rice_k);
+
+  const CabacContexts &ctx_;
+  const uint32_t frac_bits_offset_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_BIT_ESTIMATOR_H_
@@ -127,7 +127,29 @@ bool CuCache::Store(const CodingUnit &cu) {
   return false;
 }
 
+void CuCache::CopyEntryFrom(const CuCache &other, const CodingUnit &cu) {
+  const CacheEntry *src_entry = other.Find(cu);
+  CacheEntry *dst_entry = Find(cu);
+  if (!src_entry) {
+    return;
+  }
+  dst_entry->features = src_entry->features;
+  for (int cu_idx = 0; cu_idx < kNumCuPerEntry; cu_idx++) {
+    dst_entry->valid[cu_idx] = src_entry->valid[cu_idx];
+    if (src_entry->valid[cu_idx]) {
+      *dst_entry->cu[cu_idx] = *src_entry->cu[cu_idx];
+      dst_entry->cu[cu_idx]->SetQp(src_entry->cu[cu_idx]->GetQp(
+        YuvComponent::kY));
+    }
+  }
+}
+
 CuCache::CacheEntry* CuCache::Find(const CodingUnit &cu) {
+  const CuCache *const_this = this;
+  return const_cast<CacheEntry*>(const_this->Find(cu));
+}
+
+const CuCache::CacheEntry* CuCache::Find(const CodingUnit &cu) const {
   const YuvComponent comp = YuvComponent::kY;
   // Determine partition within smallest enclosing square cu
   const CachePartition partition = DetermineCuPartition(cu);
@@ -150,7 +172,8 @@ CuCache::CacheEntry* CuCache::Find(const CodingUnit &cu) {
   return &cu_cache_[cu_tree][quad_depth][quad_pos][static_cast<int>(partition)];
 }
 
-CuCache::CachePartition CuCache::DetermineCuPartition(const CodingUnit &cu) {
+CuCache::CachePartition
+CuCache::DetermineCuPartition(const CodingUnit &cu) const {
   const YuvComponent comp = YuvComponent::kY;
   const int width = cu.GetWidth(comp);
   const int height = cu.GetHeight(comp);
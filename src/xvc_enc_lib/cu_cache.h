@@ -53,6 +53,8 @@ public:
   void Invalidate(CuTree cu_tree, int depth);
   Result Lookup(const CodingUnit &cu);
   bool Store(const CodingUnit &cu);
+  // Copy the cache entry of cu from a cache belonging to another picture
+  void CopyEntryFrom(const CuCache &other, const CodingUnit &cu);
 
 private:
   // number of cu objects to store per cache entry,
@@ -79,7 +81,8 @@ private:
   };
 
   CacheEntry* Find(const CodingUnit &cu);
-  CachePartition DetermineCuPartition(const CodingUnit &cu);
+  const CacheEntry* Find(const CodingUnit &cu) const;
+  CachePartition DetermineCuPartition(const CodingUnit &cu) const;
 
   PictureData* const pic_data_;
   std::array<std::array<std::array<std::array<CacheEntry,
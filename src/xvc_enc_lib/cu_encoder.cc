@@ -22,10 +22,13 @@
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdlib>
 #include <limits>
 #include <utility>
 
+#include "xvc_common_lib/perf_trace.h"
 #include "xvc_common_lib/restrictions.h"
+#include "xvc_common_lib/temporal_mv_field.h"
 #include "xvc_common_lib/utils.h"
 #include "xvc_enc_lib/sample_metric.h"
 
@@ -43,16 +46,29 @@ struct CuEncoder::RdoCost {
 CuEncoder::CuEncoder(const SimdFunctions &simd,
                      const YuvPicture &orig_pic, YuvPicture *rec_pic,
                      PictureData *pic_data,
+                     const Lookahead::PictureAnalysis *lookahead_analysis,
+                     const IntraModeAnalysis *intra_mode_analysis,
+                     MotionField *motion_field,
+                     const LadderLink::PictureAnalysis *ladder_analysis,
+                     SplitRdoPool *split_rdo_pool,
                      const EncoderSettings &encoder_settings)
   : TransformEncoder(rec_pic->GetBitdepth(), pic_data->GetMaxNumComponents(),
                      orig_pic, encoder_settings),
   orig_pic_(orig_pic),
   encoder_settings_(encoder_settings),
+  lookahead_analysis_(lookahead_analysis),
+  motion_field_(encoder_settings.motion_field_seeding > 0 ?
+                motion_field : nullptr),
+  ladder_analysis_(encoder_settings.ladder_split_depth_bound > 0 ?
+                   ladder_analysis : nullptr),
+  split_rdo_pool_(split_rdo_pool),
   rec_pic_(*rec_pic),
   pic_data_(*pic_data),
   inter_search_(simd, rec_pic->GetBitdepth(), pic_data->GetMaxNumComponents(),
-                orig_pic, *pic_data->GetRefPicLists(), encoder_settings),
-  intra_search_(rec_pic->GetBitdepth(), *pic_data, orig_pic, encoder_settings),
+                orig_pic, *pic_data->GetRefPicLists(), motion_field_,
+                encoder_settings),
+  intra_search_(rec_pic->GetBitdepth(), *pic_data, orig_pic,
+                intra_mode_analysis, encoder_settings),
   cu_writer_(pic_data_, &intra_search_),
   cu_cache_(pic_data) {
   for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
@@ -82,9 +98,14 @@ void CuEncoder::EncodeCtu(int rsaddr, SyntaxWriter *bitstream_writer) {
     frac_bits = rsaddr == 0 ? 0 : last_ctu_frac_bits_;
   }
   RdoSyntaxWriter rdo_writer(*bitstream_writer, 0, frac_bits);
+  inter_search_.InvalidatePredCache();
 
   CodingUnit *ctu = pic_data_.GetCtu(CuTree::Primary, rsaddr);
   int ctu_qp = pic_data_.GetPicQp()->GetQpRaw(YuvComponent::kY);
+  if (encoder_settings_.adaptive_qp ||
+      encoder_settings_.early_split_termination) {
+    CalcCtuVariance(ctu);
+  }
   if (encoder_settings_.adaptive_qp) {
     ctu_qp += CalcDeltaQpFromVariance(ctu);
   }
@@ -124,21 +145,28 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
   cu->SetQp(qp);
   const int cu_tree = static_cast<int>(cu->GetCuTree());
   const int depth = cu->GetDepth();
-  const bool do_quad_split = cu->GetBinaryDepth() == 0 &&
+  bool do_quad_split = cu->GetBinaryDepth() == 0 &&
     depth < pic_data_.GetMaxDepth(cu->GetCuTree());
   const bool can_binary_split = cu->IsBinarySplitValid() &&
     cu->IsFullyWithinPicture() &&
     cu->GetWidth(YuvComponent::kY) <= kMaxTrSize &&
     cu->GetHeight(YuvComponent::kY) <= kMaxTrSize;
-  const bool do_hor_split = can_binary_split &&
+  bool do_hor_split = can_binary_split &&
     split_restiction != SplitRestriction::kNoHorizontal &&
     cu->GetHeight(YuvComponent::kY) > constants::kMinBinarySplitSize;
-  const bool do_ver_split = can_binary_split &&
+  bool do_ver_split = can_binary_split &&
     split_restiction != SplitRestriction::kNoVertical &&
     cu->GetWidth(YuvComponent::kY) > constants::kMinBinarySplitSize;
+  if (encoder_settings_.binary_split_gradient_pruning &&
+      (do_hor_split || do_ver_split)) {
+    PruneBinarySplitByGradient(*cu, &do_hor_split, &do_ver_split);
+  }
   const bool do_full = cu->IsFullyWithinPicture() &&
     cu->GetWidth(YuvComponent::kY) <= kMaxTrSize &&
     cu->GetHeight(YuvComponent::kY) <= kMaxTrSize;
+  if (do_quad_split && do_full && CanSkipQuadSplitFromLadder(*cu)) {
+    do_quad_split = false;
+  }
   const bool do_split_any = do_quad_split || do_hor_split || do_ver_split;
   assert(do_full || do_split_any);
 
@@ -157,20 +185,63 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
   }
 
   // First eval without CU split
-  if (do_full) {
-    Bits start_bits = writer->GetNumWrittenBits();
+  const Bits start_bits = writer->GetNumWrittenBits();
+  SplitRdoPool::Worker *no_split_worker = nullptr;
+  const bool isolate_no_split = do_full && IsNoSplitIsolated(*cu);
+  if (isolate_no_split && split_rdo_pool_ && CanEvalNoSplitInParallel()) {
+    no_split_worker = split_rdo_pool_->Acquire();
+  }
+  if (no_split_worker) {
+    // Evaluated on a worker thread while the split candidates are evaluated
+    // below, the result is needed first when comparing against a split
+    no_split_worker->Start(*cu, qp, rdo_depth, split_restiction, best_writer,
+                           rec_pic_, pic_data_, cu_cache_,
+                           inter_search_.GetPreviousFullpel(),
+                           motion_field_);
+  } else if (do_full) {
+    const InterSearch::FullpelMvs fullpel_mvs =
+      inter_search_.GetPreviousFullpel();
+    if (isolate_no_split && motion_field_) {
+      motion_field_->SaveArea(*cu, &motion_field_state_);
+    }
     best_cost.dist =
       CompressNoSplit(best_cu, rdo_depth, split_restiction, &best_writer);
+    if (isolate_no_split) {
+      // Motion search start candidates of the split candidates shall not
+      // depend on the result without split, same as when run in parallel
+      inter_search_.SetPreviousFullpel(fullpel_mvs);
+      if (motion_field_) {
+        motion_field_->RestoreArea(*cu, motion_field_state_);
+      }
+    }
     cu = *best_cu;
     Bits full_bits = best_writer.GetNumWrittenBits() - start_bits;
     best_cost.cost =
       best_cost.dist + static_cast<Cost>(full_bits * qp.GetLambda() + 0.5);
     cu->SaveStateTo(best_state, rec_pic_);
   }
+  auto finish_no_split = [&]() {
+    if (!no_split_worker) {
+      return;
+    }
+    best_cost.dist = no_split_worker->Finish(cu, qp, best_state, &best_writer,
+                                             &cu_cache_);
+    no_split_worker = nullptr;
+    Bits full_bits = best_writer.GetNumWrittenBits() - start_bits;
+    best_cost.cost =
+      best_cost.dist + static_cast<Cost>(full_bits * qp.GetLambda() + 0.5);
+  };
 
   // Encoder split speed-up
   if (encoder_settings_.fast_cu_split_based_on_full_cu &&
-      do_full && CanSkipAnySplitForCu(pic_data_, *cu)) {
+      do_full && !no_split_worker && CanSkipAnySplitForCu(pic_data_, *cu)) {
+    *writer = best_writer;
+    return best_cost.dist;
+  }
+
+  // Content adaptive early termination of split evaluation
+  if (encoder_settings_.early_split_termination && do_full &&
+      !no_split_worker && CanTerminateSplitEarly(*cu, best_cost.cost, qp)) {
     *writer = best_writer;
     return best_cost.dist;
   }
@@ -189,6 +260,7 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
         best_binary_depth_greater_than_one = true;
       }
     }
+    finish_no_split();
     if (split_cost.cost < best_cost.cost) {
       std::swap(*best_cu, *temp_cu);
       cu = *best_cu;
@@ -221,6 +293,7 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
         }
       }
     }
+    finish_no_split();
     if (split_cost.cost < best_cost.cost) {
       std::swap(*best_cu, *temp_cu);
       cu = *best_cu;
@@ -258,6 +331,7 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
     RdoCost split_cost =
       CompressSplitCu(*temp_cu, rdo_depth, qp, SplitType::kQuad,
                       split_restiction, &splitcu_writer);
+    finish_no_split();
     if (split_cost.cost < best_cost.cost) {
       std::swap(*best_cu, *temp_cu);
       // No more split evaluations
@@ -270,6 +344,7 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
     }
   }
 
+  assert(!no_split_worker);
   *writer = best_writer;
   return best_cost.dist;
 }
@@ -307,16 +382,11 @@ CuEncoder::CompressSplitCu(CodingUnit *cu, int rdo_depth, const Qp &qp,
 }
 
 
-int CuEncoder::CalcDeltaQpFromVariance(const CodingUnit *cu) {
-  const double kStrength = encoder_settings_.aqp_strength;
-  const double kOffset = 13;
-  const int kVarBlocksize = 8;
-  const int kMeanDiv = 4;
-  const int kMinQpOffset = -4;
-  const int kMaxQpOffset = 5;
+void CuEncoder::CalcCtuVariance(const CodingUnit *ctu) {
   const YuvComponent luma = YuvComponent::kY;
-  const int x = cu->GetPosX(luma);
-  const int y = cu->GetPosY(luma);
+  const int x = ctu->GetPosX(luma);
+  const int y = ctu->GetPosY(luma);
+  const ptrdiff_t orig_stride = orig_pic_.GetStride(luma);
 
   auto calc_variance = [](const Sample* src, int block_size, ptrdiff_t stride) {
     uint64_t sum = 0;
@@ -334,26 +404,38 @@ int CuEncoder::CalcDeltaQpFromVariance(const CodingUnit *cu) {
     return (256 * (squares - (sum * sum) / num)) / num;
   };
 
-  const int h = cu->GetHeight(luma) / kVarBlocksize;
-  const int w = cu->GetHeight(luma) / kVarBlocksize;
-  std::vector<uint64_t> v(h * w, std::numeric_limits<uint64_t>::max());
-  int blocks = 0;
+  const int h = ctu->GetHeight(luma) / kVarBlocksize;
+  const int w = ctu->GetWidth(luma) / kVarBlocksize;
+  ctu_variance_stride_ = w;
+  ctu_variance_.assign(h * w, std::numeric_limits<uint64_t>::max());
   for (int i = 0; i < h; i++) {
     if (y + i * kVarBlocksize >= pic_data_.GetPictureHeight(luma)) {
       continue;
     }
     const Sample *orig = orig_pic_.GetSamplePtr(luma, x, y) +
-      i * kVarBlocksize * orig_pic_.GetStride(luma);
+      i * kVarBlocksize * orig_stride;
     for (int j = 0; j < w; j++) {
       if (x + j * kVarBlocksize >= pic_data_.GetPictureWidth(luma)) {
         continue;
       }
-      uint64_t variance =
-        calc_variance(orig, kVarBlocksize, orig_pic_.GetStride(luma));
-      v[blocks++] = variance;
+      ctu_variance_[i * w + j] = calc_variance(orig, kVarBlocksize, orig_stride);
       orig += kVarBlocksize;
     }
   }
+}
+
+int CuEncoder::CalcDeltaQpFromVariance(const CodingUnit *cu) {
+  const double kStrength = encoder_settings_.aqp_strength;
+  const double kOffset = 13;
+  const int kMeanDiv = 4;
+  const int kMinQpOffset = -4;
+  const int kMaxQpOffset = 5;
+
+  std::vector<uint64_t> v(ctu_variance_);
+  const int blocks = static_cast<int>(
+    std::count_if(v.begin(), v.end(), [](uint64_t var) {
+    return var != std::numeric_limits<uint64_t>::max();
+  }));
   std::sort(v.begin(), v.end());
   uint64_t variance;
   variance = 1 + v[blocks / kMeanDiv];
@@ -364,6 +446,70 @@ int CuEncoder::CalcDeltaQpFromVariance(const CodingUnit *cu) {
   return util::Clip3(static_cast<int>(dqp), kMinQpOffset, kMaxQpOffset);
 }
 
+bool CuEncoder::CanTerminateSplitEarly(const CodingUnit &cu,
+                                       Cost no_split_cost,
+                                       const Qp &qp) const {
+  const YuvComponent luma = YuvComponent::kY;
+  const int posx = cu.GetPosX(luma);
+  const int posy = cu.GetPosY(luma);
+  const int width = cu.GetWidth(luma);
+  const int height = cu.GetHeight(luma);
+  const int depth = cu.GetDepth() + cu.GetBinaryDepth();
+
+  // The co-located area in the closest reference picture should not have
+  // been split further than the current CU
+  if (!pic_data_.IsIntraPic()) {
+    const ReferencePictureLists *ref_pic_lists = pic_data_.GetRefPicLists();
+    if (ref_pic_lists->GetNumRefPics(RefPicList::kL0) == 0) {
+      return false;
+    }
+    const int last_x =
+      std::min(posx + width, pic_data_.GetPictureWidth(luma)) - 1;
+    const int last_y =
+      std::min(posy + height, pic_data_.GetPictureHeight(luma)) - 1;
+    const std::array<std::pair<int, int>, 5> positions = { {
+      { posx, posy }, { last_x, posy }, { posx, last_y }, { last_x, last_y },
+      { (posx + last_x) / 2, (posy + last_y) / 2 }
+    } };
+    const TemporalMvField &col_field =
+      ref_pic_lists->GetTemporalMvField(RefPicList::kL0, 0);
+    for (auto &pos : positions) {
+      const int col_depth = col_field.GetDepthAt(pos.first, pos.second);
+      if (col_depth < 0 || col_depth > depth) {
+        return false;
+      }
+    }
+    if (cu.GetSkipFlag()) {
+      return true;
+    }
+  }
+
+  // Cheap to code without split, the split candidates would mostly spend
+  // bits on signaling the split and the additional cus
+  if (no_split_cost * kEarlyTerminationSamplesPerBit <
+      qp.GetLambda() * width * height) {
+    return true;
+  }
+
+  // Otherwise the content must be homogeneous
+  const int ctu_mask = constants::kCtuSize - 1;
+  const int block_x0 = (posx & ctu_mask) / kVarBlocksize;
+  const int block_y0 = (posy & ctu_mask) / kVarBlocksize;
+  const int block_x1 = ((posx & ctu_mask) + width - 1) / kVarBlocksize;
+  const int block_y1 = ((posy & ctu_mask) + height - 1) / kVarBlocksize;
+  const uint64_t max_variance =
+    kEarlyTerminationMaxVariance << (2 * (orig_pic_.GetBitdepth() - 8));
+  for (int y = block_y0; y <= block_y1; y++) {
+    for (int x = block_x0; x <= block_x1; x++) {
+      const uint64_t variance = ctu_variance_[y * ctu_variance_stride_ + x];
+      if (variance != std::numeric_limits<uint64_t>::max() &&
+          variance > max_variance) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
 Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
                                       SplitRestriction split_restriction,
@@ -401,9 +547,23 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
       encoder_settings_.fast_mode_selection_for_cached_cu &&
       (cache_result.any_intra || cache_result.any_skip) &&
       !Restrictions::Get().disable_inter_merge_mode;
+    const bool lookahead_skip_intra = lookahead_analysis_ &&
+      lookahead_analysis_->IsInterDominant(cu->GetPosX(YuvComponent::kY),
+                                           cu->GetPosY(YuvComponent::kY),
+                                           cu->GetWidth(YuvComponent::kY),
+                                           cu->GetHeight(YuvComponent::kY),
+                                           kLookaheadSkipIntraFactor);
+    const bool lookahead_single_ref = lookahead_skip_intra &&
+      lookahead_analysis_->IsInterDominant(cu->GetPosX(YuvComponent::kY),
+                                           cu->GetPosY(YuvComponent::kY),
+                                           cu->GetWidth(YuvComponent::kY),
+                                           cu->GetHeight(YuvComponent::kY),
+                                           kLookaheadSingleRefFactor);
     const bool fast_skip_intra =
-      encoder_settings_.fast_mode_selection_for_cached_cu &&
-      cache_result.any_inter;
+      (encoder_settings_.fast_mode_selection_for_cached_cu &&
+       cache_result.any_inter) || lookahead_skip_intra;
+    inter_search_.SetMaxNumRefIdx(lookahead_single_ref ?
+                                  1 : constants::kMaxNumRefPics);
 
     RdoCost cost;
     if (!Restrictions::Get().disable_inter_merge_mode) {
@@ -417,7 +577,11 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
       }
     }
 
-    if (!fast_skip_inter) {
+    // Encoder speed-up when merge already found a skip block
+    const bool merge_skip_found =
+      encoder_settings_.fast_merge_skip_termination &&
+      best_cost.cost < std::numeric_limits<Cost>::max() && cu->GetSkipFlag();
+    if (!fast_skip_inter && !merge_skip_found) {
       cost = CompressInter(temp_cu, qp, *writer);
       if (cost < best_cost) {
         best_cost = cost;
@@ -426,7 +590,7 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
       }
     }
 
-    if ((!fast_skip_intra && cu->GetHasAnyCbf()) ||
+    if ((!fast_skip_intra && !merge_skip_found && cu->GetHasAnyCbf()) ||
         encoder_settings_.always_evaluate_intra_in_inter) {
       cost = CompressIntra(temp_cu, qp, *writer);
       if (cost < best_cost) {
@@ -466,12 +630,14 @@ Distortion CuEncoder::CompressFast(CodingUnit *cu, const Qp &qp,
   assert(cu->GetSplit() == SplitType::kNone);
   Distortion dist = 0;
   if (cu->IsIntra()) {
+    XVC_PERF_TIMER(kIntraSearch);
     for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
       // TODO(PH) Add fast method without cbf evaluation
       dist += intra_search_.CompressIntra(cu, comp, qp, writer, this,
                                           &rec_pic_);
     }
   } else {
+    XVC_PERF_TIMER(kInterSearch);
     for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
       dist += inter_search_.CompressInterFast(cu, comp, qp, writer, this,
                                               &rec_pic_);
@@ -483,6 +649,7 @@ Distortion CuEncoder::CompressFast(CodingUnit *cu, const Qp &qp,
 CuEncoder::RdoCost
 CuEncoder::CompressIntra(CodingUnit *cu, const Qp &qp,
                          const SyntaxWriter &writer) {
+  XVC_PERF_TIMER(kIntraSearch);
   cu->SetPredMode(PredictionMode::kIntra);
   cu->SetSkipFlag(false);
   Distortion dist = 0;
@@ -504,6 +671,7 @@ CuEncoder::CompressIntra(CodingUnit *cu, const Qp &qp,
 CuEncoder::RdoCost
 CuEncoder::CompressInter(CodingUnit *cu, const Qp &qp,
                          const SyntaxWriter &bitstream_writer) {
+  XVC_PERF_TIMER(kInterSearch);
   Distortion dist =
     inter_search_.CompressInter(cu, qp, bitstream_writer, this, &rec_pic_);
   return GetCuCostWithoutSplit(*cu, qp, bitstream_writer, dist);
@@ -513,6 +681,7 @@ CuEncoder::RdoCost
 CuEncoder::CompressMerge(CodingUnit *cu, const Qp &qp,
                          const SyntaxWriter &bitstream_writer,
                          bool fast_merge_skip) {
+  XVC_PERF_TIMER(kInterSearch);
   std::array<bool,
     constants::kNumInterMergeCandidates> skip_evaluated = { false };
   InterMergeCandidateList merge_list = inter_search_.GetMergeCandidates(*cu);
@@ -572,6 +741,8 @@ CuEncoder::RdoCost
 CuEncoder::GetCuCostWithoutSplit(const CodingUnit &cu, const Qp &qp,
                                  const SyntaxWriter &bitstream_writer,
                                  Distortion ssd) {
+  // Residual coding updates the coefficient contexts for every bin, so the
+  // cost of the complete cu is counted with a forked writer
   RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
   for (YuvComponent comp : pic_data_.GetComponents(cu.GetCuTree())) {
     cu_writer_.WriteComponent(cu, comp, &rdo_writer);
@@ -582,6 +753,7 @@ CuEncoder::GetCuCostWithoutSplit(const CodingUnit &cu, const Qp &qp,
 }
 
 void CuEncoder::WriteCtu(int rsaddr, SyntaxWriter *writer) {
+  XVC_PERF_TIMER(kCabacWrite);
   if (EncoderSettings::kEncoderCountActualWrittenBits) {
     writer->ResetBitCounting();
   }
@@ -624,9 +796,77 @@ void CuEncoder::SetQpForAllCusInCtu(CodingUnit *ctu, int qp) {
       }
     }
   }
+  // Refresh the qp in the cu info table
+  pic_data_.MarkUsedInPic(ctu);
 }
 
 
+bool CuEncoder::IsNoSplitIsolated(const CodingUnit &cu) const {
+  // Always decided by the cu alone so that the bitstream does not depend on
+  // whether the cu is evaluated in parallel or not
+  return cu.GetCuTree() == CuTree::Primary &&
+    cu.GetBinaryDepth() < 2 &&
+    cu.GetWidth(YuvComponent::kY) * cu.GetHeight(YuvComponent::kY) >=
+    kParallelNoSplitMinArea;
+}
+
+bool CuEncoder::CanEvalNoSplitInParallel() const {
+  // The result without split must not be needed before the first split
+  // candidate has been evaluated, i.e. the early split termination checks
+  // can not apply (CanSkipAnySplitForCu requires binary depth 2 or more)
+  return encoder_settings_.parallel_split_rdo > 0 &&
+    !encoder_settings_.early_split_termination;
+}
+
+bool CuEncoder::CanSkipQuadSplitFromLadder(const CodingUnit &cu) const {
+  if (!ladder_analysis_ || cu.GetCuTree() != CuTree::Primary) {
+    return false;
+  }
+  // The other rung is allowed one more level of quad split when it has been
+  // coded at a higher qp than the current picture
+  const YuvComponent luma = YuvComponent::kY;
+  const int margin =
+    ladder_analysis_->GetQp() > pic_data_.GetPicQp()->GetQpRaw(luma) ? 1 : 0;
+  const int ladder_depth =
+    ladder_analysis_->GetMaxDepth(cu.GetPosX(luma), cu.GetPosY(luma),
+                                  cu.GetWidth(luma), cu.GetHeight(luma));
+  return cu.GetDepth() >= ladder_depth + margin;
+}
+
+void CuEncoder::PruneBinarySplitByGradient(const CodingUnit &cu,
+                                           bool *do_hor_split,
+                                           bool *do_ver_split) const {
+  const YuvComponent luma = YuvComponent::kY;
+  const int width = cu.GetWidth(luma);
+  const int height = cu.GetHeight(luma);
+  const ptrdiff_t stride = orig_pic_.GetStride(luma);
+  const Sample *src =
+    orig_pic_.GetSamplePtr(luma, cu.GetPosX(luma), cu.GetPosY(luma));
+  uint64_t grad_hor = 0;
+  uint64_t grad_ver = 0;
+  for (int y = 0; y < height - 1; y++) {
+    for (int x = 0; x < width - 1; x++) {
+      grad_hor += std::abs(src[x + 1] - src[x]);
+      grad_ver += std::abs(src[x + stride] - src[x]);
+    }
+    src += stride;
+  }
+  const int bitdepth_shift = orig_pic_.GetBitdepth() - 8;
+  const uint64_t flat_threshold =
+    static_cast<uint64_t>((width - 1) * (height - 1) *
+                          kBinarySplitFlatGradient) << bitdepth_shift;
+  if (grad_hor + grad_ver < flat_threshold) {
+    // Flat content gains nothing from binary split
+    *do_hor_split = false;
+    *do_ver_split = false;
+  } else if (grad_hor > kBinarySplitGradientRatio * grad_ver) {
+    // Mostly vertical edges, only a vertical split can follow them
+    *do_hor_split = false;
+  } else if (grad_ver > kBinarySplitGradientRatio * grad_hor) {
+    *do_ver_split = false;
+  }
+}
+
 bool CuEncoder::CanSkipAnySplitForCu(const PictureData &pic_data,
                                      const CodingUnit &cu) {
   const int binary_depth_threshold = pic_data.IsHighestLayer() ? 2 : 3;
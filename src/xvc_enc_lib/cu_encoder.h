@@ -29,8 +29,13 @@
 #include "xvc_enc_lib/cu_cache.h"
 #include "xvc_enc_lib/cu_writer.h"
 #include "xvc_enc_lib/inter_search.h"
+#include "xvc_enc_lib/intra_mode_analysis.h"
 #include "xvc_enc_lib/intra_search.h"
+#include "xvc_enc_lib/ladder_link.h"
 #include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/lookahead.h"
+#include "xvc_enc_lib/motion_field.h"
+#include "xvc_enc_lib/split_rdo_pool.h"
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/transform_encoder.h"
 
@@ -40,12 +45,34 @@ class CuEncoder : public TransformEncoder {
 public:
   CuEncoder(const SimdFunctions &simd, const YuvPicture &orig_pic,
             YuvPicture *rec_pic, PictureData *pic_data,
+            const Lookahead::PictureAnalysis *lookahead_analysis,
+            const IntraModeAnalysis *intra_mode_analysis,
+            MotionField *motion_field,
+            const LadderLink::PictureAnalysis *ladder_analysis,
+            SplitRdoPool *split_rdo_pool,
             const EncoderSettings &encoder_settings);
   ~CuEncoder();
   void EncodeCtu(int rsaddr, SyntaxWriter *writer);
 
 private:
   struct RdoCost;
+  // Lookahead inter cost must be this many times lower than intra cost for
+  // intra to be skipped, or for only the first reference picture to be used
+  static const int kLookaheadSkipIntraFactor = 4;
+  static const int kLookaheadSingleRefFactor = 8;
+  // Average absolute gradient per sample below which content is flat, and
+  // ratio between directions above which the other binary split is pruned
+  static const int kBinarySplitFlatGradient = 1;
+  static const int kBinarySplitGradientRatio = 3;
+  static const int kVarBlocksize = 8;
+  // Max 8x8 variance (scaled by 256, 8 bit samples) for early termination
+  static const uint64_t kEarlyTerminationMaxVariance = 256 * 16;
+  // Early termination if the rd cost without split is lower than the cost
+  // of one bit per this many samples
+  static const int kEarlyTerminationSamplesPerBit = 2;
+  // Smallest cu (in luma samples) evaluated without split independently of
+  // its split candidates, possibly on a worker thread
+  static const int kParallelNoSplitMinArea = 32 * 32;
 
   Distortion CompressCu(CodingUnit **cu, int rdo_depth,
                         SplitRestriction split_restiction,
@@ -69,7 +96,15 @@ private:
   RdoCost GetCuCostWithoutSplit(const CodingUnit &cu, const Qp &qp,
                                 const SyntaxWriter &bitstream_writer,
                                 Distortion ssd);
+  void CalcCtuVariance(const CodingUnit *ctu);
   int CalcDeltaQpFromVariance(const CodingUnit *cu);
+  bool CanTerminateSplitEarly(const CodingUnit &cu, Cost no_split_cost,
+                              const Qp &qp) const;
+  bool IsNoSplitIsolated(const CodingUnit &cu) const;
+  bool CanEvalNoSplitInParallel() const;
+  bool CanSkipQuadSplitFromLadder(const CodingUnit &cu) const;
+  void PruneBinarySplitByGradient(const CodingUnit &cu, bool *do_hor_split,
+                                  bool *do_ver_split) const;
   void WriteCtu(int rsaddr, SyntaxWriter *writer);
   void SetQpForAllCusInCtu(CodingUnit *ctu, int qp);
 
@@ -80,6 +115,10 @@ private:
 
   const YuvPicture &orig_pic_;
   const EncoderSettings &encoder_settings_;
+  const Lookahead::PictureAnalysis *lookahead_analysis_;
+  MotionField *motion_field_;
+  const LadderLink::PictureAnalysis *ladder_analysis_;
+  SplitRdoPool *split_rdo_pool_;
   YuvPicture &rec_pic_;
   PictureData &pic_data_;
   InterSearch inter_search_;
@@ -87,12 +126,17 @@ private:
   CuWriter cu_writer_;
   CuCache cu_cache_;
   uint32_t last_ctu_frac_bits_ = 0;
+  // Variance of each 8x8 luma block in current ctu (max if outside picture)
+  std::vector<uint64_t> ctu_variance_;
+  int ctu_variance_stride_ = 0;
   // +2 for allow access to one depth lower than smallest CU in RDO
   std::array<CodingUnit::ReconstructionState,
     constants::kMaxBlockDepth + 2> temp_cu_state_;
   CodingUnit::TransformState rd_transform_state_;
+  MotionField::AreaState motion_field_state_;
   std::array<std::array<CodingUnit*, constants::kMaxBlockDepth + 2>,
     constants::kMaxNumCuTrees> rdo_temp_cu_;
+  friend class SplitRdoPool::Worker;
 };
 
 }   // namespace xvc
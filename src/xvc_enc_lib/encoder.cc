@@ -19,13 +19,16 @@
 #include "xvc_enc_lib/encoder.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
 #include <utility>
 
+#include "xvc_common_lib/perf_trace.h"
 #include "xvc_common_lib/reference_list_sorter.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_enc_lib/async_encoder.h"
 #include "xvc_enc_lib/segment_header_writer.h"
 
 namespace xvc {
@@ -37,13 +40,85 @@ Encoder::Encoder()
   segment_header_->codec_identifier = constants::kXvcCodecIdentifier;
   segment_header_->major_version = constants::kXvcMajorVersion;
   segment_header_->minor_version = constants::kXvcMinorVersion;
+  max_sub_gop_length_ = segment_header_->max_sub_gop_length;
+}
+
+Encoder::~Encoder() {
+  // Wake up the encoder thread if waiting for the upstream encoder
+  if (ladder_upstream_) {
+    ladder_upstream_->Close();
+  }
+  if (ladder_downstream_) {
+    ladder_downstream_->Close();
+  }
+}
+
+AsyncEncoder* Encoder::GetAsyncEncoder() {
+  if (!async_encoder_) {
+    async_encoder_.reset(new AsyncEncoder(this, async_input_queue_size_,
+                                          async_output_queue_size_));
+  }
+  return async_encoder_.get();
+}
+
+bool Encoder::SetLadderUpstream(Encoder *upstream) {
+  if (!upstream || upstream == this || ladder_upstream_ ||
+      upstream->ladder_downstream_ || poc_ != 0 || upstream->poc_ != 0) {
+    return false;
+  }
+  const SegmentHeader &segment = *segment_header_;
+  const SegmentHeader &upstream_segment = *upstream->segment_header_;
+  if (segment.GetInternalWidth() != upstream_segment.GetInternalWidth() ||
+      segment.GetInternalHeight() != upstream_segment.GetInternalHeight() ||
+      max_sub_gop_length_ != upstream->max_sub_gop_length_ ||
+      segment_length_ != upstream->segment_length_) {
+    return false;
+  }
+  // Both encoders must code the pictures in the same order, otherwise the
+  // downstream encoder waits forever for pictures that upstream has not
+  // coded yet. Scene cuts and sub gop lengths are chosen by the lookahead.
+  if (closed_gop_interval_ != upstream->closed_gop_interval_ ||
+      (encoder_settings_.lookahead > 0) !=
+      (upstream->encoder_settings_.lookahead > 0)) {
+    return false;
+  }
+  ladder_upstream_ = std::make_shared<LadderLink>();
+  upstream->ladder_downstream_ = ladder_upstream_;
+  return true;
 }
 
 int Encoder::Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
                     bool output_rec, xvc_enc_pic_buffer *rec_pic) {
+  auto pic_enc = PrepareNewPicture();
+  if (IsResamplingInput()) {
+    pic_enc->GetOrigPic()->CopyFromWithResampling(
+      pic_bytes, input_bitdepth_, segment_header_->GetOutputWidth(),
+      segment_header_->GetOutputHeight());
+  } else {
+    pic_enc->GetOrigPic()->CopyFrom(pic_bytes, input_bitdepth_);
+  }
+  return EncodePicture(pic_enc, nal_units, output_rec, rec_pic);
+}
+
+int Encoder::Encode(const uint8_t *const planes[constants::kMaxYuvComponents],
+                    const ptrdiff_t strides[constants::kMaxYuvComponents],
+                    xvc_enc_nal_unit **nal_units, bool output_rec,
+                    xvc_enc_pic_buffer *rec_pic) {
+  auto pic_enc = PrepareNewPicture();
+  if (IsResamplingInput()) {
+    pic_enc->GetOrigPic()->CopyFromWithResampling(
+      planes, strides, input_bitdepth_, segment_header_->GetOutputWidth(),
+      segment_header_->GetOutputHeight());
+  } else {
+    pic_enc->GetOrigPic()->CopyFrom(planes, strides, input_bitdepth_);
+  }
+  return EncodePicture(pic_enc, nal_units, output_rec, rec_pic);
+}
+
+std::shared_ptr<PictureEncoder> Encoder::PrepareNewPicture() {
   nal_units_.clear();
 
-  // Set picture parameters and get bytes for original picture
+  // Set picture parameters, original picture is set by caller
   auto pic_enc = GetNewPictureEncoder();
   auto pic_data = pic_enc->GetPicData();
   pic_enc->SetOutputStatus(OutputStatus::kHasNotBeenOutput);
@@ -69,27 +144,55 @@ int Encoder::Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
   pic_data->SetDeblock(segment_header_->deblock > 0);
   pic_data->SetBetaOffset(segment_header_->beta_offset);
   pic_data->SetTcOffset(segment_header_->tc_offset);
+  return pic_enc;
+}
 
-  if (segment_header_->GetOutputWidth() != segment_header_->GetInternalWidth()
-      || segment_header_->GetOutputHeight() !=
-      segment_header_->GetInternalHeight()) {
-    pic_enc->GetOrigPic()->CopyFromWithResampling(
-      pic_bytes, input_bitdepth_, segment_header_->GetOutputWidth(),
-      segment_header_->GetOutputHeight());
-  } else {
-    pic_enc->GetOrigPic()->CopyFrom(pic_bytes, input_bitdepth_);
+bool Encoder::IsResamplingInput() const {
+  return segment_header_->GetOutputWidth() !=
+    segment_header_->GetInternalWidth() ||
+    segment_header_->GetOutputHeight() != segment_header_->GetInternalHeight();
+}
+
+int Encoder::EncodePicture(std::shared_ptr<PictureEncoder> pic_enc,
+                           xvc_enc_nal_unit **nal_units, bool output_rec,
+                           xvc_enc_pic_buffer *rec_pic) {
+  auto pic_data = pic_enc->GetPicData();
+  if (encoder_settings_.lookahead > 0) {
+    if (!lookahead_) {
+      lookahead_.reset(new Lookahead(segment_header_->GetInternalWidth(),
+                                     segment_header_->GetInternalHeight(),
+                                     segment_header_->internal_bitdepth,
+                                     pic_buffering_num_ + 1));
+    }
+    lookahead_->Push(poc_, *pic_enc->GetOrigPic());
   }
 
+  // A scene cut in the lookahead turns the last picture of the Sub Gop into
+  // an intra access picture by starting a new segment.
+  const PicNum sub_gop_length = segment_header_->max_sub_gop_length;
+  const bool scene_cut = lookahead_ && poc_ > 0 &&
+    poc_ == doc_ + sub_gop_length && lookahead_->HasSceneCut(doc_ + 1, poc_);
+
   // Check if it is time to encode a new segment header.
-  if ((poc_ % segment_length_) == 0) {
+  if (((poc_ - segment_start_poc_) % segment_length_) == 0 || scene_cut) {
+    segment_start_poc_ = poc_;
+    if (scene_cut) {
+      closed_gop_start_poc_ = poc_;
+    }
     prev_segment_open_gop_ = curr_segment_open_gop_;
-    if (((poc_ + segment_length_) % closed_gop_interval_) == 0) {
+    // Closed gops follow the segment cadence, restarted by scene cuts
+    if (((poc_ - closed_gop_start_poc_ + segment_length_) %
+         closed_gop_interval_) == 0) {
       curr_segment_open_gop_ = false;
     } else {
       curr_segment_open_gop_ = true;
     }
     prev_segment_header_ = std::move(segment_header_);
     segment_header_.reset(new SegmentHeader(*prev_segment_header_));
+    segment_header_->open_gop = curr_segment_open_gop_;
+    if (lookahead_ && poc_ > 0) {
+      segment_header_->max_sub_gop_length = SelectSubGopLength(scene_cut);
+    }
     bit_writer_.Clear();
     if (encoder_settings_.encapsulation_mode != 0) {
       bit_writer_.WriteBits(constants::kEncapsulationCode1, 8);
@@ -104,7 +207,7 @@ int Encoder::Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
     nal.bytes = &(*nal_bytes)[0];
     nal.size = nal_bytes->size();
     nal.buffer_flag = 0;
-    SetNalStats(*pic_data, &nal);
+    SetNalStats(*pic_data, nullptr, &nal);
     nal.stats.nal_unit_type = static_cast<int>(NalUnitType::kSegmentHeader);
     nal_units_.push_back(nal);
     pic_data->SetNalType(NalUnitType::kIntraAccessPicture);
@@ -121,13 +224,13 @@ int Encoder::Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
   }
 
   // Check if there are enough pictures buffered to encode a new Sub Gop
-  if (poc_ == doc_ + segment_header_->max_sub_gop_length) {
-    for (PicNum i = 0; i < segment_header_->max_sub_gop_length; i++) {
+  if (poc_ == doc_ + sub_gop_length) {
+    for (PicNum i = 0; i < sub_gop_length; i++) {
       // Find next picture to encode by searching for
       // the one that has doc = this->doc_ + 1.
       for (auto &pic : pic_encoders_) {
         if (pic->GetPicData()->GetDoc() == doc_ + 1) {
-          EncodeOnePicture(pic, segment_header_->max_sub_gop_length);
+          EncodeOnePicture(pic, sub_gop_length);
         }
       }
     }
@@ -237,10 +340,52 @@ void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic,
                           pic->GetPicData()->IsIntraPic(),
                           pic_encoders_, pic->GetPicData()->GetRefPicLists());
 
+  std::shared_ptr<const Lookahead::PictureAnalysis> lookahead_analysis;
+  if (lookahead_) {
+    lookahead_analysis = lookahead_->Get(pic->GetPicData()->GetPoc());
+    pic->SetLookaheadAnalysis(lookahead_analysis);
+  }
+  int segment_qp = segment_qp_;
+  if (target_bitrate_ > 0) {
+    if (!rate_control_) {
+      rate_control_.reset(
+        new RateControl(target_bitrate_, framerate_, vbv_buffer_size_,
+                        segment_header_->GetInternalWidth(),
+                        segment_header_->GetInternalHeight()));
+    }
+    segment_qp =
+      rate_control_->SelectQp(pic->GetPicData()->GetTid(),
+                              pic->GetPicData()->IsIntraPic(), sub_gop_length,
+                              EstimateComplexity(*pic,
+                                                 lookahead_analysis.get()));
+  }
+  if (encoder_settings_.motion_field_seeding > 0) {
+    pic->SetColocatedMotionField(
+      FindColocatedMotionField(*pic->GetPicData()));
+  }
+  if (encoder_settings_.parallel_split_rdo > 0 && !split_rdo_pool_) {
+    split_rdo_pool_.reset(
+      new SplitRdoPool(simd_, encoder_settings_.parallel_split_rdo));
+  }
+  pic->SetSplitRdoPool(split_rdo_pool_.get());
+  if (segment_header.num_tile_columns * segment_header.num_tile_rows > 1 &&
+      !tile_thread_pool_) {
+    tile_thread_pool_.reset(new TileThreadPool(num_threads_));
+  }
+  pic->SetTileThreadPool(tile_thread_pool_.get());
+  pic->SetLadderLinks(ladder_upstream_.get(), ladder_downstream_.get());
+
   // Bitstream reference valid until next picture is coded
   std::vector<uint8_t> *pic_bytes =
-    pic->Encode(segment_header, segment_qp_, sub_gop_length, buffer_flag,
+    pic->Encode(segment_header, segment_qp, sub_gop_length, buffer_flag,
                 flat_lambda_, encoder_settings_);
+  if (rate_control_) {
+    rate_control_->Update(
+      pic_bytes->size() * 8,
+      pic->GetPicData()->GetPicQp()->GetQpRaw(YuvComponent::kY));
+  }
+  // Later pictures only read the temporal mv field
+  pic->GetPicData()->ReleaseCus();
 
   // When a picture has been encoded, the picture data is put into
   // the xvc_enc_nal_unit struct to be delivered through the API.
@@ -248,7 +393,7 @@ void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic,
   nal.bytes = &(*pic_bytes)[0];
   nal.size = pic_bytes->size();
   nal.buffer_flag = buffer_flag;
-  SetNalStats(*pic->GetPicData(), &nal);
+  SetNalStats(*pic->GetPicData(), pic->GetPerfStats(), &nal);
   nal_units_.push_back(nal);
 
   // Decoding order counter is increased each time a picture has been encoded.
@@ -291,7 +436,8 @@ std::shared_ptr<PictureEncoder> Encoder::GetNewPictureEncoder() {
                                        segment_header_->chroma_format,
                                        segment_header_->GetInternalWidth(),
                                        segment_header_->GetInternalHeight(),
-                                       segment_header_->internal_bitdepth);
+                                       segment_header_->internal_bitdepth,
+                                       cu_storage_pool_);
     pic_encoders_.push_back(pic);
     return pic;
   }
@@ -317,7 +463,57 @@ std::shared_ptr<PictureEncoder> Encoder::GetNewPictureEncoder() {
   return pic_enc;
 }
 
-void Encoder::SetNalStats(const PictureData &pic_data, xvc_enc_nal_unit *nal) {
+std::shared_ptr<const MotionField>
+Encoder::FindColocatedMotionField(const PictureData &pic_data) const {
+  // Use the motion of the first reference picture that has any, i.e. that
+  // is not an intra picture
+  const ReferencePictureLists *ref_pic_lists = pic_data.GetRefPicLists();
+  for (RefPicList ref_list : { RefPicList::kL0, RefPicList::kL1 }) {
+    if (ref_pic_lists->GetNumRefPics(ref_list) == 0) {
+      continue;
+    }
+    PicNum ref_poc = ref_pic_lists->GetRefPoc(ref_list, 0);
+    for (auto &pic : pic_encoders_) {
+      auto motion_field = pic->GetMotionField();
+      if (pic->GetPicData()->GetPoc() == ref_poc && motion_field &&
+          !motion_field->IsEmpty()) {
+        return motion_field;
+      }
+    }
+  }
+  return std::shared_ptr<const MotionField>();
+}
+
+double Encoder::EstimateComplexity(
+  const PictureEncoder &pic,
+  const Lookahead::PictureAnalysis *analysis) const {
+  double complexity = RateControl::CalcSpatialComplexity(*pic.GetOrigPic());
+  // Inter pictures are scaled by how well they are predicted from the
+  // previous picture according to the lookahead
+  if (analysis && !pic.GetPicData()->IsIntraPic()) {
+    Distortion intra_cost = std::max(analysis->GetIntraCost(),
+                                     static_cast<Distortion>(1));
+    complexity *= static_cast<double>(analysis->GetInterCost()) / intra_cost;
+  }
+  return complexity;
+}
+
+PicNum Encoder::SelectSubGopLength(bool scene_cut) {
+  // The Sub Gop length can only change at a segment start. Use a shorter
+  // Sub Gop when the pictures since the last key picture had high motion
+  // since prediction over long distances is then less efficient.
+  if (scene_cut || max_sub_gop_length_ < 2 || max_sub_gop_length_ % 2 != 0) {
+    return max_sub_gop_length_;
+  }
+  double ratio = lookahead_->GetInterIntraRatio(doc_ + 1, poc_);
+  if (ratio > kHighMotionInterIntraRatio) {
+    return max_sub_gop_length_ / 2;
+  }
+  return max_sub_gop_length_;
+}
+
+void Encoder::SetNalStats(const PictureData &pic_data,
+                          const PerfStats *perf_stats, xvc_enc_nal_unit *nal) {
   nal->stats.nal_unit_type =
     static_cast<uint32_t>(pic_data.GetNalType());
 
@@ -349,6 +545,25 @@ void Encoder::SetNalStats(const PictureData &pic_data, xvc_enc_nal_unit *nal) {
       nal->stats.l1[i] = -1;
     }
   }
+
+  // Time spent per stage, only measured when built with tracing enabled.
+  static const std::array<PerfStage, XVC_ENC_STAGE_TOTAL_NUMBER> kStages = { {
+    PerfStage::kIntraSearch, PerfStage::kInterSearch, PerfStage::kRdoQuant,
+    PerfStage::kCabacWrite, PerfStage::kDeblock, PerfStage::kPadBorder,
+    PerfStage::kChecksum, PerfStage::kIntraAnalysis,
+  } };
+  for (int i = 0; i < XVC_ENC_STAGE_TOTAL_NUMBER; i++) {
+    nal->stats.stage_time_us[i] =
+      perf_stats ? perf_stats->GetMicroseconds(kStages[i]) : 0;
+  }
+  static const std::array<PerfCounter, XVC_ENC_COUNTER_TOTAL_NUMBER>
+    kCounters = { {
+      PerfCounter::kInterPredCacheLookup, PerfCounter::kInterPredCacheHit,
+    } };
+  for (int i = 0; i < XVC_ENC_COUNTER_TOTAL_NUMBER; i++) {
+    nal->stats.counters[i] =
+      perf_stats ? perf_stats->GetCount(kCounters[i]) : 0;
+  }
 }
 
 }   // namespace xvc
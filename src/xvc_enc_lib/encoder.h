@@ -31,20 +31,38 @@
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/simd_functions.h"
 #include "xvc_enc_lib/bit_writer.h"
+#include "xvc_enc_lib/ladder_link.h"
+#include "xvc_enc_lib/lookahead.h"
 #include "xvc_enc_lib/picture_encoder.h"
+#include "xvc_enc_lib/rate_control.h"
+#include "xvc_enc_lib/split_rdo_pool.h"
 #include "xvc_enc_lib/encoder_settings.h"
 
 struct xvc_encoder {};
 
 namespace xvc {
 
+class AsyncEncoder;
+
 class Encoder : public xvc_encoder {
 public:
   Encoder();
+  ~Encoder();
   int Encode(const uint8_t *pic_bytes, xvc_enc_nal_unit **nal_units,
              bool output_rec, xvc_enc_pic_buffer *rec_pic);
+  int Encode(const uint8_t *const planes[constants::kMaxYuvComponents],
+             const ptrdiff_t strides[constants::kMaxYuvComponents],
+             xvc_enc_nal_unit **nal_units, bool output_rec,
+             xvc_enc_pic_buffer *rec_pic);
   int Flush(xvc_enc_nal_unit **nal_units, bool output_rec,
             xvc_enc_pic_buffer *rec_pic);
+  // Switches the encoder to asynchronous encoding on first use
+  AsyncEncoder* GetAsyncEncoder();
+  // Reuse the analysis of upstream, an encoder of the same input with the
+  // same parameters except for qp. Must be called before any picture is
+  // given to either encoder. Returns false if the encoders can not be linked.
+  bool SetLadderUpstream(Encoder *upstream);
+  bool IsAsync() const { return async_encoder_ != nullptr; }
   const SegmentHeader* GetCurrentSegment() const {
     return segment_header_.get();
   }
@@ -73,6 +91,7 @@ public:
   void SetFramerate(double rate) { framerate_ = rate; }
   void SetSubGopLength(PicNum sub_gop_length) {
     segment_header_->max_sub_gop_length = sub_gop_length;
+    max_sub_gop_length_ = sub_gop_length;
     pic_buffering_num_ = sub_gop_length + segment_header_->num_ref_pics;
   }
   void SetSegmentLength(PicNum length) { segment_length_ = length; }
@@ -91,26 +110,55 @@ public:
   void SetDeblock(int deblock) { segment_header_->deblock = deblock; }
   void SetBetaOffset(int offset) { segment_header_->beta_offset = offset; }
   void SetTcOffset(int offset) { segment_header_->tc_offset = offset; }
+  void SetTiles(int num_tile_columns, int num_tile_rows) {
+    segment_header_->num_tile_columns = num_tile_columns;
+    segment_header_->num_tile_rows = num_tile_rows;
+  }
+  // Threads coding the tiles of a picture, negative for one per cpu core
+  void SetNumThreads(int num_threads) { num_threads_ = num_threads; }
   void SetQp(int qp) {
     segment_qp_ =
       util::Clip3(qp, constants::kMinAllowedQp, constants::kMaxAllowedQp);
   }
+  // Bitrate in kbit/s (0 for constant qp) and VBV buffer size in kbit
+  void SetRateControl(int bitrate, int vbv_buffer_size) {
+    target_bitrate_ = 1000.0 * bitrate;
+    vbv_buffer_size_ = 1000.0 * vbv_buffer_size;
+  }
   void SetFlatLambda(bool flat_lambda) { flat_lambda_ = flat_lambda; }
   void SetChecksumMode(Checksum::Mode mode) {
     segment_header_->checksum_mode = mode;
   }
+  void SetAsyncQueueSizes(int input_queue_size, int output_queue_size) {
+    async_input_queue_size_ = input_queue_size;
+    async_output_queue_size_ = output_queue_size;
+  }
 
   const EncoderSettings& GetEncoderSettings() { return encoder_settings_; }
   void SetEncoderSettings(const EncoderSettings &settings);
 
 private:
+  // Average inter to intra cost ratio above which Sub Gop length is reduced
+  static constexpr double kHighMotionInterIntraRatio = 0.4;
+
   void EncodeOnePicture(std::shared_ptr<PictureEncoder> pic,
                         PicNum sub_gop_length);
   void ReconstructOnePicture(bool output_rec,
                              xvc_enc_pic_buffer *rec_pic);
   std::shared_ptr<PictureEncoder> GetNewPictureEncoder();
+  std::shared_ptr<PictureEncoder> PrepareNewPicture();
+  bool IsResamplingInput() const;
+  int EncodePicture(std::shared_ptr<PictureEncoder> pic_enc,
+                    xvc_enc_nal_unit **nal_units, bool output_rec,
+                    xvc_enc_pic_buffer *rec_pic);
+  PicNum SelectSubGopLength(bool scene_cut);
+  double EstimateComplexity(const PictureEncoder &pic,
+                            const Lookahead::PictureAnalysis *analysis) const;
+  std::shared_ptr<const MotionField>
+    FindColocatedMotionField(const PictureData &pic_data) const;
 
-  void SetNalStats(const PictureData &pic_data, xvc_enc_nal_unit *nal);
+  void SetNalStats(const PictureData &pic_data, const PerfStats *perf_stats,
+                   xvc_enc_nal_unit *nal);
 
   int input_bitdepth_ = 8;
   bool encode_with_buffer_flag_ = false;
@@ -123,18 +171,37 @@ private:
   bool curr_segment_open_gop_ = false;
   PicNum poc_ = 0;
   PicNum doc_ = 0;
+  PicNum segment_start_poc_ = 0;
+  PicNum closed_gop_start_poc_ = 0;
+  PicNum max_sub_gop_length_ = 0;
   SegmentNum soc_ = std::numeric_limits<SegmentNum>::max();
   PicNum pic_buffering_num_ = 1;
   PicNum segment_length_ = 1;
   PicNum closed_gop_interval_ = std::numeric_limits<PicNum>::max();
   int segment_qp_ = std::numeric_limits<int>::max();
+  double target_bitrate_ = 0;
+  double vbv_buffer_size_ = 0;
   bool flat_lambda_ = false;
+  int num_threads_ = -1;
   SimdFunctions simd_;
   EncoderSettings encoder_settings_;
+  std::unique_ptr<Lookahead> lookahead_;
+  std::unique_ptr<SplitRdoPool> split_rdo_pool_;
+  std::unique_ptr<TileThreadPool> tile_thread_pool_;
+  std::unique_ptr<RateControl> rate_control_;
+  std::shared_ptr<LadderLink> ladder_upstream_;
+  std::shared_ptr<LadderLink> ladder_downstream_;
   std::vector<std::shared_ptr<PictureEncoder>> pic_encoders_;
+  // Cu objects of coded pictures, handed over to the next picture to encode
+  std::shared_ptr<PictureData::CuStoragePool> cu_storage_pool_ =
+    std::make_shared<PictureData::CuStoragePool>();
   std::vector<uint8_t> output_pic_bytes_;
   BitWriter bit_writer_;
   std::vector<xvc_enc_nal_unit> nal_units_;
+  int async_input_queue_size_ = 0;
+  int async_output_queue_size_ = 0;
+  // Declared last so that the encoder thread is stopped first
+  std::unique_ptr<AsyncEncoder> async_encoder_;
 };
 
 }   // namespace xvc
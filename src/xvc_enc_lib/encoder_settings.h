@@ -23,10 +23,19 @@
 
 namespace xvc {
 
+// Trade-offs relative kSlow, measured single threaded on two synthetic
+// 352x288 sequences (one with a scene cut), sub gop length 8, qp 27-42:
+//   kPlacebo:   0.15-0.2x speed, BD-rate  -1.1%
+//   kMedium:    1.6x      speed, BD-rate  +1.6%
+//   kFast:      3.8-8x    speed, BD-rate  +6.0%
+//   kUltraFast: 14-27x    speed, BD-rate +14.1%
 enum struct SpeedMode {
   kPlacebo = 0,
   kSlow = 1,
-  kTotalNumber = 2,
+  kMedium = 2,
+  kFast = 3,
+  kUltraFast = 4,
+  kTotalNumber = 5,
 };
 
 enum struct TuneMode {
@@ -46,6 +55,9 @@ struct EncoderSettings {
         always_evaluate_intra_in_inter = 1;
         default_num_ref_pics = 3;
         max_binary_split_depth = 3;
+        fast_merge_skip_termination = 0;
+        binary_split_gradient_pruning = 0;
+        rdo_quant = 1;
         break;
       case SpeedMode::kSlow:
         fast_intra_mode_eval_level = 1;
@@ -54,6 +66,50 @@ struct EncoderSettings {
         always_evaluate_intra_in_inter = 0;
         default_num_ref_pics = 2;
         max_binary_split_depth = 2;
+        fast_merge_skip_termination = 0;
+        binary_split_gradient_pruning = 0;
+        rdo_quant = 1;
+        break;
+      case SpeedMode::kMedium:
+        fast_intra_mode_eval_level = 2;
+        fast_merge_eval = 1;
+        bipred_refinement_iterations = 1;
+        always_evaluate_intra_in_inter = 0;
+        default_num_ref_pics = 2;
+        max_binary_split_depth = 2;
+        fast_merge_skip_termination = 1;
+        binary_split_gradient_pruning = 1;
+        rdo_quant = 1;
+        intra_mode_preselection = 1;
+        motion_field_seeding = 1;
+        break;
+      case SpeedMode::kFast:
+        fast_intra_mode_eval_level = 3;
+        fast_merge_eval = 1;
+        bipred_refinement_iterations = 1;
+        always_evaluate_intra_in_inter = 0;
+        default_num_ref_pics = 2;
+        max_binary_split_depth = 1;
+        fast_merge_skip_termination = 1;
+        binary_split_gradient_pruning = 1;
+        rdo_quant = 2;
+        lookahead = 1;
+        intra_mode_preselection = 2;
+        motion_field_seeding = 1;
+        break;
+      case SpeedMode::kUltraFast:
+        fast_intra_mode_eval_level = 3;
+        fast_merge_eval = 1;
+        bipred_refinement_iterations = 1;
+        always_evaluate_intra_in_inter = 0;
+        default_num_ref_pics = 1;
+        max_binary_split_depth = 0;
+        fast_merge_skip_termination = 1;
+        binary_split_gradient_pruning = 1;
+        rdo_quant = 0;
+        lookahead = 1;
+        intra_mode_preselection = 2;
+        motion_field_seeding = 1;
         break;
       default:
         assert(0);
@@ -75,6 +131,9 @@ struct EncoderSettings {
         smooth_lambda_scaling = 0;
         default_num_ref_pics = 2;
         max_binary_split_depth = 0;
+        fast_merge_skip_termination = 0;
+        binary_split_gradient_pruning = 0;
+        rdo_quant = 1;
         adaptive_qp = 0;
         chroma_qp_offset_table = 1;
         chroma_qp_offset_u = 0;
@@ -91,6 +150,9 @@ struct EncoderSettings {
         smooth_lambda_scaling = 0;
         default_num_ref_pics = 2;
         max_binary_split_depth = 2;
+        fast_merge_skip_termination = 0;
+        binary_split_gradient_pruning = 0;
+        rdo_quant = 1;
         adaptive_qp = 0;
         chroma_qp_offset_table = 1;
         chroma_qp_offset_u = 1;
@@ -127,13 +189,13 @@ struct EncoderSettings {
                 "Fast bit counting should use strict rdo bit signaling");
 
   // Fast encoder decisions (always used)
-  static const bool rdo_quant = true;
   static const bool rdo_quant_size_2 = false;
   static const bool fast_cu_split_based_on_full_cu = true;
   static const bool fast_mode_selection_for_cached_cu = true;
   static const bool skip_mode_decision_for_identical_cu = false;
   static const bool fast_inter_cbf_dist = true;  // not really any impact
   static const bool fast_inter_root_cbf_zero_bits = true;  // very small loss
+  static const bool inter_pred_cache = true;  // no loss
 
   // Speed mode dependent settings
   int fast_intra_mode_eval_level = -1;
@@ -142,6 +204,9 @@ struct EncoderSettings {
   int always_evaluate_intra_in_inter = -1;
   int default_num_ref_pics = -1;
   int max_binary_split_depth = -1;
+  int fast_merge_skip_termination = -1;
+  int binary_split_gradient_pruning = -1;
+  int rdo_quant = -1;
 
   // Setting with default values used in all speed modes
   int fast_quad_split_based_on_binary_split = 1;
@@ -152,6 +217,12 @@ struct EncoderSettings {
   double aqp_strength = 1.0;
   int structural_ssd = 0;
   int encapsulation_mode = 0;
+  int lookahead = 0;
+  int early_split_termination = 0;
+  int parallel_split_rdo = 0;
+  int intra_mode_preselection = 0;
+  int motion_field_seeding = 0;
+  int ladder_split_depth_bound = 1;
   int chroma_qp_offset_table = 1;
   int chroma_qp_offset_u = 0;
   int chroma_qp_offset_v = 0;
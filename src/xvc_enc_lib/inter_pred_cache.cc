@@ -0,0 +1,122 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/inter_pred_cache.h"
+
+#include <cstring>
+
+#include "xvc_common_lib/perf_trace.h"
+
+namespace xvc {
+
+bool InterPredCache::Key::operator==(const Key &other) const {
+  return comp == other.comp && posx == other.posx && posy == other.posy &&
+    width == other.width && height == other.height &&
+    inter_dir == other.inter_dir && ref_idx == other.ref_idx &&
+    mv == other.mv;
+}
+
+InterPredCache::~InterPredCache() {
+  XVC_PERF_COUNT(kInterPredCacheLookup, num_lookups_);
+  XVC_PERF_COUNT(kInterPredCacheHit, num_hits_);
+}
+
+bool InterPredCache::Lookup(const CodingUnit &cu, YuvComponent comp,
+                            Sample *pred, ptrdiff_t pred_stride) {
+  const Key key = GetKey(cu, comp);
+  const Entry &entry = entries_[GetEntryIndex(key)];
+  num_lookups_++;
+  if (entry.generation != generation_ || !(entry.key == key)) {
+    return false;
+  }
+  num_hits_++;
+  const Sample *src = &entry.samples[0];
+  for (int y = 0; y < key.height; y++) {
+    std::memcpy(pred, src, key.width * sizeof(Sample));
+    src += key.width;
+    pred += pred_stride;
+  }
+  return true;
+}
+
+void InterPredCache::Store(const CodingUnit &cu, YuvComponent comp,
+                           const Sample *pred, ptrdiff_t pred_stride) {
+  const Key key = GetKey(cu, comp);
+  Entry &entry = entries_[GetEntryIndex(key)];
+  entry.key = key;
+  entry.generation = generation_;
+  if (entry.samples.size() < static_cast<size_t>(key.width * key.height)) {
+    entry.samples.resize(key.width * key.height);
+  }
+  Sample *dst = &entry.samples[0];
+  for (int y = 0; y < key.height; y++) {
+    std::memcpy(dst, pred, key.width * sizeof(Sample));
+    dst += key.width;
+    pred += pred_stride;
+  }
+}
+
+void InterPredCache::Invalidate() {
+  generation_++;
+  if (!generation_) {
+    // Wrapped around, entries from the first generation could match again
+    for (Entry &entry : entries_) {
+      entry.generation = 0;
+    }
+    generation_ = 1;
+  }
+}
+
+InterPredCache::Key InterPredCache::GetKey(const CodingUnit &cu,
+                                           YuvComponent comp) {
+  Key key;
+  key.comp = static_cast<int>(comp);
+  key.posx = cu.GetPosX(comp);
+  key.posy = cu.GetPosY(comp);
+  key.width = cu.GetWidth(comp);
+  key.height = cu.GetHeight(comp);
+  key.inter_dir = cu.GetInterDir();
+  for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+    const RefPicList ref_list = static_cast<RefPicList>(i);
+    // Motion of an unused list does not affect the prediction
+    if (cu.HasMv(ref_list)) {
+      key.ref_idx[i] = cu.GetRefIdx(ref_list);
+      key.mv[i] = cu.GetMv(ref_list);
+    } else {
+      key.ref_idx[i] = -1;
+      key.mv[i] = MotionVector(0, 0);
+    }
+  }
+  return key;
+}
+
+int InterPredCache::GetEntryIndex(const Key &key) {
+  uint32_t hash = static_cast<uint32_t>(key.posx) * 73856093u ^
+    static_cast<uint32_t>(key.posy) * 19349663u ^
+    static_cast<uint32_t>(key.width * 64 + key.height) * 83492791u ^
+    static_cast<uint32_t>(key.comp * 4 + static_cast<int>(key.inter_dir));
+  for (int i = 0; i < 2; i++) {
+    hash = hash * 31u + static_cast<uint32_t>(key.ref_idx[i]);
+    hash = hash * 31u + static_cast<uint32_t>(key.mv[i].x);
+    hash = hash * 31u + static_cast<uint32_t>(key.mv[i].y);
+  }
+  hash ^= hash >> 16;
+  return static_cast<int>(hash & (kNumEntries - 1));
+}
+
+}   // namespace xvc
@@ -0,0 +1,84 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_INTER_PRED_CACHE_H_
+#define XVC_ENC_LIB_INTER_PRED_CACHE_H_
+
+#include <array>
+#include <vector>
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/sample_buffer.h"
+
+namespace xvc {
+
+// Cache of motion compensated predictions for the current ctu. During rdo
+// the same prediction (block, reference pictures and motion vectors) is
+// requested several times, e.g. a merge candidate is first evaluated with
+// satd and then again with and without residual, and the same block is
+// reached through more than one split configuration. Since reference
+// pictures do not change while a picture is encoded a cached prediction is
+// valid for the whole picture, entries are only dropped for each new ctu
+// to keep the cache small.
+class InterPredCache {
+public:
+  // The cache lives for one picture, lookups and hits are added to the perf
+  // stats of the picture when it is destroyed
+  ~InterPredCache();
+  // Copies a cached prediction of cu to pred, returns false on miss
+  bool Lookup(const CodingUnit &cu, YuvComponent comp, Sample *pred,
+              ptrdiff_t pred_stride);
+  void Store(const CodingUnit &cu, YuvComponent comp, const Sample *pred,
+             ptrdiff_t pred_stride);
+  void Invalidate();
+  uint64_t GetNumLookups() const { return num_lookups_; }
+  uint64_t GetNumHits() const { return num_hits_; }
+
+private:
+  // Direct mapped, must be a power of two
+  static const int kNumEntries = 64;
+  struct Key {
+    bool operator==(const Key &other) const;
+    int comp;
+    int posx;
+    int posy;
+    int width;
+    int height;
+    InterDir inter_dir;
+    std::array<int, 2> ref_idx;
+    std::array<MotionVector, 2> mv;
+  };
+  struct Entry {
+    Key key;
+    uint32_t generation = 0;
+    std::vector<Sample> samples;
+  };
+  static Key GetKey(const CodingUnit &cu, YuvComponent comp);
+  static int GetEntryIndex(const Key &key);
+
+  std::array<Entry, kNumEntries> entries_;
+  // Entries stored in an older generation are invalid
+  uint32_t generation_ = 1;
+  uint64_t num_lookups_ = 0;
+  uint64_t num_hits_ = 0;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_INTER_PRED_CACHE_H_
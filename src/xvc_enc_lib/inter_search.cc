@@ -26,8 +26,8 @@
 
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/utils.h"
+#include "xvc_enc_lib/bit_estimator.h"
 #include "xvc_enc_lib/inter_tz_search.h"
-#include "xvc_enc_lib/cu_writer.h"
 
 namespace xvc {
 
@@ -41,6 +41,7 @@ static const std::array<std::array<int8_t, 2>, 9> kSquareXYQpel = { {
 InterSearch::InterSearch(const SimdFunctions &simd, int bitdepth,
                          int max_components, const YuvPicture &orig_pic,
                          const ReferencePictureLists &ref_pic_list,
+                         MotionField *motion_field,
                          const EncoderSettings &encoder_settings)
   : InterPrediction(simd.inter_prediction, bitdepth),
   bitdepth_(bitdepth),
@@ -48,7 +49,9 @@ InterSearch::InterSearch(const SimdFunctions &simd, int bitdepth,
   orig_pic_(orig_pic),
   encoder_settings_(encoder_settings),
   bipred_orig_buffer_(constants::kMaxBlockSize, constants::kMaxBlockSize),
-  bipred_pred_buffer_(constants::kMaxBlockSize, constants::kMaxBlockSize) {
+  bipred_pred_buffer_(constants::kMaxBlockSize, constants::kMaxBlockSize),
+  motion_field_(encoder_settings.motion_field_seeding > 0 ?
+                motion_field : nullptr) {
   std::vector<int> l1_mapping;
   ref_pic_list.GetSamePocMappingFor(RefPicList::kL1, &l1_mapping);
   assert(l1_mapping.size() <= same_poc_in_l0_mapping_.size());
@@ -74,14 +77,16 @@ InterSearch::CompressInterFast(CodingUnit *cu, YuvComponent comp, const Qp &qp,
     // Write prediction directly to reconstruction
     SampleBuffer reco =
       rec_pic->GetSampleBuffer(comp, cu->GetPosX(comp), cu->GetPosY(comp));
-    MotionCompensation(*cu, comp, reco.GetDataPtr(), reco.GetStride());
+    MotionCompensationCached(*cu, comp, reco.GetDataPtr(),
+                             reco.GetStride());
     MetricType m = encoder_settings_.structural_ssd > 0 &&
       comp == YuvComponent::kY ? MetricType::kStructuralSsd : MetricType::kSsd;
     SampleMetric metric(m, qp, rec_pic->GetBitdepth());
     return metric.CompareSample(*cu, comp, orig_pic_, reco);
   } else {
     SampleBuffer &pred = encoder->GetPredBuffer();
-    MotionCompensation(*cu, comp, pred.GetDataPtr(), pred.GetStride());
+    MotionCompensationCached(*cu, comp, pred.GetDataPtr(),
+                             pred.GetStride());
     return encoder->TransformAndReconstruct(cu, comp, qp, bitstream_writer,
                                             orig_pic_, rec_pic);
   }
@@ -119,8 +124,8 @@ InterSearch::SearchMergeCandidates(CodingUnit *cu, const Qp &qp,
   std::array<std::pair<int, double>, max_merge_cand> cand_cost;
   for (int merge_idx = 0; merge_idx < max_merge_cand; merge_idx++) {
     ApplyMerge(cu, merge_list[merge_idx]);
-    MotionCompensation(*cu, YuvComponent::kY, pred_buffer.GetDataPtr(),
-                       pred_buffer.GetStride());
+    MotionCompensationCached(*cu, YuvComponent::kY, pred_buffer.GetDataPtr(),
+                             pred_buffer.GetStride());
     Distortion dist =
       metric.CompareSample(*cu, YuvComponent::kY, orig_pic_, pred_buffer);
     Bits bits = merge_idx + 1 - (merge_idx < max_merge_cand - 1 ? 0 : 1);
@@ -210,8 +215,8 @@ InterSearch::CompressAndEvalCbf(CodingUnit *cu, const Qp &qp,
       comp == YuvComponent::kY ? MetricType::kStructuralSsd : MetricType::kSsd;
     SampleMetric metric(m, qp, bitdepth_);
     SampleBuffer &pred_buffer = encoder->GetPredBuffer();
-    MotionCompensation(*cu, comp, pred_buffer.GetDataPtr(),
-                       pred_buffer.GetStride());
+    MotionCompensationCached(*cu, comp, pred_buffer.GetDataPtr(),
+                             pred_buffer.GetStride());
     Distortion dist_orig =
       encoder->TransformAndReconstruct(cu, comp, qp, bitstream_writer,
                                        orig_pic_, rec_pic);
@@ -258,7 +263,8 @@ InterSearch::CompressAndEvalCbf(CodingUnit *cu, const Qp &qp,
     // TODO(Dev) Faster to save and reuse predicition buffers
     SampleBuffer reco =
       rec_pic->GetSampleBuffer(comp, cu->GetPosX(comp), cu->GetPosY(comp));
-    MotionCompensation(*cu, comp, reco.GetDataPtr(), reco.GetStride());
+    MotionCompensationCached(*cu, comp, reco.GetDataPtr(),
+                             reco.GetStride());
   }
   cu->SetRootCbf(cu->GetHasAnyCbf());
   cu->SetSkipFlag(cu->GetMergeFlag() && !cu->GetRootCbf());
@@ -282,8 +288,8 @@ InterSearch::CompressSkipOnly(CodingUnit *cu, const Qp &qp,
     int posx = cu->GetPosX(comp);
     int posy = cu->GetPosY(comp);
     SampleBuffer reco_buffer = rec_pic->GetSampleBuffer(comp, posx, posy);
-    MotionCompensation(*cu, comp, reco_buffer.GetDataPtr(),
-                       reco_buffer.GetStride());
+    MotionCompensationCached(*cu, comp, reco_buffer.GetDataPtr(),
+                             reco_buffer.GetStride());
     cu->SetCbf(comp, false);
     Distortion dist = metric.CompareSample(*cu, comp, orig_pic_, reco_buffer);
     sum_dist += dist;
@@ -313,8 +319,8 @@ InterSearch::SearchBiIterative(CodingUnit *cu, const Qp &qp,
     // If searching in L1 use original without L0 prediction
     cu->SetInterDir(search_list == RefPicList::kL0 ?
                     InterDir::kL1 : InterDir::kL0);
-    MotionCompensation(*cu, comp, bipred_pred_buffer_.GetDataPtr(),
-                       bipred_pred_buffer_.GetStride());
+    MotionCompensationCached(*cu, comp, bipred_pred_buffer_.GetDataPtr(),
+                             bipred_pred_buffer_.GetStride());
     bipred_orig_buffer_.SubtractWeighted(width, height, orig_luma,
                                          bipred_pred_buffer_);
     cu->SetInterDir(InterDir::kBi);
@@ -341,7 +347,8 @@ InterSearch::SearchRefIdx(CodingUnit *cu, const Qp &qp, RefPicList ref_list,
                           CodingUnit::InterState *best_state,
                           CodingUnit::InterState *best_state_unique,
                           Distortion *out_cost_unique) {
-  const int num_ref_idx = cu->GetRefPicLists()->GetNumRefPics(ref_list);
+  const int num_ref_idx =
+    std::min(cu->GetRefPicLists()->GetNumRefPics(ref_list), max_num_ref_idx_);
   const uint32_t lambda =
     static_cast<uint32_t>(std::floor(65536.0 * qp.GetLambdaSqrt()));
   const bool bipred = cu->GetInterDir() == InterDir::kBi;
@@ -372,7 +379,8 @@ InterSearch::SearchRefIdx(CodingUnit *cu, const Qp &qp, RefPicList ref_list,
     Distortion dist = 0;
     MotionVector mv_subpel;
     if (!bipred && ref_list == RefPicList::kL1 &&
-        same_poc_in_l0_mapping_[ref_idx] >= 0) {
+        same_poc_in_l0_mapping_[ref_idx] >= 0 &&
+        same_poc_in_l0_mapping_[ref_idx] < max_num_ref_idx_) {
       // Encoder speed-up for already searched ref pictures in L0
       int l0_list_idx = static_cast<int>(RefPicList::kL0);
       int l0_ref_idx = same_poc_in_l0_mapping_[ref_idx];
@@ -441,16 +449,22 @@ InterSearch::MotionEstimation(const CodingUnit &cu, const Qp &qp,
                       kSearchRangeBi, &clip_min, &clip_max);
   }
 
+  const PicNum ref_poc = cu.GetRefPicLists()->GetRefPoc(ref_list, ref_idx);
   MotionVector mv_fullpel;
   if (search_method == SearchMethod::FullSearch) {
     mv_fullpel = FullSearch(cu, qp, mvp, *ref_pic, clip_min, clip_max);
   } else if (search_method == SearchMethod::TzSearch) {
     MetricType metric_type = GetFullpelMetric(cu);
+    MotionField::Candidates field_cands;
+    if (motion_field_) {
+      motion_field_->GetCandidates(cu, ref_poc, &field_cands);
+    }
     TzSearch tz_search(bitdepth_, orig_pic_, *this, encoder_settings_,
                        kSearchRangeUni);
     mv_fullpel =
       tz_search.Search(cu, qp, metric_type, mvp, *ref_pic, clip_min, clip_max,
-                       previous_fullpel_[static_cast<int>(ref_list)][ref_idx]);
+                       previous_fullpel_[static_cast<int>(ref_list)][ref_idx],
+                       field_cands);
     previous_fullpel_[static_cast<int>(ref_list)][ref_idx] = mv_fullpel;
   } else {
     assert(0);
@@ -458,6 +472,9 @@ InterSearch::MotionEstimation(const CodingUnit &cu, const Qp &qp,
   MotionVector mv_subpel =
     SubpelSearch(cu, qp, *ref_pic, mvp, mv_fullpel, orig_buffer, pred,
                  pred_stride, out_dist);
+  if (motion_field_ && search_method == SearchMethod::TzSearch) {
+    motion_field_->Store(cu, ref_poc, mv_subpel);
+  }
   return mv_subpel;
 }
 
@@ -613,6 +630,26 @@ int InterSearch::EvalFinalMvpIdx(const CodingUnit &cu,
   return best_mvp_idx;
 }
 
+void InterSearch::MotionCompensationCached(const CodingUnit &cu,
+                                           YuvComponent comp, Sample *pred,
+                                           ptrdiff_t pred_stride) {
+  bool cacheable = EncoderSettings::inter_pred_cache;
+  if (cacheable && cu.GetInterDir() != InterDir::kBi && util::IsLuma(comp)) {
+    // Uni-prediction with fullpel mv is a plain copy, not worth caching
+    const MotionVector &mv = cu.GetMv(cu.GetInterDir() == InterDir::kL0 ?
+                                      RefPicList::kL0 : RefPicList::kL1);
+    const int frac_mask = (1 << constants::kMvPrecisionShift) - 1;
+    cacheable = ((mv.x | mv.y) & frac_mask) != 0;
+  }
+  if (cacheable && pred_cache_.Lookup(cu, comp, pred, pred_stride)) {
+    return;
+  }
+  MotionCompensation(cu, comp, pred, pred_stride);
+  if (cacheable) {
+    pred_cache_.Store(cu, comp, pred, pred_stride);
+  }
+}
+
 MetricType InterSearch::GetFullpelMetric(const CodingUnit & cu) {
   return cu.GetHeight(YuvComponent::kY) > 8 ?
     MetricType::kSadFast : MetricType::kSad;
@@ -650,11 +687,8 @@ Bits InterSearch::GetInterPredBits(const CodingUnit &cu,
       return bits;
     }
   } else {
-    const PictureData *pic_data = cu.GetPicData();
-    CuWriter cu_writer(*pic_data, nullptr);
-    RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
-    cu_writer.WriteInterPrediction(cu, YuvComponent::kY, &rdo_writer);
-    return rdo_writer.GetNumWrittenBits();
+    BitEstimator bit_estimator(bitstream_writer);
+    return bit_estimator.GetNumBits(bit_estimator.EstimateInterPrediction(cu));
   }
 }
 
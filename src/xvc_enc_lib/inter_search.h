@@ -29,6 +29,8 @@
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_common_lib/quantize.h"
 #include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/inter_pred_cache.h"
+#include "xvc_enc_lib/motion_field.h"
 #include "xvc_enc_lib/sample_metric.h"
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/transform_encoder.h"
@@ -38,10 +40,13 @@ namespace xvc {
 class InterSearch : public InterPrediction {
 public:
   using MergeCandLookup = std::array<int, constants::kNumInterMergeCandidates>;
+  using FullpelMvs = std::array<std::array<MotionVector,
+    constants::kMaxNumRefPics>, static_cast<int>(RefPicList::kTotalNumber)>;
 
   InterSearch(const SimdFunctions &simd, int bitdepth, int max_components,
               const YuvPicture &orig_pic,
               const ReferencePictureLists &ref_pic_list,
+              MotionField *motion_field,
               const EncoderSettings &encoder_settings);
 
 
@@ -61,6 +66,14 @@ public:
                             const InterMergeCandidateList &merge_list,
                             TransformEncoder *encoder,
                             MergeCandLookup *out_cand_list);
+  // Restrict motion search to the first num_ref_idx pictures in each list
+  void SetMaxNumRefIdx(int num_ref_idx) { max_num_ref_idx_ = num_ref_idx; }
+  // Fullpel search results used as start candidates for the next search
+  const FullpelMvs& GetPreviousFullpel() const { return previous_fullpel_; }
+  void SetPreviousFullpel(const FullpelMvs &mvs) { previous_fullpel_ = mvs; }
+  // Cached predictions are only kept for the current ctu
+  void InvalidatePredCache() { pred_cache_.Invalidate(); }
+  const InterPredCache& GetPredCache() const { return pred_cache_; }
 
 private:
   enum class SearchMethod { TzSearch, FullSearch };
@@ -125,6 +138,8 @@ private:
   int EvalFinalMvpIdx(const CodingUnit &cu,
                       const InterPredictorList &mvp_list,
                       const MotionVector &mv_final, int mvp_idx_start);
+  void MotionCompensationCached(const CodingUnit &cu, YuvComponent comp,
+                                Sample *pred, ptrdiff_t pred_stride);
   MetricType GetFullpelMetric(const CodingUnit &cu);
   Bits GetInterPredBits(const CodingUnit &cu,
                         const SyntaxWriter &bitstream_writer);
@@ -137,6 +152,7 @@ private:
   const int max_components_;
   const YuvPicture &orig_pic_;
   const EncoderSettings &encoder_settings_;
+  int max_num_ref_idx_ = constants::kMaxNumRefPics;
   ResidualBufferStorage bipred_orig_buffer_;
   SampleBufferStorage bipred_pred_buffer_;
   // Mapping of ref_idx from L1 to L0 when POC is same
@@ -149,8 +165,10 @@ private:
   std::array<std::array<Distortion, constants::kMaxNumRefPics>,
     static_cast<int>(RefPicList::kTotalNumber)> unipred_best_dist_;
   // Best fullpel search mv per ref list, ref idx and picture
-  std::array<std::array<MotionVector, constants::kMaxNumRefPics>,
-    static_cast<int>(RefPicList::kTotalNumber)> previous_fullpel_;
+  FullpelMvs previous_fullpel_;
+  // Uni-prediction search results of the picture, may be null
+  MotionField *motion_field_;
+  InterPredCache pred_cache_;
   friend class TzSearch;
 };
 
@@ -18,6 +18,9 @@
 
 #include "xvc_enc_lib/inter_tz_search.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <cmath>
 
 #include "xvc_common_lib/restrictions.h"
@@ -25,6 +28,27 @@
 
 namespace xvc {
 
+struct TzSearch::CandidateList {
+  // Largest diamond pattern evaluates 16 points
+  static const int kMaxNumCand = 16;
+  struct Candidate {
+    int mv_x;
+    int mv_y;
+    int position;
+    int range;
+  };
+  void Add(int mv_x, int mv_y, int position, int range) {
+    assert(num < kMaxNumCand);
+    cand[num].mv_x = mv_x;
+    cand[num].mv_y = mv_y;
+    cand[num].position = position;
+    cand[num].range = range;
+    num++;
+  }
+  std::array<Candidate, kMaxNumCand> cand;
+  int num = 0;
+};
+
 template<typename TOrig>
 class TzSearch::DistortionWrapper {
 public:
@@ -47,6 +71,16 @@ public:
                                  src2_ptr, stride2_);
   }
 
+  void GetDistBatch(const CandidateList::Candidate *cands, int num_cands,
+                    Distortion *out_dist) {
+    std::array<const Sample*, SampleMetric::kMaxBatchSize> src2_ptr;
+    for (int i = 0; i < num_cands; i++) {
+      src2_ptr[i] = src2_ + cands[i].mv_y * stride2_ + cands[i].mv_x;
+    }
+    metric_.CompareSampleBatch(comp_, width_, height_, src1_, stride1_,
+                               &src2_ptr[0], stride2_, num_cands, out_dist);
+  }
+
 private:
   YuvComponent comp_;
   int width_;
@@ -79,8 +113,11 @@ MotionVector
 TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
                  const MotionVector &mvp, const YuvPicture &ref_pic,
                  const MotionVector &mv_min, const MotionVector &mv_max,
-                 const MotionVector &prev_search) {
+                 const MotionVector &prev_search,
+                 const MotionField::Candidates &field_cands) {
   static const int kDiamondSearchThreshold = 3;
+  // Rounds without improvement when starting from a motion field candidate
+  static const int kDiamondSearchThresholdSeeded = 1;
   static const int kFullSearchGranularity = 5;
   const YuvComponent comp = YuvComponent::kY;
   auto orig_buffer =
@@ -107,6 +144,7 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
   state.last_range_ = 0;
 
   // Check MV from previous CU search (can be either same or a different size)
+  bool eval_start_cands = false;
   if (cu.GetDepth() != 0 &&
       encoder_settings_.eval_prev_mv_search_result) {
     int prev_subpel_x = prev_search.x * (1 << constants::kMvPrecisionShift);
@@ -115,23 +153,40 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
     MotionVector prev_fullpel(prev_subpel_x >> constants::kMvPrecisionShift,
                               prev_subpel_y >> constants::kMvPrecisionShift);
     change_min_max |= CheckCostBest(&state, prev_fullpel.x, prev_fullpel.y);
-    if (change_min_max) {
-      int best_subpel_x = state.mv_best.x * (1 << constants::kMvPrecisionShift);
-      int best_subpel_y = state.mv_best.y * (1 << constants::kMvPrecisionShift);
-      inter_pred_.DetermineMinMaxMv(cu, ref_pic, best_subpel_x, best_subpel_y,
-                                    search_range_, &fullsearch_min,
-                                    &fullsearch_max);
-    }
+    eval_start_cands = true;
+  }
+
+  // Check motion of earlier searches around the same position
+  bool seeded = false;
+  for (int i = 0; i < field_cands.num; i++) {
+    int cand_subpel_x = field_cands.mv[i].x;
+    int cand_subpel_y = field_cands.mv[i].y;
+    inter_pred_.ClipMV(cu, ref_pic, &cand_subpel_x, &cand_subpel_y);
+    seeded |= CheckCostBest(&state,
+                            cand_subpel_x >> constants::kMvPrecisionShift,
+                            cand_subpel_y >> constants::kMvPrecisionShift);
+    eval_start_cands = true;
+  }
+  change_min_max |= seeded;
+  if (eval_start_cands && change_min_max) {
+    int best_subpel_x = state.mv_best.x * (1 << constants::kMvPrecisionShift);
+    int best_subpel_y = state.mv_best.y * (1 << constants::kMvPrecisionShift);
+    inter_pred_.DetermineMinMaxMv(cu, ref_pic, best_subpel_x, best_subpel_y,
+                                  search_range_, &fullsearch_min,
+                                  &fullsearch_max);
   }
 
   // Initial search around mvp
+  const int diamond_search_threshold =
+    seeded && encoder_settings_.motion_field_seeding > 1 ?
+    kDiamondSearchThresholdSeeded : kDiamondSearchThreshold;
   MotionVector mv_base = state.mv_best;
   int rounds_with_no_match = 0;
   for (int range = 1; range <= search_range_; range *= 2) {
     bool changed = FullpelDiamondSearch(&state, mv_base, range);
     if (changed) {
       rounds_with_no_match = 0;
-    } else if (++rounds_with_no_match >= kDiamondSearchThreshold) {
+    } else if (++rounds_with_no_match >= diamond_search_threshold) {
       break;
     }
   }
@@ -143,12 +198,8 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
   // Full search in search window
   if (state.last_range_ > kFullSearchGranularity) {
     state.last_range_ = kFullSearchGranularity;
-    const int step_size = kFullSearchGranularity;
-    for (int y = fullsearch_min.y; y <= fullsearch_max.y; y += step_size) {
-      for (int x = fullsearch_min.x; x <= fullsearch_max.x; x += step_size) {
-        CheckCostBest(&state, x, y);
-      }
-    }
+    FullpelRasterSearch(&state, fullsearch_min, fullsearch_max,
+                        kFullSearchGranularity);
   }
 
   // Iterative refinement of start position
@@ -169,90 +220,110 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
 
 bool TzSearch::FullpelDiamondSearch(SearchState *state,
                                     const MotionVector &mv_base, int range) {
-  bool mod = false;
+  CandidateList cands;
   if (range == 1) {
-    mod |= CheckCost1<Up>(state, mv_base.x, mv_base.y - range, range);
-    mod |= CheckCost1<Left>(state, mv_base.x - range, mv_base.y, range);
-    mod |= CheckCost1<Right>(state, mv_base.x + range, mv_base.y, range);
-    mod |= CheckCost1<Down>(state, mv_base.x, mv_base.y + range, range);
+    AddCand1<Up>(state, mv_base.x, mv_base.y - range, range, &cands);
+    AddCand1<Left>(state, mv_base.x - range, mv_base.y, range, &cands);
+    AddCand1<Right>(state, mv_base.x + range, mv_base.y, range, &cands);
+    AddCand1<Down>(state, mv_base.x, mv_base.y + range, range, &cands);
   } else if (range <= 8) {
     int r2 = range >> 1;
-    mod |= CheckCost1<Up>(state, mv_base.x, mv_base.y - range, range);
-    mod |= CheckCost2<Up, Left>(state, mv_base.x - r2, mv_base.y - r2, r2);
-    mod |= CheckCost2<Up, Right>(state, mv_base.x + r2, mv_base.y - r2, r2);
-    mod |= CheckCost1<Left>(state, mv_base.x - range, mv_base.y, range);
-    mod |= CheckCost1<Right>(state, mv_base.x + range, mv_base.y, range);
-    mod |= CheckCost2<Down, Left>(state, mv_base.x - r2, mv_base.y + r2, r2);
-    mod |= CheckCost2<Down, Right>(state, mv_base.x + r2, mv_base.y + r2, r2);
-    mod |= CheckCost1<Down>(state, mv_base.x, mv_base.y + range, range);
+    AddCand1<Up>(state, mv_base.x, mv_base.y - range, range, &cands);
+    AddCand2<Up, Left>(state, mv_base.x - r2, mv_base.y - r2, r2, &cands);
+    AddCand2<Up, Right>(state, mv_base.x + r2, mv_base.y - r2, r2, &cands);
+    AddCand1<Left>(state, mv_base.x - range, mv_base.y, range, &cands);
+    AddCand1<Right>(state, mv_base.x + range, mv_base.y, range, &cands);
+    AddCand2<Down, Left>(state, mv_base.x - r2, mv_base.y + r2, r2, &cands);
+    AddCand2<Down, Right>(state, mv_base.x + r2, mv_base.y + r2, r2, &cands);
+    AddCand1<Down>(state, mv_base.x, mv_base.y + range, range, &cands);
   } else {
-    mod |= CheckCost1<Up>(state, mv_base.x, mv_base.y - range, range);
-    mod |= CheckCost1<Left>(state, mv_base.x - range, mv_base.y, range);
-    mod |= CheckCost1<Right>(state, mv_base.x + range, mv_base.y, range);
-    mod |= CheckCost1<Down>(state, mv_base.x, mv_base.y + range, range);
+    AddCand1<Up>(state, mv_base.x, mv_base.y - range, range, &cands);
+    AddCand1<Left>(state, mv_base.x - range, mv_base.y, range, &cands);
+    AddCand1<Right>(state, mv_base.x + range, mv_base.y, range, &cands);
+    AddCand1<Down>(state, mv_base.x, mv_base.y + range, range, &cands);
     for (int i = 1; i < 4; i++) {
       int range14 = i * (range >> 2);
       int range34 = range - range14;
-      mod |= CheckCost2<Up, Left>(state, mv_base.x - range14,
-                                  mv_base.y - range34, range);
-      mod |= CheckCost2<Up, Right>(state, mv_base.x + range14,
-                                   mv_base.y - range34, range);
-      mod |= CheckCost2<Down, Left>(state, mv_base.x - range14,
-                                    mv_base.y + range34, range);
-      mod |= CheckCost2<Down, Right>(state, mv_base.x + range14,
-                                     mv_base.y + range34, range);
+      AddCand2<Up, Left>(state, mv_base.x - range14,
+                         mv_base.y - range34, range, &cands);
+      AddCand2<Up, Right>(state, mv_base.x + range14,
+                          mv_base.y - range34, range, &cands);
+      AddCand2<Down, Left>(state, mv_base.x - range14,
+                           mv_base.y + range34, range, &cands);
+      AddCand2<Down, Right>(state, mv_base.x + range14,
+                            mv_base.y + range34, range, &cands);
     }
   }
-  return mod;
+  return CheckCandidates(state, cands);
 }
 
 void TzSearch::FullpelNeighborPointSearch(SearchState *state) {
   const int r = 1;
   MotionVector mv_base = state->mv_best;
+  CandidateList cands;
   switch (state->last_position) {
     case Up::index + Left::index:
-      CheckCost1<Left>(state, mv_base.x - r, mv_base.y, r);
-      CheckCost1<Up>(state, mv_base.x, mv_base.y - r, r);
+      AddCand1<Left>(state, mv_base.x - r, mv_base.y, r, &cands);
+      AddCand1<Up>(state, mv_base.x, mv_base.y - r, r, &cands);
       break;
 
     case Up::index:
-      CheckCost2<Up, Left>(state, mv_base.x - r, mv_base.y - r, r);
-      CheckCost2<Up, Right>(state, mv_base.x + r, mv_base.y - r, r);
+      AddCand2<Up, Left>(state, mv_base.x - r, mv_base.y - r, r, &cands);
+      AddCand2<Up, Right>(state, mv_base.x + r, mv_base.y - r, r, &cands);
       break;
 
     case Up::index + Right::index:
-      CheckCost1<Up>(state, mv_base.x, mv_base.y - r, r);
-      CheckCost1<Right>(state, mv_base.x + r, mv_base.y, r);
+      AddCand1<Up>(state, mv_base.x, mv_base.y - r, r, &cands);
+      AddCand1<Right>(state, mv_base.x + r, mv_base.y, r, &cands);
       break;
 
     case Left::index:
-      CheckCost2<Down, Left>(state, mv_base.x - r, mv_base.y + r, r);
-      CheckCost2<Up, Left>(state, mv_base.x - r, mv_base.y - r, r);
+      AddCand2<Down, Left>(state, mv_base.x - r, mv_base.y + r, r, &cands);
+      AddCand2<Up, Left>(state, mv_base.x - r, mv_base.y - r, r, &cands);
       break;
 
     case Right::index:
-      CheckCost2<Up, Right>(state, mv_base.x + r, mv_base.y - r, r);
-      CheckCost2<Down, Right>(state, mv_base.x + r, mv_base.y + r, r);
+      AddCand2<Up, Right>(state, mv_base.x + r, mv_base.y - r, r, &cands);
+      AddCand2<Down, Right>(state, mv_base.x + r, mv_base.y + r, r, &cands);
       break;
 
     case Down::index + Left::index:
-      CheckCost1<Left>(state, mv_base.x - r, mv_base.y, r);
-      CheckCost1<Down>(state, mv_base.x, mv_base.y + r, r);
+      AddCand1<Left>(state, mv_base.x - r, mv_base.y, r, &cands);
+      AddCand1<Down>(state, mv_base.x, mv_base.y + r, r, &cands);
       break;
 
     case Down::index:
-      CheckCost2<Down, Left>(state, mv_base.x - r, mv_base.y + r, r);
-      CheckCost2<Down, Right>(state, mv_base.x + r, mv_base.y + r, r);
+      AddCand2<Down, Left>(state, mv_base.x - r, mv_base.y + r, r, &cands);
+      AddCand2<Down, Right>(state, mv_base.x + r, mv_base.y + r, r, &cands);
       break;
 
     case Down::index + Right::index:
-      CheckCost1<Right>(state, mv_base.x + r, mv_base.y, r);
-      CheckCost1<Down>(state, mv_base.x, mv_base.y + r, r);
+      AddCand1<Right>(state, mv_base.x + r, mv_base.y, r, &cands);
+      AddCand1<Down>(state, mv_base.x, mv_base.y + r, r, &cands);
       break;
 
     default:
       break;
   }
+  CheckCandidates(state, cands);
+}
+
+void TzSearch::FullpelRasterSearch(SearchState *state,
+                                   const MotionVector &mv_min,
+                                   const MotionVector &mv_max, int step_size) {
+  CandidateList cands;
+  for (int y = mv_min.y; y <= mv_max.y; y += step_size) {
+    for (int x = mv_min.x; x <= mv_max.x; x += step_size) {
+      cands.Add(x, y, 0, 0);
+      if (cands.num == CandidateList::kMaxNumCand) {
+        CheckCostBestBatch(state, cands);
+        cands.num = 0;
+      }
+    }
+  }
+  if (cands.num > 0) {
+    CheckCostBestBatch(state, cands);
+  }
 }
 
 Distortion TzSearch::GetCost(SearchState *state, int mv_x, int mv_y) {
@@ -274,6 +345,45 @@ bool TzSearch::CheckCostBest(SearchState *state, int mv_x, int mv_y) {
   return false;
 }
 
+// Candidates are evaluated in batches but compared in list order, this gives
+// the same result as checking them one by one
+int TzSearch::CheckCostBestBatch(SearchState *state,
+                                 const CandidateList &cands) {
+  const int mv_scale = state->mv_precision;
+  std::array<Distortion, SampleMetric::kMaxBatchSize> dist;
+  int best_idx = -1;
+  for (int i = 0; i < cands.num; i += SampleMetric::kMaxBatchSize) {
+    const int batch_size =
+      std::min(cands.num - i, static_cast<int>(SampleMetric::kMaxBatchSize));
+    state->dist->GetDistBatch(&cands.cand[i], batch_size, &dist[0]);
+    for (int j = 0; j < batch_size; j++) {
+      const CandidateList::Candidate &cand = cands.cand[i + j];
+      Bits mvd =
+        InterSearch::GetMvdBits(state->mvp, cand.mv_x, cand.mv_y, mv_scale);
+      Bits bits = ((state->lambda * mvd) >> 16);
+      Distortion cost = dist[j] + bits;
+      if (cost < state->cost_best) {
+        state->cost_best = cost;
+        state->mv_best.x = cand.mv_x;
+        state->mv_best.y = cand.mv_y;
+        best_idx = i + j;
+      }
+    }
+  }
+  return best_idx;
+}
+
+bool TzSearch::CheckCandidates(SearchState *state,
+                               const CandidateList &cands) {
+  int best_idx = CheckCostBestBatch(state, cands);
+  if (best_idx < 0) {
+    return false;
+  }
+  state->last_position = cands.cand[best_idx].position;
+  state->last_range_ = cands.cand[best_idx].range;
+  return true;
+}
+
 template<class Dir>
 bool
 TzSearch::IsInside(int mv_x, int mv_y, const_mv *mv_min, const_mv *mv_max) {
@@ -301,32 +411,22 @@ bool TzSearch::IsInside<TzSearch::Right>(int mv_x, int mv_y,
 }
 
 template<class Dir>
-bool TzSearch::CheckCost1(SearchState *state, int mv_x, int mv_y,
-                          int range) {
+void TzSearch::AddCand1(SearchState *state, int mv_x, int mv_y, int range,
+                        CandidateList *cands) {
   if (!IsInside<Dir>(mv_x, mv_y, &state->mv_min, &state->mv_max)) {
-    return false;
+    return;
   }
-  if (!CheckCostBest(state, mv_x, mv_y)) {
-    return false;
-  }
-  state->last_position = Dir::index;
-  state->last_range_ = range;
-  return true;
+  cands->Add(mv_x, mv_y, Dir::index, range);
 }
 
 template<class Dir1, class Dir2>
-bool TzSearch::CheckCost2(SearchState *state, int mv_x, int mv_y,
-                          int range) {
+void TzSearch::AddCand2(SearchState *state, int mv_x, int mv_y, int range,
+                        CandidateList *cands) {
   if (!IsInside<Dir1>(mv_x, mv_y, &state->mv_min, &state->mv_max) ||
       !IsInside<Dir2>(mv_x, mv_y, &state->mv_min, &state->mv_max)) {
-    return false;
-  }
-  if (!CheckCostBest(state, mv_x, mv_y)) {
-    return false;
+    return;
   }
-  state->last_position = Dir1::index + Dir2::index;
-  state->last_range_ = range;
-  return true;
+  cands->Add(mv_x, mv_y, Dir1::index + Dir2::index, range);
 }
 
 }   // namespace xvc
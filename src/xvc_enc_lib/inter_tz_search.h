@@ -25,6 +25,7 @@
 #include "xvc_common_lib/quantize.h"
 #include "xvc_enc_lib/sample_metric.h"
 #include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/motion_field.h"
 
 namespace xvc {
 
@@ -42,7 +43,8 @@ public:
   MotionVector Search(const CodingUnit &cu, const Qp &qp, MetricType metric,
                       const MotionVector &mvp, const YuvPicture &ref_pic,
                       const MotionVector &mv_min, const MotionVector &mv_max,
-                      const MotionVector &prev_search);
+                      const MotionVector &prev_search,
+                      const MotionField::Candidates &field_cands);
 
 private:
   using const_mv = const MotionVector;
@@ -51,17 +53,24 @@ private:
   struct Up { static const int index = -3; };
   struct Down { static const int index = 3; };
   struct SearchState;
+  struct CandidateList;
   template<typename TOrig> class DistortionWrapper;
 
   bool FullpelDiamondSearch(SearchState *state, const MotionVector &mv_base,
                             int range);
   void FullpelNeighborPointSearch(SearchState *state);
+  void FullpelRasterSearch(SearchState *state, const MotionVector &mv_min,
+                           const MotionVector &mv_max, int step_size);
   Distortion GetCost(SearchState *state, int mv_x, int mv_y);
   bool CheckCostBest(SearchState *state, int mv_x, int mv_y);
+  int CheckCostBestBatch(SearchState *state, const CandidateList &cands);
+  bool CheckCandidates(SearchState *state, const CandidateList &cands);
   template<class Dir>
-  bool CheckCost1(SearchState *state, int mv_x, int mv_y, int range);
+  void AddCand1(SearchState *state, int mv_x, int mv_y, int range,
+                CandidateList *cands);
   template<class Dir1, class Dir2>
-  bool CheckCost2(SearchState *state, int mv_x, int mv_y, int range);
+  void AddCand2(SearchState *state, int mv_x, int mv_y, int range,
+                CandidateList *cands);
   template<class Dir>
   bool IsInside(int mv_x, int mv_y, const_mv *mv_min, const_mv *mv_max);
 
@@ -0,0 +1,155 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/intra_mode_analysis.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+namespace xvc {
+
+// Angles of the angular modes relative pure horizontal or vertical, same as
+// used by intra prediction
+static const int kNumAngles = 17;
+static const int kAngleTable[kNumAngles] = {
+  -32, -26, -21, -17, -13, -9, -5, -2, 0, 2, 5, 9, 13, 17, 21, 26, 32
+};
+// Orientations are periodic, mode 2 and 34 share the same direction
+static const int kNumOrientations = IntraModeAnalysis::kNumAngularModes - 1;
+
+// Maps each integer angle in [-32, 32] to the nearest mode angle offset
+static std::array<int8_t, 65> BuildAngleOffsetTable() {
+  std::array<int8_t, 65> table;
+  for (int angle = -32; angle <= 32; angle++) {
+    int best = 0;
+    for (int i = 1; i < kNumAngles; i++) {
+      if (std::abs(kAngleTable[i] - angle) <
+          std::abs(kAngleTable[best] - angle)) {
+        best = i;
+      }
+    }
+    table[32 + angle] = static_cast<int8_t>(best - kNumAngles / 2);
+  }
+  return table;
+}
+static const std::array<int8_t, 65> kAngleOffsetTable =
+  BuildAngleOffsetTable();
+
+// Returns round(32 * num / den) given that abs(num) <= abs(den)
+static int GetRoundedAngle(int num, int den) {
+  if (den < 0) {
+    num = -num;
+    den = -den;
+  }
+  const int scaled = 32 * num;
+  return (scaled >= 0 ? scaled + den / 2 : scaled - den / 2) / den;
+}
+
+IntraModeAnalysis::IntraModeAnalysis(int width, int height)
+  : width_in_blocks_((width + kBlockSize - 1) / kBlockSize),
+  height_in_blocks_((height + kBlockSize - 1) / kBlockSize),
+  histograms_(width_in_blocks_ * height_in_blocks_) {
+}
+
+void IntraModeAnalysis::Analyze(const YuvPicture &orig_pic) {
+  const YuvComponent luma = YuvComponent::kY;
+  const int width = orig_pic.GetWidth(luma);
+  const int height = orig_pic.GetHeight(luma);
+  const ptrdiff_t stride = orig_pic.GetStride(luma);
+  const int magnitude_shift = orig_pic.GetBitdepth() - 8;
+  assert((width + kBlockSize - 1) / kBlockSize == width_in_blocks_);
+  assert((height + kBlockSize - 1) / kBlockSize == height_in_blocks_);
+  for (Histogram &histogram : histograms_) {
+    histogram.fill(0);
+  }
+  for (int y = 1; y < height - 1; y++) {
+    const Sample *src = orig_pic.GetSamplePtr(luma, 0, y);
+    Histogram *row_histograms =
+      &histograms_[(y / kBlockSize) * width_in_blocks_];
+    for (int x = 1; x < width - 1; x++) {
+      const Sample *above = src + x - stride;
+      const Sample *curr = src + x;
+      const Sample *below = src + x + stride;
+      const int grad_x = (above[1] + 2 * curr[1] + below[1]) -
+        (above[-1] + 2 * curr[-1] + below[-1]);
+      const int grad_y = (below[-1] + 2 * below[0] + below[1]) -
+        (above[-1] + 2 * above[0] + above[1]);
+      const int magnitude =
+        (std::abs(grad_x) + std::abs(grad_y)) >> magnitude_shift;
+      if (!magnitude) {
+        continue;
+      }
+      // The edge is perpendicular to the gradient and the prediction
+      // direction of the selected mode should follow the edge
+      int mode;
+      if (std::abs(grad_y) >= std::abs(grad_x)) {
+        const int angle = GetRoundedAngle(grad_x, grad_y);
+        mode = IntraMode::kHorizontal - kAngleOffsetTable[32 + angle];
+      } else {
+        const int angle = GetRoundedAngle(grad_y, grad_x);
+        mode = IntraMode::kVertical + kAngleOffsetTable[32 + angle];
+      }
+      row_histograms[x / kBlockSize][mode - 2] += magnitude;
+    }
+  }
+}
+
+void IntraModeAnalysis::GetCandidateModes(int posx, int posy, int width,
+                                          int height, int num_dominant,
+                                          int neighbor_range,
+                                          ModeSet *modes) const {
+  const int block_x0 = std::min(posx / kBlockSize, width_in_blocks_ - 1);
+  const int block_y0 = std::min(posy / kBlockSize, height_in_blocks_ - 1);
+  const int block_x1 =
+    std::min((posx + width - 1) / kBlockSize, width_in_blocks_ - 1);
+  const int block_y1 =
+    std::min((posy + height - 1) / kBlockSize, height_in_blocks_ - 1);
+  std::array<uint32_t, kNumOrientations> orientations;
+  orientations.fill(0);
+  for (int y = block_y0; y <= block_y1; y++) {
+    for (int x = block_x0; x <= block_x1; x++) {
+      const Histogram &histogram = histograms_[y * width_in_blocks_ + x];
+      for (int i = 0; i < kNumAngularModes; i++) {
+        orientations[i % kNumOrientations] += histogram[i];
+      }
+    }
+  }
+  modes->fill(false);
+  (*modes)[IntraMode::kPlanar] = true;
+  (*modes)[IntraMode::kDc] = true;
+  for (int n = 0; n < num_dominant; n++) {
+    auto it = std::max_element(orientations.begin(), orientations.end());
+    if (*it == 0) {
+      break;
+    }
+    const int dominant = static_cast<int>(it - orientations.begin());
+    for (int d = -neighbor_range; d <= neighbor_range; d++) {
+      const int orientation =
+        (dominant + d + kNumOrientations) % kNumOrientations;
+      (*modes)[2 + orientation] = true;
+      if (orientation == 0) {
+        (*modes)[2 + kNumOrientations] = true;
+      }
+      // Next dominant direction must be outside of this neighborhood
+      orientations[orientation] = 0;
+    }
+  }
+}
+
+}   // namespace xvc
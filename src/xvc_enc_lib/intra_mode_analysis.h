@@ -0,0 +1,59 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_INTRA_MODE_ANALYSIS_H_
+#define XVC_ENC_LIB_INTRA_MODE_ANALYSIS_H_
+
+#include <array>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/cu_types.h"
+#include "xvc_common_lib/yuv_pic.h"
+
+namespace xvc {
+
+// Texture orientation analysis of the original luma, done once per picture.
+// For each kBlockSize x kBlockSize block a histogram of sobel gradient
+// orientations is computed, weighted by gradient magnitude and quantized
+// to the angular intra mode whose prediction direction follows the edge.
+// Used to narrow down the angular modes evaluated in intra search.
+class IntraModeAnalysis {
+public:
+  static const int kBlockSize = 8;
+  static const int kNumAngularModes = IntraMode::kTotalNumber - 2;
+  using ModeSet = std::array<bool, IntraMode::kTotalNumber>;
+
+  IntraModeAnalysis(int width, int height);
+  void Analyze(const YuvPicture &orig_pic);
+  // Marks planar, dc and the angular modes within neighbor_range of the
+  // num_dominant strongest directions overlapping the given luma area
+  void GetCandidateModes(int posx, int posy, int width, int height,
+                         int num_dominant, int neighbor_range,
+                         ModeSet *modes) const;
+
+private:
+  using Histogram = std::array<uint32_t, kNumAngularModes>;
+  const int width_in_blocks_;
+  const int height_in_blocks_;
+  std::vector<Histogram> histograms_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_INTRA_MODE_ANALYSIS_H_
@@ -18,20 +18,24 @@
 
 #include "xvc_enc_lib/intra_search.h"
 
+#include <algorithm>
 #include <utility>
 #include <limits>
 
 #include "xvc_common_lib/restrictions.h"
+#include "xvc_enc_lib/bit_estimator.h"
 #include "xvc_enc_lib/sample_metric.h"
 
 namespace xvc {
 
 IntraSearch::IntraSearch(int bitdepth, const PictureData &pic_data,
                          const YuvPicture &orig_pic,
+                         const IntraModeAnalysis *mode_analysis,
                          const EncoderSettings &encoder_settings)
   : IntraPrediction(bitdepth),
   pic_data_(pic_data),
   orig_pic_(orig_pic),
+  mode_analysis_(mode_analysis),
   encoder_settings_(encoder_settings),
   cu_writer_(pic_data, this) {
 }
@@ -65,28 +69,40 @@ IntraSearch::SearchIntraLuma(CodingUnit *cu, YuvComponent comp, const Qp &qp,
   SampleBuffer &pred_buf = encoder->GetPredBuffer();
   SampleMetric metric(MetricType::kSatd, qp, rec_pic->GetBitdepth());
   std::array<std::pair<IntraMode, double>, IntraMode::kTotalNumber> modes_cost;
+  IntraModeAnalysis::ModeSet eval_modes;
+  GetModesToEvaluate(*cu, mpm, &eval_modes);
+  BitEstimator bit_estimator(bitstream_writer);
+  int num_modes_evaluated = 0;
   for (int i = 0; i < IntraMode::kTotalNumber; i++) {
     IntraMode intra_mode = static_cast<IntraMode>(i);
+    if (!eval_modes[intra_mode]) {
+      continue;
+    }
     Predict(intra_mode, *cu, comp, intra_state,
             pred_buf.GetDataPtr(), pred_buf.GetStride());
 
     // Bits
-    RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
-    rdo_writer.WriteIntraMode(intra_mode, mpm);
-    size_t bits = rdo_writer.GetNumWrittenBits();
+    uint32_t frac_bits = bit_estimator.EstimateIntraMode(intra_mode, mpm);
+    size_t bits = bit_estimator.GetNumBits(frac_bits);
 
     uint64_t sad = metric.CompareSample(*cu, comp, orig_pic_,
                                         pred_buf.GetDataPtr(),
                                         pred_buf.GetStride());
     double cost = sad + bits * qp.GetLambdaSqrt();
-    modes_cost[i] = std::make_pair(intra_mode, cost);
+    modes_cost[num_modes_evaluated++] = std::make_pair(intra_mode, cost);
   }
-  std::stable_sort(modes_cost.begin(), modes_cost.end(),
+  std::stable_sort(modes_cost.begin(),
+                   modes_cost.begin() + num_modes_evaluated,
                    [](std::pair<IntraMode, double> p1,
                       std::pair<IntraMode, double> p2) {
     return p1.second < p2.second;
   });
 
+  // Pick the best mode from satd without any rdo
+  if (encoder_settings_.fast_intra_mode_eval_level == 3) {
+    return modes_cost[0].first;
+  }
+
   // Extend shortlist with mpm modes if not already included
   int width_log2 = util::SizeToLog2(cu->GetWidth(comp));
   int height_log2 = util::SizeToLog2(cu->GetHeight(comp));
@@ -96,6 +112,8 @@ IntraSearch::SearchIntraLuma(CodingUnit *cu, YuvComponent comp, const Qp &qp,
   } else if (encoder_settings_.fast_intra_mode_eval_level == 0) {
     num_modes_for_slow_rdo = 33;
   }
+  num_modes_for_slow_rdo = std::min(num_modes_for_slow_rdo,
+                                    num_modes_evaluated);
   for (int i = 0; i < mpm.num_neighbor_modes; i++) {
     bool found = false;
     for (int j = 0; j < num_modes_for_slow_rdo; j++) {
@@ -133,6 +151,30 @@ IntraSearch::SearchIntraLuma(CodingUnit *cu, YuvComponent comp, const Qp &qp,
   return best_mode;
 }
 
+void IntraSearch::GetModesToEvaluate(const CodingUnit &cu,
+                                     const IntraPredictorLuma &mpm,
+                                     IntraModeAnalysis::ModeSet *modes) const {
+  // Number of dominant directions and their neighbor range for each level
+  static const std::array<std::pair<int, int>, 3> kPreselection = { {
+    { 0, 0 }, { 2, 2 }, { 1, 2 }
+  } };
+  const int level = encoder_settings_.intra_mode_preselection;
+  if (!mode_analysis_ || level <= 0 ||
+      level >= static_cast<int>(kPreselection.size())) {
+    modes->fill(true);
+    return;
+  }
+  const YuvComponent luma = YuvComponent::kY;
+  mode_analysis_->GetCandidateModes(cu.GetPosX(luma), cu.GetPosY(luma),
+                                    cu.GetWidth(luma), cu.GetHeight(luma),
+                                    kPreselection[level].first,
+                                    kPreselection[level].second, modes);
+  // Most probable modes are cheap to signal and always evaluated
+  for (int i = 0; i < static_cast<int>(mpm.size()); i++) {
+    (*modes)[mpm[i]] = true;
+  }
+}
+
 IntraChromaMode
 IntraSearch::SearchIntraChroma(CodingUnit *cu, const Qp &qp,
                                const SyntaxWriter &bitstream_writer,
@@ -142,7 +184,8 @@ IntraSearch::SearchIntraChroma(CodingUnit *cu, const Qp &qp,
   IntraPredictorChroma chroma_modes = GetPredictorsChroma(luma_mode);
   IntraChromaMode best_mode = IntraChromaMode::kDmChroma;
   Cost best_cost = std::numeric_limits<Cost>::max();
-  if (Restrictions::Get().disable_intra_chroma_predictor) {
+  if (Restrictions::Get().disable_intra_chroma_predictor ||
+      encoder_settings_.fast_intra_mode_eval_level == 3) {
     return best_mode;
   }
   for (int i = 0; i < static_cast<int>(chroma_modes.size()); i++) {
@@ -24,6 +24,7 @@
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/cu_writer.h"
 #include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/intra_mode_analysis.h"
 #include "xvc_enc_lib/transform_encoder.h"
 
 namespace xvc {
@@ -32,6 +33,7 @@ class IntraSearch : public IntraPrediction {
 public:
   IntraSearch(int bitdepth, const PictureData &pic_data,
               const YuvPicture &orig_pic,
+              const IntraModeAnalysis *mode_analysis,
               const EncoderSettings &encoder_settings);
 
   IntraMode SearchIntraLuma(CodingUnit *cu, YuvComponent comp, const Qp &qp,
@@ -46,8 +48,13 @@ public:
                            TransformEncoder *encoder, YuvPicture *rec_pic);
 
 private:
+  void GetModesToEvaluate(const CodingUnit &cu,
+                          const IntraPredictorLuma &mpm,
+                          IntraModeAnalysis::ModeSet *modes) const;
+
   const PictureData &pic_data_;
   const YuvPicture &orig_pic_;
+  const IntraModeAnalysis *mode_analysis_;
   const EncoderSettings &encoder_settings_;
   CuWriter cu_writer_;
 };
@@ -0,0 +1,101 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/ladder_link.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace xvc {
+
+LadderLink::PictureAnalysis::PictureAnalysis(
+  const PictureData &pic_data,
+  std::shared_ptr<const IntraModeAnalysis> intra_analysis,
+  std::shared_ptr<const MotionField> motion_field)
+  : poc_(pic_data.GetPoc()),
+  qp_(pic_data.GetPicQp()->GetQpRaw(YuvComponent::kY)),
+  width_in_blocks_((pic_data.GetPictureWidth(YuvComponent::kY) +
+                    kBlockSize - 1) / kBlockSize),
+  height_in_blocks_((pic_data.GetPictureHeight(YuvComponent::kY) +
+                     kBlockSize - 1) / kBlockSize),
+  depth_(width_in_blocks_ * height_in_blocks_),
+  intra_mode_analysis_(std::move(intra_analysis)),
+  motion_field_(std::move(motion_field)) {
+  for (int y = 0; y < height_in_blocks_; y++) {
+    for (int x = 0; x < width_in_blocks_; x++) {
+      const CodingUnit *cu = pic_data.GetCuAt(CuTree::Primary, x * kBlockSize,
+                                              y * kBlockSize);
+      depth_[y * width_in_blocks_ + x] =
+        static_cast<uint8_t>(cu ? cu->GetDepth() : 0);
+    }
+  }
+}
+
+int LadderLink::PictureAnalysis::GetMaxDepth(int posx, int posy, int width,
+                                             int height) const {
+  const int x0 = posx / kBlockSize;
+  const int y0 = posy / kBlockSize;
+  const int x1 = std::min((posx + width - 1) / kBlockSize + 1,
+                          width_in_blocks_);
+  const int y1 = std::min((posy + height - 1) / kBlockSize + 1,
+                          height_in_blocks_);
+  int max_depth = 0;
+  for (int y = y0; y < y1; y++) {
+    for (int x = x0; x < x1; x++) {
+      max_depth = std::max(max_depth,
+                           static_cast<int>(depth_[y * width_in_blocks_ + x]));
+    }
+  }
+  return max_depth;
+}
+
+void LadderLink::Publish(std::shared_ptr<const PictureAnalysis> analysis) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+      return;
+    }
+    pics_[analysis->GetPoc()] = std::move(analysis);
+  }
+  published_cond_.notify_all();
+}
+
+std::shared_ptr<const LadderLink::PictureAnalysis>
+LadderLink::Take(PicNum poc) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  published_cond_.wait(lock, [this, poc] {
+    return pics_.count(poc) > 0 || closed_;
+  });
+  auto it = pics_.find(poc);
+  if (it == pics_.end()) {
+    return nullptr;
+  }
+  std::shared_ptr<const PictureAnalysis> analysis = std::move(it->second);
+  pics_.erase(it);
+  return analysis;
+}
+
+void LadderLink::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  published_cond_.notify_all();
+}
+
+}   // namespace xvc
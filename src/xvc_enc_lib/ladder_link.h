@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_LADDER_LINK_H_
+#define XVC_ENC_LIB_LADDER_LINK_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <map>
+#include <memory>
+#include <mutex>                // NOLINT
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_enc_lib/intra_mode_analysis.h"
+#include "xvc_enc_lib/motion_field.h"
+
+namespace xvc {
+
+// Connection between the encoders of two neighboring rungs in a bitrate
+// ladder, i.e. encoders of the same input with the same parameters except
+// for qp. After coding a picture the upstream encoder publishes its qp
+// independent analysis and final decisions, which the downstream encoder
+// takes when it codes the same picture instead of repeating the analysis.
+// Taking a picture blocks until it has been published, so each picture
+// must be given to the upstream encoder before the downstream encoder.
+class LadderLink {
+public:
+  class PictureAnalysis {
+  public:
+    static const int kBlockSize = 8;
+    PictureAnalysis(const PictureData &pic_data,
+                    std::shared_ptr<const IntraModeAnalysis> intra_analysis,
+                    std::shared_ptr<const MotionField> motion_field);
+    PicNum GetPoc() const { return poc_; }
+    int GetQp() const { return qp_; }
+    // May be null if not used by the upstream encoder
+    const std::shared_ptr<const IntraModeAnalysis>&
+      GetIntraModeAnalysis() const { return intra_mode_analysis_; }
+    const std::shared_ptr<const MotionField>& GetMotionField() const {
+      return motion_field_;
+    }
+    // Largest quad split depth of the primary cu tree in the given luma area
+    int GetMaxDepth(int posx, int posy, int width, int height) const;
+
+  private:
+    PicNum poc_;
+    int qp_;
+    int width_in_blocks_;
+    int height_in_blocks_;
+    std::vector<uint8_t> depth_;
+    std::shared_ptr<const IntraModeAnalysis> intra_mode_analysis_;
+    std::shared_ptr<const MotionField> motion_field_;
+  };
+
+  void Publish(std::shared_ptr<const PictureAnalysis> analysis);
+  // Blocks until the picture with given poc has been published, returns
+  // null if the link is closed before that. Pictures published before the
+  // link was closed can still be taken.
+  std::shared_ptr<const PictureAnalysis> Take(PicNum poc);
+  // Called when any of the two encoders is destroyed
+  void Close();
+
+private:
+  std::mutex mutex_;
+  std::condition_variable published_cond_;
+  std::map<PicNum, std::shared_ptr<const PictureAnalysis>> pics_;
+  bool closed_ = false;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_LADDER_LINK_H_
@@ -0,0 +1,358 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/lookahead.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <limits>
+
+#include "xvc_common_lib/utils.h"
+#include "xvc_enc_lib/sample_metric.h"
+
+namespace xvc {
+
+static const int kLowresBlockSize = Lookahead::kBlockSize / 2;
+static const int kLowresSearchRange = 16;
+static const int kMaxRefineIterations = 8;
+static const int kAnalysisQp = 32;
+
+Lookahead::PictureAnalysis::PictureAnalysis(PicNum poc, int width_in_blocks,
+                                            int height_in_blocks)
+  : poc_(poc),
+  width_in_blocks_(width_in_blocks),
+  height_in_blocks_(height_in_blocks),
+  intra_cost_(width_in_blocks * height_in_blocks, 0),
+  inter_cost_(width_in_blocks * height_in_blocks,
+              std::numeric_limits<Distortion>::max()) {
+}
+
+bool Lookahead::PictureAnalysis::IsInterDominant(int posx, int posy, int width,
+                                                 int height,
+                                                 int factor) const {
+  if (!has_inter_) {
+    return false;
+  }
+  const int block_x0 = std::min(posx / kBlockSize, width_in_blocks_ - 1);
+  const int block_y0 = std::min(posy / kBlockSize, height_in_blocks_ - 1);
+  const int block_x1 =
+    std::min((posx + width - 1) / kBlockSize, width_in_blocks_ - 1);
+  const int block_y1 =
+    std::min((posy + height - 1) / kBlockSize, height_in_blocks_ - 1);
+  for (int y = block_y0; y <= block_y1; y++) {
+    for (int x = block_x0; x <= block_x1; x++) {
+      const int idx = y * width_in_blocks_ + x;
+      if (inter_cost_[idx] * factor >= intra_cost_[idx]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Lookahead::Lookahead(int width, int height, int bitdepth,
+                     PicNum max_stored_pics)
+  : bitdepth_(bitdepth),
+  width_in_blocks_((width + kBlockSize - 1) / kBlockSize),
+  height_in_blocks_((height + kBlockSize - 1) / kBlockSize),
+  lowres_width_(width_in_blocks_ * kLowresBlockSize),
+  lowres_height_(height_in_blocks_ * kLowresBlockSize),
+  max_stored_pics_(max_stored_pics),
+  qp_(kAnalysisQp, ChromaFormat::k420, bitdepth, 1.0) {
+  worker_thread_ = std::thread([this] {
+    WorkerMain();
+  });
+}
+
+Lookahead::~Lookahead() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  running_ = false;
+  wait_work_cond_.notify_all();
+  lock.unlock();
+  worker_thread_.join();
+}
+
+void Lookahead::Push(PicNum poc, const YuvPicture &orig_pic) {
+  // Downsample by averaging 2x2 luma samples, the picture edges are
+  // replicated up to a multiple of the block size
+  const YuvComponent comp = YuvComponent::kY;
+  const int width = orig_pic.GetWidth(comp);
+  const int height = orig_pic.GetHeight(comp);
+  const ptrdiff_t stride = orig_pic.GetStride(comp);
+  const Sample *src = orig_pic.GetSamplePtr(comp, 0, 0);
+  auto lowres =
+    std::make_shared<LowresPicture>(lowres_width_ * lowres_height_);
+  Sample *dst = &(*lowres)[0];
+  for (int y = 0; y < lowres_height_; y++) {
+    const Sample *src0 = src + std::min(2 * y, height - 1) * stride;
+    const Sample *src1 = src + std::min(2 * y + 1, height - 1) * stride;
+    for (int x = 0; x < lowres_width_; x++) {
+      const int x0 = std::min(2 * x, width - 1);
+      const int x1 = std::min(2 * x + 1, width - 1);
+      dst[x] = static_cast<Sample>(
+        (src0[x0] + src0[x1] + src1[x0] + src1[x1] + 2) >> 2);
+    }
+    dst += lowres_width_;
+  }
+
+  WorkItem work;
+  work.poc = poc;
+  work.curr = lowres;
+  work.prev = prev_lowres_;
+  prev_lowres_ = lowres;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_work_.push_back(std::move(work));
+  num_pushed_++;
+  wait_work_cond_.notify_one();
+}
+
+std::shared_ptr<const Lookahead::PictureAnalysis> Lookahead::Get(PicNum poc) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_cond_.wait(lock, [this, poc] {
+    return analyzed_pics_.count(poc) > 0 || num_analyzed_ == num_pushed_;
+  });
+  auto it = analyzed_pics_.find(poc);
+  if (it == analyzed_pics_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+bool Lookahead::HasSceneCut(PicNum first_poc, PicNum last_poc) {
+  for (PicNum poc = first_poc; poc <= last_poc; poc++) {
+    auto analysis = Get(poc);
+    if (analysis && analysis->IsSceneCut()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+double Lookahead::GetInterIntraRatio(PicNum first_poc, PicNum last_poc) {
+  Distortion intra_cost = 0;
+  Distortion inter_cost = 0;
+  for (PicNum poc = first_poc; poc <= last_poc; poc++) {
+    auto analysis = Get(poc);
+    if (analysis && analysis->has_inter_) {
+      intra_cost += analysis->GetIntraCost();
+      inter_cost += analysis->GetInterCost();
+    }
+  }
+  if (intra_cost == 0) {
+    return 0;
+  }
+  return static_cast<double>(inter_cost) / intra_cost;
+}
+
+void Lookahead::WorkerMain() {
+  while (true) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    wait_work_cond_.wait(lock, [this] {
+      return !running_ || !pending_work_.empty();
+    });
+    if (!running_) {
+      return;
+    }
+    WorkItem work = std::move(pending_work_.front());
+    pending_work_.pop_front();
+    lock.unlock();
+
+    auto analysis = std::make_shared<PictureAnalysis>(work.poc,
+                                                      width_in_blocks_,
+                                                      height_in_blocks_);
+    Analyze(*work.curr, work.prev.get(), analysis.get());
+
+    lock.lock();
+    analyzed_pics_[work.poc] = analysis;
+    while (analyzed_pics_.size() > max_stored_pics_) {
+      analyzed_pics_.erase(analyzed_pics_.begin());
+    }
+    num_analyzed_++;
+    work_done_cond_.notify_all();
+  }
+}
+
+void Lookahead::Analyze(const LowresPicture &curr, const LowresPicture *prev,
+                        PictureAnalysis *analysis) const {
+  std::vector<MotionVector> mvs(width_in_blocks_ * height_in_blocks_);
+  std::vector<MotionVector> mv_preds;
+  for (int by = 0; by < height_in_blocks_; by++) {
+    for (int bx = 0; bx < width_in_blocks_; bx++) {
+      const int idx = by * width_in_blocks_ + bx;
+      const int x = bx * kLowresBlockSize;
+      const int y = by * kLowresBlockSize;
+      Distortion intra_cost = EstimateIntraCost(curr, x, y);
+      Distortion inter_cost = std::numeric_limits<Distortion>::max();
+      if (prev) {
+        mv_preds.clear();
+        mv_preds.push_back(MotionVector(0, 0));
+        if (bx > 0) {
+          mv_preds.push_back(mvs[idx - 1]);
+        }
+        if (by > 0) {
+          mv_preds.push_back(mvs[idx - width_in_blocks_]);
+          if (bx + 1 < width_in_blocks_) {
+            mv_preds.push_back(mvs[idx - width_in_blocks_ + 1]);
+          }
+        }
+        inter_cost =
+          EstimateInterCost(curr, *prev, x, y, mv_preds, &mvs[idx]);
+      }
+      analysis->intra_cost_[idx] = intra_cost;
+      analysis->inter_cost_[idx] = inter_cost;
+      analysis->total_intra_cost_ += intra_cost;
+      analysis->total_inter_cost_ += std::min(intra_cost, inter_cost);
+    }
+  }
+  analysis->has_inter_ = prev != nullptr;
+  analysis->scene_cut_ = prev != nullptr &&
+    analysis->total_inter_cost_ > kSceneCutRatio * analysis->total_intra_cost_;
+}
+
+Distortion Lookahead::EstimateIntraCost(const LowresPicture &curr,
+                                        int x, int y) const {
+  const int size = kLowresBlockSize;
+  const ptrdiff_t stride = lowres_width_;
+  const Sample *src = &curr[y * stride + x];
+  const Sample *above = y > 0 ? src - stride : nullptr;
+  const Sample *left = x > 0 ? src - 1 : nullptr;
+  SampleMetric metric(MetricType::kSatd, qp_, bitdepth_);
+  std::array<Sample, kLowresBlockSize * kLowresBlockSize> pred;
+
+  // DC prediction from available neighbors
+  int dc_sum = 0;
+  int dc_num = 0;
+  for (int i = 0; i < size; i++) {
+    if (above) {
+      dc_sum += above[i];
+      dc_num++;
+    }
+    if (left) {
+      dc_sum += left[i * stride];
+      dc_num++;
+    }
+  }
+  const Sample dc = static_cast<Sample>(
+    dc_num > 0 ? (dc_sum + dc_num / 2) / dc_num : 1 << (bitdepth_ - 1));
+  std::fill(pred.begin(), pred.end(), dc);
+  Distortion best_cost =
+    metric.CompareSample(YuvComponent::kY, size, size, src, stride,
+                         &pred[0], size);
+  if (above) {
+    for (int i = 0; i < size; i++) {
+      std::copy(above, above + size, &pred[i * size]);
+    }
+    best_cost = std::min(best_cost,
+                         metric.CompareSample(YuvComponent::kY, size, size,
+                                              src, stride, &pred[0], size));
+  }
+  if (left) {
+    for (int i = 0; i < size; i++) {
+      std::fill(&pred[i * size], &pred[i * size] + size, left[i * stride]);
+    }
+    best_cost = std::min(best_cost,
+                         metric.CompareSample(YuvComponent::kY, size, size,
+                                              src, stride, &pred[0], size));
+  }
+  return best_cost;
+}
+
+Distortion
+Lookahead::EstimateInterCost(const LowresPicture &curr,
+                             const LowresPicture &prev, int x, int y,
+                             const std::vector<MotionVector> &preds,
+                             MotionVector *out_mv) const {
+  const int size = kLowresBlockSize;
+  const ptrdiff_t stride = lowres_width_;
+  const Sample *src = &curr[y * stride + x];
+  const int min_x = std::max(-x, -kLowresSearchRange);
+  const int max_x = std::min(lowres_width_ - size - x, kLowresSearchRange);
+  const int min_y = std::max(-y, -kLowresSearchRange);
+  const int max_y = std::min(lowres_height_ - size - y, kLowresSearchRange);
+  SampleMetric sad_metric(MetricType::kSad, qp_, bitdepth_);
+  std::array<MotionVector, SampleMetric::kMaxBatchSize> cand_mv;
+  std::array<const Sample *, SampleMetric::kMaxBatchSize> cand_ptr;
+  std::array<Distortion, SampleMetric::kMaxBatchSize> cand_dist;
+  MotionVector best_mv(0, 0);
+  Distortion best_dist = std::numeric_limits<Distortion>::max();
+
+  auto eval_candidates = [&](int num_cand) {
+    if (num_cand == 0) {
+      return false;
+    }
+    sad_metric.CompareSampleBatch(YuvComponent::kY, size, size, src, stride,
+                                  &cand_ptr[0], stride, num_cand,
+                                  &cand_dist[0]);
+    bool improved = false;
+    for (int i = 0; i < num_cand; i++) {
+      if (cand_dist[i] < best_dist) {
+        best_dist = cand_dist[i];
+        best_mv = cand_mv[i];
+        improved = true;
+      }
+    }
+    return improved;
+  };
+  auto add_candidate = [&](int mv_x, int mv_y, int *num_cand) {
+    MotionVector mv(util::Clip3(mv_x, min_x, max_x),
+                    util::Clip3(mv_y, min_y, max_y));
+    for (int i = 0; i < *num_cand; i++) {
+      if (cand_mv[i] == mv) {
+        return;
+      }
+    }
+    cand_mv[*num_cand] = mv;
+    cand_ptr[*num_cand] = &prev[(y + mv.y) * stride + x + mv.x];
+    (*num_cand)++;
+  };
+
+  // Start from best predictor
+  int num_cand = 0;
+  for (const MotionVector &mv : preds) {
+    if (num_cand < SampleMetric::kMaxBatchSize) {
+      add_candidate(mv.x, mv.y, &num_cand);
+    }
+  }
+  eval_candidates(num_cand);
+
+  // Diamond refinement with decreasing step size
+  for (int step = 4; step > 0; step >>= 1) {
+    for (int iter = 0; iter < kMaxRefineIterations; iter++) {
+      const MotionVector center = best_mv;
+      num_cand = 0;
+      add_candidate(center.x, center.y - step, &num_cand);
+      add_candidate(center.x - step, center.y, &num_cand);
+      add_candidate(center.x + step, center.y, &num_cand);
+      add_candidate(center.x, center.y + step, &num_cand);
+      if (!eval_candidates(num_cand)) {
+        break;
+      }
+    }
+  }
+
+  *out_mv = best_mv;
+  SampleMetric satd_metric(MetricType::kSatd, qp_, bitdepth_);
+  const Sample *ref = &prev[(y + best_mv.y) * stride + x + best_mv.x];
+  return satd_metric.CompareSample(YuvComponent::kY, size, size, src, stride,
+                                   ref, stride);
+}
+
+}   // namespace xvc
@@ -0,0 +1,122 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_LOOKAHEAD_H_
+#define XVC_ENC_LIB_LOOKAHEAD_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/cu_types.h"
+#include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/yuv_pic.h"
+
+namespace xvc {
+
+// Cheap half resolution analysis of input pictures running on a separate
+// thread ahead of the actual encoding. Each picture is divided into blocks
+// of kBlockSize x kBlockSize full resolution luma samples and for each block
+// an intra cost and an inter cost (relative the previous input picture)
+// is estimated using satd.
+class Lookahead {
+public:
+  static const int kBlockSize = 16;
+  // Inter cost relative intra cost above which a picture is a scene cut
+  static constexpr double kSceneCutRatio = 0.7;
+
+  class PictureAnalysis {
+  public:
+    PictureAnalysis(PicNum poc, int width_in_blocks, int height_in_blocks);
+    PicNum GetPoc() const { return poc_; }
+    bool IsSceneCut() const { return scene_cut_; }
+    Distortion GetIntraCost() const { return total_intra_cost_; }
+    Distortion GetInterCost() const { return total_inter_cost_; }
+    // True if inter cost times factor is below intra cost for all blocks
+    // overlapping the given luma area
+    bool IsInterDominant(int posx, int posy, int width, int height,
+                         int factor) const;
+
+  private:
+    PicNum poc_;
+    int width_in_blocks_;
+    int height_in_blocks_;
+    std::vector<Distortion> intra_cost_;
+    std::vector<Distortion> inter_cost_;
+    Distortion total_intra_cost_ = 0;
+    Distortion total_inter_cost_ = 0;
+    bool has_inter_ = false;
+    bool scene_cut_ = false;
+    friend class Lookahead;
+  };
+
+  Lookahead(int width, int height, int bitdepth, PicNum max_stored_pics);
+  ~Lookahead();
+  // Downsample the luma of orig_pic and queue it for analysis
+  void Push(PicNum poc, const YuvPicture &orig_pic);
+  // Blocks until the picture with given poc has been analyzed
+  std::shared_ptr<const PictureAnalysis> Get(PicNum poc);
+  // True if any picture in the poc range [first, last] is a scene cut
+  bool HasSceneCut(PicNum first_poc, PicNum last_poc);
+  // Average ratio between inter and intra cost for pictures in range
+  double GetInterIntraRatio(PicNum first_poc, PicNum last_poc);
+
+private:
+  using LowresPicture = std::vector<Sample>;
+  struct WorkItem {
+    PicNum poc = 0;
+    std::shared_ptr<const LowresPicture> curr;
+    std::shared_ptr<const LowresPicture> prev;
+  };
+  void WorkerMain();
+  void Analyze(const LowresPicture &curr, const LowresPicture *prev,
+               PictureAnalysis *analysis) const;
+  Distortion EstimateIntraCost(const LowresPicture &curr, int x, int y) const;
+  Distortion EstimateInterCost(const LowresPicture &curr,
+                               const LowresPicture &prev, int x, int y,
+                               const std::vector<MotionVector> &preds,
+                               MotionVector *out_mv) const;
+
+  const int bitdepth_;
+  const int width_in_blocks_;
+  const int height_in_blocks_;
+  const int lowres_width_;
+  const int lowres_height_;
+  const PicNum max_stored_pics_;
+  const Qp qp_;
+  std::shared_ptr<const LowresPicture> prev_lowres_;
+  std::thread worker_thread_;
+  std::mutex mutex_;
+  std::condition_variable wait_work_cond_;
+  std::condition_variable work_done_cond_;
+  std::deque<WorkItem> pending_work_;
+  std::map<PicNum, std::shared_ptr<const PictureAnalysis>> analyzed_pics_;
+  PicNum num_pushed_ = 0;
+  PicNum num_analyzed_ = 0;
+  bool running_ = true;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_LOOKAHEAD_H_
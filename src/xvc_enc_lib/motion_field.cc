@@ -0,0 +1,176 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/motion_field.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+namespace xvc {
+
+static int ScaleComponent(int mv, int dst_dist, int src_dist) {
+  int num = mv * dst_dist;
+  int half = std::abs(src_dist) / 2;
+  int scaled = (std::abs(num) + half) / std::abs(src_dist);
+  return (num < 0) != (src_dist < 0) ? -scaled : scaled;
+}
+
+MotionField::MotionField(int width, int height)
+  : width_in_blocks_((width + kBlockSize - 1) / kBlockSize),
+  height_in_blocks_((height + kBlockSize - 1) / kBlockSize),
+  entries_(width_in_blocks_ * height_in_blocks_) {
+}
+
+void MotionField::StartPicture(PicNum poc, const MotionField *colocated,
+                               const MotionField *ladder) {
+  assert(!colocated || (colocated->width_in_blocks_ == width_in_blocks_ &&
+                        colocated->height_in_blocks_ == height_in_blocks_));
+  assert(!ladder || (ladder->width_in_blocks_ == width_in_blocks_ &&
+                     ladder->height_in_blocks_ == height_in_blocks_));
+  poc_ = poc;
+  colocated_ = colocated && !colocated->IsEmpty() ? colocated : nullptr;
+  ladder_ = ladder && !ladder->IsEmpty() ? ladder : nullptr;
+  std::fill(entries_.begin(), entries_.end(), Entry{ MotionVector(), 0 });
+}
+
+void MotionField::Store(const CodingUnit &cu, PicNum ref_poc,
+                        const MotionVector &mv) {
+  const int poc_dist = static_cast<int>(poc_ - ref_poc);
+  if (poc_dist == 0) {
+    return;
+  }
+  const Area area = GetArea(cu, false);
+  for (int y = area.y0; y < area.y1; y++) {
+    Entry *entry = &entries_[y * width_in_blocks_];
+    for (int x = area.x0; x < area.x1; x++) {
+      entry[x].mv = mv;
+      entry[x].poc_dist = poc_dist;
+    }
+  }
+}
+
+bool MotionField::IsEmpty() const {
+  return std::none_of(entries_.begin(), entries_.end(),
+                      [](const Entry &entry) { return entry.poc_dist != 0; });
+}
+
+void MotionField::GetCandidates(const CodingUnit &cu, PicNum ref_poc,
+                                Candidates *cands) const {
+  const YuvComponent luma = YuvComponent::kY;
+  const int posx = cu.GetPosX(luma);
+  const int posy = cu.GetPosY(luma);
+  const int center_x = posx + cu.GetWidth(luma) / 2;
+  const int center_y = posy + cu.GetHeight(luma) / 2;
+  const int poc_dist = static_cast<int>(poc_ - ref_poc);
+  cands->num = 0;
+  // Entries without stored motion are skipped, also before the first store
+  if (poc_dist == 0) {
+    return;
+  }
+  AddCandidate(GetEntry(center_x, center_y), poc_dist, cands);
+  if (posx > 0 && cu.IsSameTile(posx - 1, center_y)) {
+    AddCandidate(GetEntry(posx - 1, center_y), poc_dist, cands);
+  }
+  if (posy > 0 && cu.IsSameTile(center_x, posy - 1)) {
+    AddCandidate(GetEntry(center_x, posy - 1), poc_dist, cands);
+  }
+  if (colocated_) {
+    AddCandidate(colocated_->GetEntry(center_x, center_y), poc_dist, cands);
+  }
+  if (ladder_) {
+    AddCandidate(ladder_->GetEntry(center_x, center_y), poc_dist, cands);
+  }
+}
+
+void MotionField::CopyNeighborhood(const MotionField &src,
+                                   const CodingUnit &cu) {
+  assert(src.width_in_blocks_ == width_in_blocks_ &&
+         src.height_in_blocks_ == height_in_blocks_);
+  const Area area = GetArea(cu, true);
+  for (int y = area.y0; y < area.y1; y++) {
+    const int offset = y * width_in_blocks_;
+    std::copy(src.entries_.begin() + offset + area.x0,
+              src.entries_.begin() + offset + area.x1,
+              entries_.begin() + offset + area.x0);
+  }
+}
+
+void MotionField::SaveArea(const CodingUnit &cu, AreaState *state) const {
+  const Area area = GetArea(cu, false);
+  state->clear();
+  for (int y = area.y0; y < area.y1; y++) {
+    const int offset = y * width_in_blocks_;
+    state->insert(state->end(), entries_.begin() + offset + area.x0,
+                  entries_.begin() + offset + area.x1);
+  }
+}
+
+void MotionField::RestoreArea(const CodingUnit &cu, const AreaState &state) {
+  const Area area = GetArea(cu, false);
+  const int width = area.x1 - area.x0;
+  assert(static_cast<int>(state.size()) == width * (area.y1 - area.y0));
+  for (int y = area.y0; y < area.y1; y++) {
+    const int offset = (y - area.y0) * width;
+    std::copy(state.begin() + offset, state.begin() + offset + width,
+              entries_.begin() + y * width_in_blocks_ + area.x0);
+  }
+}
+
+MotionField::Area MotionField::GetArea(const CodingUnit &cu,
+                                       bool include_neighbors) const {
+  const YuvComponent luma = YuvComponent::kY;
+  const int posx = cu.GetPosX(luma);
+  const int posy = cu.GetPosY(luma);
+  const int offset = include_neighbors ? 1 : 0;
+  Area area;
+  area.x0 = std::max(posx - offset, 0) / kBlockSize;
+  area.y0 = std::max(posy - offset, 0) / kBlockSize;
+  area.x1 = std::min((posx + cu.GetWidth(luma) - 1) / kBlockSize + 1,
+                     width_in_blocks_);
+  area.y1 = std::min((posy + cu.GetHeight(luma) - 1) / kBlockSize + 1,
+                     height_in_blocks_);
+  return area;
+}
+
+const MotionField::Entry& MotionField::GetEntry(int posx, int posy) const {
+  const int x = std::min(posx / kBlockSize, width_in_blocks_ - 1);
+  const int y = std::min(posy / kBlockSize, height_in_blocks_ - 1);
+  return entries_[y * width_in_blocks_ + x];
+}
+
+void MotionField::AddCandidate(const Entry &entry, int poc_dist,
+                               Candidates *cands) {
+  if (entry.poc_dist == 0) {
+    return;
+  }
+  MotionVector mv = entry.mv;
+  if (entry.poc_dist != poc_dist) {
+    mv.x = ScaleComponent(mv.x, poc_dist, entry.poc_dist);
+    mv.y = ScaleComponent(mv.y, poc_dist, entry.poc_dist);
+  }
+  for (int i = 0; i < cands->num; i++) {
+    if (cands->mv[i] == mv) {
+      return;
+    }
+  }
+  assert(cands->num < kMaxNumCandidates);
+  cands->mv[cands->num++] = mv;
+}
+
+}   // namespace xvc
@@ -0,0 +1,98 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_MOTION_FIELD_H_
+#define XVC_ENC_LIB_MOTION_FIELD_H_
+
+#include <array>
+#include <vector>
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/cu_types.h"
+
+namespace xvc {
+
+// Motion estimation results of a picture at kBlockSize x kBlockSize
+// granularity, updated with each uni-prediction search during rdo. Vectors
+// are stored together with their poc distance, so that they can be scaled
+// to any reference picture when used as start candidates for the motion
+// search of later cus of other sizes and split shapes at the same position,
+// through the co-located field for the searches of the next picture, and
+// through the ladder field for another encoder of the same picture.
+// Tiles of the same picture may store and get candidates concurrently,
+// vectors of other tiles are never used as candidates.
+class MotionField {
+public:
+  static const int kBlockSize = 8;
+  static const int kMaxNumCandidates = 5;
+  struct Entry {
+    MotionVector mv;
+    // Zero if no motion has been stored
+    int poc_dist;
+  };
+  struct Candidates {
+    std::array<MotionVector, kMaxNumCandidates> mv;
+    int num = 0;
+  };
+  using AreaState = std::vector<Entry>;
+
+  MotionField(int width, int height);
+  // Clears all stored motion. The colocated field of a reference picture and
+  // the ladder field of the same picture coded at another qp may be null
+  // and must be kept alive until the next call.
+  void StartPicture(PicNum poc, const MotionField *colocated,
+                    const MotionField *ladder);
+  const MotionField* GetColocated() const { return colocated_; }
+  const MotionField* GetLadder() const { return ladder_; }
+  // True if no motion is stored, derived from the entries so that it stays
+  // consistent with restored areas and concurrent stores of other tiles
+  bool IsEmpty() const;
+  void Store(const CodingUnit &cu, PicNum ref_poc, const MotionVector &mv);
+  // Unique motion vectors at the center of cu, to the left, above and in the
+  // colocated and ladder fields, scaled to the distance of ref_poc
+  void GetCandidates(const CodingUnit &cu, PicNum ref_poc,
+                     Candidates *cands) const;
+  // Copy the area of cu and its left and above neighbors from another field
+  void CopyNeighborhood(const MotionField &src, const CodingUnit &cu);
+  void SaveArea(const CodingUnit &cu, AreaState *state) const;
+  void RestoreArea(const CodingUnit &cu, const AreaState &state);
+
+private:
+  struct Area {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+  };
+  Area GetArea(const CodingUnit &cu, bool include_neighbors) const;
+  const Entry& GetEntry(int posx, int posy) const;
+  static void AddCandidate(const Entry &entry, int poc_dist,
+                           Candidates *cands);
+
+  const int width_in_blocks_;
+  const int height_in_blocks_;
+  PicNum poc_ = 0;
+  const MotionField *colocated_ = nullptr;
+  const MotionField *ladder_ = nullptr;
+  std::vector<Entry> entries_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_MOTION_FIELD_H_
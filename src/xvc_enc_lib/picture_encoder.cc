@@ -35,12 +35,14 @@ namespace xvc {
 
 PictureEncoder::PictureEncoder(const SimdFunctions &simd,
                                ChromaFormat chroma_format, int width,
-                               int height, int bitdepth)
+                               int height, int bitdepth,
+                               std::shared_ptr<PictureData::CuStoragePool>
+                               cu_storage_pool)
   : simd_(simd),
   orig_pic_(std::make_shared<YuvPicture>(chroma_format, width, height,
                                          bitdepth, false)),
   pic_data_(std::make_shared<PictureData>(chroma_format, width, height,
-                                          bitdepth)),
+                                          bitdepth, cu_storage_pool)),
   rec_pic_(std::make_shared<YuvPicture>(chroma_format, width, height,
                                         bitdepth, true)) {
 }
@@ -50,6 +52,8 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
                        PicNum sub_gop_length, int buffer_flag,
                        bool flat_lambda,
                        const EncoderSettings &encoder_settings) {
+  perf_stats_.Clear();
+  XVC_PERF_STATS_SCOPE(&perf_stats_);
   int lambda_sub_gop_length =
     !flat_lambda ? static_cast<int>(segment.max_sub_gop_length) : 1;
   int lambda_max_tid = SegmentHeader::GetMaxTid(lambda_sub_gop_length);
@@ -74,32 +78,108 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
   }
   WriteHeader(*pic_data_, sub_gop_length, buffer_flag, &bit_writer_);
 
-  EntropyEncoder entropy_encoder(&bit_writer_);
-  entropy_encoder.Start();
-  SyntaxWriter writer(base_qp, pic_data_->GetPredictionType(),
-                      &entropy_encoder);
-  std::unique_ptr<CuEncoder>
-    cu_encoder(new CuEncoder(simd_, *orig_pic_, rec_pic_.get(), pic_data_.get(),
-                             encoder_settings));
-  int num_ctus = pic_data_->GetNumberOfCtu();
-  for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
-    cu_encoder->EncodeCtu(rsaddr, &writer);
+  // Analysis of the same picture by the encoder of the neighboring rung
+  std::shared_ptr<const LadderLink::PictureAnalysis> ladder_analysis;
+  if (ladder_upstream_) {
+    ladder_analysis = ladder_upstream_->Take(pic_data_->GetPoc());
+  }
+  std::shared_ptr<const IntraModeAnalysis> intra_mode_analysis;
+  if (encoder_settings.intra_mode_preselection > 0) {
+    if (ladder_analysis && ladder_analysis->GetIntraModeAnalysis()) {
+      intra_mode_analysis = ladder_analysis->GetIntraModeAnalysis();
+    } else {
+      XVC_PERF_TIMER(kIntraAnalysis);
+      // Not reused while still referenced by the downstream encoder
+      if (!intra_mode_analysis_ || intra_mode_analysis_.use_count() > 1) {
+        intra_mode_analysis_ = std::make_shared<IntraModeAnalysis>(
+          orig_pic_->GetWidth(YuvComponent::kY),
+          orig_pic_->GetHeight(YuvComponent::kY));
+      }
+      intra_mode_analysis_->Analyze(*orig_pic_);
+      intra_mode_analysis = intra_mode_analysis_;
+    }
+  }
+  MotionField *motion_field = nullptr;
+  if (encoder_settings.motion_field_seeding > 0) {
+    if (!motion_field_ || motion_field_.use_count() > 1) {
+      motion_field_ =
+        std::make_shared<MotionField>(orig_pic_->GetWidth(YuvComponent::kY),
+                                      orig_pic_->GetHeight(YuvComponent::kY));
+    }
+    const MotionField *ladder_field =
+      ladder_analysis ? ladder_analysis->GetMotionField().get() : nullptr;
+    motion_field_->StartPicture(pic_data_->GetPoc(),
+                                colocated_motion_field_.get(), ladder_field);
+    motion_field = motion_field_.get();
+  }
+  // Multiple tiles are encoded in parallel instead of the split candidates
+  const int num_tiles = pic_data_->GetNumTiles();
+  SplitRdoPool *split_rdo_pool = num_tiles == 1 ? split_rdo_pool_ : nullptr;
+  if (split_rdo_pool) {
+    split_rdo_pool->StartPicture(segment, base_qp, *pic_data_, *orig_pic_,
+                                 lookahead_analysis_.get(),
+                                 intra_mode_analysis.get(), motion_field,
+                                 encoder_settings);
+  }
+  std::vector<std::unique_ptr<CuEncoder>> cu_encoders;
+  for (int tile = 0; tile < num_tiles; tile++) {
+    cu_encoders.emplace_back(
+      new CuEncoder(simd_, *orig_pic_, rec_pic_.get(), pic_data_.get(),
+                    lookahead_analysis_.get(), intra_mode_analysis.get(),
+                    motion_field, ladder_analysis.get(), split_rdo_pool,
+                    encoder_settings));
   }
+  if (num_tiles == 1) {
+    EncodeTile(0, base_qp, cu_encoders[0].get(), &bit_writer_);
+  } else {
+    tile_bit_writers_.resize(num_tiles);
+    const Restrictions restrictions = Restrictions::Get();
+    auto encode_tile = [&](int tile) {
+      Restrictions::GetRW() = restrictions;
+      XVC_PERF_STATS_SCOPE(&perf_stats_);
+      EncodeTile(tile, base_qp, cu_encoders[tile].get(),
+                 &tile_bit_writers_[tile]);
+    };
+    if (tile_thread_pool_) {
+      tile_thread_pool_->Run(num_tiles, encode_tile);
+    } else {
+      for (int tile = 0; tile < num_tiles; tile++) {
+        encode_tile(tile);
+      }
+    }
+    WriteTiles(&bit_writer_);
+  }
+  if (split_rdo_pool) {
+    split_rdo_pool->FinishPicture();
+  }
+  colocated_motion_field_.reset();
+  if (ladder_downstream_) {
+    std::shared_ptr<const MotionField> published_field;
+    if (motion_field) {
+      published_field = motion_field_;
+    }
+    ladder_downstream_->Publish(
+      std::make_shared<LadderLink::PictureAnalysis>(*pic_data_,
+                                                    intra_mode_analysis,
+                                                    published_field));
+  }
+  pic_data_->StoreTemporalMvField();
   if (pic_data_->GetDeblock()) {
+    XVC_PERF_TIMER(kDeblock);
     DeblockingFilter deblocker(pic_data_.get(), rec_pic_.get(),
                                pic_data_->GetBetaOffset(),
                                pic_data_->GetTcOffset());
     deblocker.DeblockPicture();
   }
-  entropy_encoder.EncodeBinTrm(1);
-  entropy_encoder.Finish();
 
   int pic_tid = pic_data_->GetTid();
   if (pic_tid == 0 || !pic_data_->IsHighestLayer()) {
+    XVC_PERF_TIMER(kPadBorder);
     rec_pic_->PadBorder();
   }
   pic_data_->GetRefPicLists()->ZeroOutReferences();
   if (pic_tid == 0 || segment.checksum_mode == Checksum::Mode::kMaxRobust) {
+    XVC_PERF_TIMER(kChecksum);
     WriteChecksum(&bit_writer_, segment.checksum_mode);
   }
   return bit_writer_.GetBytes();
@@ -127,6 +207,34 @@ void PictureEncoder::WriteHeader(const PictureData &pic_data,
   bit_writer->PadZeroBits();
 }
 
+void PictureEncoder::EncodeTile(int tile_idx, const Qp &qp,
+                                CuEncoder *cu_encoder, BitWriter *bit_writer) {
+  // Each tile is coded as a separate cabac stream
+  EntropyEncoder entropy_encoder(bit_writer);
+  entropy_encoder.Start();
+  SyntaxWriter writer(qp, pic_data_->GetPredictionType(), &entropy_encoder);
+  for (int rsaddr : pic_data_->GetTileCtus(tile_idx)) {
+    cu_encoder->EncodeCtu(rsaddr, &writer);
+  }
+  entropy_encoder.EncodeBinTrm(1);
+  entropy_encoder.Finish();
+}
+
+void PictureEncoder::WriteTiles(BitWriter *bit_writer) {
+  // Entry points are given as the size in bytes of all but the last tile
+  for (size_t tile = 0; tile + 1 < tile_bit_writers_.size(); tile++) {
+    size_t tile_size = tile_bit_writers_[tile].GetBytes()->size();
+    assert(tile_size < (static_cast<size_t>(1) << 32));
+    bit_writer->WriteBits(static_cast<uint32_t>(tile_size >> 16), 16);
+    bit_writer->WriteBits(static_cast<uint32_t>(tile_size & 0xffff), 16);
+  }
+  for (BitWriter &tile_bit_writer : tile_bit_writers_) {
+    const std::vector<uint8_t> &bytes = *tile_bit_writer.GetBytes();
+    bit_writer->WriteBytes(&bytes[0], bytes.size());
+    tile_bit_writer.Clear();
+  }
+}
+
 void PictureEncoder::WriteChecksum(BitWriter *bit_writer,
                                    Checksum::Mode checksum_mode) {
   checksum_.Clear();
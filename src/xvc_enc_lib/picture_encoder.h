@@ -25,49 +25,98 @@
 
 #include "xvc_common_lib/checksum.h"
 #include "xvc_common_lib/common.h"
+#include "xvc_common_lib/perf_trace.h"
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/tile_thread_pool.h"
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_enc_lib/bit_writer.h"
 #include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/intra_mode_analysis.h"
+#include "xvc_enc_lib/ladder_link.h"
+#include "xvc_enc_lib/lookahead.h"
+#include "xvc_enc_lib/motion_field.h"
+#include "xvc_enc_lib/split_rdo_pool.h"
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/xvcenc.h"
 
 namespace xvc {
 
+class CuEncoder;
+
 class PictureEncoder {
 public:
   PictureEncoder(const SimdFunctions &simd, ChromaFormat chroma_format,
-                 int width, int height, int bitdepth);
+                 int width, int height, int bitdepth,
+                 std::shared_ptr<PictureData::CuStoragePool> cu_storage_pool =
+                 nullptr);
   std::shared_ptr<YuvPicture> GetOrigPic() { return orig_pic_; }
+  std::shared_ptr<const YuvPicture> GetOrigPic() const { return orig_pic_; }
   std::shared_ptr<const PictureData> GetPicData() const { return pic_data_; }
   std::shared_ptr<PictureData> GetPicData() { return pic_data_; }
   std::shared_ptr<const YuvPicture> GetRecPic() const { return rec_pic_; }
   std::shared_ptr<YuvPicture> GetRecPic() { return rec_pic_; }
   void SetOutputStatus(OutputStatus status) { output_status_ = status; }
   OutputStatus GetOutputStatus() const { return output_status_; }
+  void SetLookaheadAnalysis(
+    std::shared_ptr<const Lookahead::PictureAnalysis> analysis) {
+    lookahead_analysis_ = analysis;
+  }
+  // Motion field of a reference picture, only used by the next Encode call
+  void SetColocatedMotionField(std::shared_ptr<const MotionField> field) {
+    colocated_motion_field_ = field;
+  }
+  std::shared_ptr<const MotionField> GetMotionField() const {
+    return motion_field_;
+  }
+  // Links to the encoders of the neighboring rungs in a bitrate ladder
+  void SetLadderLinks(LadderLink *upstream, LadderLink *downstream) {
+    ladder_upstream_ = upstream;
+    ladder_downstream_ = downstream;
+  }
+  void SetSplitRdoPool(SplitRdoPool *split_rdo_pool) {
+    split_rdo_pool_ = split_rdo_pool;
+  }
+  void SetTileThreadPool(TileThreadPool *tile_thread_pool) {
+    tile_thread_pool_ = tile_thread_pool;
+  }
 
   std::vector<uint8_t>* Encode(const SegmentHeader &segment, int segment_qp,
                                PicNum sub_gop_length, int buffer_flag,
                                bool flat_lambda,
                                const EncoderSettings &encoder_settings);
   std::vector<uint8_t> GetLastChecksum() const { return checksum_.GetHash(); }
+  const PerfStats* GetPerfStats() const { return &perf_stats_; }
   std::shared_ptr<YuvPicture> GetAlternativeRecPic(
     ChromaFormat chroma_format, int width, int height, int bitdepth) const;
 
 private:
   void WriteHeader(const PictureData &pic_data, PicNum sub_gop_length,
                    int buffer_flag, BitWriter *bit_writer);
+  void EncodeTile(int tile_idx, const Qp &qp, CuEncoder *cu_encoder,
+                  BitWriter *bit_writer);
+  void WriteTiles(BitWriter *bit_writer);
   void WriteChecksum(BitWriter *bit_writer, Checksum::Mode checksum_mode);
   int DerivePictureQp(const PictureData &pic_data, int segment_qp) const;
 
   const SimdFunctions &simd_;
   BitWriter bit_writer_;
+  // Substreams of each tile when there is more than one tile
+  std::vector<BitWriter> tile_bit_writers_;
   Checksum checksum_;
+  PerfStats perf_stats_;
   std::shared_ptr<YuvPicture> orig_pic_;
   std::shared_ptr<PictureData> pic_data_;
   std::shared_ptr<YuvPicture> rec_pic_;
+  std::shared_ptr<const Lookahead::PictureAnalysis> lookahead_analysis_;
+  std::shared_ptr<IntraModeAnalysis> intra_mode_analysis_;
+  std::shared_ptr<MotionField> motion_field_;
+  std::shared_ptr<const MotionField> colocated_motion_field_;
+  LadderLink *ladder_upstream_ = nullptr;
+  LadderLink *ladder_downstream_ = nullptr;
+  SplitRdoPool *split_rdo_pool_ = nullptr;
+  TileThreadPool *tile_thread_pool_ = nullptr;
   OutputStatus output_status_ = OutputStatus::kHasNotBeenOutput;
 };
 
@@ -0,0 +1,257 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/rate_control.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/utils.h"
+
+namespace xvc {
+
+RateControl::RateControl(double bitrate, double framerate,
+                         double vbv_buffer_size, int width, int height)
+  : bitrate_(bitrate),
+  bits_per_pic_(bitrate / framerate),
+  vbv_buffer_size_(vbv_buffer_size),
+  vbv_fullness_(vbv_buffer_size * kVbvInitialFullness) {
+  const double bits_per_pixel =
+    bits_per_pic_ / std::max(width * height, 1);
+  const double lambda =
+    kSeedLambdaAlpha * std::pow(bits_per_pixel, kSeedLambdaBeta);
+  seed_qp_ = util::Clip3(kSeedQpScale * std::log(lambda) + kSeedQpOffset,
+                         static_cast<double>(constants::kMinAllowedQp),
+                         static_cast<double>(constants::kMaxAllowedQp));
+  bits_factor_.fill(0);
+  model_qp_.fill(0);
+  complexity_.fill(0);
+  qp_offset_.fill(0);
+  class_known_.fill(false);
+}
+
+int RateControl::SelectQp(int tid, bool intra_pic, PicNum sub_gop_length,
+                          double complexity) {
+  const int pic_class = GetClass(tid, intra_pic);
+  complexity = std::max(complexity, 1.0);
+  complexity_[pic_class] = complexity;
+
+  // The key picture is the first picture of a Sub Gop in encoding order
+  const bool key_pic = tid == 0 || !has_sub_gop_qp_;
+  if (key_pic) {
+    sub_gop_bits_ = 0;
+    sub_gop_predicted_bits_ = 0;
+    sub_gop_num_pics_ = 0;
+    key_class_ = pic_class;
+  }
+  // Until the model predicts the size of the pictures well, the Sub Gop qp
+  // is planned again for each picture and may change faster
+  if (key_pic || !converged_ || !class_known_[pic_class]) {
+    int qp = SelectSubGopQp(key_class_, sub_gop_length, complexity);
+    if (has_sub_gop_qp_) {
+      const int max_delta = converged_ ? kMaxQpDelta : kMaxQpDeltaUnconverged;
+      qp = util::Clip3(qp, sub_gop_qp_ - max_delta, sub_gop_qp_ + max_delta);
+    }
+    sub_gop_qp_ = qp;
+    has_sub_gop_qp_ = true;
+  }
+  int qp = sub_gop_qp_;
+
+  // Never let a single picture use more than what is left in the buffer
+  if (vbv_buffer_size_ > 0) {
+    double max_bits = std::max(vbv_fullness_ - vbv_buffer_size_ * kVbvMargin,
+                               bits_per_pic_ * kVbvMargin);
+    if (!class_known_[pic_class]) {
+      // The prediction is only a guess before the first picture of a class
+      max_bits *= 0.5;
+    }
+    double pic_bits = PredictBits(pic_class, complexity, qp);
+    if (pic_bits > max_bits) {
+      qp += static_cast<int>(
+        std::ceil(6 * std::log2(pic_bits / max_bits) / qstep_exponent_));
+    }
+  }
+  qp = util::Clip3(qp, constants::kMinAllowedQp, constants::kMaxAllowedQp);
+  last_class_ = pic_class;
+  last_qp_ = qp;
+  last_predicted_bits_ = PredictBits(pic_class, complexity, qp);
+  return qp;
+}
+
+void RateControl::Update(size_t num_bits, int pic_qp) {
+  const double bits = static_cast<double>(num_bits);
+  const double bits_factor = bits / complexity_[last_class_];
+  if (last_class_ == 0) {
+    UpdateQstepExponent(pic_qp, complexity_[last_class_], bits_factor);
+  }
+  if (class_known_[last_class_]) {
+    const double predicted_bits_factor = bits_factor_[last_class_] *
+      QstepRatio(model_qp_[last_class_], pic_qp);
+    bits_factor_[last_class_] = kModelDecay * predicted_bits_factor +
+      (1 - kModelDecay) * bits_factor;
+  } else {
+    bits_factor_[last_class_] = bits_factor;
+    class_known_[last_class_] = true;
+  }
+  model_qp_[last_class_] = pic_qp;
+  qp_offset_[last_class_] = pic_qp - last_qp_;
+  bits_encoded_ += bits;
+  bits_wanted_ += bits_per_pic_;
+  sub_gop_bits_ += bits;
+  sub_gop_num_pics_++;
+  sub_gop_predicted_bits_ += last_predicted_bits_;
+  converged_ = sub_gop_bits_ < sub_gop_predicted_bits_ * kMaxMisprediction &&
+    sub_gop_bits_ * kMaxMisprediction > sub_gop_predicted_bits_;
+  if (vbv_buffer_size_ > 0) {
+    vbv_fullness_ =
+      std::min(vbv_fullness_ - bits + bits_per_pic_, vbv_buffer_size_);
+  }
+}
+
+void RateControl::UpdateQstepExponent(int pic_qp, double complexity,
+                                      double bits_factor) {
+  // The size of intra pictures follows their spatial complexity closely, so
+  // the latest earlier intra picture of similar content gives the exponent
+  // if it was coded at a clearly different qp
+  const int num_pics = std::min(num_intra_pics_, kNumIntraPics);
+  for (int i = 1; i <= num_pics; i++) {
+    const IntraPicture &prev =
+      intra_pics_[(num_intra_pics_ - i) % kNumIntraPics];
+    const double complexity_change = complexity / prev.complexity;
+    if (complexity_change >= kExponentMaxComplexityChange ||
+        complexity_change * kExponentMaxComplexityChange <= 1) {
+      continue;
+    }
+    if (std::abs(pic_qp - prev.qp) >= kExponentMinQpDistance &&
+        bits_factor > 0 && prev.bits_factor > 0) {
+      double exponent = std::log(prev.bits_factor / bits_factor) /
+        std::log(QpToQstep(pic_qp) / QpToQstep(prev.qp));
+      exponent = util::Clip3(exponent, kMinQstepExponent, kMaxQstepExponent);
+      // The first estimate replaces the initial guess
+      qstep_exponent_ = !exponent_known_ ? exponent :
+        kModelDecay * qstep_exponent_ + (1 - kModelDecay) * exponent;
+      exponent_known_ = true;
+    }
+    break;
+  }
+  IntraPicture &pic = intra_pics_[num_intra_pics_ % kNumIntraPics];
+  pic.qp = pic_qp;
+  pic.complexity = complexity;
+  pic.bits_factor = bits_factor;
+  num_intra_pics_++;
+}
+
+double RateControl::CalcSpatialComplexity(const YuvPicture &pic) {
+  const YuvComponent luma = YuvComponent::kY;
+  const int width = pic.GetWidth(luma);
+  const int height = pic.GetHeight(luma);
+  const ptrdiff_t stride = pic.GetStride(luma);
+  const int num = kBlockSize * kBlockSize;
+  const double scale = 1.0 / (1 << (pic.GetBitdepth() - 8));
+  double complexity = 0;
+  for (int y = 0; y + kBlockSize <= height; y += kBlockSize) {
+    for (int x = 0; x + kBlockSize <= width; x += kBlockSize) {
+      const Sample *src = pic.GetSamplePtr(luma, x, y);
+      uint64_t sum = 0;
+      uint64_t squares = 0;
+      for (int i = 0; i < kBlockSize; i++) {
+        for (int j = 0; j < kBlockSize; j++) {
+          sum += src[j];
+          squares += src[j] * src[j];
+        }
+        src += stride;
+      }
+      double variance =
+        static_cast<double>(squares - (sum * sum) / num) / num;
+      complexity += num * std::sqrt(variance) * scale;
+    }
+  }
+  return complexity;
+}
+
+int RateControl::SelectSubGopQp(int pic_class, PicNum sub_gop_length,
+                                double complexity) const {
+  // Compensate for the deviation from target before this Sub Gop
+  sub_gop_length = std::max(sub_gop_length, static_cast<PicNum>(1));
+  double gop_target_bits = sub_gop_length * bits_per_pic_;
+  double deviation = ((bits_encoded_ - sub_gop_bits_) -
+                      (bits_wanted_ - sub_gop_num_pics_ * bits_per_pic_)) /
+    (bitrate_ * kCompensationWindow);
+  gop_target_bits *= util::Clip3(1 - deviation, 0.5, 1.5);
+  double vbv_scale = 1;
+  if (vbv_buffer_size_ > 0 &&
+      vbv_fullness_ < vbv_buffer_size_ * kVbvLowFullness) {
+    vbv_scale =
+      std::max(0.5, vbv_fullness_ / (vbv_buffer_size_ * kVbvLowFullness));
+  }
+
+  // Predicted bits of all pictures of the Sub Gop at base qp 0, and of those
+  // that are not yet encoded. An intra picture replaces the key picture.
+  double gop_bits = 0;
+  double remaining_bits = 0;
+  const PicNum first_doc = std::min(sub_gop_num_pics_, sub_gop_length - 1) + 1;
+  for (PicNum doc = 1; doc <= sub_gop_length; doc++) {
+    int doc_tid = SegmentHeader::CalcTidFromDoc(doc, sub_gop_length, 0);
+    int doc_class = doc_tid == 0 ? pic_class : GetClass(doc_tid, false);
+    double doc_complexity = complexity_[doc_class] > 0 ?
+      complexity_[doc_class] : complexity;
+    double doc_bits = PredictBits(doc_class, doc_complexity, 0);
+    gop_bits += doc_bits;
+    if (doc >= first_doc) {
+      remaining_bits += doc_bits;
+    }
+  }
+  // What is left of the target goes to the remaining pictures, but never
+  // move far from their planned share of it
+  const double share = gop_target_bits * remaining_bits / gop_bits;
+  const double target_bits = vbv_scale *
+    util::Clip3(gop_target_bits - sub_gop_bits_, share * 0.5, share * 1.25);
+  return static_cast<int>(std::lround(
+    6 * std::log2(remaining_bits / target_bits) / qstep_exponent_));
+}
+
+int RateControl::GetClass(int tid, bool intra_pic) {
+  return intra_pic ? 0 : std::min(tid + 1, kNumClasses - 1);
+}
+
+double RateControl::QpToQstep(double qp) {
+  return std::pow(2.0, (qp - 4) / 6.0);
+}
+
+int RateControl::GetQpOffset(int pic_class) const {
+  return class_known_[pic_class] ? qp_offset_[pic_class] : pic_class;
+}
+
+double RateControl::QstepRatio(double from_qp, double to_qp) const {
+  return std::pow(QpToQstep(from_qp) / QpToQstep(to_qp), qstep_exponent_);
+}
+
+double RateControl::PredictBits(int pic_class, double complexity,
+                                double base_qp) const {
+  const double pic_qp = base_qp + GetQpOffset(pic_class);
+  if (class_known_[pic_class]) {
+    return bits_factor_[pic_class] * complexity *
+      QstepRatio(model_qp_[pic_class], pic_qp);
+  }
+  // Guess that the picture would hit the target at the seed qp
+  return bits_per_pic_ * QstepRatio(seed_qp_ + GetQpOffset(pic_class), pic_qp);
+}
+
+}   // namespace xvc
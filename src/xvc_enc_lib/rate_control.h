@@ -0,0 +1,142 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_RATE_CONTROL_H_
+#define XVC_ENC_LIB_RATE_CONTROL_H_
+
+#include <array>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/yuv_pic.h"
+
+namespace xvc {
+
+// Single pass rate control for a target bitrate with an optional VBV (video
+// buffering verifier) buffer constraint. Pictures are given in encoding
+// order and for each picture a base qp is selected, i.e. the qp before the
+// temporal layer adjustment made by PictureEncoder.
+// The number of bits of a picture is predicted as k * complexity / qstep^e
+// where k is learned separately for intra pictures and for inter pictures
+// of each temporal layer from the previously encoded pictures. The exponent
+// e starts at 1 and is learned from intra pictures coded at different qp,
+// at low qp it is typically well below 1 and e = 1 would overpredict the
+// size. Pictures of a class that has not been encoded yet are assumed to
+// hit the target at a qp derived from the target bits per pixel. One base qp
+// is selected for each Sub Gop such that the predicted size of the Sub Gop
+// matches the target, with any deviation so far compensated over a window
+// of a few seconds. Individual pictures only deviate from the Sub Gop qp
+// when needed to not underflow the VBV buffer.
+class RateControl {
+public:
+  // Block size used for complexity estimation, same as for adaptive qp
+  static const int kBlockSize = 8;
+  // Max change of base qp between consecutive Sub Gops, and before the
+  // model has predicted the size of a Sub Gop within kMaxMisprediction
+  static const int kMaxQpDelta = 4;
+  static const int kMaxQpDeltaUnconverged = 12;
+  static constexpr double kMaxMisprediction = 1.25;
+  // Time in seconds over which an overshoot or undershoot is compensated
+  static constexpr double kCompensationWindow = 2.0;
+  // Initial and lowest desired VBV buffer fullness
+  static constexpr double kVbvInitialFullness = 0.9;
+  static constexpr double kVbvLowFullness = 0.5;
+  // Fraction of the VBV buffer that is kept as a safety margin
+  static constexpr double kVbvMargin = 0.1;
+
+  // Bitrate in bits per second, vbv_buffer_size in bits (0 disables VBV)
+  RateControl(double bitrate, double framerate, double vbv_buffer_size,
+              int width, int height);
+  // Returns the base qp of the next picture in encoding order
+  int SelectQp(int tid, bool intra_pic, PicNum sub_gop_length,
+               double complexity);
+  // Updates the model with the size and the resulting qp, after lambda
+  // based adjustment, of the picture given to the last call to SelectQp
+  void Update(size_t num_bits, int pic_qp);
+  double GetVbvFullness() const { return vbv_fullness_; }
+  // Sum of standard deviations of all kBlockSize x kBlockSize luma blocks
+  // multiplied by block area
+  static double CalcSpatialComplexity(const YuvPicture &pic);
+
+private:
+  // Classes for intra pictures and inter pictures of each temporal layer
+  static const int kNumClasses = 8;
+  // Parameters of the R-lambda model of JCTVC-K0103 used to guess the
+  // base qp from the target bits per pixel before a class has been encoded
+  static constexpr double kSeedLambdaAlpha = 3.2003;
+  static constexpr double kSeedLambdaBeta = -1.367;
+  static constexpr double kSeedQpScale = 4.2005;
+  static constexpr double kSeedQpOffset = 13.7122;
+  // Weight of the previous estimate when a class model is updated
+  static constexpr double kModelDecay = 0.5;
+  // Range of the qstep exponent, only estimated from two of the last
+  // kNumIntraPics intra pictures at least kExponentMinQpDistance apart and
+  // with complexities that differ by less than kExponentMaxComplexityChange
+  static constexpr double kMinQstepExponent = 0.3;
+  static constexpr double kMaxQstepExponent = 1.5;
+  static const int kExponentMinQpDistance = 3;
+  static constexpr double kExponentMaxComplexityChange = 1.25;
+  static const int kNumIntraPics = 4;
+
+  struct IntraPicture {
+    int qp;
+    double complexity;
+    double bits_factor;
+  };
+
+  void UpdateQstepExponent(int pic_qp, double complexity, double bits_factor);
+  int SelectSubGopQp(int pic_class, PicNum sub_gop_length,
+                     double complexity) const;
+  static int GetClass(int tid, bool intra_pic);
+  static double QpToQstep(double qp);
+  int GetQpOffset(int pic_class) const;
+  // Ratio of the size at to_qp and the size at from_qp
+  double QstepRatio(double from_qp, double to_qp) const;
+  double PredictBits(int pic_class, double complexity, double base_qp) const;
+
+  const double bitrate_;
+  const double bits_per_pic_;
+  const double vbv_buffer_size_;
+  double seed_qp_;
+  double vbv_fullness_;
+  // Predicted bits per complexity of each class at model_qp_
+  std::array<double, kNumClasses> bits_factor_;
+  std::array<int, kNumClasses> model_qp_;
+  std::array<double, kNumClasses> complexity_;
+  std::array<int, kNumClasses> qp_offset_;
+  std::array<bool, kNumClasses> class_known_;
+  double qstep_exponent_ = 1;
+  bool exponent_known_ = false;
+  std::array<IntraPicture, kNumIntraPics> intra_pics_;
+  int num_intra_pics_ = 0;
+  double bits_encoded_ = 0;
+  double bits_wanted_ = 0;
+  double sub_gop_bits_ = 0;
+  double sub_gop_predicted_bits_ = 0;
+  PicNum sub_gop_num_pics_ = 0;
+  int sub_gop_qp_ = 0;
+  bool has_sub_gop_qp_ = false;
+  bool converged_ = false;
+  int key_class_ = 0;
+  int last_class_ = 0;
+  int last_qp_ = 0;
+  double last_predicted_bits_ = 0;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_RATE_CONTROL_H_
@@ -26,6 +26,7 @@
 #include <utility>
 #include <vector>
 
+#include "xvc_common_lib/perf_trace.h"
 #include "xvc_common_lib/transform.h"
 #include "xvc_enc_lib/encoder_settings.h"
 
@@ -202,6 +203,7 @@ int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
                        const SyntaxWriter &writer,
                        const Coeff *src, ptrdiff_t src_stride,
                        Coeff *out, ptrdiff_t out_stride) {
+  XVC_PERF_TIMER(kRdoQuant);
   if (cu.GetWidth(comp) == 2 || cu.GetHeight(comp) == 2) {
     if (EncoderSettings::rdo_quant_size_2) {
       return QuantRdo<1>(cu, comp, qp, pic_type, writer, src, src_stride,
@@ -268,6 +270,7 @@ int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
   int64_t comp_zero_dist = 0;
   int64_t comp_code_cost = 0;
 
+  ContextModel *sig_ctx_base = contexts->GetCoeffSigCtxBase(comp);
   SubblockScan<SubBlockShift> subblock_scan(scan_order, width, height);
   for (auto &subblock : subblock_scan) {
     int last_c1 = code_state.c1;
@@ -285,6 +288,11 @@ int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
       contexts->GetSubblockCsbfCtx(comp, &subblock_csbf[0], subblock.scan_x,
                                    subblock.scan_y, subblock_width,
                                    subblock_height, &pattern_sig_ctx);
+    // Contexts of 2x2 subblocks are derived per coefficient
+    const uint8_t *sig_ctx_idx = SubBlockShift == 1 ? nullptr :
+      contexts->GetCoeffSigCtxIdx(comp, pattern_sig_ctx, scan_order,
+                                  subblock.pos_x == 0 && subblock.pos_y == 0,
+                                  width_log2, height_log2);
     int num_non_zero = 0;
 
     for (auto &coeff : subblock) {
@@ -304,10 +312,11 @@ int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
         continue;
       }
 
-      ContextModel &sig_ctx =
+      ContextModel &sig_ctx = SubBlockShift == 1 ?
         contexts->GetCoeffSigCtx(comp, pattern_sig_ctx, scan_order,
                                  coeff.scan_x, coeff.scan_y,
-                                 width_log2, height_log2);
+                                 width_log2, height_log2) :
+        sig_ctx_base[sig_ctx_idx[coeff.offset]];
       const Bits sig0_bits = sig_ctx.GetEntropyBits(0);
       Bits sig1_bits = sig_ctx.GetEntropyBits(1);
       if (last_pos_index == coeff.index ||
@@ -882,28 +891,28 @@ Bits RdoQuant::GetLastPosBits(int width, int height, YuvComponent comp,
   }
   const int group_idx_x = TransformHelper::kLastPosGroupIdx[last_pos_x];
   const int group_idx_y = TransformHelper::kLastPosGroupIdx[last_pos_y];
+  ContextModel *ctx_base_x = contexts->GetCoeffLastPosCtxBase(comp, true);
+  ContextModel *ctx_base_y = contexts->GetCoeffLastPosCtxBase(comp, false);
+  const uint8_t *ctx_idx_x = contexts->GetCoeffLastPosCtxIdx(comp, width);
+  const uint8_t *ctx_idx_y = contexts->GetCoeffLastPosCtxIdx(comp, height);
   // pos X
   int ctx_last_x;
   for (ctx_last_x = 0; ctx_last_x < group_idx_x; ctx_last_x++) {
-    ContextModel &ctx =
-      contexts->GetCoeffLastPosCtx(comp, width, height, ctx_last_x, true);
+    ContextModel &ctx = ctx_base_x[ctx_idx_x[ctx_last_x]];
     bits += ctx.GetEntropyBits(1);
   }
   if (group_idx_x < TransformHelper::kLastPosGroupIdx[width - 1]) {
-    ContextModel &ctx =
-      contexts->GetCoeffLastPosCtx(comp, width, height, ctx_last_x, true);
+    ContextModel &ctx = ctx_base_x[ctx_idx_x[ctx_last_x]];
     bits += ctx.GetEntropyBits(0);
   }
   // pos Y
   int ctx_last_y;
   for (ctx_last_y = 0; ctx_last_y < group_idx_y; ctx_last_y++) {
-    ContextModel &ctx =
-      contexts->GetCoeffLastPosCtx(comp, width, height, ctx_last_y, false);
+    ContextModel &ctx = ctx_base_y[ctx_idx_y[ctx_last_y]];
     bits += ctx.GetEntropyBits(1);
   }
   if (group_idx_y < TransformHelper::kLastPosGroupIdx[height - 1]) {
-    ContextModel &ctx =
-      contexts->GetCoeffLastPosCtx(comp, width, height, ctx_last_y, false);
+    ContextModel &ctx = ctx_base_y[ctx_idx_y[ctx_last_y]];
     bits += ctx.GetEntropyBits(0);
   }
   if (group_idx_x > 3) {
@@ -18,6 +18,7 @@
 
 #include "xvc_enc_lib/sample_metric.h"
 
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
@@ -82,6 +83,52 @@ SampleMetric::CompareSample(YuvComponent comp, int width, int height,
   return Compare(comp, width, height, src1, stride1, src2, stride2);
 }
 
+void
+SampleMetric::CompareSampleBatch(YuvComponent comp, int width, int height,
+                                 const Sample *src1, ptrdiff_t stride1,
+                                 const Sample *const *src2, ptrdiff_t stride2,
+                                 int num_candidates, Distortion *out_dist) {
+  assert(num_candidates <= kMaxBatchSize);
+  std::array<uint64_t, kMaxBatchSize> dist;
+  switch (type_) {
+    case MetricType::kSad:
+    case MetricType::kSadFast:
+    {
+      // Original samples are loaded once and compared against all candidates
+      const int row_step = type_ == MetricType::kSadFast ? 2 : 1;
+      int i = 0;
+      for (; i + 8 <= num_candidates; i += 8) {
+        ComputeSadXN<8>(width, height, src1, stride1, src2 + i, stride2,
+                        row_step, &dist[i]);
+      }
+      for (; i + 4 <= num_candidates; i += 4) {
+        ComputeSadXN<4>(width, height, src1, stride1, src2 + i, stride2,
+                        row_step, &dist[i]);
+      }
+      for (; i < num_candidates; i++) {
+        ComputeSadXN<1>(width, height, src1, stride1, src2 + i, stride2,
+                        row_step, &dist[i]);
+      }
+      break;
+    }
+    case MetricType::kSatd:
+      for (int i = 0; i < num_candidates; i++) {
+        dist[i] = ComputeSatd(width, height, src1, stride1, src2[i], stride2);
+      }
+      break;
+    default:
+      for (int i = 0; i < num_candidates; i++) {
+        out_dist[i] =
+          Compare(comp, width, height, src1, stride1, src2[i], stride2);
+      }
+      return;
+  }
+  double weight = qp_.GetDistortionWeight(comp);
+  for (int i = 0; i < num_candidates; i++) {
+    out_dist[i] = static_cast<Distortion>(dist[i] * weight);
+  }
+}
+
 Distortion SampleMetric::CompareShort(YuvComponent comp, int width, int height,
                                       const DataBuffer<Residual> &src1,
                                       const DataBuffer<Residual> &src2) {
@@ -459,6 +506,32 @@ uint64_t SampleMetric::ComputeSad(int width, int height,
   return sum >> (bitdepth_ - 8);
 }
 
+template<int N, typename SampleT1, typename SampleT2>
+void SampleMetric::ComputeSadXN(int width, int height,
+                                const SampleT1 *sample1, ptrdiff_t stride1,
+                                const SampleT2 *const *sample2,
+                                ptrdiff_t stride2, int row_step,
+                                uint64_t *out_sad) {
+  std::array<uint64_t, N> sum;
+  sum.fill(0);
+  ptrdiff_t offset2 = 0;
+  for (int y = 0; y < height; y += row_step) {
+    for (int x = 0; x < width; x++) {
+      const int orig = sample1[x];
+      for (int n = 0; n < N; n++) {
+        sum[n] += std::abs(orig - sample2[n][offset2 + x]);
+      }
+    }
+    sample1 += stride1 * row_step;
+    offset2 += stride2 * row_step;
+  }
+  // Sub-sampled rows are compensated for to match ComputeSadFast
+  const int scale = row_step == 2 ? 1 : 0;
+  for (int n = 0; n < N; n++) {
+    out_sad[n] = (sum[n] << scale) >> (bitdepth_ - 8);
+  }
+}
+
 template<typename SampleT1, typename SampleT2>
 uint64_t
 SampleMetric::ComputeSadFast(int width, int height,
@@ -40,6 +40,8 @@ enum class MetricType {
 
 class SampleMetric {
 public:
+  static const int kMaxBatchSize = 8;
+
   SampleMetric(MetricType type, const Qp &qp, int bitdepth)
     : type_(type), qp_(qp), bitdepth_(bitdepth) {
   }
@@ -61,6 +63,11 @@ public:
   Distortion CompareSample(YuvComponent comp, int width, int height,
                            const Residual *src1, ptrdiff_t stride1,
                            const Sample *src2, ptrdiff_t stride2);
+  // Sample vs multiple candidates sharing the same stride (batched)
+  void CompareSampleBatch(YuvComponent comp, int width, int height,
+                          const Sample *src1, ptrdiff_t stride1,
+                          const Sample *const *src2, ptrdiff_t stride2,
+                          int num_candidates, Distortion *out_dist);
   // Residual vs Residual
   Distortion CompareShort(YuvComponent comp, int width, int height,
                           const DataBuffer<Residual> &src1,
@@ -89,6 +96,11 @@ private:
   uint64_t ComputeSad(int width, int height,
                       const SampleT1 *sample1, ptrdiff_t stride1,
                       const SampleT2 *sample2, ptrdiff_t stride2);
+  template<int N, typename SampleT1, typename SampleT2>
+  void ComputeSadXN(int width, int height,
+                    const SampleT1 *sample1, ptrdiff_t stride1,
+                    const SampleT2 *const *sample2, ptrdiff_t stride2,
+                    int row_step, uint64_t *out_sad);
   template<typename SampleT1, typename SampleT2>
   uint64_t ComputeSadFast(int width, int height,
                           const SampleT1 *sample1, ptrdiff_t stride1,
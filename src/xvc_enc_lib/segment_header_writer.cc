@@ -172,6 +172,18 @@ void SegmentHeaderWriter::Write(SegmentHeader* segment_header,
   } else {
     bit_writer->WriteBit(0);  // ext_restrictions
   }
+  if (segment_header->minor_version >= constants::kTilesMinorVersion) {
+    int d = constants::kTileSizeBits;
+    assert(segment_header->num_tile_columns <= constants::kMaxTileColumns);
+    assert(segment_header->num_tile_rows <= constants::kMaxTileRows);
+    int tiles = (segment_header->num_tile_columns > 1 ||
+                 segment_header->num_tile_rows > 1) ? 1 : 0;
+    bit_writer->WriteBit(tiles);
+    if (tiles) {
+      bit_writer->WriteBits(segment_header->num_tile_columns - 1, d);
+      bit_writer->WriteBits(segment_header->num_tile_rows - 1, d);
+    }
+  }
   bit_writer->PadZeroBits();
 }
 
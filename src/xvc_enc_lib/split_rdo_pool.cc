@@ -0,0 +1,279 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_enc_lib/split_rdo_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "xvc_common_lib/utils.h"
+#include "xvc_enc_lib/cu_encoder.h"
+
+namespace xvc {
+
+SplitRdoPool::SplitRdoPool(const SimdFunctions &simd, int num_threads) {
+  for (int i = 0; i < num_threads; i++) {
+    workers_.emplace_back(new Worker(simd));
+  }
+}
+
+void SplitRdoPool::StartPicture(
+  const SegmentHeader &segment, const Qp &pic_qp, const PictureData &pic_data,
+  const YuvPicture &orig_pic,
+  const Lookahead::PictureAnalysis *lookahead_analysis,
+  const IntraModeAnalysis *intra_mode_analysis,
+  const MotionField *motion_field, const EncoderSettings &encoder_settings) {
+  for (auto &worker : workers_) {
+    worker->StartPicture(segment, pic_qp, pic_data, orig_pic,
+                         lookahead_analysis, intra_mode_analysis,
+                         motion_field, encoder_settings);
+  }
+}
+
+void SplitRdoPool::FinishPicture() {
+  for (auto &worker : workers_) {
+    worker->FinishPicture();
+  }
+}
+
+SplitRdoPool::Worker* SplitRdoPool::Acquire() {
+  // Only called from the encoding thread, workers are released in Finish
+  for (auto &worker : workers_) {
+    if (!worker->in_use_) {
+      worker->in_use_ = true;
+      return worker.get();
+    }
+  }
+  return nullptr;
+}
+
+SplitRdoPool::Worker::Worker(const SimdFunctions &simd)
+  : simd_(simd) {
+  thread_ = std::thread(&Worker::WorkerMain, this);
+}
+
+SplitRdoPool::Worker::~Worker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  wait_work_cond_.notify_one();
+  thread_.join();
+}
+
+void SplitRdoPool::Worker::StartPicture(
+  const SegmentHeader &segment, const Qp &pic_qp, const PictureData &pic_data,
+  const YuvPicture &orig_pic,
+  const Lookahead::PictureAnalysis *lookahead_analysis,
+  const IntraModeAnalysis *intra_mode_analysis,
+  const MotionField *motion_field, const EncoderSettings &encoder_settings) {
+  const YuvComponent luma = YuvComponent::kY;
+  const int width = pic_data.GetPictureWidth(luma);
+  const int height = pic_data.GetPictureHeight(luma);
+  if (!pic_data_ || pic_data_->GetPictureWidth(luma) != width ||
+      pic_data_->GetPictureHeight(luma) != height ||
+      pic_data_->GetChromaFormat() != pic_data.GetChromaFormat() ||
+      pic_data_->GetBitdepth() != pic_data.GetBitdepth()) {
+    pic_data_.reset(new PictureData(pic_data.GetChromaFormat(), width, height,
+                                    pic_data.GetBitdepth()));
+    rec_pic_.reset(new YuvPicture(pic_data.GetChromaFormat(), width, height,
+                                  pic_data.GetBitdepth(), true));
+    motion_field_.reset();
+  }
+  if (motion_field) {
+    if (!motion_field_) {
+      motion_field_.reset(new MotionField(width, height));
+    }
+    motion_field_->StartPicture(pic_data.GetPoc(),
+                                motion_field->GetColocated(),
+                                motion_field->GetLadder());
+  }
+  pic_data_->SetNalType(pic_data.GetNalType());
+  pic_data_->SetPoc(pic_data.GetPoc());
+  pic_data_->SetDoc(pic_data.GetDoc());
+  pic_data_->SetSoc(pic_data.GetSoc());
+  pic_data_->SetTid(pic_data.GetTid());
+  pic_data_->SetHighestLayer(pic_data.IsHighestLayer());
+  pic_data_->SetAdaptiveQp(pic_data.GetAdaptiveQp());
+  pic_data_->SetDeblock(pic_data.GetDeblock());
+  pic_data_->SetBetaOffset(pic_data.GetBetaOffset());
+  pic_data_->SetTcOffset(pic_data.GetTcOffset());
+  *pic_data_->GetRefPicLists() = *pic_data.GetRefPicLists();
+  pic_data_->Init(segment, pic_qp, encoder_settings.adaptive_qp > 0);
+  restrictions_ = Restrictions::Get();
+  perf_stats_ = PerfStats::GetCurrent();
+  cu_clones_.clear();
+  cu_ = nullptr;
+  cu_encoder_.reset(new CuEncoder(simd_, orig_pic, rec_pic_.get(),
+                                  pic_data_.get(), lookahead_analysis,
+                                  intra_mode_analysis,
+                                  motion_field ? motion_field_.get() : nullptr,
+                                  nullptr, nullptr, encoder_settings));
+}
+
+void SplitRdoPool::Worker::FinishPicture() {
+  assert(!in_use_);
+  ReleaseCus();
+  cu_encoder_.reset();
+  pic_data_->GetRefPicLists()->ZeroOutReferences();
+}
+
+void SplitRdoPool::Worker::Start(const CodingUnit &cu, const Qp &qp,
+                                 int rdo_depth,
+                                 SplitRestriction split_restriction,
+                                 const RdoSyntaxWriter &writer,
+                                 const YuvPicture &rec_pic,
+                                 const PictureData &pic_data,
+                                 const CuCache &cu_cache,
+                                 const InterSearch::FullpelMvs &fullpel_mvs,
+                                 const MotionField *motion_field) {
+  assert(in_use_ && state_ == State::kIdle);
+  ReleaseCus();
+  const YuvComponent luma = YuvComponent::kY;
+  const CuTree cu_tree = cu.GetCuTree();
+  const int posx = cu.GetPosX(luma);
+  const int posy = cu.GetPosY(luma);
+  const int width = cu.GetWidth(luma);
+  const int height = cu.GetHeight(luma);
+  const int size = std::max(width, height);
+  const int margin = constants::kMinBlockSize;
+  // Above-left, above and above-right
+  if (posy > 0) {
+    CopyArea(cu_tree, std::max(posx - margin, 0), posy - margin,
+             std::min(posx + width + size, pic_data.GetPictureWidth(luma)),
+             posy, rec_pic, pic_data);
+  }
+  // Left and below-left
+  if (posx > 0) {
+    CopyArea(cu_tree, posx - margin, posy, posx,
+             std::min(posy + height + size, pic_data.GetPictureHeight(luma)),
+             rec_pic, pic_data);
+  }
+  cu_ = pic_data_->CreateCu(cu_tree, cu.GetDepth(), posx, posy, width, height);
+  cu_->SetQp(qp.GetQpRaw(luma));
+  pic_data_->ClearMarkCuInPic(cu_);
+  cu_encoder_->cu_cache_.CopyEntryFrom(cu_cache, *cu_);
+  cu_encoder_->inter_search_.SetPreviousFullpel(fullpel_mvs);
+  if (motion_field) {
+    motion_field_->CopyNeighborhood(*motion_field, cu);
+  }
+  if (!writer_) {
+    writer_.reset(new RdoSyntaxWriter(writer));
+  } else {
+    *writer_ = writer;
+  }
+  rdo_depth_ = rdo_depth;
+  split_restriction_ = split_restriction;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = State::kPending;
+  }
+  wait_work_cond_.notify_one();
+}
+
+Distortion SplitRdoPool::Worker::Finish(CodingUnit *cu, const Qp &qp,
+                                        CodingUnit::ReconstructionState *state,
+                                        RdoSyntaxWriter *writer,
+                                        CuCache *cu_cache) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_done_cond_.wait(lock, [this] { return state_ == State::kDone; });
+    state_ = State::kIdle;
+  }
+  if (cu->GetSplit() != SplitType::kNone) {
+    cu->UnSplit();
+  }
+  cu->CopyPredictionDataFrom(*cu_);
+  cu->SetQp(qp);
+  cu_->SaveStateTo(state, *rec_pic_);
+  *writer = *writer_;
+  cu_cache->CopyEntryFrom(cu_encoder_->cu_cache_, *cu_);
+  in_use_ = false;
+  return dist_;
+}
+
+void SplitRdoPool::Worker::CopyArea(CuTree cu_tree, int x0, int y0,
+                                    int x1, int y1, const YuvPicture &rec_pic,
+                                    const PictureData &pic_data) {
+  for (int c = 0; c < pic_data.GetMaxNumComponents(); c++) {
+    const YuvComponent comp = static_cast<YuvComponent>(c);
+    const int shift_x = util::IsLuma(comp) ? 0 : pic_data.GetChromaShiftX();
+    const int shift_y = util::IsLuma(comp) ? 0 : pic_data.GetChromaShiftY();
+    SampleBuffer dst =
+      rec_pic_->GetSampleBuffer(comp, x0 >> shift_x, y0 >> shift_y);
+    dst.CopyFrom((x1 - x0) >> shift_x, (y1 - y0) >> shift_y,
+                 rec_pic.GetSampleBuffer(comp, x0 >> shift_x, y0 >> shift_y));
+  }
+  for (int y = y0; y < y1; y += constants::kMinBlockSize) {
+    for (int x = x0; x < x1; x += constants::kMinBlockSize) {
+      const CodingUnit *cu = pic_data.GetCuAt(cu_tree, x, y);
+      pic_data_->SetCuAt(cu_tree, x, y, cu ? CloneCu(*cu) : nullptr);
+    }
+  }
+}
+
+CodingUnit* SplitRdoPool::Worker::CloneCu(const CodingUnit &cu) {
+  for (auto &clone : cu_clones_) {
+    if (clone.first == &cu) {
+      return clone.second;
+    }
+  }
+  const YuvComponent luma = YuvComponent::kY;
+  CodingUnit *clone =
+    pic_data_->CreateCu(cu.GetCuTree(), cu.GetDepth(), cu.GetPosX(luma),
+                        cu.GetPosY(luma), cu.GetWidth(luma),
+                        cu.GetHeight(luma));
+  *clone = cu;
+  clone->SetQp(cu.GetQp(luma));
+  cu_clones_.emplace_back(&cu, clone);
+  return clone;
+}
+
+void SplitRdoPool::Worker::ReleaseCus() {
+  for (auto &clone : cu_clones_) {
+    pic_data_->ReleaseCu(clone.second);
+  }
+  cu_clones_.clear();
+  if (cu_) {
+    pic_data_->ReleaseCu(cu_);
+    cu_ = nullptr;
+  }
+}
+
+void SplitRdoPool::Worker::WorkerMain() {
+  XVC_PERF_THREAD_NAME("split rdo worker");
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wait_work_cond_.wait(lock, [this] {
+      return !running_ || state_ == State::kPending;
+    });
+    if (!running_) {
+      break;
+    }
+    lock.unlock();
+    Restrictions::GetRW() = restrictions_;
+    XVC_PERF_STATS_SCOPE(perf_stats_);
+    dist_ = cu_encoder_->CompressNoSplit(&cu_, rdo_depth_, split_restriction_,
+                                         writer_.get());
+    lock.lock();
+    state_ = State::kDone;
+    work_done_cond_.notify_one();
+  }
+}
+
+}   // namespace xvc
@@ -0,0 +1,138 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_SPLIT_RDO_POOL_H_
+#define XVC_ENC_LIB_SPLIT_RDO_POOL_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <memory>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <utility>
+#include <vector>
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/perf_trace.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/restrictions.h"
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/yuv_pic.h"
+#include "xvc_enc_lib/cu_cache.h"
+#include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/inter_search.h"
+#include "xvc_enc_lib/intra_mode_analysis.h"
+#include "xvc_enc_lib/lookahead.h"
+#include "xvc_enc_lib/motion_field.h"
+#include "xvc_enc_lib/syntax_writer.h"
+
+namespace xvc {
+
+class CuEncoder;
+
+// Worker threads for evaluating the coding of a cu without split while the
+// calling thread evaluates the split candidates of the same cu. Each worker
+// has its own picture data, reconstruction and CuEncoder scratch buffers, and
+// only the neighborhood of the evaluated cu is copied into them. The split
+// candidates are still evaluated in order by the caller since later split
+// candidates depend on CuCache results of earlier ones. Together with
+// CuEncoder not letting the result without split seed the motion search of
+// the split candidates, the bitstream is identical to a sequential
+// evaluation regardless of the number of worker threads.
+class SplitRdoPool {
+public:
+  class Worker {
+  public:
+    explicit Worker(const SimdFunctions &simd);
+    ~Worker();
+    // Copy the neighborhood of cu and start evaluating it without split
+    void Start(const CodingUnit &cu, const Qp &qp, int rdo_depth,
+               SplitRestriction split_restriction,
+               const RdoSyntaxWriter &writer, const YuvPicture &rec_pic,
+               const PictureData &pic_data, const CuCache &cu_cache,
+               const InterSearch::FullpelMvs &fullpel_mvs,
+               const MotionField *motion_field);
+    // Wait for the evaluation to finish and copy the resulting prediction
+    // data to cu, reconstruction to state and bit counting to writer
+    Distortion Finish(CodingUnit *cu, const Qp &qp,
+                      CodingUnit::ReconstructionState *state,
+                      RdoSyntaxWriter *writer, CuCache *cu_cache);
+
+  private:
+    enum class State { kIdle, kPending, kDone };
+    void StartPicture(const SegmentHeader &segment, const Qp &pic_qp,
+                      const PictureData &pic_data, const YuvPicture &orig_pic,
+                      const Lookahead::PictureAnalysis *lookahead_analysis,
+                      const IntraModeAnalysis *intra_mode_analysis,
+                      const MotionField *motion_field,
+                      const EncoderSettings &encoder_settings);
+    void FinishPicture();
+    void CopyArea(CuTree cu_tree, int x0, int y0, int x1, int y1,
+                  const YuvPicture &rec_pic, const PictureData &pic_data);
+    CodingUnit* CloneCu(const CodingUnit &cu);
+    void ReleaseCus();
+    void WorkerMain();
+
+    const SimdFunctions &simd_;
+    std::unique_ptr<PictureData> pic_data_;
+    std::unique_ptr<YuvPicture> rec_pic_;
+    std::unique_ptr<CuEncoder> cu_encoder_;
+    std::unique_ptr<RdoSyntaxWriter> writer_;
+    // Private copy of the neighborhood of the evaluated cu
+    std::unique_ptr<MotionField> motion_field_;
+    // Copies of neighboring cu objects, indexed by the original object
+    std::vector<std::pair<const CodingUnit*, CodingUnit*>> cu_clones_;
+    CodingUnit *cu_ = nullptr;
+    int rdo_depth_ = 0;
+    SplitRestriction split_restriction_ = SplitRestriction::kNone;
+    // Restriction flags are thread local, copied from the encoding thread
+    Restrictions restrictions_;
+    PerfStats *perf_stats_ = nullptr;
+    Distortion dist_ = 0;
+    bool in_use_ = false;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wait_work_cond_;
+    std::condition_variable work_done_cond_;
+    State state_ = State::kIdle;
+    bool running_ = true;
+    friend class SplitRdoPool;
+  };
+
+  SplitRdoPool(const SimdFunctions &simd, int num_threads);
+  // Must be called after pic_data has been initialized and before any cu
+  // of the picture is evaluated
+  void StartPicture(const SegmentHeader &segment, const Qp &pic_qp,
+                    const PictureData &pic_data, const YuvPicture &orig_pic,
+                    const Lookahead::PictureAnalysis *lookahead_analysis,
+                    const IntraModeAnalysis *intra_mode_analysis,
+                    const MotionField *motion_field,
+                    const EncoderSettings &encoder_settings);
+  void FinishPicture();
+  // Returns an idle worker or nullptr if all workers are busy
+  Worker* Acquire();
+
+private:
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_SPLIT_RDO_POOL_H_
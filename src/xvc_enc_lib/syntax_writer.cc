@@ -146,6 +146,7 @@ void SyntaxWriter::WriteCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
   }
 
   int c1 = 1;
+  ContextModel *sig_ctx_base = ctx_.GetCoeffSigCtxBase(comp);
 
   for (int subblock_index = subblock_last_index; subblock_index >= 0;
        subblock_index--) {
@@ -187,6 +188,11 @@ void SyntaxWriter::WriteCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
     if (!sig) {
       continue;
     }
+    // Contexts of 2x2 subblocks are derived per coefficient
+    const uint8_t *sig_ctx_idx = SubBlockShift == 1 ? nullptr :
+      ctx_.GetCoeffSigCtxIdx(comp, pattern_sig_ctx, scan_order,
+                             subblock_pos_x == 0 && subblock_pos_y == 0,
+                             width_log2, height_log2);
 
     // sig flags
     for (int coeff_index = subblock_size - subblock_last_coeff_offset;
@@ -201,9 +207,10 @@ void SyntaxWriter::WriteCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
         // implicitly signaled 1
         assert(coeff != 0);
       } else {
-        ContextModel &ctx =
+        ContextModel &ctx = SubBlockShift == 1 ?
           ctx_.GetCoeffSigCtx(comp, pattern_sig_ctx, scan_order, coeff_scan_x,
-                              coeff_scan_y, width_log2, height_log2);
+                              coeff_scan_y, width_log2, height_log2) :
+          sig_ctx_base[sig_ctx_idx[coeff_index]];
         entropyenc_->EncodeBin(coeff != 0, &ctx);
       }
       if (coeff != 0) {
@@ -541,28 +548,28 @@ void SyntaxWriter::WriteCoeffLastPos(int width, int height, YuvComponent comp,
   }
   int group_idx_x = TransformHelper::kLastPosGroupIdx[last_pos_x];
   int group_idx_y = TransformHelper::kLastPosGroupIdx[last_pos_y];
+  ContextModel *ctx_base_x = ctx_.GetCoeffLastPosCtxBase(comp, true);
+  ContextModel *ctx_base_y = ctx_.GetCoeffLastPosCtxBase(comp, false);
+  const uint8_t *ctx_idx_x = ctx_.GetCoeffLastPosCtxIdx(comp, width);
+  const uint8_t *ctx_idx_y = ctx_.GetCoeffLastPosCtxIdx(comp, height);
   // pos X
   int ctx_last_x;
   for (ctx_last_x = 0; ctx_last_x < group_idx_x; ctx_last_x++) {
-    ContextModel &ctx =
-      ctx_.GetCoeffLastPosCtx(comp, width, height, ctx_last_x, true);
+    ContextModel &ctx = ctx_base_x[ctx_idx_x[ctx_last_x]];
     entropyenc_->EncodeBin(1, &ctx);
   }
   if (group_idx_x < TransformHelper::kLastPosGroupIdx[width - 1]) {
-    ContextModel &ctx =
-      ctx_.GetCoeffLastPosCtx(comp, width, height, ctx_last_x, true);
+    ContextModel &ctx = ctx_base_x[ctx_idx_x[ctx_last_x]];
     entropyenc_->EncodeBin(0, &ctx);
   }
   // pos Y
   int ctx_last_y;
   for (ctx_last_y = 0; ctx_last_y < group_idx_y; ctx_last_y++) {
-    ContextModel &ctx =
-      ctx_.GetCoeffLastPosCtx(comp, width, height, ctx_last_y, false);
+    ContextModel &ctx = ctx_base_y[ctx_idx_y[ctx_last_y]];
     entropyenc_->EncodeBin(1, &ctx);
   }
   if (group_idx_y < TransformHelper::kLastPosGroupIdx[height - 1]) {
-    ContextModel &ctx =
-      ctx_.GetCoeffLastPosCtx(comp, width, height, ctx_last_y, false);
+    ContextModel &ctx = ctx_base_y[ctx_idx_y[ctx_last_y]];
     entropyenc_->EncodeBin(0, &ctx);
   }
 
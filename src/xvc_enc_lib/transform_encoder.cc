@@ -19,6 +19,7 @@
 #include "xvc_enc_lib/transform_encoder.h"
 
 #include "xvc_common_lib/restrictions.h"
+#include "xvc_enc_lib/bit_estimator.h"
 
 namespace xvc {
 
@@ -64,7 +65,8 @@ TransformEncoder::TransformAndReconstruct(CodingUnit *cu, YuvComponent comp,
 
   // Quant
   int non_zero;
-  if (encoder_settings_.rdo_quant) {
+  if (encoder_settings_.rdo_quant == 1 ||
+      (encoder_settings_.rdo_quant == 2 && util::IsLuma(comp))) {
     non_zero =
       fwd_quant_.QuantRdo(*cu, comp, qp, cu->GetPicType(), syntax_writer,
                           temp_coeff_.GetDataPtr(), temp_coeff_.GetStride(),
@@ -122,9 +124,9 @@ bool TransformEncoder::EvalCbfZero(CodingUnit *cu, const Qp &qp,
                                     cu_coeff.GetStride());
   Bits non_zero_bits = non_zero_writer.GetNumWrittenBits();
 
-  RdoSyntaxWriter zero_writer(rdo_writer, 0);
-  zero_writer.WriteCbf(*cu, comp, false);
-  Bits bits_zero = zero_writer.GetNumWrittenBits();
+  BitEstimator bit_estimator(rdo_writer);
+  Bits bits_zero =
+    bit_estimator.GetNumBits(bit_estimator.EstimateCbf(comp, false));
 
   Cost cost_non_zero = dist_non_zero +
     static_cast<Cost>(non_zero_bits * qp.GetLambda() + 0.5);
@@ -161,10 +163,10 @@ bool TransformEncoder::EvalRootCbfZero(CodingUnit *cu, const Qp &qp,
     rdo_writer_nonzero.WriteRootCbf(false);
     bits_zero = rdo_writer_nonzero.GetNumWrittenBits() - bits_non_zero;
   } else {
-    RdoSyntaxWriter rdo_writer_zero(bitstream_writer, 0);
+    BitEstimator bit_estimator(bitstream_writer);
     // Note that root cbf is not used in case of skip, ok both are 1 bin...
-    rdo_writer_zero.WriteRootCbf(false);
-    bits_zero = rdo_writer_zero.GetNumWrittenBits();
+    bits_zero =
+      bit_estimator.GetNumBits(bit_estimator.EstimateRootCbf(false));
   }
 
   Cost cost_zero = sum_dist_zero +
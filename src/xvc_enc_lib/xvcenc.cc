@@ -25,6 +25,7 @@
 #include <string>
 
 #include "xvc_common_lib/common.h"
+#include "xvc_enc_lib/async_encoder.h"
 #include "xvc_enc_lib/encoder.h"
 #include "xvc_enc_lib/encoder_settings.h"
 
@@ -75,6 +76,13 @@ extern "C" {
     param->tune_mode = 0;
     param->simd_mask = static_cast<uint32_t>(-1);
     param->explicit_encoder_settings = nullptr;
+    param->async_input_queue_size = 0;
+    param->async_output_queue_size = 0;
+    param->target_bitrate = 0;
+    param->vbv_buffer_size = 0;
+    param->tile_columns = 1;
+    param->tile_rows = 1;
+    param->threads = -1;
     return XVC_ENC_OK;
   }
 
@@ -162,6 +170,23 @@ extern "C" {
         param->tune_mode >= static_cast<int>(xvc::TuneMode::kTotalNumber)) {
       return XVC_ENC_INVALID_PARAMETER;
     }
+    if (param->async_input_queue_size < 0 ||
+        param->async_output_queue_size < 0) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
+    if (param->target_bitrate < 0 || param->vbv_buffer_size < 0 ||
+        (param->vbv_buffer_size > 0 && param->target_bitrate == 0)) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
+    const int ctu_size = xvc::constants::kCtuSize;
+    if (param->tile_columns < 1 ||
+        param->tile_columns > xvc::constants::kMaxTileColumns ||
+        param->tile_columns > (param->width + ctu_size - 1) / ctu_size ||
+        param->tile_rows < 1 ||
+        param->tile_rows > xvc::constants::kMaxTileRows ||
+        param->tile_rows > (param->height + ctu_size - 1) / ctu_size) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
     return XVC_ENC_OK;
   }
 
@@ -213,6 +238,12 @@ extern "C" {
           stream >> encoder_settings.default_num_ref_pics;
         } else if (setting == "max_binary_split_depth") {
           stream >> encoder_settings.max_binary_split_depth;
+        } else if (setting == "fast_merge_skip_termination") {
+          stream >> encoder_settings.fast_merge_skip_termination;
+        } else if (setting == "binary_split_gradient_pruning") {
+          stream >> encoder_settings.binary_split_gradient_pruning;
+        } else if (setting == "rdo_quant") {
+          stream >> encoder_settings.rdo_quant;
         } else if (setting == "fast_quad_split_based_on_binary_split") {
           stream >> encoder_settings.fast_quad_split_based_on_binary_split;
         } else if (setting == "eval_prev_mv_search_result") {
@@ -229,6 +260,18 @@ extern "C" {
           stream >> encoder_settings.structural_ssd;
         } else if (setting == "encapsulation_mode") {
           stream >> encoder_settings.encapsulation_mode;
+        } else if (setting == "lookahead") {
+          stream >> encoder_settings.lookahead;
+        } else if (setting == "early_split_termination") {
+          stream >> encoder_settings.early_split_termination;
+        } else if (setting == "parallel_split_rdo") {
+          stream >> encoder_settings.parallel_split_rdo;
+        } else if (setting == "intra_mode_preselection") {
+          stream >> encoder_settings.intra_mode_preselection;
+        } else if (setting == "motion_field_seeding") {
+          stream >> encoder_settings.motion_field_seeding;
+        } else if (setting == "ladder_split_depth_bound") {
+          stream >> encoder_settings.ladder_split_depth_bound;
         }
       }
     }
@@ -291,12 +334,17 @@ extern "C" {
       encoder->SetDeblock(param->deblock);
     }
     encoder->SetQp(param->qp);
+    encoder->SetRateControl(param->target_bitrate, param->vbv_buffer_size);
+    encoder->SetTiles(param->tile_columns, param->tile_rows);
+    encoder->SetNumThreads(param->threads);
     if (param->num_ref_pics >= 0) {
       encoder->SetNumRefPics(param->num_ref_pics);
     }
     encoder->SetFlatLambda(param->flat_lambda != 0);
     encoder->SetChecksumMode(
       static_cast<xvc::Checksum::Mode>(param->checksum_mode));
+    encoder->SetAsyncQueueSizes(param->async_input_queue_size,
+                                param->async_output_queue_size);
 
     int sub_gop_length = param->sub_gop_length;
     if (sub_gop_length == 0) {
@@ -324,6 +372,9 @@ extern "C" {
       return XVC_ENC_INVALID_ARGUMENT;
     }
     xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    if (lib_encoder->IsAsync()) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
     xvc_enc_pic_buffer rec_pic_buffer;
     *num_nal_units = lib_encoder->Encode(input_picture, nal_units,
       (rec_pic != nullptr), &rec_pic_buffer);
@@ -333,6 +384,32 @@ extern "C" {
     return XVC_ENC_OK;
   }
 
+  static xvc_enc_return_code
+    xvc_enc_encoder_encode_planes(xvc_encoder *encoder,
+                                  const xvc_enc_pic_planes *input_picture,
+                                  xvc_enc_nal_unit **nal_units,
+                                  int *num_nal_units,
+                                  xvc_enc_pic_buffer *rec_pic) {
+    // Chroma planes are allowed to be null for monochrome input
+    if (!encoder || !input_picture || !input_picture->planes[0] ||
+        !nal_units || !num_nal_units) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    if (lib_encoder->IsAsync()) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc_enc_pic_buffer rec_pic_buffer;
+    *num_nal_units = lib_encoder->Encode(input_picture->planes,
+                                         input_picture->stride, nal_units,
+                                         (rec_pic != nullptr),
+                                         &rec_pic_buffer);
+    if (rec_pic) {
+      *rec_pic = rec_pic_buffer;
+    }
+    return XVC_ENC_OK;
+  }
+
   static xvc_enc_return_code
     xvc_enc_encoder_flush(xvc_encoder *encoder, xvc_enc_nal_unit **nal_units,
                           int *num_nal_units, xvc_enc_pic_buffer *rec_pic) {
@@ -340,6 +417,9 @@ extern "C" {
       return XVC_ENC_INVALID_ARGUMENT;
     }
     xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    if (lib_encoder->IsAsync()) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
     xvc_enc_pic_buffer rec_pic_buffer;
     *num_nal_units = lib_encoder->Flush(nal_units, (rec_pic != nullptr),
                                         &rec_pic_buffer);
@@ -349,10 +429,67 @@ extern "C" {
     return XVC_ENC_OK;
   }
 
+  static xvc_enc_return_code
+    xvc_enc_encoder_send_picture(xvc_encoder *encoder,
+                                 const xvc_enc_pic_planes *picture,
+                                 xvc_enc_release_callback release_callback,
+                                 void *opaque) {
+    if (!encoder || (picture && !picture->planes[0])) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    return lib_encoder->GetAsyncEncoder()->SendPicture(picture,
+                                                       release_callback,
+                                                       opaque);
+  }
+
+  static xvc_enc_return_code
+    xvc_enc_encoder_receive_nal(xvc_encoder *encoder,
+                                xvc_enc_nal_unit *nal_unit, int wait) {
+    if (!encoder || !nal_unit) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    return lib_encoder->GetAsyncEncoder()->ReceiveNal(nal_unit, wait != 0);
+  }
+
+  static xvc_enc_return_code
+    xvc_enc_encoder_set_nal_callback(xvc_encoder *encoder,
+                                     xvc_enc_nal_callback nal_callback,
+                                     void *opaque) {
+    if (!encoder) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    return lib_encoder->GetAsyncEncoder()->SetNalCallback(nal_callback,
+                                                          opaque);
+  }
+
+  static xvc_enc_return_code
+    xvc_enc_encoder_set_ladder_upstream(xvc_encoder *encoder,
+                                        xvc_encoder *upstream) {
+    if (!encoder || !upstream) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    xvc::Encoder *lib_upstream = reinterpret_cast<xvc::Encoder*>(upstream);
+    if (!lib_encoder->SetLadderUpstream(lib_upstream)) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    return XVC_ENC_OK;
+  }
+
   static const char* xvc_enc_get_error_text(xvc_enc_return_code error_code) {
     switch (error_code) {
       case XVC_ENC_OK:
         return "No Error";
+      case XVC_ENC_NO_NAL_UNIT:
+        return "No nal unit is available yet.";
+      case XVC_ENC_QUEUE_FULL:
+        return "The input queue is full. Receive nal units before sending"
+          " more pictures.";
+      case XVC_ENC_END_OF_STREAM:
+        return "All nal units have been received.";
       case XVC_ENC_INVALID_ARGUMENT:
         return "Error. One or more invalid arguments provided to an xvc api"
           " function.";
@@ -403,6 +540,11 @@ extern "C" {
     &xvc_enc_encoder_encode,
     &xvc_enc_encoder_flush,
     &xvc_enc_get_error_text,
+    &xvc_enc_encoder_encode_planes,
+    &xvc_enc_encoder_send_picture,
+    &xvc_enc_encoder_receive_nal,
+    &xvc_enc_encoder_set_nal_callback,
+    &xvc_enc_encoder_set_ladder_upstream,
   };
 
   const xvc_encoder_api* xvc_encoder_api_get() {
@@ -41,6 +41,9 @@ extern "C" {
 
   typedef enum {
     XVC_ENC_OK = 0,
+    XVC_ENC_NO_NAL_UNIT = 1,
+    XVC_ENC_QUEUE_FULL = 2,
+    XVC_ENC_END_OF_STREAM = 3,
     XVC_ENC_INVALID_ARGUMENT = 10,
     XVC_ENC_INVALID_PARAMETER = 20,
     XVC_ENC_SIZE_TOO_SMALL,
@@ -70,6 +73,26 @@ extern "C" {
     XVC_ENC_COLOR_MATRIX_2020 = 3,
   } xvc_enc_color_matrix;
 
+  // Processing stages measured per encoded picture
+  typedef enum {
+    XVC_ENC_STAGE_INTRA_SEARCH = 0,
+    XVC_ENC_STAGE_INTER_SEARCH = 1,
+    XVC_ENC_STAGE_RDO_QUANT = 2,
+    XVC_ENC_STAGE_CABAC_WRITE = 3,
+    XVC_ENC_STAGE_DEBLOCK = 4,
+    XVC_ENC_STAGE_PAD_BORDER = 5,
+    XVC_ENC_STAGE_CHECKSUM = 6,
+    XVC_ENC_STAGE_INTRA_ANALYSIS = 7,
+    XVC_ENC_STAGE_TOTAL_NUMBER = 8,
+  } xvc_enc_stage;
+
+  // Events counted per encoded picture
+  typedef enum {
+    XVC_ENC_COUNTER_INTER_PRED_CACHE_LOOKUP = 0,
+    XVC_ENC_COUNTER_INTER_PRED_CACHE_HIT = 1,
+    XVC_ENC_COUNTER_TOTAL_NUMBER = 2,
+  } xvc_enc_counter;
+
   // Statistics for picture encoded by nal
   // Lifecycle managed by xvc_enc_nal_unit
   typedef struct xvc_enc_nal_stats {
@@ -81,6 +104,12 @@ extern "C" {
     int32_t qp;
     int32_t l0[5];
     int32_t l1[5];
+    // Time in microseconds spent per stage (indexed by xvc_enc_stage), only
+    // measured when the library is built with tracing enabled
+    uint32_t stage_time_us[XVC_ENC_STAGE_TOTAL_NUMBER];
+    // Number of events (indexed by xvc_enc_counter), only counted when the
+    // library is built with tracing enabled
+    uint32_t counters[XVC_ENC_COUNTER_TOTAL_NUMBER];
   } xvc_enc_nal_stats;
 
   // NAL unit representing the coded bitstream
@@ -99,6 +128,27 @@ extern "C" {
     size_t size;
   } xvc_enc_pic_buffer;
 
+  // Input picture given as separate planes, e.g. pointing directly into
+  // a memory mapped file or a decoder output buffer.
+  // Stride is given in bytes, samples are 8 bit for input_bitdepth 8,
+  // otherwise 16 bit little endian
+  // Lifecycle managed by application
+  typedef struct xvc_enc_pic_planes {
+    const uint8_t *planes[3];
+    ptrdiff_t stride[3];
+  } xvc_enc_pic_planes;
+
+  // Called when the encoder no longer needs a picture given to
+  // encoder_send_picture, possibly from an encoder thread
+  typedef void(*xvc_enc_release_callback)(void *opaque,
+                                          const xvc_enc_pic_planes *picture);
+
+  // Called from the encoder thread for each nal unit when set by
+  // encoder_set_nal_callback. The nal unit is only valid during the call.
+  // A null nal unit signals that the end of stream has been reached.
+  typedef void(*xvc_enc_nal_callback)(void *opaque,
+                                      const xvc_enc_nal_unit *nal_unit);
+
   // xvc encoder instance
   // Lifecycle managed by api->encoder_create & api->encoder_destroy
   typedef struct xvc_encoder xvc_encoder;
@@ -131,6 +181,22 @@ extern "C" {
     int checksum_mode;
     uint32_t simd_mask;
     char* explicit_encoder_settings;
+    // Queue depths used by encoder_send_picture and encoder_receive_nal,
+    // 0 selects the default depth
+    int async_input_queue_size;
+    int async_output_queue_size;
+    // Target bitrate in kbit/s for single pass rate control,
+    // 0 encodes with constant qp
+    int target_bitrate;
+    // VBV buffer size in kbit, drained at target_bitrate, 0 disables the
+    // buffer constraint
+    int vbv_buffer_size;
+    // Number of uniformly spaced tiles, coded and decoded in parallel
+    int tile_columns;
+    int tile_rows;
+    // Number of threads coding the tiles of a picture, -1 gives one thread
+    // per cpu core and 0 or 1 codes all tiles on the encoding thread
+    int threads;
   } xvc_encoder_parameters;
 
   // xvc encoder api
@@ -160,6 +226,42 @@ extern "C" {
                                         xvc_enc_pic_buffer *rec_pic);
     // Misc
     const char*(*xvc_enc_get_error_text)(xvc_enc_return_code error_code);
+    // Same as encoder_encode but without requiring contiguous input
+    xvc_enc_return_code(*encoder_encode_planes)(
+      xvc_encoder *encoder, const xvc_enc_pic_planes *picture_to_encode,
+      xvc_enc_nal_unit **nal_units, int *num_nal_units,
+      xvc_enc_pic_buffer *rec_pic);
+    // Asynchronous encoding on a separate encoder thread, can not be mixed
+    // with encoder_encode and encoder_flush on the same encoder.
+    // Queues a picture without waiting for it to be encoded. The picture
+    // buffer is owned by the caller until release_callback is called.
+    // Returns XVC_ENC_QUEUE_FULL if the input queue is full.
+    // A null picture signals end of stream and flushes the encoder.
+    xvc_enc_return_code(*encoder_send_picture)(
+      xvc_encoder *encoder, const xvc_enc_pic_planes *picture,
+      xvc_enc_release_callback release_callback, void *opaque);
+    // Returns the next nal unit in bitstream order, valid until the next
+    // call. Returns XVC_ENC_NO_NAL_UNIT if none is available and wait is 0,
+    // or XVC_ENC_END_OF_STREAM when all nal units have been received.
+    // With wait set to 1 the call blocks until a nal unit is available or
+    // the stream has ended. Pictures are only encoded once the input queue
+    // is flushed with a null picture or enough pictures for a sub gop have
+    // been sent, so waiting before that may block forever.
+    xvc_enc_return_code(*encoder_receive_nal)(xvc_encoder *encoder,
+                                              xvc_enc_nal_unit *nal_unit,
+                                              int wait);
+    // Delivers nal units through a callback instead of encoder_receive_nal,
+    // must be set before the first picture is sent.
+    xvc_enc_return_code(*encoder_set_nal_callback)(
+      xvc_encoder *encoder, xvc_enc_nal_callback nal_callback, void *opaque);
+    // Bitrate ladder encoding, lets encoder reuse the qp independent
+    // analysis and decisions of upstream, an encoder of the same input with
+    // the same parameters except for qp. Must be called before any picture
+    // is given to either encoder. Each picture and flush must then be given
+    // to upstream before encoder, or both encoders must be asynchronous.
+    // Each encoder can have at most one upstream and one downstream encoder.
+    xvc_enc_return_code(*encoder_set_ladder_upstream)(xvc_encoder *encoder,
+                                                      xvc_encoder *upstream);
   } xvc_encoder_api;
 
   // Starting point for using the xvc encoder api
@@ -0,0 +1,258 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_bench/codec_bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/picture_types.h"
+#include "xvc_test/yuv_helper.h"
+
+namespace xvc_bench {
+
+static double GetElapsedMs(std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Restarts the resident set size high-water mark (only supported on Linux)
+static void ResetPeakRss() {
+#ifdef __linux__
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+#endif
+}
+
+static double GetPeakRss() {
+#ifdef __linux__
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      double kib = 0;
+      std::stringstream(line.substr(6)) >> kib;
+      return kib / 1024;
+    }
+  }
+#endif
+  return 0;
+}
+
+CodecBench::CodecBench(const CodecConfig &config)
+  : config_(config),
+  xvc_enc_api_(xvc_encoder_api_get()),
+  xvc_dec_api_(xvc_decoder_api_get()) {
+}
+
+CodecBench::~CodecBench() {
+}
+
+bool CodecBench::Run(CodecResult *result, std::string *error) {
+  result->config = config_;
+  // All input is generated up front to not be part of the measurements
+  input_pictures_.clear();
+  for (int i = 0; i < config_.frames; i++) {
+    input_pictures_.push_back(xvc_test::TestYuvPic::GetScaledBytes(
+      config_.width, config_.height, config_.bitdepth, i,
+      xvc::ChromaFormat(config_.chroma_format)));
+  }
+  nal_units_.clear();
+  if (!Encode(&result->encode, error)) {
+    return false;
+  }
+  size_t total_bytes = 0;
+  for (const std::vector<uint8_t> &nal : nal_units_) {
+    total_bytes += nal.size();
+  }
+  result->bytes_per_picture =
+    config_.frames > 0 ? static_cast<double>(total_bytes) / config_.frames : 0;
+  input_pictures_.clear();
+  input_pictures_.shrink_to_fit();
+  if (!Decode(&result->decode, &result->decoded_pictures, error)) {
+    return false;
+  }
+  if (result->decoded_pictures != config_.frames) {
+    std::stringstream ss;
+    ss << "Decoded " << result->decoded_pictures << " of " << config_.frames
+      << " pictures";
+    *error = ss.str();
+    return false;
+  }
+  return true;
+}
+
+bool CodecBench::Encode(PipelineStats *stats, std::string *error) {
+  xvc_encoder_parameters *params = xvc_enc_api_->parameters_create();
+  xvc_enc_api_->parameters_set_default(params);
+  params->width = config_.width;
+  params->height = config_.height;
+  params->chroma_format = config_.chroma_format;
+  params->input_bitdepth = config_.bitdepth;
+  params->internal_bitdepth = config_.bitdepth;
+  params->framerate = 30;
+  params->sub_gop_length = config_.sub_gop_length;
+  params->qp = config_.qp;
+  params->speed_mode = config_.speed_mode;
+  params->simd_mask = config_.simd_mask;
+  params->threads = config_.threads;
+  // Worker threads evaluating coding units without split
+  std::string explicit_settings;
+  if (config_.parallel_split_rdo > 0) {
+    std::stringstream ss;
+    ss << "parallel_split_rdo " << config_.parallel_split_rdo;
+    explicit_settings = ss.str();
+    params->explicit_encoder_settings = &explicit_settings[0];
+  }
+  xvc_enc_return_code ret = xvc_enc_api_->parameters_check(params);
+  if (ret != XVC_ENC_OK) {
+    *error = xvc_enc_api_->xvc_enc_get_error_text(ret);
+    params->explicit_encoder_settings = nullptr;
+    xvc_enc_api_->parameters_destroy(params);
+    return false;
+  }
+
+  ResetPeakRss();
+  xvc_encoder *encoder = xvc_enc_api_->encoder_create(params);
+  params->explicit_encoder_settings = nullptr;
+  xvc_enc_api_->parameters_destroy(params);
+  if (!encoder) {
+    *error = "Failed to create encoder";
+    return false;
+  }
+  std::vector<std::chrono::steady_clock::time_point> submit_time;
+  std::vector<double> latencies;
+  auto collect_nals = [&](xvc_enc_nal_unit *nal_units, int num_nal_units) {
+    auto now = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_nal_units; i++) {
+      const xvc_enc_nal_unit &nal = nal_units[i];
+      nal_units_.emplace_back(nal.bytes, nal.bytes + nal.size);
+      if (nal.stats.nal_unit_type !=
+          static_cast<uint32_t>(xvc::NalUnitType::kSegmentHeader) &&
+          nal.stats.poc < submit_time.size()) {
+        latencies.push_back(GetElapsedMs(submit_time[nal.stats.poc], now));
+      }
+    }
+  };
+
+  xvc_enc_nal_unit *nal_units = nullptr;
+  int num_nal_units = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < config_.frames; i++) {
+    submit_time.push_back(std::chrono::steady_clock::now());
+    xvc_enc_api_->encoder_encode(encoder, &input_pictures_[i][0], &nal_units,
+                                 &num_nal_units, nullptr);
+    collect_nals(nal_units, num_nal_units);
+  }
+  do {
+    xvc_enc_api_->encoder_flush(encoder, &nal_units, &num_nal_units, nullptr);
+    collect_nals(nal_units, num_nal_units);
+  } while (num_nal_units > 0);
+  auto end = std::chrono::steady_clock::now();
+  stats->peak_rss = GetPeakRss();
+  xvc_enc_api_->encoder_destroy(encoder);
+
+  const double elapsed_ms = GetElapsedMs(start, end);
+  stats->fps = elapsed_ms > 0 ? 1000.0 * config_.frames / elapsed_ms : 0;
+  CalcLatencyStats(&latencies, stats);
+  return true;
+}
+
+bool CodecBench::Decode(PipelineStats *stats, int *decoded_pictures,
+                        std::string *error) {
+  xvc_decoder_parameters *params = xvc_dec_api_->parameters_create();
+  xvc_dec_api_->parameters_set_default(params);
+  params->threads = config_.threads;
+  params->simd_mask = config_.simd_mask;
+  xvc_dec_return_code ret = xvc_dec_api_->parameters_check(params);
+  if (ret != XVC_DEC_OK) {
+    *error = xvc_dec_api_->xvc_dec_get_error_text(ret);
+    xvc_dec_api_->parameters_destroy(params);
+    return false;
+  }
+
+  ResetPeakRss();
+  xvc_decoder *decoder = xvc_dec_api_->decoder_create(params);
+  xvc_dec_api_->parameters_destroy(params);
+  if (!decoder) {
+    *error = "Failed to create decoder";
+    return false;
+  }
+  std::vector<std::chrono::steady_clock::time_point> submit_time;
+  std::vector<double> latencies;
+  xvc_decoded_picture decoded_pic;
+  *decoded_pictures = 0;
+  auto collect_pictures = [&]() {
+    while (xvc_dec_api_->decoder_get_picture(decoder, &decoded_pic) ==
+           XVC_DEC_OK) {
+      auto now = std::chrono::steady_clock::now();
+      (*decoded_pictures)++;
+      const size_t nal_index = static_cast<size_t>(decoded_pic.user_data);
+      if (nal_index < submit_time.size()) {
+        latencies.push_back(GetElapsedMs(submit_time[nal_index], now));
+      }
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < nal_units_.size(); i++) {
+    submit_time.push_back(std::chrono::steady_clock::now());
+    ret = xvc_dec_api_->decoder_decode_nal(decoder, &nal_units_[i][0],
+                                           nal_units_[i].size(),
+                                           static_cast<int64_t>(i));
+    if (ret != XVC_DEC_OK) {
+      *error = xvc_dec_api_->xvc_dec_get_error_text(ret);
+      xvc_dec_api_->decoder_destroy(decoder);
+      return false;
+    }
+    collect_pictures();
+  }
+  xvc_dec_api_->decoder_flush(decoder);
+  collect_pictures();
+  auto end = std::chrono::steady_clock::now();
+  stats->peak_rss = GetPeakRss();
+  xvc_dec_api_->decoder_destroy(decoder);
+
+  const double elapsed_ms = GetElapsedMs(start, end);
+  stats->fps = elapsed_ms > 0 ? 1000.0 * *decoded_pictures / elapsed_ms : 0;
+  CalcLatencyStats(&latencies, stats);
+  return true;
+}
+
+void CodecBench::CalcLatencyStats(std::vector<double> *latencies,
+                                  PipelineStats *stats) {
+  if (latencies->empty()) {
+    return;
+  }
+  std::sort(latencies->begin(), latencies->end());
+  // Nearest-rank percentile
+  auto percentile = [latencies](int p) {
+    size_t rank = (latencies->size() * p + 99) / 100;
+    return (*latencies)[std::max(rank, static_cast<size_t>(1)) - 1];
+  };
+  stats->latency_p50 = percentile(50);
+  stats->latency_p90 = percentile(90);
+  stats->latency_p99 = percentile(99);
+  stats->latency_max = latencies->back();
+}
+
+}   // namespace xvc_bench
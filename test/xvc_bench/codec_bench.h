@@ -0,0 +1,88 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_BENCH_CODEC_BENCH_H_
+#define XVC_BENCH_CODEC_BENCH_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "xvc_dec_lib/xvcdec.h"
+#include "xvc_enc_lib/xvcenc.h"
+
+namespace xvc_bench {
+
+struct CodecConfig {
+  int width;
+  int height;
+  xvc_enc_chroma_format chroma_format;
+  int bitdepth;
+  int speed_mode;
+  int sub_gop_length;
+  int threads;
+  int parallel_split_rdo;
+  uint32_t simd_mask;
+  int qp;
+  int frames;
+};
+
+struct PipelineStats {
+  double fps = 0;
+  // Per picture latency percentiles in milliseconds
+  double latency_p50 = 0;
+  double latency_p90 = 0;
+  double latency_p99 = 0;
+  double latency_max = 0;
+  // Resident set size high-water mark in MiB, 0 if not available
+  double peak_rss = 0;
+};
+
+struct CodecResult {
+  CodecConfig config;
+  double bytes_per_picture = 0;
+  int decoded_pictures = 0;
+  PipelineStats encode;
+  PipelineStats decode;
+};
+
+// Full encode and decode through the public api of synthetic content
+class CodecBench {
+public:
+  explicit CodecBench(const CodecConfig &config);
+  ~CodecBench();
+  bool Run(CodecResult *result, std::string *error);
+
+private:
+  bool Encode(PipelineStats *stats, std::string *error);
+  bool Decode(PipelineStats *stats, int *decoded_pictures,
+              std::string *error);
+  static void CalcLatencyStats(std::vector<double> *latencies,
+                               PipelineStats *stats);
+
+  const CodecConfig config_;
+  const xvc_encoder_api *xvc_enc_api_;
+  const xvc_decoder_api *xvc_dec_api_;
+  std::vector<std::vector<uint8_t>> input_pictures_;
+  std::vector<std::vector<uint8_t>> nal_units_;
+};
+
+}   // namespace xvc_bench
+
+#endif  // XVC_BENCH_CODEC_BENCH_H_
@@ -0,0 +1,488 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include "xvc_bench/kernel_bench.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+
+#include "xvc_common_lib/deblocking_filter.h"
+#include "xvc_common_lib/inter_prediction.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/transform.h"
+#include "xvc_common_lib/utils.h"
+#include "xvc_common_lib/yuv_pic.h"
+#include "xvc_enc_lib/bit_writer.h"
+#include "xvc_enc_lib/entropy_encoder.h"
+#include "xvc_enc_lib/rdo_quant.h"
+#include "xvc_enc_lib/sample_metric.h"
+#include "xvc_enc_lib/syntax_writer.h"
+
+namespace xvc_bench {
+
+using xvc::Coeff;
+using xvc::Residual;
+using xvc::Sample;
+
+static const int kMaxSize = xvc::constants::kMaxBlockSize;
+static const int kMargin = 8;
+static const ptrdiff_t kRefStride = kMaxSize + 2 * kMargin;
+static const int kQp = 32;
+static const int kBatchSize = xvc::SampleMetric::kMaxBatchSize;
+static const int kDeblockPicSize = 4 * xvc::constants::kCtuSize;
+// Luma half sample and chroma quarter sample interpolation filters
+static const std::array<int16_t, 8> kLumaFilter = {
+  { -1, 4, -11, 40, 40, -11, 4, -1 }
+};
+static const std::array<int16_t, 4> kChromaFilter = { { -4, 54, 16, -2 } };
+
+static const std::vector<std::string> kKernelNames = {
+  "inter_pred_luma_h",
+  "inter_pred_luma_v",
+  "inter_pred_luma_hv",
+  "inter_pred_luma_hv_bipred",
+  "inter_pred_chroma_h",
+  "inter_pred_chroma_v",
+  "inter_pred_chroma_hv",
+  "inter_pred_chroma_hv_bipred",
+  "inter_pred_copy_bipred",
+  "inter_pred_add_avg",
+  "sample_metric_sad",
+  "sample_metric_sad_fast",
+  "sample_metric_sad_batch",
+  "sample_metric_satd",
+  "sample_metric_ssd",
+  "sample_metric_structural_ssd",
+  "forward_transform",
+  "inverse_transform",
+  "inverse_quant",
+  "rdo_quant_fast",
+  "rdo_quant_rdo",
+  "deblocking_filter",
+};
+
+static bool StartsWith(const std::string &str, const std::string &prefix) {
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+// Deterministic pseudo random content, smooth gradients with texture
+class SampleGenerator {
+public:
+  explicit SampleGenerator(int bitdepth) : bitdepth_(bitdepth) {}
+  int Rand() {
+    state_ = state_ * 1103515245 + 12345;
+    return static_cast<int>((state_ >> 16) & 0x7fff);
+  }
+  Sample Get(int x, int y) {
+    const int max_val = (1 << bitdepth_) - 1;
+    int val = ((x * 3 + y * 2) & 127) + 64 + (Rand() & 31);
+    return static_cast<Sample>(
+      xvc::util::Clip3(val << (bitdepth_ - 8), 0, max_val));
+  }
+
+private:
+  int bitdepth_;
+  uint32_t state_ = 1;
+};
+
+struct KernelBench::Buffers {
+  Buffers(int bitdepth, xvc::ChromaFormat chroma_format)
+    : qp(kQp, chroma_format, bitdepth, 0.57 * std::pow(2.0, (kQp - 12) / 3.0)),
+    pic_data(chroma_format, kMaxSize, kMaxSize, bitdepth),
+    fwd_transform(bitdepth),
+    inv_transform(bitdepth),
+    rdo_quant(bitdepth),
+    entropy_encoder(&bit_writer) {
+  }
+  std::array<Sample, kRefStride * kRefStride> ref;
+  std::array<Sample, kMaxSize * kMaxSize> orig;
+  std::array<Sample, kMaxSize * kMaxSize> pred;
+  std::array<int16_t, kMaxSize * (kMaxSize + kMargin)> filter_temp;
+  std::array<std::array<int16_t, kMaxSize * kMaxSize>, 2> bipred;
+  std::array<Residual, kMaxSize * kMaxSize> resi;
+  std::array<Residual, kMaxSize * kMaxSize> resi_out;
+  std::array<Coeff, kMaxSize * kMaxSize> coeff;
+  std::array<Coeff, kMaxSize * kMaxSize> coeff_out;
+  xvc::Qp qp;
+  xvc::PictureData pic_data;
+  xvc::ForwardTransform fwd_transform;
+  xvc::InverseTransform inv_transform;
+  xvc::Quantize inv_quant;
+  xvc::RdoQuant rdo_quant;
+  xvc::BitWriter bit_writer;
+  xvc::EntropyEncoder entropy_encoder;
+};
+
+KernelBench::KernelBench(int bitdepth, uint32_t simd_mask,
+                         const std::string &simd_tier, double min_time_ms)
+  : bitdepth_(bitdepth),
+  simd_mask_(simd_mask),
+  simd_tier_(simd_tier),
+  min_time_ns_(min_time_ms * 1000000.0),
+  simd_(xvc::SimdCpu::GetMaskedCaps(simd_mask)),
+  buffers_(new Buffers(bitdepth, xvc::ChromaFormat::k420)) {
+  SampleGenerator generator(bitdepth);
+  for (int y = 0; y < kRefStride; y++) {
+    for (int x = 0; x < kRefStride; x++) {
+      buffers_->ref[y * kRefStride + x] = generator.Get(x, y);
+    }
+  }
+  const int bipred_shift = xvc::InterPrediction::kInternalPrecision - bitdepth;
+  for (int y = 0; y < kMaxSize; y++) {
+    for (int x = 0; x < kMaxSize; x++) {
+      const int i = y * kMaxSize + x;
+      buffers_->orig[i] = generator.Get(x + 1, y + 2);
+      buffers_->resi[i] =
+        static_cast<Residual>(buffers_->orig[i] - buffers_->ref[i]);
+      for (int j = 0; j < 2; j++) {
+        buffers_->bipred[j][i] = static_cast<int16_t>(
+          (generator.Get(x, y) << bipred_shift) -
+          xvc::InterPrediction::kInternalOffset);
+      }
+    }
+  }
+  // Coding unit and picture state needed by quantization
+  xvc::SegmentHeader segment;
+  buffers_->pic_data.Init(segment, buffers_->qp, false);
+}
+
+KernelBench::~KernelBench() {
+}
+
+const std::vector<std::string>& KernelBench::GetKernelNames() {
+  return kKernelNames;
+}
+
+bool KernelBench::Run(const std::string &kernel, int size,
+                      std::vector<BenchResult> *results) {
+  if (size < xvc::constants::kMinBlockSize || size > kMaxSize ||
+      (size & (size - 1)) != 0) {
+    return false;
+  }
+  if (StartsWith(kernel, "inter_pred_")) {
+    RunInterPrediction(kernel, size, results);
+  } else if (StartsWith(kernel, "sample_metric_")) {
+    RunSampleMetric(kernel, size, results);
+  } else if (StartsWith(kernel, "forward_transform") ||
+             StartsWith(kernel, "inverse_transform")) {
+    RunTransform(kernel, size, results);
+  } else if (StartsWith(kernel, "inverse_quant") ||
+             StartsWith(kernel, "rdo_quant_")) {
+    RunQuant(kernel, size, results);
+  } else if (kernel == "deblocking_filter") {
+    RunDeblock(kernel, size, results);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+template<typename Func>
+void KernelBench::Measure(const std::string &kernel, int width, int height,
+                          int64_t samples, const Func &func,
+                          std::vector<BenchResult> *results) {
+  static const int64_t kMaxIterations = static_cast<int64_t>(1) << 32;
+  func();   // warm up caches
+  int64_t iterations = 1;
+  while (true) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+      func();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double elapsed_ns = static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count());
+    if (elapsed_ns >= min_time_ns_ || iterations >= kMaxIterations) {
+      AddResult(kernel, width, height, samples, iterations, elapsed_ns,
+                results);
+      return;
+    }
+    // Aim slightly above the minimum time to avoid another round
+    double scale = elapsed_ns > 0 ? 1.2 * min_time_ns_ / elapsed_ns : 100;
+    iterations = std::max(iterations * 2, static_cast<int64_t>(
+      iterations * std::min(scale, 100.0)));
+  }
+}
+
+template<typename Func, typename ResetFunc>
+void KernelBench::MeasureWithReset(const std::string &kernel, int width,
+                                   int height, int64_t samples,
+                                   const Func &func, const ResetFunc &reset,
+                                   std::vector<BenchResult> *results) {
+  // Each call is timed individually, only used for kernels with long runtime
+  double elapsed_ns = 0;
+  int64_t iterations = 0;
+  do {
+    reset();
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto end = std::chrono::steady_clock::now();
+    elapsed_ns += static_cast<double>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count());
+    iterations++;
+  } while (elapsed_ns < min_time_ns_);
+  AddResult(kernel, width, height, samples, iterations, elapsed_ns, results);
+}
+
+void KernelBench::AddResult(const std::string &kernel, int width, int height,
+                            int64_t samples, int64_t iterations,
+                            double elapsed_ns,
+                            std::vector<BenchResult> *results) {
+  BenchResult result;
+  result.kernel = kernel;
+  result.width = width;
+  result.height = height;
+  result.bitdepth = bitdepth_;
+  result.simd_mask = simd_mask_;
+  result.simd_tier = simd_tier_;
+  result.iterations = iterations;
+  result.ns_per_call = elapsed_ns / iterations;
+  result.msamples_per_sec = result.ns_per_call > 0 ?
+    1000.0 * samples / result.ns_per_call : 0;
+  results->push_back(result);
+}
+
+void KernelBench::RunInterPrediction(const std::string &kernel, int size,
+                                     std::vector<BenchResult> *results) {
+  typedef xvc::InterPrediction IP;
+  const IP::SimdFunc &simd = simd_.inter_prediction;
+  const int bitdepth = bitdepth_;
+  const bool chroma = StartsWith(kernel, "inter_pred_chroma_");
+  const int lc = chroma ? 1 : 0;
+  const int taps = chroma ? IP::kNumTapsChroma : IP::kNumTapsLuma;
+  const int16_t *filter = chroma ? &kChromaFilter[0] : &kLumaFilter[0];
+  const Sample *ref = &buffers_->ref[kMargin * kRefStride + kMargin];
+  const ptrdiff_t ref_offset = (taps / 2 - 1) * kRefStride;
+  const ptrdiff_t tmp_offset = (taps / 2 - 1) * size;
+  Sample *pred = &buffers_->pred[0];
+  int16_t *tmp = &buffers_->filter_temp[0];
+  int16_t *bipred0 = &buffers_->bipred[0][0];
+  const int16_t *bipred1 = &buffers_->bipred[1][0];
+  const int64_t samples = size * size;
+
+  if (kernel == "inter_pred_luma_h" || kernel == "inter_pred_chroma_h") {
+    Measure(kernel, size, size, samples, [&]() {
+      simd.filter_h_sample_sample[lc](size, size, bitdepth, filter,
+                                      ref, kRefStride, pred, size);
+    }, results);
+  } else if (kernel == "inter_pred_luma_v" ||
+             kernel == "inter_pred_chroma_v") {
+    Measure(kernel, size, size, samples, [&]() {
+      simd.filter_v_sample_sample[lc](size, size, bitdepth, filter,
+                                      ref, kRefStride, pred, size);
+    }, results);
+  } else if (kernel == "inter_pred_luma_hv" ||
+             kernel == "inter_pred_chroma_hv") {
+    Measure(kernel, size, size, samples, [&]() {
+      simd.filter_h_sample_short[lc](size, size + taps - 1, bitdepth, filter,
+                                     ref - ref_offset, kRefStride, tmp, size);
+      simd.filter_v_short_sample[lc](size, size, bitdepth, filter,
+                                     tmp + tmp_offset, size, pred, size);
+    }, results);
+  } else if (kernel == "inter_pred_luma_hv_bipred" ||
+             kernel == "inter_pred_chroma_hv_bipred") {
+    Measure(kernel, size, size, samples, [&]() {
+      simd.filter_h_sample_short[lc](size, size + taps - 1, bitdepth, filter,
+                                     ref - ref_offset, kRefStride, tmp, size);
+      simd.filter_v_short_short[lc](size, size, bitdepth, filter,
+                                    tmp + tmp_offset, size, bipred0, size);
+    }, results);
+  } else if (kernel == "inter_pred_copy_bipred") {
+    const int shift = IP::kInternalPrecision - bitdepth;
+    const int16_t offset = IP::kInternalOffset;
+    Measure(kernel, size, size, samples, [&]() {
+      simd.filter_copy_bipred[size > 2](size, size, offset, shift,
+                                        ref, kRefStride, bipred0, size);
+    }, results);
+  } else if (kernel == "inter_pred_add_avg") {
+    const int shift = std::max(2, IP::kInternalPrecision - bitdepth) + 1;
+    const int offset = (1 << (shift - 1)) + 2 * IP::kInternalOffset;
+    Measure(kernel, size, size, samples, [&]() {
+      simd.add_avg[size > 2](size, size, offset, shift, bitdepth,
+                             bipred0, size, bipred1, size, pred, size);
+    }, results);
+  }
+}
+
+void KernelBench::RunSampleMetric(const std::string &kernel, int size,
+                                  std::vector<BenchResult> *results) {
+  xvc::MetricType type;
+  if (kernel == "sample_metric_sad" || kernel == "sample_metric_sad_batch") {
+    type = xvc::MetricType::kSad;
+  } else if (kernel == "sample_metric_sad_fast") {
+    type = xvc::MetricType::kSadFast;
+  } else if (kernel == "sample_metric_satd") {
+    type = xvc::MetricType::kSatd;
+  } else if (kernel == "sample_metric_ssd") {
+    type = xvc::MetricType::kSsd;
+  } else if (kernel == "sample_metric_structural_ssd") {
+    type = xvc::MetricType::kStructuralSsd;
+  } else {
+    return;
+  }
+  xvc::SampleMetric metric(type, buffers_->qp, bitdepth_);
+  const Sample *orig = &buffers_->orig[0];
+  const Sample *ref = &buffers_->ref[kMargin * kRefStride + kMargin];
+  if (kernel == "sample_metric_sad_batch") {
+    // Candidates as evaluated by a motion search step
+    std::array<const Sample*, kBatchSize> cand;
+    for (int i = 0; i < kBatchSize; i++) {
+      cand[i] = ref + (i / 4 - 1) * kRefStride + (i % 4 - 2);
+    }
+    std::array<xvc::Distortion, kBatchSize> dist;
+    Measure(kernel, size, size, size * size * kBatchSize, [&]() {
+      metric.CompareSampleBatch(xvc::YuvComponent::kY, size, size,
+                                orig, size, &cand[0], kRefStride,
+                                kBatchSize, &dist[0]);
+      sink_ += dist[0];
+    }, results);
+    return;
+  }
+  Measure(kernel, size, size, size * size, [&]() {
+    sink_ += metric.CompareSample(xvc::YuvComponent::kY, size, size,
+                                  orig, size, ref, kRefStride);
+  }, results);
+}
+
+void KernelBench::RunTransform(const std::string &kernel, int size,
+                               std::vector<BenchResult> *results) {
+  xvc::ForwardTransform &fwd = buffers_->fwd_transform;
+  xvc::InverseTransform &inv = buffers_->inv_transform;
+  const Residual *resi = &buffers_->resi[0];
+  Residual *resi_out = &buffers_->resi_out[0];
+  Coeff *coeff = &buffers_->coeff[0];
+  fwd.Transform(size, size, false, resi, size, coeff, size);
+  if (kernel == "forward_transform") {
+    Coeff *coeff_out = &buffers_->coeff_out[0];
+    Measure(kernel, size, size, size * size, [&]() {
+      fwd.Transform(size, size, false, resi, size, coeff_out, size);
+    }, results);
+  } else if (kernel == "inverse_transform") {
+    Measure(kernel, size, size, size * size, [&]() {
+      inv.Transform(size, size, false, coeff, size, resi_out, size);
+    }, results);
+  }
+}
+
+void KernelBench::RunQuant(const std::string &kernel, int size,
+                           std::vector<BenchResult> *results) {
+  const xvc::YuvComponent luma = xvc::YuvComponent::kY;
+  const xvc::Qp &qp = buffers_->qp;
+  const Coeff *coeff = &buffers_->coeff[0];
+  Coeff *coeff_out = &buffers_->coeff_out[0];
+  buffers_->fwd_transform.Transform(size, size, false, &buffers_->resi[0],
+                                    size, &buffers_->coeff[0], size);
+  if (kernel == "inverse_quant") {
+    Measure(kernel, size, size, size * size, [&]() {
+      buffers_->inv_quant.Inverse(luma, qp, size, size, bitdepth_,
+                                  coeff, size, coeff_out, size);
+    }, results);
+    return;
+  }
+  xvc::PictureData *pic_data = &buffers_->pic_data;
+  xvc::CodingUnit *cu =
+    pic_data->CreateCu(xvc::CuTree::Primary, 0, 0, 0, size, size);
+  const xvc::PicturePredictionType pic_type = cu->GetPicType();
+  xvc::RdoQuant &rdo_quant = buffers_->rdo_quant;
+  if (kernel == "rdo_quant_fast") {
+    Measure(kernel, size, size, size * size, [&]() {
+      sink_ += rdo_quant.QuantFast(*cu, luma, qp, pic_type, coeff, size,
+                                   coeff_out, size);
+    }, results);
+  } else if (kernel == "rdo_quant_rdo") {
+    xvc::SyntaxWriter writer(qp, pic_type, &buffers_->entropy_encoder);
+    Measure(kernel, size, size, size * size, [&]() {
+      sink_ += rdo_quant.QuantRdo(*cu, luma, qp, pic_type, writer, coeff,
+                                  size, coeff_out, size);
+    }, results);
+  }
+  pic_data->ReleaseCu(cu);
+}
+
+static void SplitToSize(xvc::CodingUnit *cu, int size) {
+  if (cu->GetWidth(xvc::YuvComponent::kY) <= size) {
+    return;
+  }
+  cu->Split(xvc::SplitType::kQuad);
+  for (xvc::CodingUnit *sub_cu : cu->GetSubCu()) {
+    if (sub_cu) {
+      SplitToSize(sub_cu, size);
+    }
+  }
+}
+
+void KernelBench::RunDeblock(const std::string &kernel, int size,
+                             std::vector<BenchResult> *results) {
+  const xvc::ChromaFormat chroma_format = xvc::ChromaFormat::k420;
+  const int pic_size = kDeblockPicSize;
+  // Intra picture with all coding units of the same size
+  xvc::PictureData pic_data(chroma_format, pic_size, pic_size, bitdepth_);
+  xvc::SegmentHeader segment;
+  pic_data.Init(segment, buffers_->qp, false);
+  for (int rsaddr = 0; rsaddr < pic_data.GetNumberOfCtu(); rsaddr++) {
+    xvc::CodingUnit *ctu = pic_data.GetCtu(xvc::CuTree::Primary, rsaddr);
+    SplitToSize(ctu, size);
+    pic_data.MarkUsedInPic(ctu);
+    if (pic_data.HasSecondaryCuTree()) {
+      // Chroma blocks are at least 4x4 samples
+      ctu = pic_data.GetCtu(xvc::CuTree::Secondary, rsaddr);
+      SplitToSize(ctu, std::max(size, 2 * xvc::constants::kMinBlockSize));
+      pic_data.MarkUsedInPic(ctu);
+    }
+  }
+  // Blocking artifacts across coding unit boundaries
+  xvc::YuvPicture orig_pic(chroma_format, pic_size, pic_size, bitdepth_,
+                           false);
+  xvc::YuvPicture rec_pic(chroma_format, pic_size, pic_size, bitdepth_, false);
+  SampleGenerator generator(bitdepth_);
+  const int max_val = (1 << bitdepth_) - 1;
+  for (int c = 0; c < xvc::constants::kMaxYuvComponents; c++) {
+    const xvc::YuvComponent comp = xvc::YuvComponent(c);
+    const int block_size = size >> orig_pic.GetSizeShiftX(comp);
+    for (int y = 0; y < orig_pic.GetHeight(comp); y++) {
+      Sample *ptr = orig_pic.GetSamplePtr(comp, 0, y);
+      for (int x = 0; x < orig_pic.GetWidth(comp); x++) {
+        const int block_idx = (y / block_size) + (x / block_size);
+        const int dc_offset = ((block_idx & 1) * 2 - 1) << (bitdepth_ - 7);
+        ptr[x] = static_cast<Sample>(
+          xvc::util::Clip3(generator.Get(x, y) + dc_offset, 0, max_val));
+      }
+    }
+  }
+  xvc::DeblockingFilter deblock(&pic_data, &rec_pic, 0, 0);
+  MeasureWithReset(kernel, size, size, pic_size * pic_size, [&]() {
+    deblock.DeblockPicture();
+  }, [&]() {
+    for (int c = 0; c < xvc::constants::kMaxYuvComponents; c++) {
+      const xvc::YuvComponent comp = xvc::YuvComponent(c);
+      for (int y = 0; y < orig_pic.GetHeight(comp); y++) {
+        std::copy(orig_pic.GetSamplePtr(comp, 0, y),
+                  orig_pic.GetSamplePtr(comp, orig_pic.GetWidth(comp), y),
+                  rec_pic.GetSamplePtr(comp, 0, y));
+      }
+    }
+  }, results);
+}
+
+}   // namespace xvc_bench
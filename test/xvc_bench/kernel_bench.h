@@ -0,0 +1,94 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#ifndef XVC_BENCH_KERNEL_BENCH_H_
+#define XVC_BENCH_KERNEL_BENCH_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/simd_functions.h"
+
+namespace xvc_bench {
+
+struct BenchResult {
+  std::string kernel;
+  int width;
+  int height;
+  int bitdepth;
+  uint32_t simd_mask;
+  std::string simd_tier;
+  int64_t iterations;
+  double ns_per_call;
+  double msamples_per_sec;
+};
+
+// Measures throughput of the hot encoder and decoder kernels for one
+// bitdepth and one set of enabled cpu capabilities
+class KernelBench {
+public:
+  KernelBench(int bitdepth, uint32_t simd_mask, const std::string &simd_tier,
+              double min_time_ms);
+  ~KernelBench();
+  static const std::vector<std::string>& GetKernelNames();
+  // Returns false if the kernel does not support the given block size
+  bool Run(const std::string &kernel, int size,
+           std::vector<BenchResult> *results);
+
+private:
+  struct Buffers;
+  template<typename Func>
+  void Measure(const std::string &kernel, int width, int height,
+               int64_t samples, const Func &func,
+               std::vector<BenchResult> *results);
+  template<typename Func, typename ResetFunc>
+  void MeasureWithReset(const std::string &kernel, int width, int height,
+                        int64_t samples, const Func &func,
+                        const ResetFunc &reset,
+                        std::vector<BenchResult> *results);
+  void AddResult(const std::string &kernel, int width, int height,
+                 int64_t samples, int64_t iterations, double elapsed_ns,
+                 std::vector<BenchResult> *results);
+  void RunInterPrediction(const std::string &kernel, int size,
+                          std::vector<BenchResult> *results);
+  void RunSampleMetric(const std::string &kernel, int size,
+                       std::vector<BenchResult> *results);
+  void RunTransform(const std::string &kernel, int size,
+                    std::vector<BenchResult> *results);
+  void RunQuant(const std::string &kernel, int size,
+                std::vector<BenchResult> *results);
+  void RunDeblock(const std::string &kernel, int size,
+                  std::vector<BenchResult> *results);
+
+  const int bitdepth_;
+  const uint32_t simd_mask_;
+  const std::string simd_tier_;
+  const double min_time_ns_;
+  xvc::SimdFunctions simd_;
+  std::unique_ptr<Buffers> buffers_;
+  // Prevents the compiler from removing kernels without side effects
+  uint64_t sink_ = 0;
+};
+
+}   // namespace xvc_bench
+
+#endif  // XVC_BENCH_KERNEL_BENCH_H_
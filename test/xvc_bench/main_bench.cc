@@ -0,0 +1,451 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "xvc_bench/codec_bench.h"
+#include "xvc_bench/kernel_bench.h"
+#include "xvc_common_lib/simd_cpu.h"
+
+namespace {
+
+struct SimdTier {
+  std::string name;
+  uint32_t mask;
+};
+
+struct Resolution {
+  int width;
+  int height;
+};
+
+static const char* kCapabilityNames[] = {
+  "c", "neon", "mmx", "sse", "sse2", "sse3", "ssse3", "sse4_1", "sse4_2",
+  "avx", "avx2",
+};
+
+struct CommandLine {
+  std::string mode = "kernels";
+  std::vector<std::string> kernels;
+  std::vector<int> block_sizes;
+  std::vector<int> bitdepths;
+  int64_t simd_mask = -1;
+  int simd_tiers = 0;
+  double min_time_ms = 50;
+  std::vector<Resolution> resolutions;
+  std::vector<int> chroma_formats;
+  std::vector<int> speed_modes;
+  std::vector<int> sub_gop_lengths;
+  std::vector<int> threads;
+  int parallel_split_rdo = 0;
+  int qp = 32;
+  int frames = 10;
+  std::string output_filename;
+};
+
+void PrintUsage() {
+  std::cout << "Usage:" << std::endl;
+  std::cout << "  xvc_bench [options]" << std::endl;
+  std::cout << std::endl << "Optional parameters:" << std::endl;
+  std::cout << "  -mode <kernels/codec> (default: kernels)" << std::endl;
+  std::cout << "  -bitdepth <int> (default: all supported for kernels, "
+    "8 for codec)" << std::endl;
+  std::cout << "  -simd-mask <int> (default: all runtime capabilities)"
+    << std::endl;
+  std::cout << "  -simd-tiers <0/1> (1: run once per cpu capability tier)"
+    << std::endl;
+  std::cout << "  -output-file <string> (default: stdout)" << std::endl;
+  std::cout << std::endl << "Kernel parameters:" << std::endl;
+  std::cout << "  -kernel <string> (default: all, prefix match)" << std::endl;
+  std::cout << "  -block-size <int> (default: 4, 8, 16, 32 and 64)"
+    << std::endl;
+  std::cout << "  -min-time <double> (ms per measurement, default: 50)"
+    << std::endl;
+  std::cout << "  -list (print kernel names)" << std::endl;
+  std::cout << std::endl << "Codec parameters:" << std::endl;
+  std::cout << "  -resolution <WxH/360p/720p/1080p/2160p> (default: 360p)"
+    << std::endl;
+  std::cout << "  -chroma-format <int> (default: 1)" << std::endl;
+  std::cout << "  -speed-mode <int> (default: 2)" << std::endl;
+  std::cout << "  -sub-gop-length <int> (default: 8)" << std::endl;
+  std::cout << "  -threads <int> (default: 1)" << std::endl;
+  std::cout << "  -parallel-split-rdo <int> (encoder worker threads, "
+    "default: 0)" << std::endl;
+  std::cout << "  -qp <int> (default: 32)" << std::endl;
+  std::cout << "  -frames <int> (default: 10)" << std::endl;
+  std::cout << std::endl << "Parameters except -parallel-split-rdo, -qp and "
+    "-frames can be given multiple times to run all combinations."
+    << std::endl;
+}
+
+bool ParseResolution(const std::string &str, Resolution *resolution) {
+  if (str == "360p") {
+    *resolution = { 640, 360 };
+  } else if (str == "720p") {
+    *resolution = { 1280, 720 };
+  } else if (str == "1080p") {
+    *resolution = { 1920, 1080 };
+  } else if (str == "2160p") {
+    *resolution = { 3840, 2160 };
+  } else {
+    char separator = 0;
+    std::stringstream ss(str);
+    ss >> resolution->width >> separator >> resolution->height;
+    return !ss.fail() && separator == 'x';
+  }
+  return true;
+}
+
+CommandLine ReadArguments(int argc, const char *argv[]) {
+  CommandLine cli;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h") {
+      PrintUsage();
+      std::exit(0);
+    } else if (arg == "-list") {
+      for (const std::string &name : xvc_bench::KernelBench::GetKernelNames()) {
+        std::cout << name << std::endl;
+      }
+      std::exit(0);
+    } else if (i == argc - 1) {
+      std::cerr << "Error: Invalid argument / Missing value: " << arg <<
+        std::endl;
+      PrintUsage();
+      std::exit(1);
+    } else if (arg == "-mode") {
+      cli.mode = argv[++i];
+    } else if (arg == "-kernel") {
+      cli.kernels.push_back(argv[++i]);
+    } else if (arg == "-block-size") {
+      int tmp;
+      std::stringstream(argv[++i]) >> tmp;
+      cli.block_sizes.push_back(tmp);
+    } else if (arg == "-bitdepth") {
+      int tmp;
+      std::stringstream(argv[++i]) >> tmp;
+      cli.bitdepths.push_back(tmp);
+    } else if (arg == "-simd-mask") {
+      std::stringstream(argv[++i]) >> cli.simd_mask;
+    } else if (arg == "-simd-tiers") {
+      std::stringstream(argv[++i]) >> cli.simd_tiers;
+    } else if (arg == "-min-time") {
+      std::stringstream(argv[++i]) >> cli.min_time_ms;
+    } else if (arg == "-resolution") {
+      Resolution resolution;
+      if (!ParseResolution(argv[++i], &resolution)) {
+        std::cerr << "Error: Invalid resolution: " << argv[i] << std::endl;
+        std::exit(1);
+      }
+      cli.resolutions.push_back(resolution);
+    } else if (arg == "-chroma-format") {
+      int tmp;
+      std::stringstream(argv[++i]) >> tmp;
+      cli.chroma_formats.push_back(tmp);
+    } else if (arg == "-speed-mode") {
+      int tmp;
+      std::stringstream(argv[++i]) >> tmp;
+      cli.speed_modes.push_back(tmp);
+    } else if (arg == "-sub-gop-length") {
+      int tmp;
+      std::stringstream(argv[++i]) >> tmp;
+      cli.sub_gop_lengths.push_back(tmp);
+    } else if (arg == "-threads") {
+      int tmp;
+      std::stringstream(argv[++i]) >> tmp;
+      cli.threads.push_back(tmp);
+    } else if (arg == "-parallel-split-rdo") {
+      std::stringstream(argv[++i]) >> cli.parallel_split_rdo;
+    } else if (arg == "-qp") {
+      std::stringstream(argv[++i]) >> cli.qp;
+    } else if (arg == "-frames") {
+      std::stringstream(argv[++i]) >> cli.frames;
+    } else if (arg == "-output-file") {
+      cli.output_filename = argv[++i];
+    } else {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      PrintUsage();
+      std::exit(1);
+    }
+  }
+  if (cli.mode != "kernels" && cli.mode != "codec") {
+    std::cerr << "Error: Unknown mode: " << cli.mode << std::endl;
+    std::exit(1);
+  }
+  if (cli.block_sizes.empty()) {
+    cli.block_sizes = { 4, 8, 16, 32, 64 };
+  }
+  if (cli.bitdepths.empty()) {
+    cli.bitdepths.push_back(8);
+#if XVC_HIGH_BITDEPTH
+    if (cli.mode == "kernels") {
+      cli.bitdepths.push_back(10);
+    }
+#endif
+  }
+  for (int bitdepth : cli.bitdepths) {
+    if (bitdepth < 8 || bitdepth > (XVC_HIGH_BITDEPTH ? 12 : 8)) {
+      std::cerr << "Error: Unsupported bitdepth: " << bitdepth << std::endl;
+      std::exit(1);
+    }
+  }
+  if (cli.resolutions.empty()) {
+    cli.resolutions.push_back({ 640, 360 });
+  }
+  if (cli.chroma_formats.empty()) {
+    cli.chroma_formats.push_back(XVC_ENC_CHROMA_FORMAT_420);
+  }
+  if (cli.speed_modes.empty()) {
+    cli.speed_modes.push_back(2);
+  }
+  if (cli.sub_gop_lengths.empty()) {
+    cli.sub_gop_lengths.push_back(8);
+  }
+  if (cli.threads.empty()) {
+    cli.threads.push_back(1);
+  }
+  return cli;
+}
+
+// Name of the highest cpu capability enabled by the mask
+std::string GetTierName(uint32_t mask) {
+  int highest = 0;
+  for (xvc::CpuCapability cap : xvc::SimdCpu::GetMaskedCaps(mask)) {
+    highest = std::max(highest, static_cast<int>(cap));
+  }
+  return kCapabilityNames[highest];
+}
+
+std::vector<SimdTier> GetSimdTiers(const CommandLine &cli) {
+  std::vector<SimdTier> tiers;
+  const uint32_t mask = static_cast<uint32_t>(cli.simd_mask);
+  if (!cli.simd_tiers) {
+    tiers.push_back({ GetTierName(mask), mask });
+    return tiers;
+  }
+  // Plain c++ followed by each runtime capability allowed by the mask
+  uint32_t tier_mask = 0;
+  tiers.push_back({ kCapabilityNames[0], tier_mask });
+  for (xvc::CpuCapability cap : xvc::SimdCpu::GetMaskedCaps(mask)) {
+    tier_mask |= 1 << static_cast<int>(cap);
+    tiers.push_back({ kCapabilityNames[static_cast<int>(cap)], tier_mask });
+  }
+  return tiers;
+}
+
+bool IsKernelSelected(const CommandLine &cli, const std::string &kernel) {
+  if (cli.kernels.empty()) {
+    return true;
+  }
+  for (const std::string &prefix : cli.kernels) {
+    if (kernel.compare(0, prefix.size(), prefix) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RunKernels(const CommandLine &cli,
+                std::vector<xvc_bench::BenchResult> *results) {
+  for (const SimdTier &tier : GetSimdTiers(cli)) {
+    for (int bitdepth : cli.bitdepths) {
+      xvc_bench::KernelBench bench(bitdepth, tier.mask, tier.name,
+                                   cli.min_time_ms);
+      for (const std::string &kernel :
+           xvc_bench::KernelBench::GetKernelNames()) {
+        if (!IsKernelSelected(cli, kernel)) {
+          continue;
+        }
+        for (int size : cli.block_sizes) {
+          if (!bench.Run(kernel, size, results)) {
+            std::cerr << "Error: Unsupported block size " << size
+              << " for " << kernel << std::endl;
+            return false;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool RunCodec(const CommandLine &cli,
+              std::vector<xvc_bench::CodecResult> *results) {
+  for (const SimdTier &tier : GetSimdTiers(cli)) {
+    for (const Resolution &resolution : cli.resolutions) {
+      for (int chroma_format : cli.chroma_formats) {
+        for (int bitdepth : cli.bitdepths) {
+          for (int speed_mode : cli.speed_modes) {
+            for (int sub_gop_length : cli.sub_gop_lengths) {
+              for (int threads : cli.threads) {
+                xvc_bench::CodecConfig config;
+                config.width = resolution.width;
+                config.height = resolution.height;
+                config.chroma_format =
+                  static_cast<xvc_enc_chroma_format>(chroma_format);
+                config.bitdepth = bitdepth;
+                config.speed_mode = speed_mode;
+                config.sub_gop_length = sub_gop_length;
+                config.threads = threads;
+                config.parallel_split_rdo = cli.parallel_split_rdo;
+                config.simd_mask = tier.mask;
+                config.qp = cli.qp;
+                config.frames = cli.frames;
+                std::cerr << "Running " << config.width << "x"
+                  << config.height << " chroma_format " << chroma_format
+                  << " bitdepth " << bitdepth << " speed_mode "
+                  << speed_mode << " sub_gop_length " << sub_gop_length
+                  << " threads " << threads << " simd " << tier.name
+                  << std::endl;
+                xvc_bench::CodecBench bench(config);
+                xvc_bench::CodecResult result;
+                std::string error;
+                if (!bench.Run(&result, &error)) {
+                  std::cerr << "Error: " << error << std::endl;
+                  return false;
+                }
+                results->push_back(result);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void WriteJsonHeader(const CommandLine &cli, std::ostream *out) {
+  std::ostream &os = *out;
+  os << "{" << std::endl;
+  os << "  \"benchmark\": \"" << cli.mode << "\"," << std::endl;
+  os << "  \"high_bitdepth\": " << (XVC_HIGH_BITDEPTH ? "true" : "false")
+    << "," << std::endl;
+}
+
+void WriteJson(const CommandLine &cli,
+               const std::vector<xvc_bench::BenchResult> &results,
+               std::ostream *out) {
+  std::ostream &os = *out;
+  WriteJsonHeader(cli, out);
+  os << "  \"min_time_ms\": " << cli.min_time_ms << "," << std::endl;
+  os << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); i++) {
+    const xvc_bench::BenchResult &r = results[i];
+    os << (i == 0 ? "" : ",") << std::endl;
+    os << "    {\"kernel\": \"" << r.kernel << "\""
+      << ", \"width\": " << r.width
+      << ", \"height\": " << r.height
+      << ", \"bitdepth\": " << r.bitdepth
+      << ", \"simd_mask\": " << r.simd_mask
+      << ", \"simd_tier\": \"" << r.simd_tier << "\""
+      << ", \"iterations\": " << r.iterations
+      << std::fixed << std::setprecision(2)
+      << ", \"ns_per_call\": " << r.ns_per_call
+      << ", \"msamples_per_sec\": " << r.msamples_per_sec
+      << "}";
+    os.unsetf(std::ios_base::floatfield);
+  }
+  os << std::endl << "  ]" << std::endl;
+  os << "}" << std::endl;
+}
+
+void WritePipelineStats(const char *name,
+                        const xvc_bench::PipelineStats &stats,
+                        std::ostream *out) {
+  *out << ", \"" << name << "\": {"
+    << "\"fps\": " << stats.fps
+    << ", \"latency_ms\": {\"p50\": " << stats.latency_p50
+    << ", \"p90\": " << stats.latency_p90
+    << ", \"p99\": " << stats.latency_p99
+    << ", \"max\": " << stats.latency_max << "}"
+    << ", \"peak_rss_mb\": " << stats.peak_rss << "}";
+}
+
+void WriteJson(const CommandLine &cli,
+               const std::vector<xvc_bench::CodecResult> &results,
+               std::ostream *out) {
+  std::ostream &os = *out;
+  WriteJsonHeader(cli, out);
+  os << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); i++) {
+    const xvc_bench::CodecResult &r = results[i];
+    const xvc_bench::CodecConfig &c = r.config;
+    os << (i == 0 ? "" : ",") << std::endl;
+    os << "    {\"width\": " << c.width
+      << ", \"height\": " << c.height
+      << ", \"chroma_format\": " << c.chroma_format
+      << ", \"bitdepth\": " << c.bitdepth
+      << ", \"speed_mode\": " << c.speed_mode
+      << ", \"sub_gop_length\": " << c.sub_gop_length
+      << ", \"threads\": " << c.threads
+      << ", \"parallel_split_rdo\": " << c.parallel_split_rdo
+      << ", \"simd_mask\": " << c.simd_mask
+      << ", \"qp\": " << c.qp
+      << ", \"frames\": " << c.frames
+      << std::fixed << std::setprecision(2)
+      << ", \"bytes_per_picture\": " << r.bytes_per_picture;
+    WritePipelineStats("encode", r.encode, out);
+    WritePipelineStats("decode", r.decode, out);
+    os << "}";
+    os.unsetf(std::ios_base::floatfield);
+  }
+  os << std::endl << "  ]" << std::endl;
+  os << "}" << std::endl;
+}
+
+template<typename ResultT>
+bool WriteOutput(const CommandLine &cli, const std::vector<ResultT> &results) {
+  if (cli.output_filename.empty() || cli.output_filename == "-") {
+    WriteJson(cli, results, &std::cout);
+    return true;
+  }
+  std::ofstream out(cli.output_filename);
+  if (!out) {
+    std::cerr << "Failed to open output file for writing: "
+      << cli.output_filename << std::endl;
+    return false;
+  }
+  WriteJson(cli, results, &out);
+  return true;
+}
+
+}   // namespace
+
+int main(int argc, const char *argv[]) {
+  const CommandLine cli = ReadArguments(argc, argv);
+  if (cli.mode == "codec") {
+    std::vector<xvc_bench::CodecResult> results;
+    if (!RunCodec(cli, &results) || !WriteOutput(cli, results)) {
+      return 1;
+    }
+    return 0;
+  }
+  std::vector<xvc_bench::BenchResult> results;
+  if (!RunKernels(cli, &results) || !WriteOutput(cli, results)) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,175 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <memory>
+#include <random>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/cabac.h"
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_enc_lib/bit_estimator.h"
+#include "xvc_enc_lib/entropy_encoder.h"
+#include "xvc_enc_lib/syntax_writer.h"
+
+namespace {
+
+class BitEstimatorTest : public ::testing::TestWithParam<int> {
+protected:
+  void SetUp() override {
+    std::mt19937 rand(GetParam());
+    auto randomize = [&rand](xvc::ContextModel *ctx, size_t num) {
+      for (size_t i = 0; i < num; i++) {
+        ctx[i].SetState(static_cast<uint8_t>(rand() % 63),
+                        static_cast<uint8_t>(rand() % 2));
+      }
+    };
+    randomize(&contexts_.cu_cbf_luma[0], contexts_.cu_cbf_luma.size());
+    randomize(&contexts_.cu_cbf_chroma[0], contexts_.cu_cbf_chroma.size());
+    randomize(&contexts_.cu_root_cbf[0], contexts_.cu_root_cbf.size());
+    randomize(&contexts_.inter_dir[0], contexts_.inter_dir.size());
+    randomize(&contexts_.inter_merge_flag[0],
+              contexts_.inter_merge_flag.size());
+    randomize(&contexts_.inter_merge_idx[0], contexts_.inter_merge_idx.size());
+    randomize(&contexts_.inter_mvd[0], contexts_.inter_mvd.size());
+    randomize(&contexts_.inter_mvp_idx[0], contexts_.inter_mvp_idx.size());
+    randomize(&contexts_.inter_ref_idx[0], contexts_.inter_ref_idx.size());
+    randomize(&contexts_.intra_pred_luma[0], contexts_.intra_pred_luma.size());
+    entropyenc_.reset(new xvc::EntropyEncoder(nullptr, 0, rand() % 32768));
+    writer_.reset(new xvc::SyntaxWriter(contexts_, entropyenc_.get()));
+    estimator_.reset(new xvc::BitEstimator(*writer_));
+  }
+
+  // Verifies both whole and fractional bits against a forked writer
+  template<typename WriteFunc>
+  void ExpectSameBits(uint32_t estimated_frac_bits, WriteFunc write) {
+    xvc::RdoSyntaxWriter rdo_writer(*writer_, 0);
+    write(&rdo_writer);
+    EXPECT_EQ(rdo_writer.GetNumWrittenBits(),
+              estimator_->GetNumBits(estimated_frac_bits));
+    uint64_t total_frac_bits =
+      (static_cast<uint64_t>(rdo_writer.GetNumWrittenBits()) << 15) +
+      rdo_writer.GetFractionalBits();
+    EXPECT_EQ(total_frac_bits,
+              writer_->GetFractionalBits() + estimated_frac_bits);
+  }
+
+  xvc::CabacContexts contexts_;
+  std::unique_ptr<xvc::EntropyEncoder> entropyenc_;
+  std::unique_ptr<xvc::SyntaxWriter> writer_;
+  std::unique_ptr<xvc::BitEstimator> estimator_;
+};
+
+TEST_P(BitEstimatorTest, IntraMode) {
+  xvc::IntraPredictorLuma mpm;
+  mpm[0] = xvc::IntraMode(26);
+  mpm[1] = xvc::IntraMode(1);
+  mpm[2] = xvc::IntraMode(10);
+  for (int i = 0; i < xvc::IntraMode::kTotalNumber; i++) {
+    xvc::IntraMode mode = static_cast<xvc::IntraMode>(i);
+    ExpectSameBits(estimator_->EstimateIntraMode(mode, mpm),
+                   [&](xvc::SyntaxWriter *w) { w->WriteIntraMode(mode, mpm); });
+  }
+}
+
+TEST_P(BitEstimatorTest, Cbf) {
+  for (int c = 0; c < 3; c++) {
+    xvc::YuvComponent comp = static_cast<xvc::YuvComponent>(c);
+    for (bool cbf : { false, true }) {
+      ExpectSameBits(estimator_->EstimateRootCbf(cbf),
+                     [&](xvc::SyntaxWriter *w) { w->WriteRootCbf(cbf); });
+      xvc::PictureData pic_data(xvc::ChromaFormat::k420, 64, 64, 8);
+      xvc::CodingUnit *cu =
+        pic_data.CreateCu(xvc::CuTree::Primary, 0, 0, 0, 64, 64);
+      ExpectSameBits(estimator_->EstimateCbf(comp, cbf),
+                     [&](xvc::SyntaxWriter *w) {
+        w->WriteCbf(*cu, comp, cbf);
+      });
+      pic_data.ReleaseCu(cu);
+    }
+  }
+}
+
+TEST_P(BitEstimatorTest, InterMotion) {
+  const int kMvdValues[] = { 0, 1, -1, 2, -3, 7, -16, 100, -513 };
+  for (int mvd_x : kMvdValues) {
+    for (int mvd_y : kMvdValues) {
+      xvc::MotionVector mvd(mvd_x, mvd_y);
+      ExpectSameBits(estimator_->EstimateInterMvd(mvd),
+                     [&](xvc::SyntaxWriter *w) { w->WriteInterMvd(mvd); });
+    }
+  }
+  for (int mvp_idx = 0; mvp_idx < xvc::constants::kNumInterMvPredictors;
+       mvp_idx++) {
+    ExpectSameBits(estimator_->EstimateInterMvpIdx(mvp_idx),
+                   [&](xvc::SyntaxWriter *w) {
+      w->WriteInterMvpIdx(mvp_idx);
+    });
+  }
+  for (int num_refs = 1; num_refs <= 5; num_refs++) {
+    for (int ref_idx = 0; ref_idx < num_refs; ref_idx++) {
+      ExpectSameBits(estimator_->EstimateInterRefIdx(ref_idx, num_refs),
+                     [&](xvc::SyntaxWriter *w) {
+        w->WriteInterRefIdx(ref_idx, num_refs);
+      });
+    }
+  }
+  for (bool merge : { false, true }) {
+    ExpectSameBits(estimator_->EstimateMergeFlag(merge),
+                   [&](xvc::SyntaxWriter *w) { w->WriteMergeFlag(merge); });
+  }
+}
+
+TEST_P(BitEstimatorTest, InterDir) {
+  xvc::PictureData pic_data(xvc::ChromaFormat::k420, 128, 128, 8);
+  for (int depth = 0; depth <= 4; depth++) {
+    int size = 64 >> depth;
+    xvc::CodingUnit *cu =
+      pic_data.CreateCu(xvc::CuTree::Primary, depth, 0, 0, size, size);
+    for (xvc::InterDir dir : { xvc::InterDir::kL0, xvc::InterDir::kL1,
+         xvc::InterDir::kBi }) {
+      ExpectSameBits(estimator_->EstimateInterDir(*cu, dir),
+                     [&](xvc::SyntaxWriter *w) { w->WriteInterDir(*cu, dir); });
+    }
+    pic_data.ReleaseCu(cu);
+  }
+}
+
+TEST_P(BitEstimatorTest, MergePrediction) {
+  xvc::PictureData pic_data(xvc::ChromaFormat::k420, 64, 64, 8);
+  xvc::CodingUnit *cu =
+    pic_data.CreateCu(xvc::CuTree::Primary, 0, 0, 0, 64, 64);
+  cu->SetPredMode(xvc::PredictionMode::kInter);
+  cu->SetMergeFlag(true);
+  for (int merge_idx = 0;
+       merge_idx < xvc::constants::kNumInterMergeCandidates; merge_idx++) {
+    cu->SetMergeIdx(merge_idx);
+    ExpectSameBits(estimator_->EstimateInterPrediction(*cu),
+                   [&](xvc::SyntaxWriter *w) {
+      w->WriteMergeFlag(true);
+      w->WriteMergeIdx(merge_idx);
+    });
+  }
+  pic_data.ReleaseCu(cu);
+}
+
+INSTANTIATE_TEST_CASE_P(RandomContexts, BitEstimatorTest,
+                        ::testing::Range(0, 8));
+
+}   // namespace
@@ -115,7 +115,8 @@ protected:
                                  segment_.soc, num_buffered_nals);
     // TODO(PH) Also verify inter pictures?
     xvc::ReferencePictureLists ref_pic_list;
-    pic_decoder_->Init(segment_, pic_header, std::move(ref_pic_list), 0);
+    pic_decoder_->Init(segment_, pic_header, std::move(ref_pic_list),
+                       bitstream.size(), 0);
     return pic_decoder_->Decode(segment_, &bit_reader);
   }
 
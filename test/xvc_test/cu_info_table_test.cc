@@ -0,0 +1,175 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/reference_list_sorter.h"
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/simd_functions.h"
+#include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/picture_encoder.h"
+#include "xvc_enc_lib/split_rdo_pool.h"
+#include "xvc_test/yuv_helper.h"
+
+namespace {
+
+static const int kWidth = 176;
+static const int kHeight = 144;
+static const int kBitdepth = 8;
+static const int kQp = 32;
+static const xvc::PicNum kSubGopLength = 4;
+
+class CuInfoTableTest : public ::testing::TestWithParam<int> {
+protected:
+  void SetUp() override {
+    segment_.codec_identifier = xvc::constants::kXvcCodecIdentifier;
+    segment_.major_version = xvc::constants::kXvcMajorVersion;
+    segment_.minor_version = xvc::constants::kXvcMinorVersion;
+    segment_.soc = 0;
+    segment_.SetWidth(kWidth);
+    segment_.SetHeight(kHeight);
+    segment_.chroma_format = xvc::ChromaFormat::k420;
+    segment_.internal_bitdepth = kBitdepth;
+    segment_.max_sub_gop_length = kSubGopLength;
+    segment_.open_gop = true;
+    segment_.num_ref_pics = 2;
+    segment_.max_binary_split_depth = xvc::constants::kMaxBinarySplitDepth;
+    segment_.checksum_mode = xvc::Checksum::Mode::kMinOverhead;
+    segment_.deblock = true;
+  }
+
+  // Encodes the first sub gop in coding order and checks the cu info table
+  // of each picture before its cus are released, as done by the encoder
+  void EncodeAndCheck(const xvc::EncoderSettings &encoder_settings,
+                      int num_tiles) {
+    const std::array<xvc::PicNum, 5> pocs = { { 0, 4, 2, 1, 3 } };
+    const std::array<int, 5> tids = { { 0, 0, 1, 2, 2 } };
+    xvc::SimdFunctions simd(xvc::SimdCpu::GetRuntimeCapabilities());
+    std::unique_ptr<xvc::SplitRdoPool> split_rdo_pool;
+    if (encoder_settings.parallel_split_rdo > 0) {
+      split_rdo_pool.reset(
+        new xvc::SplitRdoPool(simd, encoder_settings.parallel_split_rdo));
+    }
+    segment_.num_tile_columns = num_tiles;
+    segment_.num_tile_rows = 1;
+    std::vector<std::shared_ptr<xvc::PictureEncoder>> pic_buffer;
+    for (int doc = 0; doc < static_cast<int>(pocs.size()); doc++) {
+      SCOPED_TRACE(testing::Message() << "poc " << pocs[doc]);
+      auto pic_enc =
+        std::make_shared<xvc::PictureEncoder>(simd, segment_.chroma_format,
+                                              kWidth, kHeight, kBitdepth);
+      xvc::PictureData *pic_data = pic_enc->GetPicData().get();
+      pic_data->SetNalType(doc == 0 ? xvc::NalUnitType::kIntraAccessPicture :
+                           xvc::NalUnitType::kBipredictedPicture);
+      pic_data->SetPoc(pocs[doc]);
+      pic_data->SetDoc(doc);
+      pic_data->SetSoc(segment_.soc);
+      pic_data->SetTid(tids[doc]);
+      pic_data->SetHighestLayer(tids[doc] == tids.back());
+      std::vector<uint8_t> orig_bytes =
+        xvc_test::TestYuvPic::GetScaledBytes(kWidth, kHeight, kBitdepth,
+                                             static_cast<int>(pocs[doc]));
+      pic_enc->GetOrigPic()->CopyFrom(&orig_bytes[0], kBitdepth);
+      xvc::ReferenceListSorter<xvc::PictureEncoder> ref_list_sorter(segment_,
+                                                                    false);
+      ref_list_sorter.Prepare(pic_data->GetPoc(), pic_data->GetTid(),
+                              pic_data->IsIntraPic(), pic_buffer,
+                              pic_data->GetRefPicLists());
+      pic_enc->SetSplitRdoPool(split_rdo_pool.get());
+      pic_enc->Encode(segment_, kQp, kSubGopLength, 0, false,
+                      encoder_settings);
+
+      ExpectSameAsCodingUnits(*pic_data, xvc::CuTree::Primary);
+      if (pic_data->HasSecondaryCuTree()) {
+        ExpectSameAsCodingUnits(*pic_data, xvc::CuTree::Secondary);
+      }
+      // Later pictures must only depend on the temporal mv field
+      pic_data->ReleaseCus();
+      pic_buffer.push_back(pic_enc);
+    }
+  }
+
+  // Compares the table entry of every 4x4 block with its coding unit
+  void ExpectSameAsCodingUnits(const xvc::PictureData &pic_data,
+                               xvc::CuTree cu_tree) {
+    const xvc::YuvComponent luma = xvc::YuvComponent::kY;
+    const xvc::PictureData::CuInfoTable &cu_info =
+      pic_data.GetCuInfoTable(cu_tree);
+    for (int y = 0; y < pic_data.GetPictureHeight(luma);
+         y += xvc::constants::kMinBlockSize) {
+      for (int x = 0; x < pic_data.GetPictureWidth(luma);
+           x += xvc::constants::kMinBlockSize) {
+        const xvc::CodingUnit *cu = pic_data.GetCuAt(cu_tree, x, y);
+        const ptrdiff_t idx = pic_data.GetCuInfoIdx(x, y);
+        ASSERT_NE(nullptr, cu) << "x " << x << " y " << y;
+        ASSERT_EQ(cu->GetDepth(), cu_info.depth[idx]);
+        EXPECT_EQ(cu->GetBinaryDepth(), cu_info.binary_depth[idx]);
+        EXPECT_EQ(cu->GetSkipFlag(), cu_info.skip_flag[idx] != 0);
+        EXPECT_EQ(cu->GetPredMode(), cu_info.pred_mode[idx]);
+        if (cu_tree == xvc::CuTree::Primary && cu->IsIntra()) {
+          EXPECT_EQ(cu->GetIntraMode(luma), cu_info.intra_mode[idx]);
+        } else {
+          EXPECT_GT(0, cu_info.intra_mode[idx]);
+        }
+        EXPECT_EQ(cu->GetQp(luma), static_cast<int>(cu_info.qp_luma[idx]));
+        EXPECT_EQ(cu->GetQp(xvc::YuvComponent::kU),
+                  static_cast<int>(cu_info.qp_chroma[idx]));
+        EXPECT_EQ(cu->GetCbf(luma), cu_info.cbf_luma[idx] != 0);
+        EXPECT_EQ(cu->GetInterDir(), cu_info.inter_dir[idx]);
+        for (int i = 0; i < 2; i++) {
+          const xvc::RefPicList ref_list = static_cast<xvc::RefPicList>(i);
+          EXPECT_EQ(cu->GetMv(ref_list), cu_info.mv[i][idx]);
+          EXPECT_EQ(cu->GetRefIdx(ref_list), cu_info.ref_idx[i][idx]);
+        }
+      }
+    }
+  }
+
+  xvc::SegmentHeader segment_;
+};
+
+TEST_P(CuInfoTableTest, MatchesCodingUnitsAfterEncode) {
+  xvc::EncoderSettings encoder_settings;
+  encoder_settings.Initialize(xvc::SpeedMode(GetParam()));
+  encoder_settings.adaptive_qp = 2;
+  EncodeAndCheck(encoder_settings, 1);
+}
+
+TEST_P(CuInfoTableTest, MatchesCodingUnitsAfterParallelSplitEncode) {
+  xvc::EncoderSettings encoder_settings;
+  encoder_settings.Initialize(xvc::SpeedMode(GetParam()));
+  encoder_settings.parallel_split_rdo = 2;
+  EncodeAndCheck(encoder_settings, 1);
+}
+
+TEST_P(CuInfoTableTest, MatchesCodingUnitsAfterTileEncode) {
+  xvc::EncoderSettings encoder_settings;
+  encoder_settings.Initialize(xvc::SpeedMode(GetParam()));
+  EncodeAndCheck(encoder_settings, 2);
+}
+
+INSTANTIATE_TEST_CASE_P(SpeedModes, CuInfoTableTest,
+                        ::testing::Values(1, 2, 3));
+
+}   // namespace
@@ -16,9 +16,23 @@
 * The xvc License Agreement is available at https://xvc.io/license/.
 ******************************************************************************/
 
+#if !defined(_WIN32)
+#include <poll.h>
+#endif
+
+// Some C++11 headers are not allowed by cpplint
+#include <algorithm>
+#include <chrono>               // NOLINT
+#include <condition_variable>   // NOLINT
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <utility>
+#include <vector>
+
 #include "googletest/include/gtest/gtest.h"
 
 #include "xvc_dec_lib/xvcdec.h"
+#include "xvc_enc_lib/xvcenc.h"
 
 namespace {
 
@@ -133,4 +147,282 @@ TEST(DecoderAPI, DecoderCheckConformance) {
   EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
 }
 
+const int kWidth = 64;
+const int kHeight = 64;
+const int kNumPictures = 10;
+
+class DecoderAsyncTest : public ::testing::Test {
+protected:
+  using DecodedPicture = std::pair<int, std::vector<char>>;
+
+  void SetUp() override {
+    api_ = xvc_decoder_api_get();
+    const xvc_encoder_api *enc_api = xvc_encoder_api_get();
+    xvc_encoder_parameters *params = enc_api->parameters_create();
+    EXPECT_EQ(XVC_ENC_OK, enc_api->parameters_set_default(params));
+    params->width = kWidth;
+    params->height = kHeight;
+    params->sub_gop_length = 4;
+    params->speed_mode = 2;
+    xvc_encoder *encoder = enc_api->encoder_create(params);
+    EXPECT_EQ(XVC_ENC_OK, enc_api->parameters_destroy(params));
+    std::vector<uint8_t> picture(kWidth * kHeight * 3 / 2);
+    xvc_enc_nal_unit *nal_units;
+    int num_nal_units;
+    for (int poc = 0; poc <= kNumPictures; poc++) {
+      if (poc < kNumPictures) {
+        for (size_t i = 0; i < picture.size(); i++) {
+          picture[i] = static_cast<uint8_t>((i * 3 + (i / kWidth) * poc) &
+                                            0xff);
+        }
+        EXPECT_EQ(XVC_ENC_OK,
+                  enc_api->encoder_encode(encoder, &picture[0], &nal_units,
+                                          &num_nal_units, nullptr));
+      } else {
+        EXPECT_EQ(XVC_ENC_OK, enc_api->encoder_flush(encoder, &nal_units,
+                                                     &num_nal_units, nullptr));
+      }
+      for (int i = 0; i < num_nal_units; i++) {
+        nal_units_.emplace_back(nal_units[i].bytes,
+                                nal_units[i].bytes + nal_units[i].size);
+      }
+    }
+    EXPECT_EQ(XVC_ENC_OK, enc_api->encoder_destroy(encoder));
+  }
+
+  xvc_decoder* CreateDecoder(int input_queue_size) {
+    xvc_decoder_parameters *params = api_->parameters_create();
+    EXPECT_EQ(XVC_DEC_OK, api_->parameters_set_default(params));
+    params->async_input_queue_size = input_queue_size;
+    params->async_output_queue_size = 2;
+    xvc_decoder *decoder = api_->decoder_create(params);
+    EXPECT_EQ(XVC_DEC_OK, api_->parameters_destroy(params));
+    return decoder;
+  }
+
+  static DecodedPicture CopyPicture(const xvc_decoded_picture &pic) {
+    return DecodedPicture(pic.stats.poc,
+                          std::vector<char>(pic.bytes, pic.bytes + pic.size));
+  }
+
+  std::vector<DecodedPicture> DecodeSync() {
+    std::vector<DecodedPicture> decoded;
+    xvc_decoder *decoder = CreateDecoder(0);
+    xvc_decoded_picture pic;
+    for (auto &nal : nal_units_) {
+      EXPECT_EQ(XVC_DEC_OK, api_->decoder_decode_nal(decoder, &nal[0],
+                                                     nal.size(), 0));
+      while (api_->decoder_get_picture(decoder, &pic) == XVC_DEC_OK) {
+        decoded.push_back(CopyPicture(pic));
+      }
+    }
+    EXPECT_EQ(XVC_DEC_OK, api_->decoder_flush(decoder));
+    while (api_->decoder_get_picture(decoder, &pic) == XVC_DEC_OK) {
+      decoded.push_back(CopyPicture(pic));
+    }
+    EXPECT_EQ(XVC_DEC_OK, api_->decoder_destroy(decoder));
+    return decoded;
+  }
+
+  static void ReceivePicture(void *opaque, const xvc_decoded_picture *pic) {
+    DecoderAsyncTest *test = reinterpret_cast<DecoderAsyncTest*>(opaque);
+    std::lock_guard<std::mutex> lock(test->mutex_);
+    if (!pic) {
+      test->end_of_stream_ = true;
+      test->end_of_stream_cond_.notify_one();
+      return;
+    }
+    test->received_.push_back(CopyPicture(*pic));
+  }
+
+  const xvc_decoder_api *api_;
+  std::vector<std::vector<uint8_t>> nal_units_;
+  std::mutex mutex_;
+  std::condition_variable end_of_stream_cond_;
+  bool end_of_stream_ = false;
+  std::vector<DecodedPicture> received_;
+};
+
+TEST_F(DecoderAsyncTest, ReceivePictureMatchesSyncDecode) {
+  std::vector<DecodedPicture> expected = DecodeSync();
+  ASSERT_EQ(static_cast<size_t>(kNumPictures), expected.size());
+  xvc_decoder *decoder = CreateDecoder(2);
+  xvc_decoded_picture pic;
+  EXPECT_EQ(XVC_DEC_NO_DECODED_PIC,
+            api_->decoder_receive_picture(decoder, &pic, 0));
+  size_t nal_idx = 0;
+  while (true) {
+    if (nal_idx < nal_units_.size()) {
+      std::vector<uint8_t> &nal = nal_units_[nal_idx];
+      xvc_dec_return_code ret =
+        api_->decoder_send_nal(decoder, &nal[0], nal.size(), 0);
+      EXPECT_TRUE(ret == XVC_DEC_QUEUE_FULL || ret == XVC_DEC_OK);
+      if (ret == XVC_DEC_OK) {
+        nal_idx++;
+      }
+    } else if (nal_idx == nal_units_.size()) {
+      EXPECT_EQ(XVC_DEC_OK, api_->decoder_send_nal(decoder, nullptr, 0, 0));
+      nal_idx++;
+    }
+    // Output may depend on nal units not yet sent, only wait after flushing
+    int wait = nal_idx > nal_units_.size();
+    xvc_dec_return_code ret =
+      api_->decoder_receive_picture(decoder, &pic, wait);
+    if (ret == XVC_DEC_END_OF_STREAM) {
+      break;
+    } else if (ret == XVC_DEC_NO_DECODED_PIC) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(XVC_DEC_OK, ret);
+    received_.push_back(CopyPicture(pic));
+  }
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT,
+            api_->decoder_decode_nal(decoder, &nal_units_[0][0],
+                                     nal_units_[0].size(), 0));
+  EXPECT_EQ(XVC_DEC_END_OF_STREAM,
+            api_->decoder_receive_picture(decoder, &pic, 1));
+  EXPECT_EQ(XVC_DEC_OK, api_->decoder_destroy(decoder));
+  EXPECT_EQ(expected, received_);
+}
+
+TEST_F(DecoderAsyncTest, PictureCallbackMatchesSyncDecode) {
+  std::vector<DecodedPicture> expected = DecodeSync();
+  xvc_decoder *decoder = CreateDecoder(static_cast<int>(nal_units_.size()));
+  EXPECT_EQ(XVC_DEC_OK,
+            api_->decoder_set_picture_callback(decoder, &ReceivePicture,
+                                               this));
+  for (auto &nal : nal_units_) {
+    EXPECT_EQ(XVC_DEC_OK, api_->decoder_send_nal(decoder, &nal[0],
+                                                 nal.size(), 0));
+  }
+  EXPECT_EQ(XVC_DEC_OK, api_->decoder_send_nal(decoder, nullptr, 0, 0));
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT,
+            api_->decoder_send_nal(decoder, nullptr, 0, 0));
+  xvc_decoded_picture pic;
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT,
+            api_->decoder_receive_picture(decoder, &pic, 1));
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    end_of_stream_cond_.wait(lock, [this]() { return end_of_stream_; });
+  }
+  EXPECT_EQ(XVC_DEC_OK, api_->decoder_destroy(decoder));
+  EXPECT_EQ(expected, received_);
+}
+
+#if !defined(_WIN32)
+TEST_F(DecoderAsyncTest, EventFdSignalsPictures) {
+  std::vector<DecodedPicture> expected = DecodeSync();
+  xvc_decoder *decoder = CreateDecoder(static_cast<int>(nal_units_.size()));
+  int fd = api_->decoder_get_event_fd(decoder);
+  ASSERT_GE(fd, 0);
+  for (auto &nal : nal_units_) {
+    EXPECT_EQ(XVC_DEC_OK, api_->decoder_send_nal(decoder, &nal[0],
+                                                 nal.size(), 0));
+  }
+  EXPECT_EQ(XVC_DEC_OK, api_->decoder_send_nal(decoder, nullptr, 0, 0));
+  xvc_decoded_picture pic;
+  while (true) {
+    pollfd poll_fd = { fd, POLLIN, 0 };
+    ASSERT_EQ(1, poll(&poll_fd, 1, -1));
+    xvc_dec_return_code ret = api_->decoder_receive_picture(decoder, &pic, 0);
+    if (ret == XVC_DEC_END_OF_STREAM) {
+      break;
+    }
+    ASSERT_EQ(XVC_DEC_OK, ret);
+    received_.push_back(CopyPicture(pic));
+  }
+  EXPECT_EQ(XVC_DEC_OK, api_->decoder_destroy(decoder));
+  EXPECT_EQ(expected, received_);
+}
+#endif
+
+class DecoderLowDelayTest : public ::testing::TestWithParam<int> {
+protected:
+  // Encodes and decodes one picture at a time and returns the number of
+  // pictures sent to the encoder before each picture is output from the
+  // decoder, i.e. the glass-to-glass latency in pictures.
+  std::vector<int> MeasureLatency(int low_delay) {
+    const xvc_encoder_api *enc_api = xvc_encoder_api_get();
+    xvc_encoder_parameters *enc_params = enc_api->parameters_create();
+    EXPECT_EQ(XVC_ENC_OK, enc_api->parameters_set_default(enc_params));
+    enc_params->width = kWidth;
+    enc_params->height = kHeight;
+    enc_params->sub_gop_length = 1;
+    enc_params->speed_mode = 2;
+    xvc_encoder *encoder = enc_api->encoder_create(enc_params);
+    EXPECT_EQ(XVC_ENC_OK, enc_api->parameters_destroy(enc_params));
+    const xvc_decoder_api *dec_api = xvc_decoder_api_get();
+    xvc_decoder_parameters *dec_params = dec_api->parameters_create();
+    EXPECT_EQ(XVC_DEC_OK, dec_api->parameters_set_default(dec_params));
+    dec_params->threads = GetParam();
+    dec_params->low_delay = low_delay;
+    xvc_decoder *decoder = dec_api->decoder_create(dec_params);
+    EXPECT_EQ(XVC_DEC_OK, dec_api->parameters_destroy(dec_params));
+
+    std::vector<int> latency;
+    std::vector<std::chrono::steady_clock::time_point> capture_time;
+    std::chrono::steady_clock::duration max_latency_time(0);
+    auto receive = [&](const xvc_decoded_picture &pic) {
+      int poc = static_cast<int>(pic.stats.poc);
+      EXPECT_EQ(static_cast<int>(latency.size()), poc);
+      latency.push_back(static_cast<int>(capture_time.size()) - 1 - poc);
+      max_latency_time = std::max(max_latency_time,
+                                  std::chrono::steady_clock::now() -
+                                  capture_time[poc]);
+    };
+    std::vector<uint8_t> picture(kWidth * kHeight * 3 / 2);
+    xvc_enc_nal_unit *nal_units;
+    int num_nal_units;
+    xvc_decoded_picture pic;
+    for (int poc = 0; poc <= kNumPictures; poc++) {
+      if (poc < kNumPictures) {
+        for (size_t i = 0; i < picture.size(); i++) {
+          picture[i] = static_cast<uint8_t>((i * 7 + (i / kWidth) * poc) &
+                                            0xff);
+        }
+        capture_time.push_back(std::chrono::steady_clock::now());
+        EXPECT_EQ(XVC_ENC_OK,
+                  enc_api->encoder_encode(encoder, &picture[0], &nal_units,
+                                          &num_nal_units, nullptr));
+      } else {
+        EXPECT_EQ(XVC_ENC_OK, enc_api->encoder_flush(encoder, &nal_units,
+                                                     &num_nal_units, nullptr));
+      }
+      for (int i = 0; i < num_nal_units; i++) {
+        EXPECT_EQ(XVC_DEC_OK,
+                  dec_api->decoder_decode_nal(decoder, nal_units[i].bytes,
+                                              nal_units[i].size, 0));
+        while (dec_api->decoder_get_picture(decoder, &pic) == XVC_DEC_OK) {
+          receive(pic);
+        }
+      }
+    }
+    EXPECT_EQ(XVC_DEC_OK, dec_api->decoder_flush(decoder));
+    while (dec_api->decoder_get_picture(decoder, &pic) == XVC_DEC_OK) {
+      receive(pic);
+    }
+    EXPECT_EQ(XVC_ENC_OK, enc_api->encoder_destroy(encoder));
+    EXPECT_EQ(XVC_DEC_OK, dec_api->decoder_destroy(decoder));
+    EXPECT_EQ(static_cast<size_t>(kNumPictures), latency.size());
+    RecordProperty(low_delay ? "low_delay_max_latency_us" : "max_latency_us",
+                   static_cast<int>(std::chrono::duration_cast<
+                                    std::chrono::microseconds>(
+                                      max_latency_time).count()));
+    return latency;
+  }
+};
+
+TEST_P(DecoderLowDelayTest, OutputsPicturesWithoutDelay) {
+  std::vector<int> latency = MeasureLatency(0);
+  std::vector<int> low_delay_latency = MeasureLatency(1);
+  for (int poc = 0; poc < kNumPictures; poc++) {
+    EXPECT_EQ(0, low_delay_latency[poc]) << "Picture poc " << poc;
+  }
+  EXPECT_GT(latency[0], 0);
+}
+
+INSTANTIATE_TEST_CASE_P(Threads, DecoderLowDelayTest,
+                        ::testing::Values(0, 2));
+
 }   // namespace
@@ -95,11 +95,31 @@ protected:
     EXPECT_EQ(byte_width / 2, decoded_picture.stride[1]);
     EXPECT_EQ(byte_width / 2, decoded_picture.stride[2]);
     EXPECT_FALSE(verified_[poc]);
+    VerifyDecodeStats(width, height, decoded_picture.stats);
     double psnr = orig_pics_[poc].CalcPsnr(decoded_picture.bytes);
     EXPECT_GE(psnr, kPsnrThreshold) << "Picture poc " << poc;
     verified_[poc] = true;
   }
 
+  void VerifyDecodeStats(int width, int height,
+                         const xvc_dec_pic_stats &stats) {
+    uint32_t num_cus = 0;
+    for (uint32_t num_cus_of_size : stats.num_cus_by_size) {
+      num_cus += num_cus_of_size;
+    }
+    EXPECT_EQ(num_cus, stats.num_intra_cus + stats.num_inter_cus +
+              stats.num_merge_cus + stats.num_skip_cus);
+    EXPECT_EQ(width * height > 0, num_cus > 0);
+    xvc::NalUnitType nal_type = xvc::NalUnitType(stats.nal_unit_type);
+    if (nal_type == xvc::NalUnitType::kIntraPicture ||
+        nal_type == xvc::NalUnitType::kIntraAccessPicture) {
+      EXPECT_EQ(num_cus, stats.num_intra_cus);
+    }
+    EXPECT_GT(stats.nal_bytes, 0u);
+    EXPECT_GE(stats.decode_time_ms, 0);
+    EXPECT_GE(stats.queue_wait_ms, 0);
+  }
+
   std::vector<xvc_test::TestYuvPic> orig_pics_;
   std::vector<bool> verified_;
   std::list<int> encoded_pocs_;
@@ -115,6 +135,99 @@ TEST_P(EncodeDecodeTest, TwoSubGop24x24) {
   Decode(24, 24, kFramesEncoded * 2 + 1);
 }
 
+TEST_P(EncodeDecodeTest, TwoSubGopTiles200x136) {
+  const int width = 200;
+  const int height = 136;
+  const int bitdepth = GetParam();
+  const int frames = kFramesEncoded * 2 + 1;
+  encoder_->SetResolution(width, height);
+  encoder_->SetTiles(3, 2);
+  // Tiles are coded by the encoding thread and two workers
+  encoder_->SetNumThreads(3);
+  for (int i = 0; i < frames; i++) {
+    std::vector<uint8_t> pic_bytes =
+      xvc_test::TestYuvPic::GetScaledBytes(width, height, bitdepth, i);
+    EncodeOneFrame(pic_bytes, bitdepth);
+  }
+  EncoderFlush();
+  // Checksums of all pictures are verified by the decoder
+  DecodeSegmentHeaderSuccess(GetNextNalToDecode());
+  int num_decoded = 0;
+  while (HasMoreNals()) {
+    DecodePictureSuccess(GetNextNalToDecode());
+    num_decoded++;
+  }
+  while (DecoderFlushAndGet()) {
+  }
+  EXPECT_EQ(frames, num_decoded);
+  EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+}
+
+TEST_P(EncodeDecodeTest, SceneCutRestartsSegmentCadence) {
+  const int width = 64;
+  const int height = 64;
+  const int bitdepth = GetParam();
+  const int sub_gop_length = 4;
+  const int segment_length = 8;
+  const int scene_cut_poc = 10;
+  const int frames = 29;
+  xvc::EncoderSettings encoder_settings;
+  encoder_settings.Initialize(xvc::SpeedMode::kFast);
+  encoder_settings.lookahead = 1;
+  encoder_ = CreateEncoder(encoder_settings, width, height, bitdepth, kQp);
+  encoder_->SetSubGopLength(sub_gop_length);
+  encoder_->SetSegmentLength(segment_length);
+  encoder_->SetClosedGopInterval(2 * segment_length);
+  std::vector<int> segment_pocs;
+  std::vector<bool> segment_open_gop;
+  std::vector<int> segment_sub_gop_length;
+  for (int i = 0; i < frames; i++) {
+    // Still content followed by other content with fast motion
+    const int pic_num = i < scene_cut_poc ? 0 : 1000 + i * 6;
+    std::vector<uint8_t> pic_bytes = xvc_test::TestYuvPic::GetScaledBytes(
+      width, height, bitdepth, pic_num);
+    for (auto &nal : EncodeOneFrame(pic_bytes, bitdepth)) {
+      if (nal.stats.nal_unit_type ==
+          static_cast<uint32_t>(xvc::NalUnitType::kSegmentHeader)) {
+        const xvc::SegmentHeader *segment = encoder_->GetCurrentSegment();
+        segment_pocs.push_back(i);
+        segment_open_gop.push_back(segment->open_gop);
+        segment_sub_gop_length.push_back(
+          static_cast<int>(segment->max_sub_gop_length));
+      }
+    }
+  }
+  EncoderFlush();
+
+  // Scene cut is moved to the end of its sub gop, cadence restarts there
+  const std::vector<int> expected_pocs = { 0, 8, 12, 20, 28 };
+  EXPECT_EQ(expected_pocs, segment_pocs);
+  const std::vector<bool> expected_open_gop =
+    { true, false, true, false, true };
+  EXPECT_EQ(expected_open_gop, segment_open_gop);
+  ASSERT_EQ(expected_pocs.size(), segment_sub_gop_length.size());
+  EXPECT_EQ(sub_gop_length, segment_sub_gop_length[2]);
+  EXPECT_EQ(sub_gop_length / 2, segment_sub_gop_length[3]);
+
+  // Checksums of all pictures are verified by the decoder
+  int num_decoded = 0;
+  while (HasMoreNals()) {
+    const xvc_test::NalUnit &nal = GetNextNalToDecode();
+    EXPECT_TRUE(decoder_->DecodeNal(&nal[0], nal.size()));
+    while (decoder_->GetDecodedPicture(&last_decoded_picture_)) {
+      EXPECT_EQ(num_decoded, last_decoded_picture_.stats.poc);
+      num_decoded++;
+    }
+  }
+  while (DecoderFlushAndGet()) {
+    EXPECT_EQ(num_decoded, last_decoded_picture_.stats.poc);
+    num_decoded++;
+  }
+  EXPECT_EQ(frames, num_decoded);
+  EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+  verified_.clear();
+}
+
 TEST_P(EncodeDecodeTest, SingleSegment16x16) {
   Encode(16, 16, kSegmentLength + 1);
   Decode(16, 16, kSegmentLength, false);
@@ -16,10 +16,15 @@
 * The xvc License Agreement is available at https://xvc.io/license/.
 ******************************************************************************/
 
+#include <condition_variable>  // NOLINT
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "googletest/include/gtest/gtest.h"
 
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/checksum.h"
+#include "xvc_dec_lib/xvcdec.h"
 #include "xvc_enc_lib/xvcenc.h"
 
 namespace {
@@ -92,6 +97,16 @@ TEST(EncoderAPI, ParamCheck) {
   params->max_keypic_distance = 0;
   EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
 
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->target_bitrate = -1;
+  EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
+
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->vbv_buffer_size = 500;
+  EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
+  params->target_bitrate = 1000;
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
+
   EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
   params->chroma_format = XVC_ENC_CHROMA_FORMAT_UNDEFINED;
   EXPECT_EQ(XVC_ENC_UNSUPPORTED_CHROMA_FORMAT, api->parameters_check(params));
@@ -159,6 +174,19 @@ TEST(EncoderAPI, ParamCheck) {
   params->tc_offset = -32;
   EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
 
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->tile_columns = 0;
+  EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
+
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->tile_rows = xvc::constants::kMaxTileRows + 1;
+  EXPECT_EQ(XVC_ENC_INVALID_PARAMETER, api->parameters_check(params));
+
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->tile_columns = 2;
+  params->tile_rows = 2;
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
+
   EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
   params->checksum_mode = static_cast<int>(xvc::Checksum::Mode::kMinOverhead);
   EXPECT_EQ(XVC_ENC_OK, api->parameters_check(params));
@@ -221,6 +249,413 @@ TEST(EncoderAPI, EncoderEncode) {
   EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
 }
 
+TEST(EncoderAPI, EncoderEncodePlanes) {
+  const xvc_encoder_api *api = xvc_encoder_api_get();
+  const int width = 176;
+  const int height = 144;
+  const int padding = 24;
+  xvc_enc_nal_unit *nal_units;
+  int num_nal_units;
+  std::vector<std::vector<uint8_t>> encoded[2];
+  std::vector<uint8_t> contiguous_pic;
+  std::vector<uint8_t> padded_pic;
+  xvc_enc_pic_planes planes;
+  for (int c = 0; c < 3; c++) {
+    const int plane_width = c == 0 ? width : width / 2;
+    const int plane_height = c == 0 ? height : height / 2;
+    planes.stride[c] = plane_width + padding;
+    for (int y = 0; y < plane_height; y++) {
+      for (int x = 0; x < plane_width + padding; x++) {
+        uint8_t sample = static_cast<uint8_t>((x * 3 + y * 7 + c * 50) & 0xff);
+        if (x < plane_width) {
+          contiguous_pic.push_back(sample);
+        }
+        padded_pic.push_back(x < plane_width ? sample : 0xff);
+      }
+    }
+  }
+  const uint8_t *padded_ptr = &padded_pic[0];
+  for (int c = 0; c < 3; c++) {
+    planes.planes[c] = padded_ptr;
+    padded_ptr += planes.stride[c] * (c == 0 ? height : height / 2);
+  }
+
+  for (int i = 0; i < 2; i++) {
+    xvc_encoder_parameters *params = api->parameters_create();
+    EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+    params->width = width;
+    params->height = height;
+    params->sub_gop_length = 1;
+    params->speed_mode = 2;
+    xvc_encoder *encoder = api->encoder_create(params);
+    EXPECT_EQ(XVC_ENC_OK, api->parameters_destroy(params));
+    ASSERT_NE(encoder, nullptr);
+    if (i == 0) {
+      EXPECT_EQ(XVC_ENC_OK,
+                api->encoder_encode(encoder, &contiguous_pic[0], &nal_units,
+                                    &num_nal_units, nullptr));
+    } else {
+      EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+                api->encoder_encode_planes(encoder, nullptr, &nal_units,
+                                           &num_nal_units, nullptr));
+      EXPECT_EQ(XVC_ENC_OK,
+                api->encoder_encode_planes(encoder, &planes, &nal_units,
+                                           &num_nal_units, nullptr));
+    }
+    for (int j = 0; j < num_nal_units; j++) {
+      encoded[i].emplace_back(nal_units[j].bytes,
+                              nal_units[j].bytes + nal_units[j].size);
+    }
+    EXPECT_EQ(XVC_ENC_OK, api->encoder_flush(encoder, &nal_units,
+                                             &num_nal_units, nullptr));
+    for (int j = 0; j < num_nal_units; j++) {
+      encoded[i].emplace_back(nal_units[j].bytes,
+                              nal_units[j].bytes + nal_units[j].size);
+    }
+    EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
+  }
+  ASSERT_FALSE(encoded[0].empty());
+  EXPECT_EQ(encoded[0], encoded[1]);
+}
+
+const int kWidth = 64;
+const int kHeight = 64;
+const int kNumPictures = 6;
+const int kLadderDownstreamQp = 27;
+
+class EncoderAsyncTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    api_ = xvc_encoder_api_get();
+    const int picture_size = kWidth * kHeight * 3 / 2;
+    pictures_.resize(kNumPictures);
+    for (int poc = 0; poc < kNumPictures; poc++) {
+      for (int i = 0; i < picture_size; i++) {
+        pictures_[poc].push_back(
+          static_cast<uint8_t>((i * 5 + (i / kWidth) * poc * 3) & 0xff));
+      }
+    }
+  }
+
+  xvc_encoder_parameters* CreateParameters(int input_queue_size) {
+    xvc_encoder_parameters *params = api_->parameters_create();
+    EXPECT_EQ(XVC_ENC_OK, api_->parameters_set_default(params));
+    params->width = kWidth;
+    params->height = kHeight;
+    params->sub_gop_length = 2;
+    // An explicit speed mode takes precedence over the restricted mode
+    params->speed_mode = restricted_mode_ ? -1 : 2;
+    params->restricted_mode = restricted_mode_;
+    params->async_input_queue_size = input_queue_size;
+    params->async_output_queue_size = 2;
+    return params;
+  }
+
+  xvc_encoder* CreateEncoder(int input_queue_size) {
+    xvc_encoder_parameters *params = CreateParameters(input_queue_size);
+    xvc_encoder *encoder = api_->encoder_create(params);
+    EXPECT_EQ(XVC_ENC_OK, api_->parameters_destroy(params));
+    return encoder;
+  }
+
+  xvc_enc_pic_planes GetPlanes(int poc) {
+    xvc_enc_pic_planes planes;
+    planes.planes[0] = &pictures_[poc][0];
+    planes.planes[1] = planes.planes[0] + kWidth * kHeight;
+    planes.planes[2] = planes.planes[1] + kWidth * kHeight / 4;
+    planes.stride[0] = kWidth;
+    planes.stride[1] = kWidth / 2;
+    planes.stride[2] = kWidth / 2;
+    return planes;
+  }
+
+  std::vector<std::vector<uint8_t>> EncodeSync() {
+    std::vector<std::vector<uint8_t>> encoded;
+    xvc_encoder *encoder = CreateEncoder(0);
+    xvc_enc_nal_unit *nal_units;
+    int num_nal_units;
+    for (int poc = 0; poc <= kNumPictures; poc++) {
+      if (poc < kNumPictures) {
+        EXPECT_EQ(XVC_ENC_OK,
+                  api_->encoder_encode(encoder, &pictures_[poc][0],
+                                       &nal_units, &num_nal_units, nullptr));
+      } else {
+        EXPECT_EQ(XVC_ENC_OK, api_->encoder_flush(encoder, &nal_units,
+                                                  &num_nal_units, nullptr));
+      }
+      for (int i = 0; i < num_nal_units; i++) {
+        encoded.emplace_back(nal_units[i].bytes,
+                             nal_units[i].bytes + nal_units[i].size);
+      }
+    }
+    EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(encoder));
+    return encoded;
+  }
+
+  static void ReleasePicture(void *opaque, const xvc_enc_pic_planes *planes) {
+    EncoderAsyncTest *test = reinterpret_cast<EncoderAsyncTest*>(opaque);
+    std::lock_guard<std::mutex> lock(test->mutex_);
+    test->num_released_++;
+  }
+
+  static void ReceiveNal(void *opaque, const xvc_enc_nal_unit *nal_unit) {
+    EncoderAsyncTest *test = reinterpret_cast<EncoderAsyncTest*>(opaque);
+    std::lock_guard<std::mutex> lock(test->mutex_);
+    if (!nal_unit) {
+      test->end_of_stream_ = true;
+      test->end_of_stream_cond_.notify_one();
+      return;
+    }
+    test->received_.emplace_back(nal_unit->bytes,
+                                 nal_unit->bytes + nal_unit->size);
+  }
+
+  const xvc_encoder_api *api_;
+  std::vector<std::vector<uint8_t>> pictures_;
+  int restricted_mode_ = 0;
+  std::mutex mutex_;
+  std::condition_variable end_of_stream_cond_;
+  int num_released_ = 0;
+  bool end_of_stream_ = false;
+  std::vector<std::vector<uint8_t>> received_;
+};
+
+TEST_F(EncoderAsyncTest, ReceiveNalMatchesSyncEncode) {
+  std::vector<std::vector<uint8_t>> expected = EncodeSync();
+  xvc_encoder *encoder = CreateEncoder(2);
+  xvc_enc_nal_unit nal_unit;
+  EXPECT_EQ(XVC_ENC_NO_NAL_UNIT, api_->encoder_receive_nal(encoder, &nal_unit,
+                                                           0));
+  int poc = 0;
+  while (true) {
+    xvc_enc_return_code ret = XVC_ENC_QUEUE_FULL;
+    if (poc < kNumPictures) {
+      xvc_enc_pic_planes planes = GetPlanes(poc);
+      ret = api_->encoder_send_picture(encoder, &planes, &ReleasePicture,
+                                       this);
+      if (ret == XVC_ENC_OK) {
+        poc++;
+        continue;
+      }
+    } else if (poc == kNumPictures) {
+      ret = api_->encoder_send_picture(encoder, nullptr, nullptr, nullptr);
+      EXPECT_EQ(XVC_ENC_OK, ret);
+      poc++;
+    }
+    EXPECT_TRUE(ret == XVC_ENC_QUEUE_FULL || ret == XVC_ENC_OK);
+    ret = api_->encoder_receive_nal(encoder, &nal_unit, 1);
+    if (ret == XVC_ENC_END_OF_STREAM) {
+      break;
+    }
+    ASSERT_EQ(XVC_ENC_OK, ret);
+    received_.emplace_back(nal_unit.bytes, nal_unit.bytes + nal_unit.size);
+  }
+  // Synchronous encoding is rejected because the encoder is asynchronous
+  xvc_enc_nal_unit *sync_nal_units = nullptr;
+  int num_sync_nal_units = 0;
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_encode(encoder, &pictures_[0][0], &sync_nal_units,
+                                 &num_sync_nal_units, nullptr));
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_flush(encoder, &sync_nal_units,
+                                &num_sync_nal_units, nullptr));
+  EXPECT_EQ(XVC_ENC_END_OF_STREAM,
+            api_->encoder_receive_nal(encoder, &nal_unit, 1));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(encoder));
+  EXPECT_EQ(kNumPictures, num_released_);
+  EXPECT_EQ(expected, received_);
+}
+
+TEST_F(EncoderAsyncTest, NalCallbackMatchesSyncEncode) {
+  std::vector<std::vector<uint8_t>> expected = EncodeSync();
+  xvc_encoder *encoder = CreateEncoder(kNumPictures);
+  EXPECT_EQ(XVC_ENC_OK,
+            api_->encoder_set_nal_callback(encoder, &ReceiveNal, this));
+  for (int poc = 0; poc < kNumPictures; poc++) {
+    xvc_enc_pic_planes planes = GetPlanes(poc);
+    EXPECT_EQ(XVC_ENC_OK, api_->encoder_send_picture(encoder, &planes,
+                                                     &ReleasePicture, this));
+  }
+  EXPECT_EQ(XVC_ENC_OK,
+            api_->encoder_send_picture(encoder, nullptr, nullptr, nullptr));
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_send_picture(encoder, nullptr, nullptr, nullptr));
+  xvc_enc_nal_unit nal_unit;
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_receive_nal(encoder, &nal_unit, 1));
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    end_of_stream_cond_.wait(lock, [this]() { return end_of_stream_; });
+  }
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(encoder));
+  EXPECT_EQ(kNumPictures, num_released_);
+  EXPECT_EQ(expected, received_);
+}
+
+TEST_F(EncoderAsyncTest, RestrictedModeFollowsEncoderSettings) {
+  restricted_mode_ = 1;
+  std::vector<std::vector<uint8_t>> expected = EncodeSync();
+  xvc_encoder *encoder = CreateEncoder(kNumPictures);
+  // Creating another encoder changes the restriction flags of this thread
+  restricted_mode_ = 0;
+  xvc_encoder *unrestricted_encoder = CreateEncoder(0);
+  EXPECT_EQ(XVC_ENC_OK,
+            api_->encoder_set_nal_callback(encoder, &ReceiveNal, this));
+  for (int poc = 0; poc < kNumPictures; poc++) {
+    xvc_enc_pic_planes planes = GetPlanes(poc);
+    EXPECT_EQ(XVC_ENC_OK, api_->encoder_send_picture(encoder, &planes,
+                                                     &ReleasePicture, this));
+  }
+  EXPECT_EQ(XVC_ENC_OK,
+            api_->encoder_send_picture(encoder, nullptr, nullptr, nullptr));
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    end_of_stream_cond_.wait(lock, [this]() { return end_of_stream_; });
+  }
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(encoder));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(unrestricted_encoder));
+  EXPECT_EQ(expected, received_);
+}
+
+TEST_F(EncoderAsyncTest, LadderUpstreamMatchesStandaloneEncode) {
+  std::vector<std::vector<uint8_t>> expected = EncodeSync();
+  xvc_encoder *upstream = CreateEncoder(0);
+  xvc_encoder_parameters *params = CreateParameters(0);
+  params->qp = kLadderDownstreamQp;
+  xvc_encoder *downstream = api_->encoder_create(params);
+  EXPECT_EQ(XVC_ENC_OK, api_->parameters_destroy(params));
+  ASSERT_NE(upstream, nullptr);
+  ASSERT_NE(downstream, nullptr);
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_set_ladder_upstream(nullptr, upstream));
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_set_ladder_upstream(downstream, nullptr));
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_set_ladder_upstream(downstream, downstream));
+  EXPECT_EQ(XVC_ENC_OK,
+            api_->encoder_set_ladder_upstream(downstream, upstream));
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_set_ladder_upstream(downstream, upstream));
+  std::vector<std::vector<uint8_t>> encoded[2];
+  std::vector<std::vector<uint8_t>> downstream_rec;
+  xvc_encoder *encoders[2] = { upstream, downstream };
+  xvc_enc_nal_unit *nal_units;
+  int num_nal_units;
+  for (int poc = 0; poc <= kNumPictures; poc++) {
+    for (int i = 0; i < 2; i++) {
+      xvc_enc_pic_buffer rec_pic = { 0 };
+      xvc_enc_pic_buffer *rec_pic_ptr = i == 1 ? &rec_pic : nullptr;
+      if (poc < kNumPictures) {
+        EXPECT_EQ(XVC_ENC_OK,
+                  api_->encoder_encode(encoders[i], &pictures_[poc][0],
+                                       &nal_units, &num_nal_units,
+                                       rec_pic_ptr));
+      } else {
+        EXPECT_EQ(XVC_ENC_OK, api_->encoder_flush(encoders[i], &nal_units,
+                                                  &num_nal_units,
+                                                  rec_pic_ptr));
+      }
+      for (int j = 0; j < num_nal_units; j++) {
+        encoded[i].emplace_back(nal_units[j].bytes,
+                                nal_units[j].bytes + nal_units[j].size);
+      }
+      // Remaining reconstructed pictures are output one per flush call
+      while (rec_pic.size > 0) {
+        downstream_rec.emplace_back(rec_pic.pic, rec_pic.pic + rec_pic.size);
+        rec_pic.size = 0;
+        if (poc == kNumPictures) {
+          EXPECT_EQ(XVC_ENC_OK, api_->encoder_flush(downstream, &nal_units,
+                                                    &num_nal_units, &rec_pic));
+          EXPECT_EQ(0, num_nal_units);
+        }
+      }
+    }
+  }
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(downstream));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(upstream));
+  EXPECT_EQ(expected, encoded[0]);
+  ASSERT_EQ(expected.size(), encoded[1].size());
+  EXPECT_NE(expected, encoded[1]);
+  ASSERT_EQ(static_cast<size_t>(kNumPictures), downstream_rec.size());
+
+  // The downstream stream decodes to the reconstruction of its encoder
+  const xvc_decoder_api *dec_api = xvc_decoder_api_get();
+  xvc_decoder_parameters *dec_params = dec_api->parameters_create();
+  EXPECT_EQ(XVC_DEC_OK, dec_api->parameters_set_default(dec_params));
+  // Reconstructed pictures are output in the internal bitdepth
+  const int bitdepth = sizeof(xvc::Sample) > 1 ? 10 : 8;
+  const int sample_size = bitdepth > 8 ? 2 : 1;
+  dec_params->output_bitdepth = bitdepth;
+  xvc_decoder *decoder = dec_api->decoder_create(dec_params);
+  EXPECT_EQ(XVC_DEC_OK, dec_api->parameters_destroy(dec_params));
+  ASSERT_NE(decoder, nullptr);
+  std::vector<std::vector<uint8_t>> decoded;
+  xvc_decoded_picture decoded_pic;
+  for (size_t i = 0; i <= encoded[1].size(); i++) {
+    if (i < encoded[1].size()) {
+      EXPECT_EQ(XVC_DEC_OK,
+                dec_api->decoder_decode_nal(decoder, &encoded[1][i][0],
+                                            encoded[1][i].size(), 0));
+    } else {
+      EXPECT_EQ(XVC_DEC_OK, dec_api->decoder_flush(decoder));
+    }
+    while (dec_api->decoder_get_picture(decoder, &decoded_pic) ==
+           XVC_DEC_OK) {
+      std::vector<uint8_t> pic;
+      for (int c = 0; c < 3; c++) {
+        const int width = c == 0 ? kWidth : kWidth / 2;
+        const int height = c == 0 ? kHeight : kHeight / 2;
+        for (int y = 0; y < height; y++) {
+          const uint8_t *row = reinterpret_cast<uint8_t*>(
+            decoded_pic.planes[c] + y * decoded_pic.stride[c]);
+          pic.insert(pic.end(), row, row + width * sample_size);
+        }
+      }
+      decoded.push_back(pic);
+    }
+  }
+  EXPECT_EQ(XVC_DEC_OK, dec_api->decoder_destroy(decoder));
+  EXPECT_EQ(downstream_rec, decoded);
+}
+
+TEST_F(EncoderAsyncTest, LadderUpstreamRejectedAfterEncode) {
+  xvc_encoder *upstream = CreateEncoder(0);
+  xvc_encoder *downstream = CreateEncoder(0);
+  ASSERT_NE(upstream, nullptr);
+  ASSERT_NE(downstream, nullptr);
+  xvc_enc_nal_unit *nal_units;
+  int num_nal_units;
+  EXPECT_EQ(XVC_ENC_OK,
+            api_->encoder_encode(upstream, &pictures_[0][0], &nal_units,
+                                 &num_nal_units, nullptr));
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_set_ladder_upstream(downstream, upstream));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(downstream));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(upstream));
+}
+
+TEST_F(EncoderAsyncTest, LadderUpstreamRejectedForOtherStructure) {
+  xvc_encoder *upstream = CreateEncoder(0);
+  ASSERT_NE(upstream, nullptr);
+  xvc_encoder_parameters *params = CreateParameters(0);
+  params->closed_gop = 1;
+  xvc_encoder *closed_gop = api_->encoder_create(params);
+  params->closed_gop = 0;
+  params->explicit_encoder_settings = const_cast<char*>("lookahead 1");
+  xvc_encoder *lookahead = api_->encoder_create(params);
+  params->explicit_encoder_settings = nullptr;
+  EXPECT_EQ(XVC_ENC_OK, api_->parameters_destroy(params));
+  ASSERT_NE(closed_gop, nullptr);
+  ASSERT_NE(lookahead, nullptr);
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_set_ladder_upstream(closed_gop, upstream));
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api_->encoder_set_ladder_upstream(lookahead, upstream));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(lookahead));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(closed_gop));
+  EXPECT_EQ(XVC_ENC_OK, api_->encoder_destroy(upstream));
+}
+
 TEST(EncoderAPI, EncoderFlush) {
   const xvc_encoder_api *api = xvc_encoder_api_get();
 
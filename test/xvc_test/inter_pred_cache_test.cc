@@ -0,0 +1,123 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <algorithm>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/perf_trace.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_enc_lib/inter_pred_cache.h"
+
+namespace {
+
+static const int kSize = 16;
+
+class InterPredCacheTest : public ::testing::Test {
+protected:
+  InterPredCacheTest()
+    : pic_data_(xvc::ChromaFormat::k420, 64, 64, 8),
+    pred_(kSize * kSize),
+    out_(kSize * kSize) {
+  }
+
+  void SetUp() override {
+    cu_ = pic_data_.CreateCu(xvc::CuTree::Primary, 2, 16, 16, kSize, kSize);
+    cu_->SetPredMode(xvc::PredictionMode::kInter);
+    cu_->SetInterDir(xvc::InterDir::kL0);
+    cu_->SetRefIdx(0, xvc::RefPicList::kL0);
+    cu_->SetMv(xvc::MotionVector(5, -3), xvc::RefPicList::kL0);
+    for (int i = 0; i < kSize * kSize; i++) {
+      pred_[i] = static_cast<xvc::Sample>(i * 7 & 255);
+    }
+  }
+
+  void TearDown() override {
+    pic_data_.ReleaseCu(cu_);
+  }
+
+  bool Lookup() {
+    std::fill(out_.begin(), out_.end(), 0);
+    return cache_.Lookup(*cu_, xvc::YuvComponent::kY, &out_[0], kSize);
+  }
+
+  xvc::PictureData pic_data_;
+  xvc::CodingUnit *cu_ = nullptr;
+  xvc::InterPredCache cache_;
+  std::vector<xvc::Sample> pred_;
+  std::vector<xvc::Sample> out_;
+};
+
+TEST_F(InterPredCacheTest, HitReturnsStoredPrediction) {
+  EXPECT_FALSE(Lookup());
+  cache_.Store(*cu_, xvc::YuvComponent::kY, &pred_[0], kSize);
+  EXPECT_TRUE(Lookup());
+  EXPECT_EQ(pred_, out_);
+  EXPECT_EQ(2u, cache_.GetNumLookups());
+  EXPECT_EQ(1u, cache_.GetNumHits());
+}
+
+TEST_F(InterPredCacheTest, MotionAndComponentArePartOfKey) {
+  cache_.Store(*cu_, xvc::YuvComponent::kY, &pred_[0], kSize);
+  EXPECT_FALSE(cache_.Lookup(*cu_, xvc::YuvComponent::kU, &out_[0], kSize));
+  cu_->SetMv(xvc::MotionVector(5, -2), xvc::RefPicList::kL0);
+  EXPECT_FALSE(Lookup());
+  cu_->SetMv(xvc::MotionVector(5, -3), xvc::RefPicList::kL0);
+  cu_->SetRefIdx(1, xvc::RefPicList::kL0);
+  EXPECT_FALSE(Lookup());
+  cu_->SetRefIdx(0, xvc::RefPicList::kL0);
+  EXPECT_TRUE(Lookup());
+}
+
+TEST_F(InterPredCacheTest, UnusedListIsIgnored) {
+  cu_->SetMv(xvc::MotionVector(9, 9), xvc::RefPicList::kL1);
+  cache_.Store(*cu_, xvc::YuvComponent::kY, &pred_[0], kSize);
+  cu_->SetMv(xvc::MotionVector(-4, 1), xvc::RefPicList::kL1);
+  EXPECT_TRUE(Lookup());
+  cu_->SetInterDir(xvc::InterDir::kBi);
+  EXPECT_FALSE(Lookup());
+}
+
+TEST_F(InterPredCacheTest, InvalidateDropsEntries) {
+  cache_.Store(*cu_, xvc::YuvComponent::kY, &pred_[0], kSize);
+  cache_.Invalidate();
+  EXPECT_FALSE(Lookup());
+}
+
+TEST_F(InterPredCacheTest, CountersAreReportedWhenDestroyed) {
+  xvc::PerfStats stats;
+  xvc::ScopedPerfStats scope(&stats);
+  {
+    xvc::InterPredCache cache;
+    cache.Store(*cu_, xvc::YuvComponent::kY, &pred_[0], kSize);
+    EXPECT_TRUE(cache.Lookup(*cu_, xvc::YuvComponent::kY, &out_[0], kSize));
+    // A new ctu does not report the counts of the previous one
+    cache.Invalidate();
+    EXPECT_FALSE(cache.Lookup(*cu_, xvc::YuvComponent::kY, &out_[0], kSize));
+    EXPECT_EQ(0u, stats.GetCount(xvc::PerfCounter::kInterPredCacheLookup));
+  }
+  // Only counted when built with tracing
+  const uint32_t scale = XVC_ENABLE_TRACING ? 1 : 0;
+  EXPECT_EQ(2 * scale,
+            stats.GetCount(xvc::PerfCounter::kInterPredCacheLookup));
+  EXPECT_EQ(1 * scale, stats.GetCount(xvc::PerfCounter::kInterPredCacheHit));
+}
+
+}   // namespace
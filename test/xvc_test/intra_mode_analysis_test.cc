@@ -0,0 +1,108 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <cmath>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/yuv_pic.h"
+#include "xvc_enc_lib/intra_mode_analysis.h"
+
+namespace {
+
+static const int kWidth = 64;
+static const int kHeight = 48;
+static const int kBitdepth = 8;
+
+class IntraModeAnalysisTest : public ::testing::Test {
+protected:
+  // Stripes where sample value only depends on dx * x + dy * y
+  static xvc::YuvPicture CreateStripes(int dx, int dy) {
+    xvc::YuvPicture pic(xvc::ChromaFormat::k420, kWidth, kHeight, kBitdepth,
+                        true);
+    const xvc::YuvComponent comp = xvc::YuvComponent::kY;
+    for (int y = 0; y < kHeight; y++) {
+      xvc::Sample *row = pic.GetSamplePtr(comp, 0, y);
+      for (int x = 0; x < kWidth; x++) {
+        const double phase = 2 * 3.14159265 * (dx * x + dy * y) / 16;
+        row[x] = static_cast<xvc::Sample>(128 + 100 * std::sin(phase));
+      }
+    }
+    return pic;
+  }
+
+  xvc::IntraModeAnalysis::ModeSet GetDominantMode(int dx, int dy) {
+    xvc::IntraModeAnalysis analysis(kWidth, kHeight);
+    analysis.Analyze(CreateStripes(dx, dy));
+    xvc::IntraModeAnalysis::ModeSet modes;
+    analysis.GetCandidateModes(16, 16, 16, 16, 1, 0, &modes);
+    EXPECT_TRUE(modes[xvc::IntraMode::kPlanar]);
+    EXPECT_TRUE(modes[xvc::IntraMode::kDc]);
+    return modes;
+  }
+
+  static int CountModes(const xvc::IntraModeAnalysis::ModeSet &modes) {
+    int count = 0;
+    for (bool mode : modes) {
+      count += mode ? 1 : 0;
+    }
+    return count;
+  }
+};
+
+TEST_F(IntraModeAnalysisTest, FlatAreaHasNoAngularModes) {
+  xvc::IntraModeAnalysis::ModeSet modes = GetDominantMode(0, 0);
+  EXPECT_EQ(2, CountModes(modes));
+}
+
+TEST_F(IntraModeAnalysisTest, HorizontalEdges) {
+  xvc::IntraModeAnalysis::ModeSet modes = GetDominantMode(0, 1);
+  EXPECT_TRUE(modes[xvc::IntraMode::kHorizontal]);
+  EXPECT_EQ(3, CountModes(modes));
+}
+
+TEST_F(IntraModeAnalysisTest, VerticalEdges) {
+  xvc::IntraModeAnalysis::ModeSet modes = GetDominantMode(1, 0);
+  EXPECT_TRUE(modes[xvc::IntraMode::kVertical]);
+  EXPECT_EQ(3, CountModes(modes));
+}
+
+TEST_F(IntraModeAnalysisTest, DiagonalEdges) {
+  // Mode 2 and 34 both predict along the bottom-left to top-right diagonal
+  xvc::IntraModeAnalysis::ModeSet modes = GetDominantMode(1, 1);
+  EXPECT_TRUE(modes[2]);
+  EXPECT_TRUE(modes[34]);
+  EXPECT_EQ(4, CountModes(modes));
+  modes = GetDominantMode(1, -1);
+  EXPECT_TRUE(modes[18]);
+  EXPECT_EQ(3, CountModes(modes));
+}
+
+TEST_F(IntraModeAnalysisTest, NeighborRangeWrapsAround) {
+  xvc::IntraModeAnalysis analysis(kWidth, kHeight);
+  analysis.Analyze(CreateStripes(1, 1));
+  xvc::IntraModeAnalysis::ModeSet modes;
+  analysis.GetCandidateModes(0, 0, kWidth, kHeight, 1, 1, &modes);
+  EXPECT_TRUE(modes[2]);
+  EXPECT_TRUE(modes[3]);
+  EXPECT_TRUE(modes[33]);
+  EXPECT_TRUE(modes[34]);
+  EXPECT_EQ(6, CountModes(modes));
+}
+
+}   // namespace
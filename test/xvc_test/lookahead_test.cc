@@ -0,0 +1,103 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <memory>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/yuv_pic.h"
+#include "xvc_enc_lib/lookahead.h"
+
+namespace {
+
+static const int kWidth = 128;
+static const int kHeight = 96;
+static const int kBitdepth = 8;
+
+class LookaheadTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    lookahead_.reset(new xvc::Lookahead(kWidth, kHeight, kBitdepth, 8));
+  }
+
+  // Smooth texture that can be shifted to simulate motion
+  static xvc::YuvPicture CreatePicture(int seed, int offset_x, int offset_y) {
+    xvc::YuvPicture pic(xvc::ChromaFormat::k420, kWidth, kHeight, kBitdepth,
+                        true);
+    const xvc::YuvComponent comp = xvc::YuvComponent::kY;
+    for (int y = 0; y < kHeight; y++) {
+      xvc::Sample *row = pic.GetSamplePtr(comp, 0, y);
+      for (int x = 0; x < kWidth; x++) {
+        const int tx = (x + offset_x) / 4;
+        const int ty = (y + offset_y) / 4;
+        uint32_t hash = (tx * 73856093u) ^ (ty * 19349663u) ^
+          (seed * 83492791u);
+        hash = hash * 1103515245u + 12345u;
+        row[x] = static_cast<xvc::Sample>((hash >> 16) & 255);
+      }
+    }
+    return pic;
+  }
+
+  std::unique_ptr<xvc::Lookahead> lookahead_;
+};
+
+TEST_F(LookaheadTest, FirstPictureHasNoInterCost) {
+  lookahead_->Push(0, CreatePicture(1, 0, 0));
+  auto analysis = lookahead_->Get(0);
+  ASSERT_TRUE(analysis);
+  EXPECT_EQ(0u, analysis->GetPoc());
+  EXPECT_FALSE(analysis->IsSceneCut());
+  EXPECT_FALSE(analysis->IsInterDominant(0, 0, 64, 64, 1));
+  EXPECT_GT(analysis->GetIntraCost(), 0u);
+}
+
+TEST_F(LookaheadTest, StaticContentIsInterDominant) {
+  lookahead_->Push(0, CreatePicture(1, 0, 0));
+  lookahead_->Push(1, CreatePicture(1, 0, 0));
+  auto analysis = lookahead_->Get(1);
+  ASSERT_TRUE(analysis);
+  EXPECT_FALSE(analysis->IsSceneCut());
+  EXPECT_EQ(0u, analysis->GetInterCost());
+  EXPECT_TRUE(analysis->IsInterDominant(0, 0, kWidth, kHeight, 8));
+  EXPECT_FALSE(lookahead_->HasSceneCut(0, 1));
+}
+
+TEST_F(LookaheadTest, MovingContentIsNotSceneCut) {
+  lookahead_->Push(0, CreatePicture(1, 0, 0));
+  lookahead_->Push(1, CreatePicture(1, 8, 4));
+  lookahead_->Push(2, CreatePicture(1, 16, 8));
+  EXPECT_FALSE(lookahead_->HasSceneCut(1, 2));
+  EXPECT_LT(lookahead_->GetInterIntraRatio(1, 2), 0.5);
+}
+
+TEST_F(LookaheadTest, ContentChangeIsSceneCut) {
+  lookahead_->Push(0, CreatePicture(1, 0, 0));
+  lookahead_->Push(1, CreatePicture(1, 0, 0));
+  lookahead_->Push(2, CreatePicture(2, 0, 0));
+  EXPECT_FALSE(lookahead_->Get(1)->IsSceneCut());
+  EXPECT_TRUE(lookahead_->Get(2)->IsSceneCut());
+  EXPECT_TRUE(lookahead_->HasSceneCut(1, 2));
+}
+
+TEST_F(LookaheadTest, UnknownPictureReturnsNull) {
+  lookahead_->Push(0, CreatePicture(1, 0, 0));
+  EXPECT_FALSE(lookahead_->Get(5));
+}
+
+}   // namespace
@@ -0,0 +1,154 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_enc_lib/motion_field.h"
+
+namespace {
+
+static const int kWidth = 64;
+static const int kHeight = 64;
+static const xvc::PicNum kPoc = 8;
+
+class MotionFieldTest : public ::testing::Test {
+protected:
+  MotionFieldTest()
+    : pic_data_(xvc::ChromaFormat::k420, kWidth, kHeight, 8),
+    field_(kWidth, kHeight) {
+  }
+
+  void SetUp() override {
+    field_.StartPicture(kPoc, nullptr, nullptr);
+  }
+
+  void TearDown() override {
+    for (xvc::CodingUnit *cu : cus_) {
+      pic_data_.ReleaseCu(cu);
+    }
+  }
+
+  const xvc::CodingUnit& CreateCu(int posx, int posy, int width, int height) {
+    cus_.push_back(pic_data_.CreateCu(xvc::CuTree::Primary, 1, posx, posy,
+                                      width, height));
+    return *cus_.back();
+  }
+
+  xvc::MotionField::Candidates GetCandidates(const xvc::MotionField &field,
+                                             const xvc::CodingUnit &cu,
+                                             xvc::PicNum ref_poc) {
+    xvc::MotionField::Candidates cands;
+    field.GetCandidates(cu, ref_poc, &cands);
+    return cands;
+  }
+
+  xvc::PictureData pic_data_;
+  xvc::MotionField field_;
+  std::vector<xvc::CodingUnit*> cus_;
+};
+
+TEST_F(MotionFieldTest, EmptyFieldHasNoCandidates) {
+  EXPECT_TRUE(field_.IsEmpty());
+  EXPECT_EQ(0, GetCandidates(field_, CreateCu(16, 16, 16, 16), 4).num);
+}
+
+TEST_F(MotionFieldTest, ParentMotionSeedsSubCu) {
+  field_.Store(CreateCu(0, 0, 32, 32), 4, xvc::MotionVector(12, -8));
+  EXPECT_FALSE(field_.IsEmpty());
+  xvc::MotionField::Candidates cands =
+    GetCandidates(field_, CreateCu(16, 0, 16, 8), 4);
+  // Left neighbor has the same motion and is not added twice
+  ASSERT_EQ(1, cands.num);
+  EXPECT_EQ(xvc::MotionVector(12, -8), cands.mv[0]);
+}
+
+TEST_F(MotionFieldTest, ScaledToReferenceDistance) {
+  field_.Store(CreateCu(0, 0, 16, 16), 4, xvc::MotionVector(12, -8));
+  const xvc::CodingUnit &cu = CreateCu(0, 0, 8, 8);
+  xvc::MotionField::Candidates cands = GetCandidates(field_, cu, 6);
+  ASSERT_EQ(1, cands.num);
+  EXPECT_EQ(xvc::MotionVector(6, -4), cands.mv[0]);
+  cands = GetCandidates(field_, cu, 10);
+  ASSERT_EQ(1, cands.num);
+  EXPECT_EQ(xvc::MotionVector(-6, 4), cands.mv[0]);
+}
+
+TEST_F(MotionFieldTest, LeftAndAboveNeighbors) {
+  field_.Store(CreateCu(0, 16, 16, 16), 4, xvc::MotionVector(4, 0));
+  field_.Store(CreateCu(16, 0, 16, 16), 4, xvc::MotionVector(0, 4));
+  xvc::MotionField::Candidates cands =
+    GetCandidates(field_, CreateCu(16, 16, 16, 16), 4);
+  ASSERT_EQ(2, cands.num);
+  EXPECT_EQ(xvc::MotionVector(4, 0), cands.mv[0]);
+  EXPECT_EQ(xvc::MotionVector(0, 4), cands.mv[1]);
+}
+
+TEST_F(MotionFieldTest, ColocatedFieldOfPreviousPicture) {
+  xvc::MotionField colocated(kWidth, kHeight);
+  colocated.StartPicture(4, nullptr, nullptr);
+  colocated.Store(CreateCu(32, 32, 32, 32), 0, xvc::MotionVector(-16, 8));
+  field_.StartPicture(kPoc, &colocated, nullptr);
+  // No motion stored yet in the current picture
+  ASSERT_TRUE(field_.IsEmpty());
+  xvc::MotionField::Candidates cands =
+    GetCandidates(field_, CreateCu(32, 32, 16, 16), 6);
+  ASSERT_EQ(1, cands.num);
+  EXPECT_EQ(xvc::MotionVector(-8, 4), cands.mv[0]);
+}
+
+TEST_F(MotionFieldTest, RestoreArea) {
+  const xvc::CodingUnit &cu = CreateCu(16, 16, 32, 16);
+  field_.Store(cu, 4, xvc::MotionVector(3, 3));
+  xvc::MotionField::AreaState state;
+  field_.SaveArea(cu, &state);
+  field_.Store(CreateCu(32, 16, 16, 16), 4, xvc::MotionVector(5, 5));
+  field_.RestoreArea(cu, state);
+  xvc::MotionField::Candidates cands =
+    GetCandidates(field_, CreateCu(32, 16, 8, 8), 4);
+  ASSERT_EQ(1, cands.num);
+  EXPECT_EQ(xvc::MotionVector(3, 3), cands.mv[0]);
+}
+
+TEST_F(MotionFieldTest, RestoreAreaOfEmptyField) {
+  const xvc::CodingUnit &cu = CreateCu(16, 16, 32, 16);
+  xvc::MotionField::AreaState state;
+  field_.SaveArea(cu, &state);
+  field_.Store(CreateCu(32, 16, 16, 16), 4, xvc::MotionVector(5, 5));
+  EXPECT_FALSE(field_.IsEmpty());
+  field_.RestoreArea(cu, state);
+  EXPECT_TRUE(field_.IsEmpty());
+  EXPECT_EQ(0, GetCandidates(field_, CreateCu(32, 16, 8, 8), 4).num);
+}
+
+TEST_F(MotionFieldTest, CopyNeighborhood) {
+  field_.Store(CreateCu(0, 0, 64, 64), 4, xvc::MotionVector(2, 2));
+  xvc::MotionField copy(kWidth, kHeight);
+  copy.StartPicture(kPoc, nullptr, nullptr);
+  const xvc::CodingUnit &cu = CreateCu(32, 32, 16, 16);
+  copy.CopyNeighborhood(field_, cu);
+  xvc::MotionField::Candidates cands = GetCandidates(copy, cu, 4);
+  ASSERT_EQ(1, cands.num);
+  EXPECT_EQ(xvc::MotionVector(2, 2), cands.mv[0]);
+  EXPECT_EQ(0, GetCandidates(copy, CreateCu(0, 0, 16, 16), 4).num);
+}
+
+}   // namespace
@@ -0,0 +1,168 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>   // NOLINT
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_dec_lib/nal_stream_reader.h"
+
+namespace {
+
+class NalStreamReaderTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    // Nal units of varying size, including an empty one
+    const std::vector<size_t> sizes = { 1, 7, 0, 300, 5000, 2 };
+    for (size_t i = 0; i < sizes.size(); i++) {
+      std::vector<uint8_t> nal(sizes[i]);
+      for (size_t j = 0; j < nal.size(); j++) {
+        nal[j] = static_cast<uint8_t>(i * 31 + j);
+      }
+      nals_.push_back(nal);
+      for (int b = 0; b < 4; b++) {
+        bitstream_.push_back(static_cast<char>((sizes[i] >> (8 * b)) & 0xff));
+      }
+      bitstream_.insert(bitstream_.end(), nal.begin(), nal.end());
+    }
+  }
+
+  void TearDown() override {
+    if (!filename_.empty()) {
+      std::remove(filename_.c_str());
+    }
+  }
+
+  std::string WriteFile(const std::string &bytes) {
+    filename_ = "xvc_nal_stream_reader_test.xvc";
+    std::ofstream file(filename_, std::ios_base::binary);
+    file.write(bytes.data(), bytes.size());
+    return filename_;
+  }
+
+  void VerifyAllNals(xvc::NalStreamReader *reader) {
+    for (const auto &expected : nals_) {
+      const uint8_t *nal = nullptr;
+      size_t nal_size = 0;
+      ASSERT_TRUE(reader->ReadNal(&nal, &nal_size));
+      ASSERT_EQ(expected.size(), nal_size);
+      EXPECT_EQ(expected, std::vector<uint8_t>(nal, nal + nal_size));
+    }
+    const uint8_t *nal = nullptr;
+    size_t nal_size = 0;
+    EXPECT_FALSE(reader->ReadNal(&nal, &nal_size));
+    EXPECT_FALSE(reader->IsTruncated());
+  }
+
+  std::vector<std::vector<uint8_t>> nals_;
+  std::string bitstream_;
+  std::string filename_;
+};
+
+TEST_F(NalStreamReaderTest, MappedFile) {
+  auto reader = xvc::NalStreamReader::OpenMapped(WriteFile(bitstream_));
+  ASSERT_TRUE(reader);
+  VerifyAllNals(reader.get());
+  EXPECT_TRUE(reader->Rewind());
+  VerifyAllNals(reader.get());
+}
+
+TEST_F(NalStreamReaderTest, MappedEmptyFile) {
+  auto reader = xvc::NalStreamReader::OpenMapped(WriteFile(std::string()));
+  ASSERT_TRUE(reader);
+  const uint8_t *nal;
+  size_t nal_size;
+  EXPECT_FALSE(reader->ReadNal(&nal, &nal_size));
+  EXPECT_FALSE(reader->IsTruncated());
+}
+
+TEST_F(NalStreamReaderTest, MappedMissingFile) {
+  EXPECT_FALSE(xvc::NalStreamReader::OpenMapped(
+    "xvc_nal_stream_reader_missing.xvc"));
+}
+
+TEST_F(NalStreamReaderTest, FileIsMappedWhenRegular) {
+  auto reader = xvc::NalStreamReader::OpenFile(WriteFile(bitstream_));
+  ASSERT_TRUE(reader);
+  VerifyAllNals(reader.get());
+  // Only a mapped file can be rewound
+  EXPECT_TRUE(reader->Rewind());
+  VerifyAllNals(reader.get());
+  EXPECT_FALSE(xvc::NalStreamReader::OpenFile(
+    "xvc_nal_stream_reader_missing.xvc"));
+}
+
+#if !defined(_WIN32)
+TEST_F(NalStreamReaderTest, FileIsStreamedWhenNamedPipe) {
+  filename_ = "xvc_nal_stream_reader_test.fifo";
+  std::remove(filename_.c_str());
+  ASSERT_EQ(0, mkfifo(filename_.c_str(), 0600));
+  // Opening a named pipe blocks until both ends are open
+  std::thread writer([this]() {
+    std::ofstream file(filename_, std::ios_base::binary);
+    file.write(bitstream_.data(), bitstream_.size());
+  });
+  auto reader = xvc::NalStreamReader::OpenFile(filename_);
+  if (reader) {
+    VerifyAllNals(reader.get());
+    EXPECT_FALSE(reader->Rewind());
+  } else {
+    ADD_FAILURE() << "Failed to open named pipe";
+    std::ifstream unblock_writer(filename_, std::ios_base::binary);
+  }
+  writer.join();
+}
+#endif
+
+TEST_F(NalStreamReaderTest, StreamWithSmallChunks) {
+  // Chunks smaller than the nal units forces buffer wrap around and growth
+  for (size_t chunk_size : { 1, 3, 64, 1 << 20 }) {
+    std::istringstream input(bitstream_);
+    auto reader = xvc::NalStreamReader::OpenStream(&input, chunk_size);
+    VerifyAllNals(reader.get());
+    EXPECT_FALSE(reader->Rewind());
+  }
+}
+
+TEST_F(NalStreamReaderTest, TruncatedStream) {
+  std::string truncated = bitstream_.substr(0, bitstream_.size() - 1);
+  std::istringstream input(truncated);
+  auto stream_reader = xvc::NalStreamReader::OpenStream(&input, 16);
+  auto mapped_reader = xvc::NalStreamReader::OpenMapped(WriteFile(truncated));
+  ASSERT_TRUE(mapped_reader);
+  for (auto reader : { stream_reader.get(), mapped_reader.get() }) {
+    const uint8_t *nal;
+    size_t nal_size;
+    for (size_t i = 0; i + 1 < nals_.size(); i++) {
+      EXPECT_TRUE(reader->ReadNal(&nal, &nal_size));
+    }
+    EXPECT_FALSE(reader->ReadNal(&nal, &nal_size));
+    EXPECT_TRUE(reader->IsTruncated());
+  }
+}
+
+}   // namespace
@@ -0,0 +1,94 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <chrono>
+#include <thread>  // NOLINT
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/perf_trace.h"
+
+namespace {
+
+using xvc::PerfStage;
+using xvc::PerfStats;
+
+void SpinFor(std::chrono::microseconds duration) {
+  const auto end = PerfStats::Clock::now() + duration;
+  while (PerfStats::Clock::now() < end) {
+  }
+}
+
+TEST(PerfTraceTest, TimerWithoutStatsIsIgnored) {
+  ASSERT_EQ(nullptr, PerfStats::GetCurrent());
+  xvc::ScopedTimer timer(PerfStage::kDeblock);
+}
+
+TEST(PerfTraceTest, TimerAccumulatesToCurrentStats) {
+  PerfStats stats;
+  {
+    xvc::ScopedPerfStats scope(&stats);
+    for (int i = 0; i < 2; i++) {
+      xvc::ScopedTimer timer(PerfStage::kDeblock);
+      SpinFor(std::chrono::microseconds(500));
+    }
+  }
+  EXPECT_EQ(nullptr, PerfStats::GetCurrent());
+  EXPECT_GE(stats.GetMicroseconds(PerfStage::kDeblock), 1000u);
+  EXPECT_EQ(0u, stats.GetMicroseconds(PerfStage::kChecksum));
+  stats.Clear();
+  EXPECT_EQ(0u, stats.GetMicroseconds(PerfStage::kDeblock));
+}
+
+TEST(PerfTraceTest, CountersAreClearedWithTimes) {
+  PerfStats stats;
+  stats.Count(xvc::PerfCounter::kInterPredCacheLookup, 5);
+  stats.Count(xvc::PerfCounter::kInterPredCacheLookup, 2);
+  stats.Count(xvc::PerfCounter::kInterPredCacheHit, 3);
+  EXPECT_EQ(7u, stats.GetCount(xvc::PerfCounter::kInterPredCacheLookup));
+  EXPECT_EQ(3u, stats.GetCount(xvc::PerfCounter::kInterPredCacheHit));
+  stats.Clear();
+  EXPECT_EQ(0u, stats.GetCount(xvc::PerfCounter::kInterPredCacheLookup));
+}
+
+TEST(PerfTraceTest, NestedStatsScopeIsRestored) {
+  PerfStats outer;
+  PerfStats inner;
+  xvc::ScopedPerfStats outer_scope(&outer);
+  {
+    xvc::ScopedPerfStats inner_scope(&inner);
+    EXPECT_EQ(&inner, PerfStats::GetCurrent());
+  }
+  EXPECT_EQ(&outer, PerfStats::GetCurrent());
+}
+
+TEST(PerfTraceTest, StatsSharedBetweenThreads) {
+  PerfStats stats;
+  auto worker = [&stats]() {
+    xvc::ScopedPerfStats scope(&stats);
+    xvc::ScopedTimer timer(PerfStage::kRdoQuant);
+    SpinFor(std::chrono::microseconds(500));
+  };
+  std::thread thread1(worker);
+  std::thread thread2(worker);
+  thread1.join();
+  thread2.join();
+  EXPECT_GE(stats.GetMicroseconds(PerfStage::kRdoQuant), 1000u);
+}
+
+}   // namespace
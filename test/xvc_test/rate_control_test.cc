@@ -0,0 +1,194 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_enc_lib/rate_control.h"
+#include "xvc_enc_lib/xvcenc.h"
+#include "xvc_test/yuv_helper.h"
+
+namespace {
+
+static const double kFramerate = 30;
+static const int kWidth = 1280;
+static const int kHeight = 720;
+static const xvc::PicNum kSubGopLength = 8;
+
+class RateControlTest : public ::testing::Test {
+protected:
+  // Synthetic encoder where the size of a picture is inversely
+  // proportional to qstep^qstep_exponent_, with cheaper pictures in higher
+  // temporal layers
+  size_t EncodedBits(int tid, bool intra, int pic_qp,
+                     double complexity) const {
+    double factor = intra ? 1.0 : 0.3 / (1 << tid);
+    return static_cast<size_t>(
+      factor * complexity /
+      std::pow(2.0, qstep_exponent_ * (pic_qp - 4) / 6.0));
+  }
+
+  static int PictureQp(int tid, bool intra, int base_qp) {
+    return intra ? base_qp : base_qp + tid + 1;
+  }
+
+  // Encodes num_pics pictures and returns the resulting bitrate
+  double Encode(xvc::RateControl *rc, int num_pics, double complexity,
+                double scene_cut_complexity = 0) {
+    double total_bits = 0;
+    for (int doc = 0; doc < num_pics; doc++) {
+      int tid = xvc::SegmentHeader::CalcTidFromDoc(doc, kSubGopLength, 0);
+      bool intra = doc == 0 || (intra_key_pics_ && tid == 0);
+      double pic_complexity = complexity;
+      if (scene_cut_complexity > 0 && doc >= num_pics / 2) {
+        pic_complexity = scene_cut_complexity;
+      }
+      int qp = rc->SelectQp(tid, intra, kSubGopLength, pic_complexity);
+      int pic_qp = PictureQp(tid, intra, qp);
+      size_t bits = EncodedBits(tid, intra, pic_qp, pic_complexity);
+      rc->Update(bits, pic_qp);
+      total_bits += bits;
+      min_vbv_fullness_ = std::min(min_vbv_fullness_, rc->GetVbvFullness());
+      last_qp_ = qp;
+    }
+    return total_bits * kFramerate / num_pics;
+  }
+
+  double qstep_exponent_ = 1;
+  bool intra_key_pics_ = false;
+  double min_vbv_fullness_ = 0;
+  int last_qp_ = 0;
+};
+
+TEST_F(RateControlTest, ReachesTargetBitrate) {
+  for (double bitrate : { 1e5, 1e6, 1e7 }) {
+    xvc::RateControl rc(bitrate, kFramerate, 0, kWidth, kHeight);
+    double actual = Encode(&rc, 30 * 20, 4e6);
+    EXPECT_NEAR(1.0, actual / bitrate, 0.05) << bitrate;
+  }
+}
+
+TEST_F(RateControlTest, ReachesTargetBitrateWithLowQstepExponent) {
+  // The size changes less with qp than the initial model assumes, the model
+  // should adapt from the first few intra pictures
+  qstep_exponent_ = 0.5;
+  intra_key_pics_ = true;
+  for (double bitrate : { 1e6, 1e7 }) {
+    xvc::RateControl rc(bitrate, kFramerate, 0, kWidth, kHeight);
+    double actual = Encode(&rc, 30 * 2, 4e5);
+    EXPECT_NEAR(1.0, actual / bitrate, 0.05) << bitrate;
+  }
+}
+
+TEST_F(RateControlTest, HigherBitrateGivesLowerQp) {
+  xvc::RateControl rc_low(1e5, kFramerate, 0, kWidth, kHeight);
+  Encode(&rc_low, 30 * 5, 4e6);
+  int qp_low_rate = last_qp_;
+  xvc::RateControl rc_high(1e6, kFramerate, 0, kWidth, kHeight);
+  Encode(&rc_high, 30 * 5, 4e6);
+  int qp_high_rate = last_qp_;
+  // Ten times the bitrate is 6 * log2(10) qp lower
+  EXPECT_NEAR(qp_low_rate - 20, qp_high_rate, 2);
+}
+
+TEST_F(RateControlTest, VbvBufferDoesNotUnderflow) {
+  const double bitrate = 1e6;
+  const double vbv_buffer_size = bitrate / 2;
+  xvc::RateControl rc(bitrate, kFramerate, vbv_buffer_size, kWidth, kHeight);
+  min_vbv_fullness_ = rc.GetVbvFullness();
+  EXPECT_EQ(vbv_buffer_size * xvc::RateControl::kVbvInitialFullness,
+            min_vbv_fullness_);
+  double actual = Encode(&rc, 30 * 20, 4e6, 4e7);
+  EXPECT_GE(min_vbv_fullness_, 0);
+  EXPECT_LE(rc.GetVbvFullness(), vbv_buffer_size);
+  EXPECT_NEAR(1.0, actual / bitrate, 0.1);
+}
+
+TEST(RateControl, SpatialComplexity) {
+  const int width = 32;
+  const int height = 32;
+  xvc::YuvPicture pic(xvc::ChromaFormat::k420, width, height, 8, false);
+  xvc::Sample *luma = pic.GetSamplePtr(xvc::YuvComponent::kY, 0, 0);
+  const ptrdiff_t stride = pic.GetStride(xvc::YuvComponent::kY);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      luma[y * stride + x] = 100;
+    }
+  }
+  EXPECT_EQ(0, xvc::RateControl::CalcSpatialComplexity(pic));
+  // Alternating rows of 90 and 110 give a standard deviation of 10
+  for (int y = 0; y < height; y += 2) {
+    for (int x = 0; x < width; x++) {
+      luma[y * stride + x] = 90;
+      luma[(y + 1) * stride + x] = 110;
+    }
+  }
+  EXPECT_DOUBLE_EQ(width * height * 10.0,
+                   xvc::RateControl::CalcSpatialComplexity(pic));
+}
+
+TEST(RateControl, EncodedBitrateMatchesTarget) {
+  const int width = 176;
+  const int height = 144;
+  const int framerate = 30;
+  const int num_pics = 2 * framerate;
+  std::vector<std::vector<uint8_t>> pictures;
+  for (int poc = 0; poc < num_pics; poc++) {
+    pictures.push_back(
+      xvc_test::TestYuvPic::GetScaledBytes(width, height, 8, poc));
+  }
+  const xvc_encoder_api *api = xvc_encoder_api_get();
+  for (int target_bitrate : { 200, 600 }) {
+    xvc_encoder_parameters *params = api->parameters_create();
+    ASSERT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+    params->width = width;
+    params->height = height;
+    params->input_bitdepth = 8;
+    params->framerate = framerate;
+    params->speed_mode = 4;
+    params->target_bitrate = target_bitrate;
+    xvc_encoder *encoder = api->encoder_create(params);
+    ASSERT_NE(nullptr, encoder);
+    EXPECT_EQ(XVC_ENC_OK, api->parameters_destroy(params));
+    xvc_enc_nal_unit *nal_units;
+    int num_nal_units;
+    size_t num_bytes = 0;
+    for (int poc = 0; poc <= num_pics; poc++) {
+      if (poc < num_pics) {
+        EXPECT_EQ(XVC_ENC_OK,
+                  api->encoder_encode(encoder, &pictures[poc][0], &nal_units,
+                                      &num_nal_units, nullptr));
+      } else {
+        EXPECT_EQ(XVC_ENC_OK, api->encoder_flush(encoder, &nal_units,
+                                                 &num_nal_units, nullptr));
+      }
+      for (int i = 0; i < num_nal_units; i++) {
+        num_bytes += nal_units[i].size;
+      }
+    }
+    EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
+    double kbps = num_bytes * 8.0 * framerate / num_pics / 1000;
+    EXPECT_NEAR(1.0, kbps / target_bitrate, 0.12) << kbps;
+  }
+}
+
+}   // namespace
@@ -16,6 +16,7 @@
 * The xvc License Agreement is available at https://xvc.io/license/.
 ******************************************************************************/
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <memory>
@@ -29,6 +30,7 @@
 #include "xvc_dec_lib/syntax_reader.h"
 #include "xvc_enc_lib/bit_writer.h"
 #include "xvc_enc_lib/syntax_writer.h"
+#include "xvc_test/test_helper.h"
 
 namespace {
 
@@ -150,7 +152,138 @@ TEST_F(ResidualCoding, AllZero) {
   EncodeDecodeVerify();
 }
 
+TEST_P(ResidualCoding, RestrictedCoeffCtx) {
+  for (int restriction = 1; restriction < 4; restriction++) {
+    xvc_test::ScopedRestrictions restrictions;
+    restrictions.Get().disable_cabac_coeff_sig_ctx = (restriction & 1) != 0;
+    restrictions.Get().disable_cabac_coeff_last_pos_ctx =
+      (restriction & 2) != 0;
+    for (int size : { 4, 16 }) {
+      width_ = size;
+      height_ = size;
+      enc_coeff.fill(GetParam());
+      EncodeDecodeVerify();
+      enc_coeff.fill(0);
+      enc_coeff[(size - 1) * coeff_stride + size - 2] = GetParam();
+      EncodeDecodeVerify();
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(CoeffValues, ResidualCoding,
                         ::testing::Values(1, 2, 3, 255));
 
+TEST(ResidualCodingContexts, SigCtxTableMatchesPerCoeffDerivation) {
+  xvc::CabacContexts ctx;
+  const xvc::YuvComponent comps[] = {
+    xvc::YuvComponent::kY, xvc::YuvComponent::kU
+  };
+  for (xvc::YuvComponent comp : comps) {
+    xvc::ContextModel *ctx_base = ctx.GetCoeffSigCtxBase(comp);
+    for (int scan = 0; scan < static_cast<int>(xvc::ScanOrder::kTotalNumber);
+         scan++) {
+      const xvc::ScanOrder scan_order = static_cast<xvc::ScanOrder>(scan);
+      const uint8_t *scan_table =
+        xvc::TransformHelper::GetCoeffScanTable4x4(scan_order);
+      for (int width_log2 = 2; width_log2 <= 6; width_log2++) {
+        for (int height_log2 = 2; height_log2 <= 6; height_log2++) {
+          for (int pattern_sig_ctx = 0; pattern_sig_ctx < 4;
+               pattern_sig_ctx++) {
+            for (int y = 0; y < (1 << height_log2); y += 4) {
+              for (int x = 0; x < (1 << width_log2); x += 4) {
+                const uint8_t *ctx_idx =
+                  ctx.GetCoeffSigCtxIdx(comp, pattern_sig_ctx, scan_order,
+                                        x == 0 && y == 0, width_log2,
+                                        height_log2);
+                for (int i = 0; i < 16; i++) {
+                  int posx = x + (scan_table[i] & 3);
+                  int posy = y + (scan_table[i] >> 2);
+                  EXPECT_EQ(&ctx.GetCoeffSigCtx(comp, pattern_sig_ctx,
+                                                scan_order, posx, posy,
+                                                width_log2, height_log2),
+                            &ctx_base[ctx_idx[i]]);
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Last position context derivation as it was done for every bin before the
+// context indices were tabulated
+static int ReferenceLastPosCtx(bool is_luma, bool alt_ctx, int size_log2,
+                               int pos) {
+  if (is_luma && alt_ctx) {
+    static const int kOffset[8] = { 0, 0, 0, 3, 6, 10, 15, 21 };
+    return kOffset[size_log2] + (pos >> ((size_log2 + 1) / 4));
+  }
+  if (is_luma) {
+    const int size_bits = size_log2 - 2;
+    return 3 * size_bits + (size_bits + 1) / 4 + (pos >> ((size_bits + 3) / 4));
+  }
+  if (alt_ctx) {
+    return pos >> std::min((1 << size_log2) / 8, 2);
+  }
+  return pos >> std::max(size_log2 - 2, 0);
+}
+
+TEST(ResidualCodingContexts, LastPosCtxTableMatchesReference) {
+  xvc::CabacContexts ctx;
+  for (int alt_ctx = 0; alt_ctx < 2; alt_ctx++) {
+    xvc_test::ScopedRestrictions restrictions;
+    restrictions.Get().disable_cabac_coeff_last_pos_ctx = false;
+    restrictions.Get().disable_ext_cabac_alt_last_pos_ctx = alt_ctx == 0;
+    for (int luma = 0; luma < 2; luma++) {
+      const xvc::YuvComponent comp =
+        luma ? xvc::YuvComponent::kY : xvc::YuvComponent::kU;
+      const int num_ctx = luma ? xvc::CabacContexts::kNumCoeffLastPosCtxLuma :
+        xvc::CabacContexts::kNumCoeffLastPosCtxChroma;
+      for (int size_log2 = luma ? 2 : 1; size_log2 <= (luma ? 7 : 6);
+           size_log2++) {
+        const int size = 1 << size_log2;
+        const uint8_t *ctx_idx = ctx.GetCoeffLastPosCtxIdx(comp, size);
+        // The prefix is truncated, the bin after the max group is not coded
+        const int num_bins = xvc::TransformHelper::kLastPosGroupIdx[size - 1];
+        for (int pos = 0; pos < num_bins; pos++) {
+          int expected = ReferenceLastPosCtx(luma != 0, alt_ctx != 0,
+                                             size_log2, pos);
+          EXPECT_EQ(expected, ctx_idx[pos])
+            << "luma " << luma << " alt " << alt_ctx << " size " << size
+            << " bin " << pos;
+          EXPECT_LT(ctx_idx[pos], num_ctx);
+        }
+      }
+    }
+  }
+}
+
+TEST(ResidualCodingContexts, RestrictedCtxIdxAreZero) {
+  xvc::CabacContexts ctx;
+  xvc_test::ScopedRestrictions restrictions;
+  restrictions.Get().disable_cabac_coeff_sig_ctx = true;
+  restrictions.Get().disable_cabac_coeff_last_pos_ctx = true;
+  const xvc::YuvComponent comps[] = {
+    xvc::YuvComponent::kY, xvc::YuvComponent::kU
+  };
+  for (xvc::YuvComponent comp : comps) {
+    for (int size_log2 = 2; size_log2 <= 6; size_log2++) {
+      for (bool first_subblock : { false, true }) {
+        const uint8_t *sig_ctx_idx =
+          ctx.GetCoeffSigCtxIdx(comp, 0, xvc::ScanOrder::kDiagonal,
+                                first_subblock, size_log2, size_log2);
+        EXPECT_TRUE(std::all_of(sig_ctx_idx, sig_ctx_idx + 16,
+                                [](uint8_t idx) { return idx == 0; }));
+      }
+      const int size = 1 << size_log2;
+      const uint8_t *last_pos_ctx_idx = ctx.GetCoeffLastPosCtxIdx(comp, size);
+      const int num_bins = xvc::TransformHelper::kLastPosGroupIdx[size - 1] + 1;
+      EXPECT_TRUE(std::all_of(last_pos_ctx_idx, last_pos_ctx_idx + num_bins,
+                              [](uint8_t idx) { return idx == 0; }));
+    }
+  }
+}
+
 }   // namespace
@@ -0,0 +1,109 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/quantize.h"
+#include "xvc_enc_lib/sample_metric.h"
+
+namespace {
+
+class SampleMetricTest : public ::testing::TestWithParam<int> {
+protected:
+  void SetUp() override {
+    const int bitdepth = GetParam();
+    const int max_val = (1 << bitdepth) - 1;
+    qp_.reset(new xvc::Qp(32, xvc::ChromaFormat::k420, bitdepth, 0));
+    orig_.resize(kStride * kSize);
+    ref_.resize(kStride * (kSize + kNumCand));
+    uint32_t seed = 1;
+    for (auto &sample : orig_) {
+      seed = seed * 1103515245 + 12345;
+      sample = static_cast<xvc::Sample>((seed >> 16) & max_val);
+    }
+    for (auto &sample : ref_) {
+      seed = seed * 1103515245 + 12345;
+      sample = static_cast<xvc::Sample>((seed >> 16) & max_val);
+    }
+  }
+
+  void VerifyBatchMatchesSingle(xvc::MetricType type, int width, int height,
+                                int num_cand) {
+    xvc::SampleMetric metric(type, *qp_, GetParam());
+    std::array<const xvc::Sample*, kNumCand> cand_ptr;
+    for (int i = 0; i < num_cand; i++) {
+      cand_ptr[i] = &ref_[i * kStride + i];
+    }
+    std::array<xvc::Distortion, kNumCand> batch_dist;
+    metric.CompareSampleBatch(xvc::YuvComponent::kY, width, height,
+                              &orig_[0], kStride, &cand_ptr[0], kStride,
+                              num_cand, &batch_dist[0]);
+    for (int i = 0; i < num_cand; i++) {
+      xvc::Distortion dist =
+        metric.CompareSample(xvc::YuvComponent::kY, width, height,
+                             &orig_[0], kStride, cand_ptr[i], kStride);
+      EXPECT_EQ(dist, batch_dist[i]) << "cand " << i << " size " << width
+        << "x" << height;
+    }
+  }
+
+  static const int kSize = 64;
+  static const int kStride = kSize + 16;
+  static const int kNumCand = xvc::SampleMetric::kMaxBatchSize;
+  std::unique_ptr<xvc::Qp> qp_;
+  std::vector<xvc::Sample> orig_;
+  std::vector<xvc::Sample> ref_;
+};
+
+TEST_P(SampleMetricTest, BatchSad) {
+  for (int num_cand = 1; num_cand <= kNumCand; num_cand++) {
+    VerifyBatchMatchesSingle(xvc::MetricType::kSad, 8, 8, num_cand);
+    VerifyBatchMatchesSingle(xvc::MetricType::kSad, 16, 4, num_cand);
+  }
+  VerifyBatchMatchesSingle(xvc::MetricType::kSad, 64, 64, kNumCand);
+}
+
+TEST_P(SampleMetricTest, BatchSadFast) {
+  for (int num_cand = 1; num_cand <= kNumCand; num_cand++) {
+    VerifyBatchMatchesSingle(xvc::MetricType::kSadFast, 16, 16, num_cand);
+  }
+  VerifyBatchMatchesSingle(xvc::MetricType::kSadFast, 32, 64, kNumCand);
+}
+
+TEST_P(SampleMetricTest, BatchSatd) {
+  VerifyBatchMatchesSingle(xvc::MetricType::kSatd, 4, 4, 4);
+  VerifyBatchMatchesSingle(xvc::MetricType::kSatd, 16, 8, 5);
+  VerifyBatchMatchesSingle(xvc::MetricType::kSatd, 32, 32, kNumCand);
+}
+
+TEST_P(SampleMetricTest, BatchSsdFallback) {
+  VerifyBatchMatchesSingle(xvc::MetricType::kSsd, 8, 16, 3);
+}
+
+INSTANTIATE_TEST_CASE_P(NormalBitdepth, SampleMetricTest,
+                        ::testing::Values(8));
+#if XVC_HIGH_BITDEPTH
+INSTANTIATE_TEST_CASE_P(HighBitdepth, SampleMetricTest,
+                        ::testing::Values(10));
+#endif
+
+}   // namespace
@@ -0,0 +1,135 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_test/test_helper.h"
+#include "xvc_test/yuv_helper.h"
+
+namespace {
+
+static const int kQp = 27;
+static const double kPsnrThreshold = 28.0;
+static const int kSize = 32;
+// Several 64x64 ctus with fast motion so that the motion search start
+// candidates of large cus matter when evaluated in parallel
+static const int kParallelWidth = 192;
+static const int kParallelHeight = 128;
+static const int kParallelPicSteps[] = { 8, 12 };
+static const int kSubGopLength = 4;
+static const int kFramesEncoded = 2 * kSubGopLength + 1;
+
+class SpeedModeTest : public ::testing::TestWithParam<int>,
+  public ::xvc_test::EncoderHelper, public ::xvc_test::DecoderHelper {
+protected:
+  void SetUp() override {
+    encoder_settings_.Initialize(static_cast<xvc::SpeedMode>(GetParam()));
+    encoder_settings_.Tune(xvc::TuneMode::kPsnr);
+    DecoderHelper::Init();
+  }
+
+  void EncodeDecode() {
+    encoder_ = CreateEncoder(encoder_settings_, kSize, kSize, 8, kQp);
+    encoder_->SetSubGopLength(kSubGopLength);
+    for (int i = 0; i < kFramesEncoded; i++) {
+      orig_pics_.emplace_back(kSize, kSize, 8, i, i);
+      verified_.push_back(false);
+      EncodeOneFrame(orig_pics_.back().GetBytes(), 8);
+    }
+    EncoderFlush();
+
+    while (HasMoreNals()) {
+      const xvc_test::NalUnit &nal = GetNextNalToDecode();
+      ASSERT_TRUE(decoder_->DecodeNal(&nal[0], nal.size()));
+      if (decoder_->GetDecodedPicture(&last_decoded_picture_)) {
+        VerifyPicture(last_decoded_picture_);
+      }
+    }
+    while (DecoderFlushAndGet()) {
+      VerifyPicture(last_decoded_picture_);
+    }
+    EXPECT_EQ(0, decoder_->GetNumCorruptedPics());
+    for (int poc = 0; poc < kFramesEncoded; poc++) {
+      EXPECT_TRUE(verified_[poc]) << "Picture poc " << poc;
+    }
+  }
+
+  std::vector<xvc_test::NalUnit> Encode(int width, int height,
+                                        int pic_step) {
+    encoded_nal_units_.clear();
+    encoder_ = CreateEncoder(encoder_settings_, width, height, 8, kQp);
+    encoder_->SetSubGopLength(kSubGopLength);
+    for (int i = 0; i < kFramesEncoded; i++) {
+      EncodeOneFrame(xvc_test::TestYuvPic::GetScaledBytes(width, height, 8,
+                                                          i * pic_step), 8);
+    }
+    EncoderFlush();
+    return encoded_nal_units_;
+  }
+
+  void VerifyPicture(const xvc_decoded_picture &decoded_picture) {
+    const int poc = decoded_picture.stats.poc;
+    ASSERT_LT(poc, kFramesEncoded);
+    EXPECT_FALSE(verified_[poc]);
+    double psnr = orig_pics_[poc].CalcPsnr(decoded_picture.bytes);
+    EXPECT_GE(psnr, kPsnrThreshold) << "Picture poc " << poc;
+    verified_[poc] = true;
+  }
+
+  xvc::EncoderSettings encoder_settings_;
+  std::vector<xvc_test::TestYuvPic> orig_pics_;
+  std::vector<bool> verified_;
+};
+
+TEST_P(SpeedModeTest, EncodeDecode) {
+  EncodeDecode();
+}
+
+TEST_P(SpeedModeTest, EncodeDecodeWithEarlySplitTermination) {
+  encoder_settings_.early_split_termination = 1;
+  EncodeDecode();
+}
+
+TEST_P(SpeedModeTest, ParallelSplitRdoGivesSameBitstream) {
+  if (GetParam() == static_cast<int>(xvc::SpeedMode::kPlacebo)) {
+    // Same split evaluation as slow speed mode, but too slow to encode
+    return;
+  }
+  for (int pic_step : kParallelPicSteps) {
+    encoder_settings_.parallel_split_rdo = 0;
+    std::vector<xvc_test::NalUnit> sequential_nals =
+      Encode(kParallelWidth, kParallelHeight, pic_step);
+    encoder_settings_.parallel_split_rdo = 2;
+    std::vector<xvc_test::NalUnit> parallel_nals =
+      Encode(kParallelWidth, kParallelHeight, pic_step);
+    ASSERT_EQ(sequential_nals.size(), parallel_nals.size());
+    for (size_t i = 0; i < sequential_nals.size(); i++) {
+      EXPECT_EQ(sequential_nals[i], parallel_nals[i])
+        << "Nal unit " << i << " pic step " << pic_step;
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(SpeedModes, SpeedModeTest,
+                        ::testing::Range(
+                          0, static_cast<int>(xvc::SpeedMode::kTotalNumber)));
+
+}   // namespace
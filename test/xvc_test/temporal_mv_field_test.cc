@@ -0,0 +1,108 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/temporal_mv_field.h"
+
+namespace {
+
+static const int kWidth = 72;
+static const int kHeight = 64;
+static const xvc::PicNum kPoc = 8;
+
+class TemporalMvFieldTest : public ::testing::Test {
+protected:
+  TemporalMvFieldTest()
+    : pic_data_(xvc::ChromaFormat::k420, kWidth, kHeight, 8),
+    qp_(32, xvc::ChromaFormat::k420, 8, 1.0) {
+  }
+
+  void SetUp() override {
+    pic_data_.SetPoc(kPoc);
+  }
+
+  void TearDown() override {
+    for (xvc::CodingUnit *cu : cus_) {
+      pic_data_.ClearMarkCuInPic(cu);
+      pic_data_.ReleaseCu(cu);
+    }
+  }
+
+  xvc::CodingUnit* CreateCu(int posx, int posy, int width, int height,
+                            xvc::PredictionMode pred_mode) {
+    xvc::CodingUnit *cu = pic_data_.CreateCu(xvc::CuTree::Primary, 1, posx,
+                                             posy, width, height);
+    cu->SetPredMode(pred_mode);
+    cu->SetQp(qp_);
+    pic_data_.MarkUsedInPic(cu);
+    cus_.push_back(cu);
+    return cu;
+  }
+
+  xvc::PictureData pic_data_;
+  xvc::Qp qp_;
+  xvc::TemporalMvField field_;
+  std::vector<xvc::CodingUnit*> cus_;
+};
+
+TEST_F(TemporalMvFieldTest, CopiesMotionOfInterCus) {
+  xvc::CodingUnit *cu = CreateCu(16, 8, 16, 8, xvc::PredictionMode::kInter);
+  cu->SetInterDir(xvc::InterDir::kL1);
+  cu->SetMv(xvc::MotionVector(-5, 7), xvc::RefPicList::kL1);
+  cu->SetRefIdx(1, xvc::RefPicList::kL1);
+  CreateCu(0, 0, 16, 16, xvc::PredictionMode::kIntra);
+  field_.Build(pic_data_);
+
+  EXPECT_EQ(kPoc, field_.GetPoc());
+  const xvc::TemporalMvField::Entry &entry = field_.GetEntryAt(28, 12);
+  EXPECT_TRUE(entry.IsInter());
+  EXPECT_FALSE(entry.HasMv(xvc::RefPicList::kL0));
+  EXPECT_TRUE(entry.HasMv(xvc::RefPicList::kL1));
+  EXPECT_EQ(1, entry.GetRefIdx(xvc::RefPicList::kL1));
+  EXPECT_EQ(xvc::MotionVector(-5, 7), entry.GetMv(xvc::RefPicList::kL1));
+  EXPECT_FALSE(field_.GetEntryAt(4, 4).IsInter());
+  EXPECT_FALSE(field_.GetEntryAt(16, 16).IsInter());
+}
+
+TEST_F(TemporalMvFieldTest, StoresDepthAtMinimumCuSize) {
+  // Quad depth 1 and binary depth 2
+  CreateCu(0, 0, 16, 16, xvc::PredictionMode::kIntra);
+  // Quad depth 1 and binary depth 5
+  CreateCu(16, 0, 8, 4, xvc::PredictionMode::kInter);
+  field_.Build(pic_data_);
+  EXPECT_EQ(3, field_.GetDepthAt(12, 12));
+  EXPECT_EQ(6, field_.GetDepthAt(20, 0));
+  EXPECT_EQ(-1, field_.GetDepthAt(20, 4));
+}
+
+TEST_F(TemporalMvFieldTest, OutsideOfPictureHasNoMotion) {
+  xvc::CodingUnit *cu = CreateCu(64, 56, 8, 8, xvc::PredictionMode::kInter);
+  cu->SetInterDir(xvc::InterDir::kBi);
+  field_.Build(pic_data_);
+  EXPECT_TRUE(field_.GetEntryAt(68, 60).IsInter());
+  EXPECT_FALSE(field_.GetEntryAt(kWidth, 60).IsInter());
+  EXPECT_FALSE(field_.GetEntryAt(68, kHeight).IsInter());
+}
+
+}   // namespace
@@ -24,6 +24,7 @@
 
 #include "googletest/include/gtest/gtest.h"
 
+#include "xvc_common_lib/restrictions.h"
 #include "xvc_dec_lib/decoder.h"
 #include "xvc_enc_lib/encoder.h"
 
@@ -31,6 +32,17 @@ namespace xvc_test {
 
 using NalUnit = std::vector<uint8_t>;
 
+// Overrides restriction flags of the calling thread until destroyed
+class ScopedRestrictions {
+public:
+  ScopedRestrictions() : saved_(xvc::Restrictions::Get()) {}
+  ~ScopedRestrictions() { xvc::Restrictions::GetRW() = saved_; }
+  xvc::Restrictions& Get() { return xvc::Restrictions::GetRW(); }
+
+private:
+  const xvc::Restrictions saved_;
+};
+
 class EncoderHelper {
 protected:
   static const int kDefaultQp = 27;
@@ -0,0 +1,81 @@
+/******************************************************************************
+* Copyright (C) 2017, Divideon.
+*
+* Redistribution and use in source and binary form, with or without
+* modifications is permitted only under the terms and conditions set forward
+* in the xvc License Agreement. For commercial redistribution and use, you are
+* required to send a signed copy of the xvc License Agreement to Divideon.
+*
+* Redistribution and use in source and binary form is permitted free of charge
+* for non-commercial purposes. See definition of non-commercial in the xvc
+* License Agreement.
+*
+* All redistribution of source code must retain this copyright notice
+* unmodified.
+*
+* The xvc License Agreement is available at https://xvc.io/license/.
+******************************************************************************/
+
+#include <atomic>
+#include <thread>   // NOLINT
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/tile_thread_pool.h"
+
+namespace {
+
+TEST(TileThreadPool, CodesEachTileOnce) {
+  for (int num_threads : { 0, 1, 4 }) {
+    xvc::TileThreadPool pool(num_threads);
+    for (int num_tiles : { 1, 2, 7 }) {
+      std::vector<std::atomic<int>> num_coded(num_tiles);
+      for (auto &n : num_coded) {
+        n = 0;
+      }
+      pool.Run(num_tiles, [&num_coded](int tile) { num_coded[tile]++; });
+      for (int tile = 0; tile < num_tiles; tile++) {
+        EXPECT_EQ(1, num_coded[tile]) << num_threads << " " << tile;
+      }
+    }
+  }
+}
+
+TEST(TileThreadPool, InlineWithoutWorkers) {
+  xvc::TileThreadPool pool(1);
+  const std::thread::id caller = std::this_thread::get_id();
+  int num_other_thread = 0;
+  pool.Run(4, [&](int tile) {
+    num_other_thread += std::this_thread::get_id() != caller;
+  });
+  EXPECT_EQ(0, num_other_thread);
+}
+
+TEST(TileThreadPool, ConcurrentPictures) {
+  const int num_pictures = 3;
+  const int num_tiles = 6;
+  xvc::TileThreadPool pool(2);
+  std::vector<std::atomic<int>> num_coded(num_pictures * num_tiles);
+  for (auto &n : num_coded) {
+    n = 0;
+  }
+  std::vector<std::thread> pictures;
+  for (int pic = 0; pic < num_pictures; pic++) {
+    pictures.emplace_back([&, pic]() {
+      for (int i = 0; i < 10; i++) {
+        pool.Run(num_tiles, [&, pic](int tile) {
+          num_coded[pic * num_tiles + tile]++;
+        });
+      }
+    });
+  }
+  for (std::thread &picture : pictures) {
+    picture.join();
+  }
+  for (auto &n : num_coded) {
+    EXPECT_EQ(10, n);
+  }
+}
+
+}   // namespace
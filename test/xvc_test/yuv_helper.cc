@@ -161,6 +161,78 @@ TestYuvPic::TestYuvPic(int width, int height, int bitdepth, int dx, int dy,
   }
 }
 
+std::vector<uint8_t>
+TestYuvPic::GetScaledBytes(int width, int height, int bitdepth, int pic_num,
+                           xvc::ChromaFormat chroma_fmt) {
+  // Positions in 1/16 sample units of the internal test content
+  const int kPrecision = 4;
+  const int kOne = 1 << kPrecision;
+  const int scale = std::max(1, height / 360);
+  const int pan_x = pic_num * 11;
+  const int pan_y = pic_num * 5;
+  const int down_shift = std::max(0, kInternalBitdepth - bitdepth);
+  const int up_shift = std::max(0, bitdepth - kInternalBitdepth);
+  const Sample max_val = (1 << bitdepth) - 1;
+  const int sample_size = bitdepth == 8 ? 1 : 2;
+  std::vector<uint8_t> bytes(
+    xvc::util::GetTotalNumSamples(width, height, chroma_fmt) * sample_size);
+  const int num_comp = xvc::util::GetNumComponents(chroma_fmt);
+  uint8_t *dst = &bytes[0];
+  for (int c = 0; c < num_comp; c++) {
+    const xvc::YuvComponent comp = xvc::YuvComponent(c);
+    const int comp_width = xvc::util::ScaleSizeX(width, chroma_fmt, comp);
+    const int comp_height = xvc::util::ScaleSizeY(height, chroma_fmt, comp);
+    const int shift_x = c == 0 ? 0 : xvc::util::GetChromaShiftX(chroma_fmt);
+    const int shift_y = c == 0 ? 0 : xvc::util::GetChromaShiftY(chroma_fmt);
+    // Test content chroma planes are always subsampled by two
+    const int src_shift = c == 0 ? 0 : 1;
+    const int src_size = kInternalPicSize >> src_shift;
+    const uint16_t *src = &kTestSamples[0];
+    if (c > 0) {
+      src += kInternalPicSize * kInternalPicSize + (c - 1) * src_size * src_size;
+    }
+    // Mirrored repetition of the test content
+    auto mirror = [src_size](int pos) {
+      const int period = 2 * (src_size - 1);
+      pos %= period;
+      return pos < src_size ? pos : period - pos;
+    };
+    std::vector<int> idx_x(comp_width);
+    std::vector<int> frac_x(comp_width);
+    for (int x = 0; x < comp_width; x++) {
+      const int pos = (((x << shift_x) << kPrecision) / scale + pan_x) >>
+        src_shift;
+      idx_x[x] = pos >> kPrecision;
+      frac_x[x] = pos & (kOne - 1);
+    }
+    for (int y = 0; y < comp_height; y++) {
+      const int pos = (((y << shift_y) << kPrecision) / scale + pan_y) >>
+        src_shift;
+      const uint16_t *row0 = src + mirror(pos >> kPrecision) * src_size;
+      const uint16_t *row1 = src + mirror((pos >> kPrecision) + 1) * src_size;
+      const int fy = pos & (kOne - 1);
+      for (int x = 0; x < comp_width; x++) {
+        const int x0 = mirror(idx_x[x]);
+        const int x1 = mirror(idx_x[x] + 1);
+        const int fx = frac_x[x];
+        const int top = row0[x0] * (kOne - fx) + row0[x1] * fx;
+        const int bottom = row1[x0] * (kOne - fx) + row1[x1] * fx;
+        const int val = (top * (kOne - fy) + bottom * fy +
+                         (1 << (2 * kPrecision - 1))) >> (2 * kPrecision);
+        const Sample sample =
+          xvc::util::ClipBD((val >> down_shift) << up_shift, max_val);
+        if (sample_size == 1) {
+          *dst++ = static_cast<uint8_t>(sample);
+        } else {
+          *dst++ = static_cast<uint8_t>(sample & 0xff);
+          *dst++ = static_cast<uint8_t>(sample >> 8);
+        }
+      }
+    }
+  }
+  return bytes;
+}
+
 double TestYuvPic::CalcPsnr(const char *pic_bytes) const {
   int ssd = 0;
   if (bitdepth_ == 8) {
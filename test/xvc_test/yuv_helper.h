@@ -39,6 +39,11 @@ public:
   const std::vector<uint8_t> GetBytes() const { return bytes_; }
   int GetBitdepth() const { return bitdepth_; }
   double CalcPsnr(const char *bytes) const;
+  // Picture of any size generated by scaling up the test content,
+  // the content is panned with pic_num to give motion between pictures
+  static std::vector<uint8_t>
+    GetScaledBytes(int width, int height, int bitdepth, int pic_num,
+                   xvc::ChromaFormat chroma_fmt = xvc::ChromaFormat::k420);
 
   static ::testing::AssertionResult
     AllSampleEqualTo(int width, int height, int bitdepth,